@@ -105,6 +105,8 @@ namespace PowerFS {
     inline constexpr auto kCpuSysfsDir       = "/sys/devices/system/cpu";
     inline constexpr auto kCpuGovernorFmt    = "/sys/devices/system/cpu/%1/cpufreq/scaling_governor";
     inline constexpr auto kCpuBoostPath      = "/sys/devices/system/cpu/cpufreq/boost";
+    inline constexpr auto kAcpiFirmwareDir   = "/sys/firmware/acpi";
+    inline constexpr auto kPowerControlPath  = "/usr/sbin/deepin-power-control";
     inline constexpr auto kLidStatePath      = "/proc/acpi/button/lid/LID/state";
     inline constexpr auto kDpmsStateFile     = "/tmp/dpms-state";
     inline constexpr auto kNoSuspendFile     = "/etc/deepin/no_suspend";
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "propertieschangednotifier.h"
+
+#include <QDBusMessage>
+#include <QMetaProperty>
+
+PropertiesChangedNotifier::PropertiesChangedNotifier(QObject *target, const QString &path,
+                                                     const QString &interface, SendFunc send)
+    : QObject(target)
+    , m_target(target)
+    , m_path(path)
+    , m_interface(interface)
+    , m_send(std::move(send))
+{
+    const QMetaMethod slot = metaObject()->method(metaObject()->indexOfSlot("markDirty()"));
+    const QMetaObject *mo = target->metaObject();
+    for (int i = mo->propertyOffset(); i < mo->propertyCount(); ++i) {
+        QMetaProperty prop = mo->property(i);
+        if (!prop.hasNotifySignal() || !prop.isReadable())
+            continue;
+        // 记录当前值作为基线，客户端此时通过 GetAll 拿到的也是这些值
+        m_lastSent.insert(QString::fromLatin1(prop.name()), prop.read(target));
+        m_signalToProperty.insert(prop.notifySignalIndex(), i);
+        connect(target, prop.notifySignal(), this, slot);
+    }
+}
+
+void PropertiesChangedNotifier::markDirty()
+{
+    auto it = m_signalToProperty.constFind(senderSignalIndex());
+    if (it == m_signalToProperty.constEnd())
+        return;
+
+    m_dirty.insert(*it);
+    if (!m_flushQueued) {
+        m_flushQueued = true;
+        QMetaObject::invokeMethod(this, &PropertiesChangedNotifier::flush, Qt::QueuedConnection);
+    }
+}
+
+void PropertiesChangedNotifier::flush()
+{
+    m_flushQueued = false;
+    if (m_dirty.isEmpty())
+        return;
+
+    const QMetaObject *mo = m_target->metaObject();
+    QVariantMap changed;
+    for (int idx : std::as_const(m_dirty)) {
+        QMetaProperty prop = mo->property(idx);
+        const QString name = QString::fromLatin1(prop.name());
+        const QVariant value = prop.read(m_target);
+        auto last = m_lastSent.find(name);
+        if (last != m_lastSent.end() && *last == value)
+            continue;
+        m_lastSent.insert(name, value);
+        changed.insert(name, value);
+    }
+    m_dirty.clear();
+
+    if (changed.isEmpty() || !m_send)
+        return;
+
+    QDBusMessage msg = QDBusMessage::createSignal(
+        m_path,
+        QStringLiteral("org.freedesktop.DBus.Properties"),
+        QStringLiteral("PropertiesChanged"));
+    msg << m_interface << changed << QStringList();
+    m_send(msg);
+}
@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QSet>
+#include <QVariantMap>
+
+#include <functional>
+
+class QDBusMessage;
+
+// 把目标对象所有 Q_PROPERTY(NOTIFY) 桥接到 org.freedesktop.DBus.Properties.PropertiesChanged。
+// NOTIFY 信号只把属性标记为脏，在下一轮事件循环统一发送一条消息，
+// 且只携带与上次发送值不同的属性。
+class PropertiesChangedNotifier : public QObject
+{
+    Q_OBJECT
+public:
+    using SendFunc = std::function<void(const QDBusMessage &)>;
+
+    PropertiesChangedNotifier(QObject *target, const QString &path,
+                              const QString &interface, SendFunc send);
+
+    bool hasPending() const { return !m_dirty.isEmpty(); }
+
+public Q_SLOTS:
+    void flush();
+
+private Q_SLOTS:
+    void markDirty();
+
+private:
+    QObject *m_target = nullptr;
+    QString m_path;
+    QString m_interface;
+    SendFunc m_send;
+    QHash<int, int> m_signalToProperty;
+    QSet<int> m_dirty;
+    QVariantMap m_lastSent;
+    bool m_flushQueued = false;
+};
@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "deadlinescheduler.h"
+
+#include <QLoggingCategory>
+#include <QTimer>
+
+#include <algorithm>
+#include <limits>
+
+Q_DECLARE_LOGGING_CATEGORY(logPowerSession)
+
+DeadlineScheduler::DeadlineScheduler(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+{
+    m_elapsed.start();
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::CoarseTimer);
+    connect(m_timer, &QTimer::timeout, this, &DeadlineScheduler::runDue);
+}
+
+void DeadlineScheduler::setClock(Clock clock)
+{
+    m_clock = std::move(clock);
+    arm();
+}
+
+qint64 DeadlineScheduler::now() const
+{
+    return m_clock ? m_clock() : m_elapsed.elapsed();
+}
+
+void DeadlineScheduler::schedule(qint64 delayMs, Task fn, const QString &name)
+{
+    const qint64 deadline = now() + qMax<qint64>(delayMs, 0);
+    qDebug(logPowerSession) << "Scheduling task" << name << "to run in" << delayMs << "ms";
+
+    const bool earliest = m_heap.empty() || deadline < m_heap.front().deadline;
+    m_heap.push_back({ deadline, m_seq++, name, std::move(fn) });
+    std::push_heap(m_heap.begin(), m_heap.end(), Later());
+    if (earliest)
+        arm();
+}
+
+void DeadlineScheduler::clear()
+{
+    ++m_generation;
+    m_heap.clear();
+    m_timer->stop();
+}
+
+qint64 DeadlineScheduler::nextDeadline() const
+{
+    return m_heap.empty() ? -1 : m_heap.front().deadline;
+}
+
+bool DeadlineScheduler::isArmed() const
+{
+    return m_timer->isActive();
+}
+
+void DeadlineScheduler::arm()
+{
+    if (m_heap.empty()) {
+        m_timer->stop();
+        return;
+    }
+    const qint64 wait = qMax<qint64>(m_heap.front().deadline - now(), 0);
+    m_timer->start(static_cast<int>(qMin<qint64>(wait, std::numeric_limits<int>::max())));
+}
+
+void DeadlineScheduler::runDue()
+{
+    // 先把到期任务整体出堆再执行，任务内部可能 clear() 或继续 schedule()
+    const qint64 limit = now() + m_tolerance;
+    std::vector<Entry> due;
+    while (!m_heap.empty() && m_heap.front().deadline <= limit) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), Later());
+        due.push_back(std::move(m_heap.back()));
+        m_heap.pop_back();
+    }
+
+    const quint64 generation = m_generation;
+    for (Entry &e : due) {
+        if (generation != m_generation)
+            return;
+        qDebug(logPowerSession) << "Running task" << e.name;
+        if (e.fn)
+            e.fn();
+    }
+
+    if (generation == m_generation)
+        arm();
+}
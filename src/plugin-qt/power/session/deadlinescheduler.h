@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+
+#include <functional>
+#include <vector>
+
+class QTimer;
+
+// 按截止时间排序的单定时器调度器：只为最早的任务挂一个粗粒度定时器，
+// 容差窗口内到期的任务在同一次唤醒中批量执行。clear() 后复用同一个 QTimer。
+class DeadlineScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    using Task = std::function<void()>;
+    using Clock = std::function<qint64()>; // 单调时钟，单位 ms
+
+    // 空闲任务以秒为单位配置，半秒内的提前执行不可感知
+    static constexpr int kDefaultTolerance = 500;
+
+    explicit DeadlineScheduler(QObject *parent = nullptr);
+
+    void setClock(Clock clock);
+    void setTolerance(int ms) { m_tolerance = ms; }
+    int tolerance() const { return m_tolerance; }
+
+    void schedule(qint64 delayMs, Task fn, const QString &name = {});
+    void clear();
+
+    int pendingCount() const { return static_cast<int>(m_heap.size()); }
+    // 最早任务的截止时间（以 clock 为基准），无任务时返回 -1
+    qint64 nextDeadline() const;
+    bool isArmed() const;
+
+public Q_SLOTS:
+    void runDue();
+
+private:
+    struct Entry {
+        qint64 deadline;
+        quint64 seq;
+        QString name;
+        Task fn;
+    };
+    // 小顶堆；截止时间相同时按加入顺序执行
+    struct Later {
+        bool operator()(const Entry &a, const Entry &b) const
+        {
+            return a.deadline != b.deadline ? a.deadline > b.deadline : a.seq > b.seq;
+        }
+    };
+
+    qint64 now() const;
+    void arm();
+
+    std::vector<Entry> m_heap;
+    QTimer *m_timer = nullptr;
+    QElapsedTimer m_elapsed;
+    Clock m_clock;
+    int m_tolerance = kDefaultTolerance;
+    quint64 m_seq = 0;
+    quint64 m_generation = 0;
+};
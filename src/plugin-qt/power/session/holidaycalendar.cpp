@@ -0,0 +1,201 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "holidaycalendar.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QPointer>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+Q_DECLARE_LOGGING_CATEGORY(logPowerSession)
+
+HolidayCalendar::HolidayCalendar(FetchFunc fetch, const QString &cachePath, QObject *parent)
+    : QObject(parent)
+    , m_fetch(std::move(fetch))
+    , m_cachePath(cachePath)
+{
+    load();
+}
+
+QString HolidayCalendar::defaultCachePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+        + QStringLiteral("/deepin/plugin-power-session/holidays.json");
+}
+
+bool HolidayCalendar::isWorkday(const QDate &date) const
+{
+    auto it = m_months.constFind(monthKey(date.year(), date.month()));
+    if (it != m_months.constEnd()) {
+        auto day = it->days.constFind(date.day());
+        if (day != it->days.constEnd())
+            return *day;
+    }
+    int dow = date.dayOfWeek();
+    return dow != Qt::Saturday && dow != Qt::Sunday;
+}
+
+void HolidayCalendar::prefetch(const QDate &today, int months)
+{
+    if (!m_fetch || !today.isValid())
+        return;
+
+    const QDate first(today.year(), today.month(), 1);
+    for (int i = 0; i < months; ++i) {
+        const QDate d = first.addMonths(i);
+        const int key = monthKey(d.year(), d.month());
+        if (m_inflight.contains(key))
+            continue;
+        auto it = m_months.constFind(key);
+        if (it != m_months.constEnd() && it->fetched.isValid()) {
+            const qint64 age = it->fetched.daysTo(today);
+            if (age >= 0 && age < kRefreshDays)
+                continue;
+        }
+
+        // 所有月份同时发出异步请求，结果陆续回填
+        m_inflight.insert(key);
+        QPointer<HolidayCalendar> self(this);
+        const quint64 generation = m_generation;
+        m_fetch(d.year(), d.month(), [self, key, generation, today](const QString &json) {
+            if (self)
+                self->handleReply(key, generation, today, json);
+        });
+    }
+}
+
+void HolidayCalendar::invalidate()
+{
+    // 已缓存的数据仍可用于查询，只是在下一次 prefetch 时重新拉取
+    for (auto &month : m_months)
+        month.fetched = QDate();
+    m_inflight.clear();
+    ++m_generation;
+}
+
+bool HolidayCalendar::parseMonth(const QString &json, int year, int month, QHash<int, bool> *days)
+{
+    if (json.isEmpty())
+        return false;
+
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8(), &error);
+    if (error.error != QJsonParseError::NoError || !doc.isArray())
+        return false;
+
+    days->clear();
+    const QJsonArray roots = doc.array();
+    if (roots.isEmpty())
+        return true;
+
+    const QJsonArray list = roots.first().toObject().value("List").toArray();
+    for (const auto &item : list) {
+        const QJsonObject obj = item.toObject();
+        const QString str = obj.value("Date").toString();
+        QDate date = QDate::fromString(str, "yyyy-M-d");
+        if (!date.isValid())
+            date = QDate::fromString(str, "yyyy-MM-dd");
+        if (!date.isValid() || date.year() != year || date.month() != month)
+            continue;
+        // Status 为 2 表示调休上班，其余为放假
+        days->insert(date.day(), obj.value("Status").toInt() == 2);
+    }
+    return true;
+}
+
+void HolidayCalendar::handleReply(int key, quint64 generation, const QDate &today, const QString &json)
+{
+    // 日历服务变更或时间跳变之前发出的请求，结果不再采用
+    if (generation != m_generation)
+        return;
+    m_inflight.remove(key);
+
+    const int year = key / 12;
+    const int month = key % 12 + 1;
+    QHash<int, bool> days;
+    if (!parseMonth(json, year, month, &days)) {
+        qWarning(logPowerSession) << "Failed to fetch festival month" << year << month;
+    } else {
+        Month &entry = m_months[key];
+        entry.fetched = today;
+        m_dirty = true;
+        if (entry.days != days) {
+            entry.days = days;
+            m_changed = true;
+        }
+    }
+
+    // 一批请求全部返回后再落盘并通知
+    if (!m_inflight.isEmpty())
+        return;
+    if (m_dirty) {
+        save();
+        m_dirty = false;
+    }
+    if (m_changed) {
+        m_changed = false;
+        Q_EMIT updated();
+    }
+}
+
+void HolidayCalendar::load()
+{
+    if (m_cachePath.isEmpty())
+        return;
+
+    QFile file(m_cachePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    const QJsonObject months = root.value("months").toObject();
+    for (auto it = months.constBegin(); it != months.constEnd(); ++it) {
+        const QDate first = QDate::fromString(it.key() + "-01", "yyyy-MM-dd");
+        if (!first.isValid())
+            continue;
+        const QJsonObject obj = it.value().toObject();
+        Month month;
+        month.fetched = QDate::fromString(obj.value("fetched").toString(), Qt::ISODate);
+        const QJsonObject days = obj.value("days").toObject();
+        for (auto day = days.constBegin(); day != days.constEnd(); ++day)
+            month.days.insert(day.key().toInt(), day.value().toBool());
+        m_months.insert(monthKey(first.year(), first.month()), month);
+    }
+}
+
+void HolidayCalendar::save() const
+{
+    if (m_cachePath.isEmpty())
+        return;
+
+    QJsonObject months;
+    for (auto it = m_months.constBegin(); it != m_months.constEnd(); ++it) {
+        QJsonObject days;
+        for (auto day = it->days.constBegin(); day != it->days.constEnd(); ++day)
+            days.insert(QString::number(day.key()), day.value());
+        QJsonObject obj;
+        obj.insert("fetched", it->fetched.toString(Qt::ISODate));
+        obj.insert("days", days);
+        const QDate first(it.key() / 12, it.key() % 12 + 1, 1);
+        months.insert(first.toString("yyyy-MM"), obj);
+    }
+    QJsonObject root;
+    root.insert("months", months);
+
+    QDir().mkpath(QFileInfo(m_cachePath).absolutePath());
+    QSaveFile file(m_cachePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning(logPowerSession) << "Failed to save holiday cache:" << file.errorString();
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.commit();
+}
@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QDate>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+#include <functional>
+
+// 节假日缓存：以月为单位向日历服务批量异步拉取调休/放假信息，并持久化到磁盘。
+// isWorkday 只查内存，未缓存的月份按周末规则回退，不会阻塞在 D-Bus 调用上。
+class HolidayCalendar : public QObject
+{
+    Q_OBJECT
+public:
+    // reply 传入 getFestivalMonth 返回的 JSON，失败时传空字符串
+    using Reply = std::function<void(const QString &json)>;
+    using FetchFunc = std::function<void(int year, int month, const Reply &reply)>;
+
+    // 下一次关机时间最多向后查找 366 天，覆盖 13 个自然月
+    static constexpr int kPrefetchMonths = 13;
+    // 节假日安排一年公布一次，缓存在该天数内视为新鲜
+    static constexpr int kRefreshDays = 7;
+
+    HolidayCalendar(FetchFunc fetch, const QString &cachePath, QObject *parent = nullptr);
+
+    bool isWorkday(const QDate &date) const;
+    void prefetch(const QDate &today, int months = kPrefetchMonths);
+    void invalidate();
+    bool hasPending() const { return !m_inflight.isEmpty(); }
+
+    static QString defaultCachePath();
+
+Q_SIGNALS:
+    void updated();
+
+private:
+    struct Month {
+        QDate fetched;
+        QHash<int, bool> days; // 日 -> 是否工作日
+    };
+
+    static int monthKey(int year, int month) { return year * 12 + month - 1; }
+    static bool parseMonth(const QString &json, int year, int month, QHash<int, bool> *days);
+    void handleReply(int key, quint64 generation, const QDate &today, const QString &json);
+    void load();
+    void save() const;
+
+    FetchFunc m_fetch;
+    QString m_cachePath;
+    QHash<int, Month> m_months;
+    QSet<int> m_inflight;
+    quint64 m_generation = 0;
+    bool m_dirty = false;
+    bool m_changed = false;
+};
@@ -10,7 +10,7 @@
 /**
  * @brief Abstract interface for user idle detection.
  *
- * X11 implementation: uses org.freedesktop.ScreenSaver D-Bus signals.
+ * X11 implementation: uses the XSync IDLETIME system counter.
  * Wayland implementation: uses ext-idle-notify-v1 protocol.
  */
 class IdleWatcher : public QObject
@@ -2,18 +2,230 @@
 //
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
-#include "idlewatcher.h"
+#include "idlewatcher_x11.h"
 
-class X11IdleWatcher : public IdleWatcher
+#include <QLoggingCategory>
+#include <QSocketNotifier>
+
+#include <cstdlib>
+#include <cstring>
+
+Q_DECLARE_LOGGING_CATEGORY(logPowerSession)
+
+static xcb_sync_int64_t toSyncInt64(qint64 value)
+{
+    xcb_sync_int64_t v;
+    v.hi = static_cast<int32_t>(value >> 32);
+    v.lo = static_cast<uint32_t>(value & 0xffffffff);
+    return v;
+}
+
+static qint64 fromSyncInt64(const xcb_sync_int64_t &v)
+{
+    return (static_cast<qint64>(v.hi) << 32) | v.lo;
+}
+
+X11IdleWatcher::X11IdleWatcher(QObject *parent)
+    : IdleWatcher(parent)
+{
+    m_conn = xcb_connect(nullptr, nullptr);
+    if (xcb_connection_has_error(m_conn)) {
+        qWarning(logPowerSession) << "[Power::X11] Idle: cannot connect to X server";
+        return;
+    }
+
+    const xcb_query_extension_reply_t *ext = xcb_get_extension_data(m_conn, &xcb_sync_id);
+    if (!ext || !ext->present) {
+        qWarning(logPowerSession) << "[Power::X11] Idle: XSync extension is not present";
+        return;
+    }
+    m_syncFirstEvent = ext->first_event;
+    free(xcb_sync_initialize_reply(m_conn,
+        xcb_sync_initialize(m_conn, XCB_SYNC_MAJOR_VERSION, XCB_SYNC_MINOR_VERSION), nullptr));
+
+    m_idleCounter = findIdleCounter();
+    if (m_idleCounter == XCB_NONE) {
+        qWarning(logPowerSession) << "[Power::X11] Idle: no IDLETIME system counter";
+        return;
+    }
+
+    m_notifier = new QSocketNotifier(xcb_get_file_descriptor(m_conn), QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &X11IdleWatcher::handleXcbEvents);
+
+    armIdleAlarm();
+    m_valid = true;
+}
+
+X11IdleWatcher::~X11IdleWatcher()
+{
+    if (!xcb_connection_has_error(m_conn)) {
+        destroyAlarm(m_idleAlarm);
+        destroyAlarm(m_resetAlarm);
+        xcb_flush(m_conn);
+    }
+    xcb_disconnect(m_conn);
+}
+
+xcb_sync_counter_t X11IdleWatcher::findIdleCounter()
+{
+    xcb_sync_list_system_counters_reply_t *reply =
+        xcb_sync_list_system_counters_reply(m_conn, xcb_sync_list_system_counters(m_conn), nullptr);
+    if (!reply)
+        return XCB_NONE;
+
+    xcb_sync_counter_t counter = XCB_NONE;
+    static const char kIdleTime[] = "IDLETIME";
+    xcb_sync_systemcounter_iterator_t it = xcb_sync_list_system_counters_counters_iterator(reply);
+    for (; it.rem; xcb_sync_systemcounter_next(&it)) {
+        const int len = xcb_sync_systemcounter_name_length(it.data);
+        if (len == int(sizeof(kIdleTime) - 1)
+            && memcmp(xcb_sync_systemcounter_name(it.data), kIdleTime, len) == 0) {
+            counter = it.data->counter;
+            break;
+        }
+    }
+    free(reply);
+    return counter;
+}
+
+qint64 X11IdleWatcher::queryIdleCounter() const
+{
+    xcb_sync_query_counter_reply_t *reply =
+        xcb_sync_query_counter_reply(m_conn, xcb_sync_query_counter(m_conn, m_idleCounter), nullptr);
+    if (!reply)
+        return 0;
+    const qint64 value = fromSyncInt64(reply->counter_value);
+    free(reply);
+    return value;
+}
+
+void X11IdleWatcher::setAlarm(xcb_sync_alarm_t &alarm, qint64 value, xcb_sync_testtype_t test)
+{
+    const uint32_t mask = XCB_SYNC_CA_COUNTER | XCB_SYNC_CA_VALUE_TYPE | XCB_SYNC_CA_VALUE
+        | XCB_SYNC_CA_TEST_TYPE | XCB_SYNC_CA_DELTA | XCB_SYNC_CA_EVENTS;
+
+    if (alarm == XCB_NONE) {
+        xcb_sync_create_alarm_value_list_t values {};
+        values.counter = m_idleCounter;
+        values.valueType = XCB_SYNC_VALUETYPE_ABSOLUTE;
+        values.value = toSyncInt64(value);
+        values.testType = test;
+        values.delta = toSyncInt64(0);
+        values.events = 1;
+        alarm = xcb_generate_id(m_conn);
+        xcb_sync_create_alarm_aux(m_conn, alarm, mask, &values);
+    } else {
+        xcb_sync_change_alarm_value_list_t values {};
+        values.counter = m_idleCounter;
+        values.valueType = XCB_SYNC_VALUETYPE_ABSOLUTE;
+        values.value = toSyncInt64(value);
+        values.testType = test;
+        values.delta = toSyncInt64(0);
+        values.events = 1;
+        xcb_sync_change_alarm_aux(m_conn, alarm, mask, &values);
+    }
+}
+
+void X11IdleWatcher::destroyAlarm(xcb_sync_alarm_t &alarm)
+{
+    if (alarm == XCB_NONE)
+        return;
+    xcb_sync_destroy_alarm(m_conn, alarm);
+    alarm = XCB_NONE;
+}
+
+void X11IdleWatcher::armIdleAlarm()
+{
+    const qint64 timeoutMs = qint64(m_timeoutSec) * 1000;
+    setAlarm(m_idleAlarm, timeoutMs, XCB_SYNC_TESTTYPE_POSITIVE_TRANSITION);
+    xcb_flush(m_conn);
+
+    // 正向跨越报警只在计数器越过阈值时触发，已经空闲超过阈值时需要立即进入空闲
+    const qint64 idle = queryIdleCounter();
+    if (!m_isIdle && idle >= timeoutMs)
+        enterIdle(idle);
+}
+
+void X11IdleWatcher::enterIdle(qint64 counterValue)
+{
+    if (m_isIdle)
+        return;
+
+    m_isIdle = true;
+    m_idleTimer.start();
+
+    // 任何输入都会把 IDLETIME 清零，从当前值反向跨越即表示用户恢复操作
+    setAlarm(m_resetAlarm, qMax<qint64>(counterValue - 1, 0), XCB_SYNC_TESTTYPE_NEGATIVE_TRANSITION);
+    xcb_flush(m_conn);
+
+    Q_EMIT idled();
+}
+
+void X11IdleWatcher::leaveIdle()
+{
+    if (!m_isIdle)
+        return;
+
+    m_isIdle = false;
+    m_idleTimer.invalidate();
+    destroyAlarm(m_resetAlarm);
+    xcb_flush(m_conn);
+
+    Q_EMIT resumed();
+}
+
+void X11IdleWatcher::handleXcbEvents()
+{
+    xcb_generic_event_t *event = nullptr;
+    while ((event = xcb_poll_for_event(m_conn)) != nullptr) {
+        const uint8_t responseType = event->response_type & ~0x80;
+        if (responseType == m_syncFirstEvent + XCB_SYNC_ALARM_NOTIFY) {
+            auto *notify = reinterpret_cast<xcb_sync_alarm_notify_event_t *>(event);
+            if (notify->state != XCB_SYNC_ALARMSTATE_DESTROYED) {
+                if (notify->alarm == m_idleAlarm)
+                    enterIdle(fromSyncInt64(notify->counter_value));
+                else if (notify->alarm == m_resetAlarm)
+                    leaveIdle();
+            }
+        } else if (responseType == 0) {
+            auto *error = reinterpret_cast<xcb_generic_error_t *>(event);
+            qWarning(logPowerSession) << "[Power::X11] Idle: xcb error" << error->error_code
+                                      << "major" << error->major_code << "minor" << error->minor_code;
+        }
+        free(event);
+    }
+}
+
+void X11IdleWatcher::setTimeout(uint32_t timeoutSec)
+{
+    if (m_timeoutSec == timeoutSec || timeoutSec == 0)
+        return;
+
+    m_timeoutSec = timeoutSec;
+    if (!m_valid)
+        return;
+
+    // 与 Wayland 实现一致：切换超时后重新开始计算空闲状态
+    m_isIdle = false;
+    m_idleTimer.invalidate();
+    destroyAlarm(m_resetAlarm);
+    armIdleAlarm();
+}
+
+void X11IdleWatcher::simulateActivity()
+{
+    if (!m_valid)
+        return;
+
+    // 重置屏保计时同时会清零 IDLETIME，空闲中将触发恢复报警
+    xcb_force_screen_saver(m_conn, XCB_SCREEN_SAVER_RESET);
+    xcb_flush(m_conn);
+}
+
+uint32_t X11IdleWatcher::idleTimeMs() const
 {
-    Q_OBJECT
-public:
-    using IdleWatcher::IdleWatcher;
-    bool isValid() const override { return false; }
-    void setTimeout(uint32_t) override {}
-    void simulateActivity() override {}
-    uint32_t idleTimeMs() const override { return 0; }
-    bool isIdle() const override { return false; }
-};
+    if (!m_isIdle || !m_idleTimer.isValid())
+        return 0;
 
-#include "idlewatcher_x11.moc"
+    return static_cast<uint32_t>(m_idleTimer.elapsed());
+}
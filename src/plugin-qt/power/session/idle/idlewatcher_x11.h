@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "idlewatcher.h"
+
+#include <QElapsedTimer>
+
+#include <xcb/sync.h>
+#include <xcb/xcb.h>
+
+class QSocketNotifier;
+
+/**
+ * @brief X11 idle detection based on the XSync IDLETIME system counter.
+ *
+ * A positive-transition alarm fires when IDLETIME crosses the timeout; once
+ * idle, a negative-transition alarm fires on the next input.  Both are
+ * delivered as events on a private xcb connection, so no polling is needed.
+ */
+class X11IdleWatcher : public IdleWatcher
+{
+    Q_OBJECT
+public:
+    explicit X11IdleWatcher(QObject *parent = nullptr);
+    ~X11IdleWatcher() override;
+
+    bool isValid() const override { return m_valid; }
+    void setTimeout(uint32_t timeoutSec) override;
+    void simulateActivity() override;
+    uint32_t idleTimeMs() const override;
+    bool isIdle() const override { return m_isIdle; }
+
+private:
+    xcb_sync_counter_t findIdleCounter();
+    qint64 queryIdleCounter() const;
+    void setAlarm(xcb_sync_alarm_t &alarm, qint64 value, xcb_sync_testtype_t test);
+    void destroyAlarm(xcb_sync_alarm_t &alarm);
+    void armIdleAlarm();
+    void enterIdle(qint64 counterValue);
+    void leaveIdle();
+    void handleXcbEvents();
+
+    xcb_connection_t *m_conn = nullptr;
+    QSocketNotifier *m_notifier = nullptr;
+    uint8_t m_syncFirstEvent = 0;
+    xcb_sync_counter_t m_idleCounter = XCB_NONE;
+    xcb_sync_alarm_t m_idleAlarm = XCB_NONE;
+    xcb_sync_alarm_t m_resetAlarm = XCB_NONE;
+    QElapsedTimer m_idleTimer;
+    uint32_t m_timeoutSec = 300;
+    bool m_valid = false;
+    bool m_isIdle = false;
+};
@@ -4,6 +4,7 @@
 
 #include "lidswitchhandler.h"
 #include "idle/idlewatcher.h"
+#include "screen/screencontroller.h"
 #include "powermanager.h"
 #include "../powerconstants.h"
 
@@ -19,14 +20,27 @@ using namespace PowerDBus;
 LidSwitchHandler::LidSwitchHandler(PowerManager *manager, QObject *parent)
     : QObject(parent), m_manager(manager)
 {
+    // 首个事件立即处理，之后 1.5s 内的抖动合并，窗口结束时再对齐到最终状态
     m_debounce = new QTimer(this);
     m_debounce->setSingleShot(true);
     m_debounce->setInterval(1500);
 
     connect(m_debounce, &QTimer::timeout, this, [this]() {
-        doLidStateChanged(m_pendingOpen);
+        if (m_pendingOpen != m_appliedOpen) {
+            m_appliedOpen = m_pendingOpen;
+            doLidStateChanged(m_appliedOpen);
+            m_debounce->start();
+        }
     });
 
+    // 合盖动作随供电状态和配置预先算好，事件到达时不再查询
+    if (m_manager) {
+        connect(m_manager, &PowerManager::onBatteryChanged, this, &LidSwitchHandler::updateCloseAction);
+        connect(m_manager, &PowerManager::batteryLidClosedActionChanged, this, &LidSwitchHandler::updateCloseAction);
+        connect(m_manager, &PowerManager::linePowerLidClosedActionChanged, this, &LidSwitchHandler::updateCloseAction);
+        updateCloseAction();
+    }
+
     auto bus = QDBusConnection::systemBus();
     bus.connect(kService, kPath, kInterface, "LidClosed",
                 this, SLOT(onLidClosed()));
@@ -37,17 +51,32 @@ LidSwitchHandler::LidSwitchHandler(PowerManager *manager, QObject *parent)
 void LidSwitchHandler::onLidClosed()
 {
     qDebug(logPowerSession) << "Lid closed";
-    m_pendingOpen = false;
-    m_debounce->start();
+    handleLidEvent(false);
 }
 
 void LidSwitchHandler::onLidOpened()
 {
     qDebug(logPowerSession) << "Lid opened";
-    m_pendingOpen = true;
+    handleLidEvent(true);
+}
+
+void LidSwitchHandler::handleLidEvent(bool opened)
+{
+    m_pendingOpen = opened;
+    if (m_debounce->isActive())
+        return;
+
+    m_appliedOpen = opened;
+    doLidStateChanged(opened);
     m_debounce->start();
 }
 
+void LidSwitchHandler::updateCloseAction()
+{
+    m_closeAction = m_manager->onBattery() ? m_manager->batteryLidClosedAction()
+                                           : m_manager->linePowerLidClosedAction();
+}
+
 void LidSwitchHandler::doLidStateChanged(bool opened)
 {
     if (!m_manager) return;
@@ -55,10 +84,20 @@ void LidSwitchHandler::doLidStateChanged(bool opened)
     if (!opened) {
         // 合盖
         m_manager->SetPrepareSuspend(PS_LidClose);
-        bool onBattery = m_manager->onBattery();
-        int32_t action = onBattery ? m_manager->batteryLidClosedAction()
-                                   : m_manager->linePowerLidClosedAction();
-        qDebug(logPowerSession) << "Lid closed, onBattery=" << onBattery << " action=" << action;
+        const int32_t action = m_closeAction;
+        qDebug(logPowerSession) << "Lid closed, onBattery=" << m_manager->onBattery() << " action=" << action;
+
+        switch (action) {
+        case PA_Shutdown:
+        case PA_Suspend:
+        case PA_Hibernate:
+            // 盖子已合上，先直接熄屏，不必等挂起/关机流程走完
+            if (auto *sc = m_manager->screenController())
+                sc->setAllModes(ScreenController::Off);
+            break;
+        default:
+            break;
+        }
 
         switch (action) {
         case PA_Shutdown:
@@ -19,8 +19,12 @@ private Q_SLOTS:
     void onLidOpened();
 
 private:
+    void handleLidEvent(bool opened);
+    void updateCloseAction();
     void doLidStateChanged(bool opened);
     QTimer *m_debounce = nullptr;
     bool m_pendingOpen = true;
+    bool m_appliedOpen = true;
+    int m_closeAction = -1;
     PowerManager *m_manager = nullptr;
 };
@@ -57,79 +57,41 @@ void LowPowerManager::initConfig(Dtk::Core::DConfig *config)
     connect(m_config, &Dtk::Core::DConfig::valueChanged,
             this, &LowPowerManager::onConfigChanged);
 
-    m_usePercentageForPolicy = m_config->value(kUsePercentageForPolicy, true).toBool();
-    m_lowPowerNotifyThreshold = m_config->value(kLowPowerNotifyThreshold, 0).toInt();
-    m_percentageAction = m_config->value(kPercentageAction, 0).toInt();
-    m_timeToEmptyLow = static_cast<quint64>(m_config->value(kTimeToEmptyLow, 0).toLongLong());
-    m_timeToEmptyDanger = static_cast<quint64>(m_config->value(kTimeToEmptyDanger, 0).toLongLong());
-    m_timeToEmptyCritical = static_cast<quint64>(m_config->value(kTimeToEmptyCritical, 0).toLongLong());
-    m_timeToEmptyAction = static_cast<quint64>(m_config->value(kTimeToEmptyAction, 0).toLongLong());
+    loadThresholds();
 }
 
 void LowPowerManager::onConfigChanged(const QString &key)
 {
     if (!m_config) return;
 
-    if (key == QLatin1String(kUsePercentageForPolicy))
-        m_usePercentageForPolicy = m_config->value(kUsePercentageForPolicy, true).toBool();
-    else if (key == QLatin1String(kLowPowerNotifyThreshold))
-        m_lowPowerNotifyThreshold = m_config->value(kLowPowerNotifyThreshold, 0).toInt();
-    else if (key == QLatin1String(kPercentageAction))
-        m_percentageAction = m_config->value(kPercentageAction, 0).toInt();
-    else if (key == QLatin1String(kTimeToEmptyLow))
-        m_timeToEmptyLow = static_cast<quint64>(m_config->value(kTimeToEmptyLow, 0).toLongLong());
-    else if (key == QLatin1String(kTimeToEmptyDanger))
-        m_timeToEmptyDanger = static_cast<quint64>(m_config->value(kTimeToEmptyDanger, 0).toLongLong());
-    else if (key == QLatin1String(kTimeToEmptyCritical))
-        m_timeToEmptyCritical = static_cast<quint64>(m_config->value(kTimeToEmptyCritical, 0).toLongLong());
-    else if (key == QLatin1String(kTimeToEmptyAction))
-        m_timeToEmptyAction = static_cast<quint64>(m_config->value(kTimeToEmptyAction, 0).toLongLong());
-    else
+    static const QStringList keys = {
+        kUsePercentageForPolicy, kLowPowerNotifyThreshold, kPercentageAction,
+        kTimeToEmptyLow, kTimeToEmptyDanger, kTimeToEmptyCritical, kTimeToEmptyAction,
+    };
+    if (!keys.contains(key))
         return;
 
+    loadThresholds();
     updateWarnLevel();
 }
 
-uint LowPowerManager::getWarnLevel(double percentage, quint64 timeToEmpty)
+void LowPowerManager::loadThresholds()
 {
-    if (!m_powerManager || !m_powerManager->onBattery())
-        return None;
-
-    if (m_usePercentageForPolicy) {
-        if (percentage == 0.0)
-            return None;
-
-        if (percentage <= m_lowPowerNotifyThreshold) {
-            if (m_percentageAction > 0 && percentage <= m_percentageAction)
-                return Action;
-            if (percentage <= 10.0)
-                return Critical;
-            if (percentage <= 15.0)
-                return Danger;
-            if (percentage <= 20.0)
-                return Low;
-            if (percentage <= 25.0)
-                return Remind;
-            return None;
-        }
-
-        return None;
-    } else {
-        if (timeToEmpty > m_timeToEmptyLow || timeToEmpty == 0)
-            return None;
-        if (timeToEmpty > m_timeToEmptyDanger)
-            return Low;
-        if (timeToEmpty > m_timeToEmptyCritical)
-            return Danger;
-        if (timeToEmpty > m_timeToEmptyAction)
-            return Critical;
-        return Action;
-    }
+    WarnLevelPolicy::Thresholds t;
+    t.usePercentage = m_config->value(kUsePercentageForPolicy, true).toBool();
+    t.notifyPercentage = m_config->value(kLowPowerNotifyThreshold, 0).toInt();
+    t.actionPercentage = m_config->value(kPercentageAction, 0).toInt();
+    t.timeLow = static_cast<quint64>(m_config->value(kTimeToEmptyLow, 0).toLongLong());
+    t.timeDanger = static_cast<quint64>(m_config->value(kTimeToEmptyDanger, 0).toLongLong());
+    t.timeCritical = static_cast<quint64>(m_config->value(kTimeToEmptyCritical, 0).toLongLong());
+    t.timeAction = static_cast<quint64>(m_config->value(kTimeToEmptyAction, 0).toLongLong());
+    m_policy.setThresholds(t);
 }
 
 void LowPowerManager::updateWarnLevel()
 {
     if (!m_powerManager || !m_powerManager->onBattery()) {
+        m_policy.reset();
         if (m_currentLevel != None) {
             m_currentLevel = None;
             handleLevelChanged(None);
@@ -146,7 +108,7 @@ void LowPowerManager::updateWarnLevel()
 
     quint64 tte = m_powerManager->batteryTimeToEmpty();
 
-    uint newLevel = getWarnLevel(pct, tte);
+    uint newLevel = m_policy.update(pct, tte);
     if (newLevel == m_currentLevel)
         return;
 
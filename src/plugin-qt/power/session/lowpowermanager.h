@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "warnlevelpolicy.h"
+
 #include <QObject>
 #include <QTimer>
 #include <DConfig>
@@ -14,18 +16,27 @@ class LowPowerManager : public QObject {
     Q_OBJECT
 public:
     LowPowerManager(PowerManager *powerManager, QObject *parent = nullptr);
-    enum Level { None = 0, Remind, Low, Danger, Critical, Action };
+    enum Level {
+        None = WarnLevelPolicy::None,
+        Remind = WarnLevelPolicy::Remind,
+        Low = WarnLevelPolicy::Low,
+        Danger = WarnLevelPolicy::Danger,
+        Critical = WarnLevelPolicy::Critical,
+        Action = WarnLevelPolicy::Action,
+    };
 
     void initConfig(Dtk::Core::DConfig *config);
 
-private Q_SLOTS:
+public Q_SLOTS:
     void updateWarnLevel();
+
+private Q_SLOTS:
     void onConfigChanged(const QString &key);
 
 private:
     void handleLevelChanged(uint level);
     void disableTicker();
-    uint getWarnLevel(double percentage, quint64 timeToEmpty);
+    void loadThresholds();
     void startCountTicker();
     void sendNotify(const QString &body);
     void showLowPower();
@@ -38,12 +49,6 @@ private:
     uint m_currentLevel = 0;
 
     Dtk::Core::DConfig *m_config = nullptr;
-    bool m_usePercentageForPolicy = true;
-    quint64 m_timeToEmptyLow = 0;
-    quint64 m_timeToEmptyDanger = 0;
-    quint64 m_timeToEmptyCritical = 0;
-    quint64 m_timeToEmptyAction = 0;
-    int m_percentageAction = 0;
-    int m_lowPowerNotifyThreshold = 0;
+    WarnLevelPolicy m_policy;
     PowerManager *m_powerManager = nullptr;
 };
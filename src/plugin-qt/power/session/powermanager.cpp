@@ -5,23 +5,26 @@
 #include "powermanager.h"
 #include "idle/idlewatcher.h"
 #include "idle/idlewatcher_wl.h"
+#include "idle/idlewatcher_x11.h"
 #include "screen/screencontroller.h"
 #include "screen/screencontroller_wl.h"
+#include "screen/screencontroller_x11.h"
 #include "powersaveplan.h"
 #include "lidswitchhandler.h"
 #include "sleepinhibitor.h"
+#include "presleeptasks.h"
 #include "sessiondbusproxy.h"
+#include "holidaycalendar.h"
 #include "../powerconstants.h"
+#include "../propertieschangednotifier.h"
 
 #include <QDBusConnection>
 #include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
 #include <QDBusMetaType>
 #include <QDBusConnectionInterface>
-#include <QMetaProperty>
 #include <QGuiApplication>
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
 #include <QThread>
 #include <QTimer>
 #include <QProcess>
@@ -40,6 +43,9 @@ using namespace Dtk::Core;
 
 Q_LOGGING_CATEGORY(logPowerSession, "dde.power.session")
 
+// 休眠前锁屏的等待上限，超时后不再阻塞休眠
+static constexpr int kPreSleepLockBudget = 2500;
+
 #define DEF_SETTER_PERSIST(T, Suffix, member, signal, dkey) \
     void PowerManager::set##Suffix(T v) { \
         if (m_##member != v) { m_##member = v; Q_EMIT signal(); \
@@ -136,18 +142,9 @@ bool PowerManager::initialize()
 
     // ExportAllProperties 只提供 Get/Set/GetAll 访问，不会自动把 NOTIFY 信号
     // 转成 org.freedesktop.DBus.Properties.PropertiesChanged。
-    // 用 notifyPropertyChanged 槽函数统一桥接所有 Q_PROPERTY(NOTIFY) 到标准 D-Bus 属性变更通知。
-    const QMetaObject *mo = metaObject();
-    int slotIdx = mo->indexOfSlot("notifyPropertyChanged()");
-    if (slotIdx >= 0) {
-        QMetaMethod slot = mo->method(slotIdx);
-        for (int i = mo->propertyOffset(); i < mo->propertyCount(); ++i) {
-            QMetaProperty prop = mo->property(i);
-            if (!prop.hasNotifySignal())
-                continue;
-            connect(this, prop.notifySignal(), this, slot);
-        }
-    }
+    // 由 PropertiesChangedNotifier 统一桥接，同一轮事件循环内的变更合并为一条消息。
+    m_propertyNotifier = new PropertiesChangedNotifier(this, kPath, kInterface,
+        [this](const QDBusMessage &msg) { m_conn->send(msg); });
 
     return true;
 }
@@ -194,6 +191,21 @@ void PowerManager::initSleepWatcher()
     if (m_sleepInhibitor) {
         connect(m_sleepInhibitor, &SleepInhibitor::aboutToSleep,
                 this, [this]() { handleBeforeSleep(true); });
+        // 锁屏需在休眠前完成，以异步任务登记，等待回复而不阻塞事件循环
+        m_sleepInhibitor->preSleepTasks()->add("lock", kPreSleepLockBudget,
+            [this](const PreSleepTasks::Done &done) {
+                if (!m_sleepLock) {
+                    done();
+                    return;
+                }
+                auto *watcher = new QDBusPendingCallWatcher(doLockAsync(true), this);
+                connect(watcher, &QDBusPendingCallWatcher::finished, this, [watcher, done]() {
+                    if (watcher->isError())
+                        qWarning(logPowerSession) << "Pre-sleep lock failed:" << watcher->error().message();
+                    watcher->deleteLater();
+                    done();
+                });
+            });
         connect(m_sleepInhibitor, &SleepInhibitor::wokeUp,
                 this, &PowerManager::handleWakeup);
     }
@@ -271,7 +283,12 @@ void PowerManager::handleBatteryStatusChanged(uint value)
 
 void PowerManager::handleBatteryTimeToEmptyChanged(quint64 value)
 {
+    if (m_batteryTimeToEmpty == value)
+        return;
     m_batteryTimeToEmpty = value;
+    // 按剩余时间判定低电量时，剩余时间变化也需要重新评估等级
+    if (m_lowPowerMgr)
+        m_lowPowerMgr->updateWarnLevel();
 }
 
 void PowerManager::handleIsHighPerformanceSupportedChanged(bool value)
@@ -317,34 +334,6 @@ void PowerManager::onLogin1OwnerChanged(const QString &name, const QString &,
     initLogindInhibit();
 }
 
-void PowerManager::notifyPropertyChanged()
-{
-    int sigIdx = senderSignalIndex();
-    if (sigIdx < 0)
-        return;
-
-    const QMetaObject *mo = metaObject();
-    for (int i = mo->propertyOffset(); i < mo->propertyCount(); ++i) {
-        QMetaProperty prop = mo->property(i);
-        if (!prop.hasNotifySignal() || !prop.isReadable())
-            continue;
-        if (prop.notifySignal().methodIndex() != sigIdx)
-            continue;
-
-        QDBusMessage msg = QDBusMessage::createSignal(
-            kPath,
-            QStringLiteral("org.freedesktop.DBus.Properties"),
-            QStringLiteral("PropertiesChanged"));
-        msg << QLatin1String(kInterface);
-        QVariantMap changed;
-        changed[QString::fromLatin1(prop.name())] = prop.read(this);
-        msg << changed;
-        msg << QStringList();
-        m_conn->send(msg);
-        return;
-    }
-}
-
 static QString currentSessionId()
 {
     QString sid = qEnvironmentVariable("XDG_SESSION_ID");
@@ -357,9 +346,6 @@ void PowerManager::handleBeforeSleep(bool)
     qDebug(logPowerSession) << "System is going to sleep, prepare suspend state:" << m_prepareSuspendState;
     m_prepareSuspendState = PS_Sleeping;
     setBlackScreenActive(true);
-    if (m_sleepLock) {
-        doLock(true);
-    }
 }
 
 void PowerManager::handleWakeup()
@@ -475,6 +461,14 @@ void PowerManager::doLock(bool autoStartAuth)
     m_proxy->showLockAuth(autoStartAuth);
 }
 
+QDBusPendingCall PowerManager::doLockAsync(bool autoStartAuth)
+{
+    qInfo(logPowerSession) << "Locking session (async)";
+    if (m_useWayland)
+        return m_proxy->lockSessionAsync(currentSessionId());
+    return m_proxy->showLockAuthAsync(autoStartAuth);
+}
+
 void PowerManager::setDPMSModeOn()  { 
     qInfo(logPowerSession) << "Setting DPMS mode to on";
     if (m_screenCtrl) {
@@ -536,21 +530,24 @@ void PowerManager::setAndSaveDisplayBrightness(const QMap<QString, double> &t)
     }
 }
 
-// TODO: x11
 IdleWatcher *PowerManager::createIdleWatcher()
 {
-    return m_useWayland ? new WaylandIdleWatcher(this) : nullptr; 
+    if (m_useWayland)
+        return new WaylandIdleWatcher(this);
+    return new X11IdleWatcher(this);
 }
 
-// TODO x11
 ScreenController *PowerManager::createScreenController()
 {
-    return m_useWayland ? new WaylandScreenController(this) : nullptr;
+    if (m_useWayland)
+        return new WaylandScreenController(this);
+    return new X11ScreenController(this);
 }
 
 void PowerManager::recalculateScheduledShutdown()
 {
     qDebug(logPowerSession) << "Recalculating scheduled shutdown, current nextShutdownTime=" << m_nextShutdownTime;
+    prefetchHolidays();
     m_nextShutdownTime = getNextShutdownTime(0);
 
     if (m_config)
@@ -729,6 +726,20 @@ void PowerManager::initScheduledShutdown()
     m_shutdownTimer->setSingleShot(true);
     m_countdownTimer = new QTimer(this);
 
+    m_holidays = new HolidayCalendar([this](int year, int month, const HolidayCalendar::Reply &reply) {
+        auto *watcher = new QDBusPendingCallWatcher(m_proxy->getFestivalMonthAsync(year, month), this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [reply](QDBusPendingCallWatcher *w) {
+            QDBusPendingReply<QString> r = *w;
+            reply(r.isError() ? QString() : r.value());
+            w->deleteLater();
+        });
+    }, HolidayCalendar::defaultCachePath(), this);
+    connect(m_holidays, &HolidayCalendar::updated, this, &PowerManager::onHolidaysUpdated);
+    connect(m_proxy, &SessionDBusProxy::calendarServiceChanged, this, [this]() {
+        m_holidays->invalidate();
+        prefetchHolidays();
+    });
+
     connect(m_proxy, &SessionDBusProxy::notifyActionInvoked,
             this, &PowerManager::onNotifyActionInvoked);
     connect(m_proxy, &SessionDBusProxy::timeUpdate,
@@ -737,6 +748,7 @@ void PowerManager::initScheduledShutdown()
             this, &PowerManager::onSessionActiveChanged);
 
     if (m_scheduledShutdownState) {
+        prefetchHolidays();
         if (m_nextShutdownTime == 0) {
             m_nextShutdownTime = getNextShutdownTime(0);
             if (m_config) m_config->setValue(kNextShutdownTime, m_nextShutdownTime);
@@ -747,9 +759,11 @@ void PowerManager::initScheduledShutdown()
 
 void PowerManager::onSystemTimeChanged()
 {
+    m_holidays->invalidate();
     if (!m_scheduledShutdownState)
         return;
 
+    prefetchHolidays();
     m_nextShutdownTime = getNextShutdownTime(0);
     if (m_config) m_config->setValue(kNextShutdownTime, m_nextShutdownTime);
     scheduledShutdown(SchedInit);
@@ -894,6 +908,7 @@ void PowerManager::scheduledShutdown(int state)
             }
             Q_EMIT scheduledShutdownStateChanged();
         } else {
+            prefetchHolidays();
             m_nextShutdownTime = getNextShutdownTime(m_nextShutdownTime);
             if (m_config) m_config->setValue(kNextShutdownTime, m_nextShutdownTime);
 
@@ -913,38 +928,24 @@ void PowerManager::scheduledShutdown(int state)
     }
 }
 
-bool PowerManager::isWorkday(const QDateTime &date) const
+void PowerManager::prefetchHolidays()
 {
-    int year = date.date().year();
-    int month = date.date().month();
-    QString reply = m_proxy->getFestivalMonth(year, month);
-    if (reply.isEmpty()) {
-        int dow = date.date().dayOfWeek();
-        return dow != Qt::Saturday && dow != Qt::Sunday;
-    }
+    if (m_scheduledShutdownState && m_shutdownRepetition == RepWorkdays)
+        m_holidays->prefetch(QDate::currentDate());
+}
 
-    QJsonDocument doc = QJsonDocument::fromJson(reply.toUtf8());
-    if (!doc.isArray() || doc.array().isEmpty()) {
-        int dow = date.date().dayOfWeek();
-        return dow != Qt::Saturday && dow != Qt::Sunday;
-    }
-    QJsonObject root = doc.array().first().toObject();
-    QJsonArray list = root["List"].toArray();
-    if (list.isEmpty()) {
-        int dow = date.date().dayOfWeek();
-        return dow != Qt::Saturday && dow != Qt::Sunday;
-    }
+void PowerManager::onHolidaysUpdated()
+{
+    if (!m_scheduledShutdownState || m_shutdownRepetition != RepWorkdays)
+        return;
+    // 节假日数据异步到达后，若下一次关机日期发生变化则重新调度
+    if (getNextShutdownTime(0) != m_nextShutdownTime)
+        recalculateScheduledShutdown();
+}
 
-    QString dateStr1 = date.toString("yyyy-M-d");
-    QString dateStr2 = date.toString("yyyy-MM-dd");
-    for (const auto &item : list) {
-        QJsonObject obj = item.toObject();
-        if (obj["Date"].toString() == dateStr1 || obj["Date"].toString() == dateStr2) {
-            return obj["Status"].toInt() == 2;
-        }
-    }
-    int dow = date.date().dayOfWeek();
-    return dow != Qt::Saturday && dow != Qt::Sunday;
+bool PowerManager::isWorkday(const QDateTime &date) const
+{
+    return m_holidays->isWorkday(date.date());
 }
 
 bool PowerManager::isCustomDay(const QDateTime &date) const
@@ -8,6 +8,7 @@
 
 #include <QVariantMap>
 #include <QByteArray>
+#include <QDBusPendingCall>
 #include <DConfig>
 
 using BatteryPercentageMap = QMap<QString, double>;
@@ -27,6 +28,8 @@ class PowerSavePlan;
 class LidSwitchHandler;
 class SleepInhibitor;
 class SessionDBusProxy;
+class PropertiesChangedNotifier;
+class HolidayCalendar;
 
 enum SchedState {
     SchedInit = 0,
@@ -189,6 +192,7 @@ public:
     void doHibernate();
     void doTurnOffScreen();
     void doLock(bool autoStartAuth = true);
+    QDBusPendingCall doLockAsync(bool autoStartAuth = true);
     bool canSuspend() const;
     void setDPMSModeOn();
     void setDPMSModeOff();
@@ -211,6 +215,7 @@ private Q_SLOTS:
     void onNotifyActionInvoked(uint id, const QString &actionKey);
     void onSystemTimeChanged();
     void onSessionActiveChanged();
+    void onHolidaysUpdated();
 
     void onLinePowerDelayChanged();
     void onBatteryDelayChanged();
@@ -225,7 +230,6 @@ private Q_SLOTS:
     void handlePowerSavingModeEnabledChanged(bool value);
     void handlePowerSavingModeBrightnessDropPercentChanged(uint value);
     void refreshBatteryInfo();
-    void notifyPropertyChanged();
 
 Q_SIGNALS:
     void onBatteryChanged();
@@ -274,6 +278,7 @@ private:
     void shutdownCountdownNotify(int count, bool playSound);
     void doAutoShutdown();
     void initScheduledShutdown();
+    void prefetchHolidays();
 
     QDBusConnection *m_conn = nullptr;
 
@@ -285,6 +290,7 @@ private:
     LidSwitchHandler *m_lidSwitch = nullptr;
     SleepInhibitor *m_sleepInhibitor = nullptr;
     LowPowerManager *m_lowPowerMgr = nullptr;
+    PropertiesChangedNotifier *m_propertyNotifier = nullptr;
 
     bool m_useWayland = false;
     bool m_onBattery = false;
@@ -328,6 +334,7 @@ private:
     int m_delayWakeupInterval = 2;
     int m_inhibitFd = -1;
 
+    HolidayCalendar *m_holidays = nullptr;
     QTimer *m_shutdownTimer = nullptr;
     QTimer *m_countdownTimer = nullptr;
     int m_shutdownStatus = SchedInit;
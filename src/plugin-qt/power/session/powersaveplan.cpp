@@ -4,6 +4,7 @@
 
 #include "powersaveplan.h"
 #include "powermanager.h"
+#include "deadlinescheduler.h"
 #include "idle/idlewatcher.h"
 #include "screen/screencontroller.h"
 #include "../powerconstants.h"
@@ -41,7 +42,7 @@ static bool canAdd(const QString &type, int delay,
 }
 
 PowerSavePlan::PowerSavePlan(PowerManager *powerManager, QObject *parent)
-    : QObject(parent), m_powerManager(powerManager)
+    : QObject(parent), m_scheduler(new DeadlineScheduler(this)), m_powerManager(powerManager)
 {
 
 }
@@ -174,37 +175,21 @@ void PowerSavePlan::HandleIdleOff()
 
 void PowerSavePlan::scheduleTask(const MetaTask &t)
 {
-    qDebug(logPowerSession) << "Scheduling task" << t.name << "to run in" << t.realDelay << "ms";
-    auto *timer = new QTimer(this);
-    timer->setSingleShot(true);
-    connect(timer, &QTimer::timeout, this, t.fn);
-    timer->start(t.realDelay > 0 ? t.realDelay : 100);
-    m_timers.append(timer);
+    m_scheduler->schedule(t.realDelay > 0 ? t.realDelay : 100, t.fn, t.name);
 }
 
+// 只清空调度队列，定时器保留复用，输入频繁时 idle on/off 不再反复创建 QTimer
 void PowerSavePlan::interruptTasks()
 {
-    for (auto *t : m_timers) {
-        t->stop();
-        t->deleteLater();
-    }
-    m_timers.clear();
+    m_scheduler->clear();
 }
 
 void PowerSavePlan::setScreenSaverTimeout(int seconds)
 {
     if (!m_powerManager)
         return;
-    auto *iw = m_powerManager->idleWatcher();
-    if (iw && m_powerManager->useWayland()) {
+    if (auto *iw = m_powerManager->idleWatcher())
         iw->setTimeout(static_cast<uint32_t>(seconds));
-        return;
-    }
-
-    // FIXME(mhduiy): delete or use in x11?
-    // QDBusInterface iface(kScreensaver, kScreensaverPath, kScreensaver,
-    //                       QDBusConnection::sessionBus());
-    // iface.call("SetTimeout", static_cast<uint32_t>(seconds), 0u, false);
 }
 
 void PowerSavePlan::startScreensaver()
@@ -12,6 +12,7 @@
 
 class PowerManager;
 class ScreenController;
+class DeadlineScheduler;
 
 class PowerSavePlan : public QObject {
     Q_OBJECT
@@ -49,7 +50,7 @@ private:
     void scheduleTask(const MetaTask &t);
 
     QVector<MetaTask> m_metaTasks;
-    QVector<QTimer *> m_timers;
+    DeadlineScheduler *m_scheduler = nullptr;
     QMap<QString, double> m_oldBrightness;
     bool m_screensaverRunning = false;
     bool m_isIdle = false;
@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "presleeptasks.h"
+
+#include <QLoggingCategory>
+#include <QPointer>
+#include <QTimer>
+
+#include <algorithm>
+
+Q_DECLARE_LOGGING_CATEGORY(logPowerSession)
+
+PreSleepTasks::PreSleepTasks(QObject *parent)
+    : QObject(parent)
+    , m_overallTimer(new QTimer(this))
+{
+    m_overallTimer->setSingleShot(true);
+    connect(m_overallTimer, &QTimer::timeout, this, [this]() {
+        finish(true);
+    });
+}
+
+void PreSleepTasks::add(const QString &name, int budgetMs, Task task)
+{
+    m_entries.append({ name, budgetMs, std::move(task) });
+}
+
+void PreSleepTasks::start()
+{
+    if (m_running)
+        cancel();
+
+    const quint64 cycle = ++m_cycle;
+    m_running = true;
+    m_starting = true;
+    m_clock.start();
+    m_report.clear();
+    m_done.fill(false, m_entries.size());
+    for (const Entry &e : std::as_const(m_entries))
+        m_report.append({ e.name, -1, false });
+
+    m_overallTimer->start(m_overallBudget);
+    for (int i = 0; i < m_entries.size(); ++i) {
+        auto *timer = new QTimer(this);
+        timer->setSingleShot(true);
+        connect(timer, &QTimer::timeout, this, [this, cycle, i]() {
+            complete(cycle, i, true);
+        });
+        timer->start(qMin(m_entries.at(i).budget, m_overallBudget));
+        m_budgetTimers.append(timer);
+    }
+
+    // done 可能在任务内同步调用，也可能在下一轮休眠后才迟到，按周期号过滤
+    QPointer<PreSleepTasks> self(this);
+    for (int i = 0; i < m_entries.size() && m_running && cycle == m_cycle; ++i) {
+        const Task task = m_entries.at(i).task;
+        task([self, cycle, i]() {
+            if (self)
+                self->complete(cycle, i, false);
+        });
+    }
+    m_starting = false;
+
+    if (m_running && cycle == m_cycle)
+        checkFinished();
+}
+
+void PreSleepTasks::cancel()
+{
+    if (!m_running)
+        return;
+    m_running = false;
+    ++m_cycle;
+    stopTimers();
+}
+
+void PreSleepTasks::complete(quint64 cycle, int index, bool timedOut)
+{
+    if (!m_running || cycle != m_cycle || m_done.value(index, true))
+        return;
+
+    m_done[index] = true;
+    m_report[index].elapsedMs = m_clock.elapsed();
+    m_report[index].timedOut = timedOut;
+    if (QTimer *timer = m_budgetTimers.value(index))
+        timer->stop();
+    if (timedOut)
+        qWarning(logPowerSession) << "Pre-sleep task" << m_report[index].name << "exceeded its budget of"
+                                  << m_entries.at(index).budget << "ms";
+
+    if (!m_starting)
+        checkFinished();
+}
+
+void PreSleepTasks::checkFinished()
+{
+    if (std::all_of(m_done.cbegin(), m_done.cend(), [](bool done) { return done; }))
+        finish(std::any_of(m_report.cbegin(), m_report.cend(), [](const Report &r) { return r.timedOut; }));
+}
+
+void PreSleepTasks::finish(bool timedOut)
+{
+    if (!m_running)
+        return;
+
+    const qint64 elapsed = m_clock.elapsed();
+    for (int i = 0; i < m_report.size(); ++i) {
+        Report &r = m_report[i];
+        if (!m_done.at(i)) {
+            r.elapsedMs = elapsed;
+            r.timedOut = true;
+        }
+        qInfo(logPowerSession) << "Pre-sleep task" << r.name << (r.timedOut ? "timed out after" : "finished in")
+                               << r.elapsedMs << "ms";
+    }
+    qInfo(logPowerSession) << "Pre-sleep tasks done in" << elapsed << "ms, timedOut=" << timedOut;
+
+    m_running = false;
+    stopTimers();
+    Q_EMIT finished(timedOut);
+}
+
+void PreSleepTasks::stopTimers()
+{
+    m_overallTimer->stop();
+    // 可能正处于某个预算定时器的 timeout 中，延迟删除
+    for (QTimer *timer : std::as_const(m_budgetTimers)) {
+        timer->stop();
+        timer->deleteLater();
+    }
+    m_budgetTimers.clear();
+}
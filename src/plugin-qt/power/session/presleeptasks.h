@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+
+#include <functional>
+
+class QTimer;
+
+// 休眠前任务登记表：各参与者以异步任务登记并声明预算，
+// 全部完成或总预算耗尽即结束，SleepInhibitor 随后释放 delay inhibitor。
+class PreSleepTasks : public QObject
+{
+    Q_OBJECT
+public:
+    using Done = std::function<void()>;
+    using Task = std::function<void(const Done &done)>;
+
+    // logind InhibitDelayMaxSec 默认 5s，留出余量
+    static constexpr int kDefaultOverallBudget = 4000;
+
+    struct Report {
+        QString name;
+        qint64 elapsedMs = -1;
+        bool timedOut = false;
+    };
+
+    explicit PreSleepTasks(QObject *parent = nullptr);
+
+    void add(const QString &name, int budgetMs, Task task);
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    void setOverallBudget(int ms) { m_overallBudget = ms; }
+    int overallBudget() const { return m_overallBudget; }
+
+    void start();
+    void cancel();
+    bool isRunning() const { return m_running; }
+    const QList<Report> &lastReport() const { return m_report; }
+
+Q_SIGNALS:
+    // 所有任务完成时 timedOut 为 false
+    void finished(bool timedOut);
+
+private:
+    struct Entry {
+        QString name;
+        int budget;
+        Task task;
+    };
+
+    void complete(quint64 cycle, int index, bool timedOut);
+    void checkFinished();
+    void finish(bool timedOut);
+    void stopTimers();
+
+    QList<Entry> m_entries;
+    QList<Report> m_report;
+    QList<bool> m_done;
+    QList<QTimer *> m_budgetTimers;
+    QTimer *m_overallTimer = nullptr;
+    QElapsedTimer m_clock;
+    int m_overallBudget = kDefaultOverallBudget;
+    quint64 m_cycle = 0;
+    bool m_running = false;
+    bool m_starting = false;
+};
@@ -2,17 +2,97 @@
 //
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
-#include "screencontroller.h"
+#include "screencontroller_x11.h"
 
-class X11ScreenController : public ScreenController
+#include <QLoggingCategory>
+
+#include <xcb/dpms.h>
+
+#include <cstdlib>
+
+Q_DECLARE_LOGGING_CATEGORY(logPowerSession)
+
+X11ScreenController::X11ScreenController(QObject *parent)
+    : ScreenController(parent)
 {
-    Q_OBJECT
-public:
-    using ScreenController::ScreenController;
-    bool isValid() const override { return false; }
-    int outputCount() const override { return 0; }
-    Mode mode(int) const override { return On; }
-    void setMode(int, Mode) override {}
-};
-
-#include "screencontroller_x11.moc"
+    m_conn = xcb_connect(nullptr, nullptr);
+    if (xcb_connection_has_error(m_conn)) {
+        qWarning(logPowerSession) << "[Power::X11] DPMS: cannot connect to X server";
+        return;
+    }
+
+    const xcb_query_extension_reply_t *ext = xcb_get_extension_data(m_conn, &xcb_dpms_id);
+    if (!ext || !ext->present) {
+        qWarning(logPowerSession) << "[Power::X11] DPMS extension is not present";
+        return;
+    }
+
+    xcb_dpms_capable_reply_t *capable =
+        xcb_dpms_capable_reply(m_conn, xcb_dpms_capable(m_conn), nullptr);
+    const bool isCapable = capable && capable->capable;
+    free(capable);
+    if (!isCapable) {
+        qWarning(logPowerSession) << "[Power::X11] DPMS is not supported by the X server";
+        return;
+    }
+
+    // 记录原有超时与启用状态，析构时还给 X server
+    xcb_dpms_get_timeouts_reply_t *timeouts =
+        xcb_dpms_get_timeouts_reply(m_conn, xcb_dpms_get_timeouts(m_conn), nullptr);
+    if (timeouts) {
+        m_standbyTimeout = timeouts->standby_timeout;
+        m_suspendTimeout = timeouts->suspend_timeout;
+        m_offTimeout = timeouts->off_timeout;
+        m_timeoutsSaved = true;
+        free(timeouts);
+    }
+    xcb_dpms_info_reply_t *info = xcb_dpms_info_reply(m_conn, xcb_dpms_info(m_conn), nullptr);
+    m_wasEnabled = !info || info->state;
+    free(info);
+
+    // 息屏由 PowerSavePlan 统一调度，关闭 X server 自带的 DPMS 超时避免两套计时互相干扰
+    xcb_dpms_enable(m_conn);
+    xcb_dpms_set_timeouts(m_conn, 0, 0, 0);
+    xcb_flush(m_conn);
+    m_valid = true;
+}
+
+X11ScreenController::~X11ScreenController()
+{
+    // DPMS 超时是 X server 全局设置，退出后恢复其自带的息屏计时
+    if (m_valid && m_timeoutsSaved) {
+        xcb_dpms_set_timeouts(m_conn, m_standbyTimeout, m_suspendTimeout, m_offTimeout);
+        if (!m_wasEnabled)
+            xcb_dpms_disable(m_conn);
+        xcb_flush(m_conn);
+    }
+    xcb_disconnect(m_conn);
+}
+
+ScreenController::Mode X11ScreenController::mode(int index) const
+{
+    if (!m_valid || index != 0)
+        return On;
+
+    xcb_dpms_info_reply_t *info = xcb_dpms_info_reply(m_conn, xcb_dpms_info(m_conn), nullptr);
+    if (!info)
+        return On;
+    const bool on = !info->state || info->power_level == XCB_DPMS_DPMS_MODE_ON;
+    free(info);
+    return on ? On : Off;
+}
+
+void X11ScreenController::setMode(int index, Mode m)
+{
+    if (!m_valid || index != 0)
+        return;
+
+    const Mode old = mode(index);
+    // 其他客户端可能关闭了 DPMS，强制电源级别前需确保处于启用状态
+    xcb_dpms_enable(m_conn);
+    xcb_dpms_force_level(m_conn, m == On ? XCB_DPMS_DPMS_MODE_ON : XCB_DPMS_DPMS_MODE_OFF);
+    xcb_flush(m_conn);
+
+    if (old != m)
+        Q_EMIT modeChanged(index, m);
+}
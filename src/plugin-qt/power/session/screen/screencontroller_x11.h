@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "screencontroller.h"
+
+#include <xcb/xcb.h>
+
+/**
+ * @brief X11 output power control through the DPMS extension.
+ *
+ * DPMS is screen-wide, so all outputs are exposed as a single output.
+ */
+class X11ScreenController : public ScreenController
+{
+    Q_OBJECT
+public:
+    explicit X11ScreenController(QObject *parent = nullptr);
+    ~X11ScreenController() override;
+
+    bool isValid() const override { return m_valid; }
+    int outputCount() const override { return m_valid ? 1 : 0; }
+    Mode mode(int index) const override;
+    void setMode(int index, Mode m) override;
+
+private:
+    xcb_connection_t *m_conn = nullptr;
+    bool m_valid = false;
+    // 构造前 X server 的 DPMS 设置，析构时恢复
+    bool m_timeoutsSaved = false;
+    bool m_wasEnabled = true;
+    uint16_t m_standbyTimeout = 0;
+    uint16_t m_suspendTimeout = 0;
+    uint16_t m_offTimeout = 0;
+};
@@ -7,6 +7,7 @@
 
 #include <QDBusConnection>
 #include <QDBusReply>
+#include <QDBusServiceWatcher>
 #include <QDBusUnixFileDescriptor>
 
 using namespace PowerDBus;
@@ -64,6 +65,12 @@ SessionDBusProxy::SessionDBusProxy(QObject *parent)
         m_freedesktopDBusInter->service(), m_freedesktopDBusInter->path(),
         m_freedesktopDBusInter->interface(),
         "NameOwnerChanged", this, SIGNAL(login1OwnerChanged(QString,QString,QString)));
+
+    // 日历服务重启后节假日数据可能已更新
+    auto *calendarWatcher = new QDBusServiceWatcher(kCalendarService, QDBusConnection::sessionBus(),
+                                                    QDBusServiceWatcher::WatchForRegistration, this);
+    connect(calendarWatcher, &QDBusServiceWatcher::serviceRegistered,
+            this, &SessionDBusProxy::calendarServiceChanged);
 }
 
 bool SessionDBusProxy::onBattery() const
@@ -153,6 +160,11 @@ void SessionDBusProxy::showLockAuth(bool autoStart)
     m_lockFrontInter->call("ShowAuth", autoStart);
 }
 
+QDBusPendingCall SessionDBusProxy::showLockAuthAsync(bool autoStart)
+{
+    return m_lockFrontInter->asyncCall("ShowAuth", autoStart);
+}
+
 void SessionDBusProxy::lockSession(const QString &sessionId)
 {
     QDBusReply<void> r = m_login1Inter->call("LockSession", sessionId);
@@ -160,6 +172,11 @@ void SessionDBusProxy::lockSession(const QString &sessionId)
         qWarning("[Proxy] LockSession(%s) failed: %s", qPrintable(sessionId), qPrintable(r.error().message()));
 }
 
+QDBusPendingCall SessionDBusProxy::lockSessionAsync(const QString &sessionId)
+{
+    return m_login1Inter->asyncCall("LockSession", sessionId);
+}
+
 QDBusUnixFileDescriptor SessionDBusProxy::inhibit(const QString &what, const QString &who,
                                                    const QString &why, const QString &mode)
 {
@@ -199,8 +216,7 @@ void SessionDBusProxy::closeNotification(uint id)
     m_notificationsInter->asyncCall("CloseNotification", id);
 }
 
-QString SessionDBusProxy::getFestivalMonth(int year, int month)
+QDBusPendingCall SessionDBusProxy::getFestivalMonthAsync(int year, int month)
 {
-    QDBusReply<QString> r = m_calendarInter->call("getFestivalMonth", year, month);
-    return r.isValid() ? r.value() : QString();
+    return m_calendarInter->asyncCall("getFestivalMonth", year, month);
 }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <QObject>
+#include <QDBusPendingCall>
 #include <QDBusUnixFileDescriptor>
 #include <DDBusInterface>
 
@@ -60,9 +61,11 @@ public:
 
     // ── LockFront ──
     void showLockAuth(bool autoStart);
+    QDBusPendingCall showLockAuthAsync(bool autoStart);
 
     // ── Login1 ──
     void lockSession(const QString &sessionId);
+    QDBusPendingCall lockSessionAsync(const QString &sessionId);
     QDBusUnixFileDescriptor inhibit(const QString &what, const QString &who,
                                     const QString &why, const QString &mode);
 
@@ -80,7 +83,7 @@ public:
     void closeNotification(uint id);
 
     // ── Calendar ──
-    QString getFestivalMonth(int year, int month);
+    QDBusPendingCall getFestivalMonthAsync(int year, int month);
 
 signals:
     // DDBusInterface 自动转发：属性名 + Changed
@@ -98,6 +101,7 @@ signals:
     void notifyActionInvoked(uint id, const QString &actionKey);
     void timeUpdate();
     void login1OwnerChanged(const QString &name, const QString &oldOwner, const QString &newOwner);
+    void calendarServiceChanged();
 
 private:
     DDBusInterface *m_powerInter;
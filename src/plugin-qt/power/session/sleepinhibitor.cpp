@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "sleepinhibitor.h"
+#include "presleeptasks.h"
 #include "../powerconstants.h"
 
 #include <QDBusInterface>
@@ -17,7 +18,9 @@ using namespace PowerDBus;
 
 SleepInhibitor::SleepInhibitor(QObject *parent)
     : QObject(parent)
+    , m_tasks(new PreSleepTasks(this))
 {
+    connect(m_tasks, &PreSleepTasks::finished, this, &SleepInhibitor::unblock);
     inhibit();
     QDBusConnection::systemBus().connect(
         kDaemonService, kDaemonPath, kDaemonService, "HandleForSleep",
@@ -35,9 +38,13 @@ SleepInhibitor::~SleepInhibitor()
 void SleepInhibitor::handleSleep(bool beforeSleep)
 {
     if (beforeSleep) {
-        unblock();
         Q_EMIT aboutToSleep();
+        if (m_tasks->isEmpty())
+            unblock();
+        else
+            m_tasks->start();
     } else {
+        m_tasks->cancel();
         Q_EMIT wokeUp();
         block();
     }
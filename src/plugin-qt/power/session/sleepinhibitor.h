@@ -6,6 +6,8 @@
 
 #include <QObject>
 
+class PreSleepTasks;
+
 class SleepInhibitor : public QObject {
     Q_OBJECT
 public:
@@ -14,6 +16,8 @@ public:
 
     void block();
     void unblock();
+    // 休眠前需要完成的异步工作在此登记，全部结束后才释放 inhibitor
+    PreSleepTasks *preSleepTasks() const { return m_tasks; }
 
 Q_SIGNALS:
     void aboutToSleep();
@@ -27,4 +31,5 @@ private Q_SLOTS:
 private:
     void inhibit();
     int m_fd = -1;
+    PreSleepTasks *m_tasks = nullptr;
 };
@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "warnlevelpolicy.h"
+
+uint WarnLevelPolicy::rawLevel(double percentage, quint64 timeToEmpty) const
+{
+    if (m_thresholds.usePercentage) {
+        if (percentage <= 0.0 || percentage > m_thresholds.notifyPercentage)
+            return None;
+        if (m_thresholds.actionPercentage > 0 && percentage <= m_thresholds.actionPercentage)
+            return Action;
+        if (percentage <= 10.0)
+            return Critical;
+        if (percentage <= 15.0)
+            return Danger;
+        if (percentage <= 20.0)
+            return Low;
+        if (percentage <= 25.0)
+            return Remind;
+        return None;
+    }
+
+    if (timeToEmpty > m_thresholds.timeLow || timeToEmpty == 0)
+        return None;
+    if (timeToEmpty > m_thresholds.timeDanger)
+        return Low;
+    if (timeToEmpty > m_thresholds.timeCritical)
+        return Danger;
+    if (timeToEmpty > m_thresholds.timeAction)
+        return Critical;
+    return Action;
+}
+
+uint WarnLevelPolicy::update(double percentage, quint64 timeToEmpty)
+{
+    const bool unknown = m_thresholds.usePercentage ? percentage <= 0.0 : timeToEmpty == 0;
+    if (unknown)
+        return m_level;
+
+    const uint raw = rawLevel(percentage, timeToEmpty);
+    if (raw >= m_level) {
+        m_level = raw;
+        return m_level;
+    }
+
+    // 按“稍差一点”的数值重新判定，仍低于当前等级才真正减轻
+    const double pct = qMax(percentage - kPercentageHysteresis, 0.1);
+    const quint64 tte = timeToEmpty > kTimeHysteresis ? timeToEmpty - kTimeHysteresis : 1;
+    const uint relaxed = rawLevel(pct, tte);
+    if (relaxed < m_level)
+        m_level = relaxed;
+    return m_level;
+}
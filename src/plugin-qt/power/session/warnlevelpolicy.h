@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QtGlobal>
+
+// 低电量等级判定。等级加重立即生效；减轻时需越过阈值一段回差，
+// 避免电量或剩余时间在阈值附近抖动导致反复提醒。
+class WarnLevelPolicy
+{
+public:
+    enum Level { None = 0, Remind, Low, Danger, Critical, Action };
+
+    // 百分比回差，单位 %
+    static constexpr double kPercentageHysteresis = 2.0;
+    // 剩余时间回差，单位秒
+    static constexpr quint64 kTimeHysteresis = 120;
+
+    struct Thresholds {
+        bool usePercentage = true;
+        int notifyPercentage = 0;
+        int actionPercentage = 0;
+        quint64 timeLow = 0;
+        quint64 timeDanger = 0;
+        quint64 timeCritical = 0;
+        quint64 timeAction = 0;
+    };
+
+    void setThresholds(const Thresholds &thresholds) { m_thresholds = thresholds; }
+    const Thresholds &thresholds() const { return m_thresholds; }
+
+    uint level() const { return m_level; }
+    void reset() { m_level = None; }
+    // 根据新的电量/剩余时间更新并返回当前等级；数据未知（0）时保持原等级
+    uint update(double percentage, quint64 timeToEmpty);
+
+    uint rawLevel(double percentage, quint64 timeToEmpty) const;
+
+private:
+    Thresholds m_thresholds;
+    uint m_level = None;
+};
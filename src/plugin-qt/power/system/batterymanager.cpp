@@ -3,39 +3,57 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "batterymanager.h"
-#include "powermanager.h"
-#include "../powerconstants.h"
 
-#include <QDBusInterface>
-#include <QDBusConnection>
-#include <QDBusReply>
 #include <QTimer>
 #include <QSocketNotifier>
 #include <QFile>
 #include <QDir>
 #include <QLoggingCategory>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <libudev.h>
 
 Q_DECLARE_LOGGING_CATEGORY(logPowerSystem)
 
-using namespace PowerDBus;
+namespace {
+const QByteArrayList kBatteryAttrs = {"capacity", "status", "energy_now", "power_now",
+                                      "energy_full", "energy_full_design"};
+const QByteArrayList kMainsAttrs = {"online"};
+
+// AC 变更后电池状态需要一段时间才稳定：1s 起，数值不变则间隔翻倍，总计 60s
+constexpr int kSettleInitialInterval = 1000;
+constexpr int kSettleMaxInterval = 16000;
+constexpr int kSettleWindow = 60000;
+
+// 部分电池驱动不会为电量变化发出 uevent，充放电过程中保留低频兜底刷新
+constexpr int kFallbackInterval = 60000;
+}
 
-BatteryManager::BatteryManager(SystemPowerManager *mgr, QObject *parent)
+BatteryManager::BatteryManager(const QString &sysfsRoot, QObject *parent)
     : QObject(parent)
-    , m_mgr(mgr)
+    , m_sysfsRoot(sysfsRoot)
 {
-    probe();
-    initUdev();
+    m_clock.start();
+
+    m_settleTimer = new QTimer(this);
+    m_settleTimer->setSingleShot(true);
+    connect(m_settleTimer, &QTimer::timeout, this, &BatteryManager::onSettleTimeout);
 
-    m_batteryPollTimer = new QTimer(this);
-    m_batteryPollTimer->setInterval(60000);
-    connect(m_batteryPollTimer, &QTimer::timeout, this, &BatteryManager::pollBattery);
-    m_batteryPollTimer->start();
+    m_fallbackTimer = new QTimer(this);
+    m_fallbackTimer->setInterval(kFallbackInterval);
+    connect(m_fallbackTimer, &QTimer::timeout, this, [this]() {
+        refreshBattery();
+    });
 }
 
 BatteryManager::~BatteryManager()
 {
+    const auto names = m_supplies.keys();
+    for (const auto &name : names)
+        closeSupply(name);
+
     if (m_udevMon) {
         udev_monitor_unref(m_udevMon);
         m_udevMon = nullptr;
@@ -46,59 +64,179 @@ BatteryManager::~BatteryManager()
     }
 }
 
+// 枚举一次 power_supply 并读取初始状态
 void BatteryManager::probe()
 {
-    QDir ps("/sys/class/power_supply");
+    QDir ps(m_sysfsRoot);
     for (const auto &entry : ps.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
-        QFile tf("/sys/class/power_supply/" + entry + "/type");
-        if (tf.open(QIODevice::ReadOnly)) {
-            if (tf.readAll().trimmed() == "Battery") { m_hasBattery = true; break; }
-        }
+        if (!m_supplies.contains(entry))
+            openSupply(entry);
     }
-    if (m_hasBattery) { m_mgr->updateHasBattery(true); pollBattery(); }
-    // AC initial state will be picked up by udev on next event,
-    // or by the fallback poll if no udev events arrive.
+
+    setHasBattery(!primaryBattery().isEmpty());
+    refreshAC();
+    refreshBattery();
 }
 
-void BatteryManager::pollBattery()
+void BatteryManager::startMonitor()
 {
-    if (!m_hasBattery) {
-        QDir ps("/sys/class/power_supply");
-        for (const auto &entry : ps.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
-            QFile tf("/sys/class/power_supply/" + entry + "/type");
-            if (tf.open(QIODevice::ReadOnly) && tf.readAll().trimmed() == "Battery")
-                { m_hasBattery = true; m_mgr->updateHasBattery(true); break; }
+    initUdev();
+}
+
+bool BatteryManager::openSupply(const QString &name)
+{
+    const QString dir = m_sysfsRoot + "/" + name + "/";
+    QFile tf(dir + "type");
+    if (!tf.open(QIODevice::ReadOnly))
+        return false;
+
+    const QByteArray type = tf.readAll().trimmed();
+    PowerSupply supply;
+    const QByteArrayList *attrs = nullptr;
+    if (type == "Battery") {
+        supply.type = SupplyType::Battery;
+        attrs = &kBatteryAttrs;
+    } else if (type == "Mains" || type == "USB") {
+        supply.type = SupplyType::Mains;
+        attrs = &kMainsAttrs;
+    }
+
+    if (attrs) {
+        for (const auto &attr : *attrs) {
+            const QByteArray path = QFile::encodeName(dir) + attr;
+            int fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+            if (fd >= 0)
+                supply.fds.insert(attr, fd);
         }
     }
-    if (!m_hasBattery) return;
 
-    double pct = 100.0; uint status = 0; quint64 tte = 0; double cap = 100.0;
-    QDir ps("/sys/class/power_supply");
-    for (const auto &entry : ps.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
-        QFile tf("/sys/class/power_supply/" + entry + "/type");
-        if (!tf.open(QIODevice::ReadOnly) || tf.readAll().trimmed() != "Battery") continue;
-        auto readInt = [&](const QString &f) -> int {
-            QFile ff("/sys/class/power_supply/" + entry + "/" + f);
-            if (ff.open(QIODevice::ReadOnly)) return ff.readAll().trimmed().toInt();
-            return 0;
-        };
-        QFile cf("/sys/class/power_supply/" + entry + "/capacity");
-        if (cf.open(QIODevice::ReadOnly)) { pct = cf.readAll().trimmed().toInt(); cf.close(); }
-        QFile sf("/sys/class/power_supply/" + entry + "/status");
-        if (sf.open(QIODevice::ReadOnly)) {
-            QString s = sf.readAll().trimmed(); sf.close();
-            if (s == "Charging") status = 1;
-            else if (s == "Discharging") { status = 2; int pw = readInt("power_now");
-                tte = pw > 0 ? static_cast<quint64>(readInt("energy_now")) * 3600 / pw : 0; }
-            else if (s == "Full") status = 4;
+    m_supplies.insert(name, supply);
+    return true;
+}
+
+void BatteryManager::closeSupply(const QString &name)
+{
+    auto it = m_supplies.find(name);
+    if (it == m_supplies.end())
+        return;
+    for (int fd : std::as_const(it->fds))
+        ::close(fd);
+    m_supplies.erase(it);
+}
+
+QByteArray BatteryManager::readAttr(const PowerSupply &supply, const QByteArray &attr) const
+{
+    int fd = supply.fds.value(attr, -1);
+    if (fd < 0)
+        return {};
+
+    // sysfs 属性在偏移 0 读取时会重新生成内容，无需重新打开
+    char buf[64];
+    ssize_t n = pread(fd, buf, sizeof(buf), 0);
+    if (n <= 0)
+        return {};
+    return QByteArray(buf, static_cast<int>(n)).trimmed();
+}
+
+qint64 BatteryManager::readIntAttr(const PowerSupply &supply, const QByteArray &attr) const
+{
+    return readAttr(supply, attr).toLongLong();
+}
+
+QString BatteryManager::primaryBattery() const
+{
+    for (auto it = m_supplies.cbegin(); it != m_supplies.cend(); ++it) {
+        if (it->type == SupplyType::Battery)
+            return it.key();
+    }
+    return {};
+}
+
+void BatteryManager::setHasBattery(bool has)
+{
+    if (m_hasBattery != has) {
+        m_hasBattery = has;
+        Q_EMIT hasBatteryChanged(has);
+    }
+    updateFallbackTimer();
+}
+
+bool BatteryManager::refreshBattery()
+{
+    const QString name = primaryBattery();
+    if (name.isEmpty())
+        return false;
+    const PowerSupply &supply = m_supplies[name];
+
+    double pct = 100.0; uint status = 0; quint64 tte = 0; quint64 ttf = 0; double cap = 100.0;
+    const QByteArray capacity = readAttr(supply, "capacity");
+    if (!capacity.isEmpty())
+        pct = capacity.toInt();
+
+    const QByteArray s = readAttr(supply, "status");
+    if (s == "Charging") status = 1;
+    else if (s == "Discharging") status = 2;
+    else if (s == "Full") status = 4;
+
+    qint64 ef = readIntAttr(supply, "energy_full"), efd = readIntAttr(supply, "energy_full_design");
+    if (efd > 0) cap = ef * 100.0 / efd;
+
+    bool statusChanged = status != m_status;
+    // 剩余时间由平滑后的功率估计得出，不直接使用瞬时的 power_now
+    if (status == 1 || status == 2) {
+        const auto direction = status == 1 ? EnergyRateEstimator::Direction::Charging
+                                           : EnergyRateEstimator::Direction::Discharging;
+        if (statusChanged || direction != m_rateEstimator.direction())
+            m_rateEstimator.reset(direction);
+        const qint64 energy = readIntAttr(supply, "energy_now");
+        m_rateEstimator.addSample(m_clock.elapsed(), energy, readIntAttr(supply, "power_now"));
+        tte = m_rateEstimator.timeToEmpty(energy);
+        ttf = m_rateEstimator.timeToFull(energy, ef);
+    }
+
+    bool chg = (pct != m_percentage || status != m_status || tte != m_timeToEmpty
+                || ttf != m_timeToFull || cap != m_capacity);
+    m_percentage = pct; m_status = status; m_timeToEmpty = tte; m_timeToFull = ttf; m_capacity = cap;
+    if (statusChanged)
+        updateFallbackTimer();
+    if (chg) {
+        Q_EMIT batteryInfoChanged(pct, status, tte, ttf, cap);
+        Q_EMIT batteryChanged();
+    }
+    return chg;
+}
+
+void BatteryManager::refreshAC()
+{
+    bool hasMains = false;
+    bool online = false;
+    for (auto it = m_supplies.cbegin(); it != m_supplies.cend(); ++it) {
+        if (it->type != SupplyType::Mains)
+            continue;
+        hasMains = true;
+        if (readAttr(*it, "online") == "1") {
+            online = true;
+            break;
         }
-        int ef = readInt("energy_full"), efd = readInt("energy_full_design");
-        if (efd > 0) cap = ef * 100.0 / efd;
-        break;
     }
-    bool chg = (pct != m_percentage || status != m_status || tte != m_timeToEmpty || cap != m_capacity);
-    m_percentage = pct; m_status = status; m_timeToEmpty = tte; m_capacity = cap;
-    if (chg) { m_mgr->updateBatteryInfo(pct, status, tte, m_timeToFull, cap); Q_EMIT batteryChanged(); }
+    // 没有外接电源设备（如台式机）时保持默认值
+    if (!hasMains)
+        return;
+
+    bool onBatt = !online;
+    if (onBatt != m_onBattery) {
+        m_onBattery = onBatt;
+        Q_EMIT onBatteryChanged(onBatt);
+    }
+}
+
+void BatteryManager::updateFallbackTimer()
+{
+    bool active = m_hasBattery && (m_status == 1 || m_status == 2);
+    if (active && !m_fallbackTimer->isActive())
+        m_fallbackTimer->start();
+    else if (!active)
+        m_fallbackTimer->stop();
 }
 
 // ── udev-based AC / battery monitoring ──────────────────────────
@@ -145,68 +283,67 @@ void BatteryManager::onUdevEvent()
     if (!dev) return;
 
     const char *action = udev_device_get_action(dev);
-    const char *type = udev_device_get_sysattr_value(dev, "type");
+    const char *sysname = udev_device_get_sysname(dev);
+    if (action && sysname)
+        handleUevent(QString::fromLatin1(action), QString::fromLatin1(sysname));
 
-    if (!action || !type) {
-        udev_device_unref(dev);
-        return;
-    }
+    udev_device_unref(dev);
+}
 
-    if (strcmp(action, "change") == 0) {
-        if (strcmp(type, "Mains") == 0 || strcmp(type, "USB") == 0) {
-            refreshACFromUdev(dev);
-            scheduleBatteryRefreshAfterAC();
-        } else if (strcmp(type, "Battery") == 0) {
-            refreshBatteryFromUdev(dev);
-        }
-    } else if (strcmp(action, "add") == 0) {
-        if (strcmp(type, "Battery") == 0) {
-            m_hasBattery = true;
-            m_mgr->updateHasBattery(true);
-            pollBattery();
-        }
-    } else if (strcmp(action, "remove") == 0) {
-        if (strcmp(type, "Battery") == 0) {
-            // re-probe to see if any batteries remain
-            m_hasBattery = false;
-            QDir ps("/sys/class/power_supply");
-            for (const auto &entry : ps.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
-                QFile tf("/sys/class/power_supply/" + entry + "/type");
-                if (tf.open(QIODevice::ReadOnly) && tf.readAll().trimmed() == "Battery") {
-                    m_hasBattery = true;
-                    break;
-                }
-            }
-            if (!m_hasBattery)
-                m_mgr->updateHasBattery(false);
+void BatteryManager::handleUevent(const QString &action, const QString &name)
+{
+    if (action == QLatin1String("remove")) {
+        auto it = m_supplies.constFind(name);
+        if (it == m_supplies.constEnd())
+            return;
+        const SupplyType type = it->type;
+        closeSupply(name);
+        if (type == SupplyType::Battery) {
+            setHasBattery(!primaryBattery().isEmpty());
+            refreshBattery();
+        } else if (type == SupplyType::Mains) {
+            refreshAC();
         }
+        return;
     }
 
-    udev_device_unref(dev);
-}
+    if (action != QLatin1String("add") && action != QLatin1String("change"))
+        return;
 
-void BatteryManager::refreshACFromUdev(struct udev_device *dev)
-{
-    const char *online = udev_device_get_sysattr_value(dev, "online");
-    bool onBatt = !(online && strcmp(online, "1") == 0);
-    if (onBatt != m_onBattery) {
-        m_onBattery = onBatt;
-        Q_EMIT onBatteryChanged(onBatt);
+    if (action == QLatin1String("add"))
+        closeSupply(name);
+    if (!m_supplies.contains(name) && !openSupply(name))
+        return;
+
+    switch (m_supplies.value(name).type) {
+    case SupplyType::Mains:
+        refreshAC();
+        scheduleBatteryRefreshAfterAC();
+        break;
+    case SupplyType::Battery:
+        setHasBattery(true);
+        if (name == primaryBattery())
+            refreshBattery();
+        break;
+    default:
+        break;
     }
 }
 
-void BatteryManager::refreshBatteryFromUdev(struct udev_device *)
+void BatteryManager::scheduleBatteryRefreshAfterAC()
 {
-    // udev notified us of a battery change; full poll picks up all values
-    pollBattery();
+    m_settleInterval = kSettleInitialInterval;
+    m_settleElapsed = 0;
+    m_settleTimer->start(m_settleInterval);
 }
 
-// AC 变更后, 在 1s, 3s, 5s, 10s, 15s, ... 60s 递进刷新电池
-void BatteryManager::scheduleBatteryRefreshAfterAC()
+void BatteryManager::onSettleTimeout()
 {
-    static const int delays[] = {1000, 3000, 5000, 10000, 15000, 20000,
-                                 25000, 30000, 35000, 40000, 45000, 50000,
-                                 55000, 60000};
-    for (int d : delays)
-        QTimer::singleShot(d, this, &BatteryManager::pollBattery);
+    bool changed = refreshBattery();
+    m_settleElapsed += m_settleTimer->interval();
+    if (m_settleElapsed >= kSettleWindow)
+        return;
+
+    m_settleInterval = changed ? kSettleInitialInterval : qMin(m_settleInterval * 2, kSettleMaxInterval);
+    m_settleTimer->start(qMin(m_settleInterval, kSettleWindow - m_settleElapsed));
 }
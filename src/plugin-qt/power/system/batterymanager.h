@@ -1,35 +1,61 @@
 // SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
+#include "energyrateestimator.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
 #include <QObject>
 
 struct udev;
 struct udev_monitor;
 class QSocketNotifier;
 class QTimer;
-class SystemPowerManager;
 
+// 电池/电源状态由 udev 事件驱动：启动时枚举一次 power_supply，
+// 常用属性保持打开并用 pread 读取，uevent 只刷新对应的设备
 class BatteryManager : public QObject {
     Q_OBJECT
 public:
-    explicit BatteryManager(SystemPowerManager *mgr, QObject *parent = nullptr);
+    explicit BatteryManager(const QString &sysfsRoot = QStringLiteral("/sys/class/power_supply"),
+                            QObject *parent = nullptr);
     ~BatteryManager() override;
     void probe();
+    void startMonitor();
+    void handleUevent(const QString &action, const QString &name);
     bool hasBattery() const { return m_hasBattery; }
+    bool onBattery() const { return m_onBattery; }
 
 Q_SIGNALS:
     void batteryChanged();
+    void hasBatteryChanged(bool hasBattery);
+    void batteryInfoChanged(double pct, uint status, quint64 tte, quint64 ttf, double cap);
     void onBatteryChanged(bool onBattery);
 
 private:
-    void pollBattery();
+    enum class SupplyType { Unknown, Battery, Mains };
+    struct PowerSupply {
+        SupplyType type = SupplyType::Unknown;
+        QHash<QByteArray, int> fds;
+    };
+
     void initUdev();
     void onUdevEvent();
-    void refreshACFromUdev(struct udev_device *dev);
-    void refreshBatteryFromUdev(struct udev_device *dev);
+    bool openSupply(const QString &name);
+    void closeSupply(const QString &name);
+    QByteArray readAttr(const PowerSupply &supply, const QByteArray &attr) const;
+    qint64 readIntAttr(const PowerSupply &supply, const QByteArray &attr) const;
+    QString primaryBattery() const;
+    void setHasBattery(bool has);
+    bool refreshBattery();
+    void refreshAC();
     void scheduleBatteryRefreshAfterAC();
+    void onSettleTimeout();
+    void updateFallbackTimer();
 
-    SystemPowerManager *m_mgr = nullptr;
+    QString m_sysfsRoot;
+    QMap<QString, PowerSupply> m_supplies;
     bool m_hasBattery = false;
     bool m_onBattery = false;
     double m_percentage = 100.0;
@@ -37,9 +63,14 @@ private:
     quint64 m_timeToEmpty = 0;
     quint64 m_timeToFull = 0;
     double m_capacity = 100.0;
+    EnergyRateEstimator m_rateEstimator;
+    QElapsedTimer m_clock;
 
     struct udev *m_udev = nullptr;
     struct udev_monitor *m_udevMon = nullptr;
     QSocketNotifier *m_udevNotifier = nullptr;
-    QTimer *m_batteryPollTimer = nullptr;
+    QTimer *m_settleTimer = nullptr;
+    int m_settleInterval = 0;
+    int m_settleElapsed = 0;
+    QTimer *m_fallbackTimer = nullptr;
 };
@@ -0,0 +1,274 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "cpufreqmanager.h"
+
+#include <QCollator>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+
+#include <algorithm>
+
+Q_DECLARE_LOGGING_CATEGORY(logPowerSystem)
+
+namespace {
+QByteArray readAttr(const QString &path)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+        return {};
+    return f.readAll().trimmed();
+}
+
+// sysfs 在 write() 时校验取值，缓冲写入会把 EINVAL/EBUSY 推迟到 close() 而丢失
+bool writeAttr(const QString &path, const QByteArray &value)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Unbuffered))
+        return false;
+    return f.write(value) == value.size();
+}
+
+// 解析 "0-3,8,10-11" 形式的 CPU 列表；affected_cpus 则是空格分隔
+QList<int> parseCpuList(const QByteArray &data)
+{
+    QList<int> cpus;
+    const QList<QByteArray> parts = QByteArray(data).replace(' ', ',').split(',');
+    for (const QByteArray &part : parts) {
+        if (part.isEmpty())
+            continue;
+        const int dash = part.indexOf('-');
+        bool ok1 = false, ok2 = false;
+        if (dash < 0) {
+            int cpu = part.toInt(&ok1);
+            if (ok1)
+                cpus.append(cpu);
+            continue;
+        }
+        int from = part.left(dash).toInt(&ok1);
+        int to = part.mid(dash + 1).toInt(&ok2);
+        if (ok1 && ok2) {
+            for (int cpu = from; cpu <= to; ++cpu)
+                cpus.append(cpu);
+        }
+    }
+    return cpus;
+}
+
+QStringList splitWords(const QByteArray &data)
+{
+    return QString::fromLatin1(data).split(' ', Qt::SkipEmptyParts);
+}
+} // namespace
+
+CpuFreqManager::CpuFreqManager(const QString &cpuRoot, QObject *parent)
+    : QObject(parent)
+    , m_cpuRoot(cpuRoot)
+{
+}
+
+QString CpuFreqManager::policyPath(const Policy &policy, const QString &attr) const
+{
+    return m_cpuRoot + "/cpufreq/" + policy.name + "/" + attr;
+}
+
+void CpuFreqManager::probe()
+{
+    QDir dir(m_cpuRoot + "/cpufreq");
+    QStringList names = dir.entryList({ "policy*" }, QDir::Dirs | QDir::NoDotAndDotDot);
+    QCollator collator;
+    collator.setNumericMode(true);
+    std::sort(names.begin(), names.end(), collator);
+
+    QList<Policy> policies;
+    m_hasPolicyBoost = false;
+    for (const QString &name : std::as_const(names)) {
+        Policy p;
+        p.name = name;
+        p.driver = QString::fromLatin1(readAttr(policyPath(p, "scaling_driver")));
+        // affected_cpus 只包含在线 CPU，全部离线时为空
+        p.cpus = parseCpuList(readAttr(policyPath(p, "affected_cpus")));
+        p.availableGovernors = splitWords(readAttr(policyPath(p, "scaling_available_governors")));
+        p.governor = QString::fromLatin1(readAttr(policyPath(p, "scaling_governor")));
+        p.availableEpp = splitWords(readAttr(policyPath(p, "energy_performance_available_preferences")));
+        p.epp = QString::fromLatin1(readAttr(policyPath(p, "energy_performance_preference")));
+        const QByteArray boost = readAttr(policyPath(p, "boost"));
+        p.hasBoost = !boost.isEmpty();
+        p.boost = boost == "1";
+        m_hasPolicyBoost = m_hasPolicyBoost || p.hasBoost;
+        policies.append(p);
+    }
+
+    const QByteArray globalBoost = readAttr(m_cpuRoot + "/cpufreq/boost");
+    m_hasGlobalBoost = !globalBoost.isEmpty();
+    m_globalBoost = globalBoost == "1";
+
+    m_policies = policies;
+    Q_EMIT policiesChanged();
+}
+
+QList<CpuFreqManager::Policy> CpuFreqManager::onlinePolicies() const
+{
+    QList<Policy> online;
+    for (const Policy &p : m_policies) {
+        if (p.isOnline())
+            online.append(p);
+    }
+    return online;
+}
+
+bool CpuFreqManager::supportsGovernor(const QString &governor) const
+{
+    const QList<Policy> online = onlinePolicies();
+    return !online.isEmpty() && std::all_of(online.cbegin(), online.cend(), [&](const Policy &p) {
+        return p.availableGovernors.contains(governor);
+    });
+}
+
+bool CpuFreqManager::supportsEpp(const QString &epp) const
+{
+    bool any = false;
+    for (const Policy &p : onlinePolicies()) {
+        if (!p.hasEpp())
+            continue;
+        if (!p.availableEpp.contains(epp))
+            return false;
+        any = true;
+    }
+    return any;
+}
+
+bool CpuFreqManager::boost() const
+{
+    if (m_hasGlobalBoost)
+        return m_globalBoost;
+    for (const Policy &p : onlinePolicies()) {
+        if (p.hasBoost && !p.boost)
+            return false;
+    }
+    return m_hasPolicyBoost;
+}
+
+QString CpuFreqManager::governor() const
+{
+    // 各 policy 不一致时返回空，表示混合状态
+    QString result;
+    for (const Policy &p : onlinePolicies()) {
+        if (result.isEmpty())
+            result = p.governor;
+        else if (result != p.governor)
+            return {};
+    }
+    return result;
+}
+
+QString CpuFreqManager::epp() const
+{
+    QString result;
+    for (const Policy &p : onlinePolicies()) {
+        if (!p.hasEpp())
+            continue;
+        if (result.isEmpty())
+            result = p.epp;
+        else if (result != p.epp)
+            return {};
+    }
+    return result;
+}
+
+bool CpuFreqManager::writeTracked(QList<Write> &done, const QString &path, const QByteArray &value)
+{
+    const QByteArray old = readAttr(path);
+    if (old == value)
+        return true;
+    if (!writeAttr(path, value)) {
+        qWarning(logPowerSystem) << "cpufreq: failed to write" << value << "to" << path;
+        return false;
+    }
+    done.append({ path, old });
+    return true;
+}
+
+void CpuFreqManager::rollback(const QList<Write> &done)
+{
+    for (auto it = done.crbegin(); it != done.crend(); ++it) {
+        if (!writeAttr(it->path, it->oldValue))
+            qWarning(logPowerSystem) << "cpufreq: rollback failed for" << it->path;
+    }
+}
+
+bool CpuFreqManager::apply(const Settings &settings)
+{
+    const QList<Policy> online = onlinePolicies();
+
+    // 先整体校验，避免写到一半才发现某个 policy 不支持
+    if (!settings.governor.isEmpty() && !supportsGovernor(settings.governor)) {
+        qWarning(logPowerSystem) << "cpufreq: governor" << settings.governor << "not supported by all policies";
+        return false;
+    }
+    if (!settings.epp.isEmpty() && !supportsEpp(settings.epp)) {
+        qWarning(logPowerSystem) << "cpufreq: EPP" << settings.epp << "not supported";
+        return false;
+    }
+
+    QList<Write> done;
+    bool ok = true;
+    // governor 必须先于 EPP 写入：intel_pstate 在 performance governor 下会拒绝其他 EPP
+    for (int i = 0; ok && i < online.size(); ++i) {
+        if (!settings.governor.isEmpty())
+            ok = writeTracked(done, policyPath(online.at(i), "scaling_governor"), settings.governor.toLatin1());
+    }
+    for (int i = 0; ok && i < online.size(); ++i) {
+        const Policy &p = online.at(i);
+        if (!settings.epp.isEmpty() && p.hasEpp())
+            ok = writeTracked(done, policyPath(p, "energy_performance_preference"), settings.epp.toLatin1());
+    }
+    if (ok && settings.boost) {
+        const QByteArray value = *settings.boost ? "1" : "0";
+        if (m_hasGlobalBoost) {
+            ok = writeTracked(done, m_cpuRoot + "/cpufreq/boost", value);
+        } else {
+            for (int i = 0; ok && i < online.size(); ++i) {
+                if (online.at(i).hasBoost)
+                    ok = writeTracked(done, policyPath(online.at(i), "boost"), value);
+            }
+        }
+    }
+
+    if (!ok) {
+        rollback(done);
+        probe();
+        return false;
+    }
+
+    if (!done.isEmpty())
+        probe();
+    return true;
+}
+
+QString CpuFreqManager::toJson() const
+{
+    QJsonArray array;
+    for (const Policy &p : m_policies) {
+        QJsonArray cpus;
+        for (int cpu : p.cpus)
+            cpus.append(cpu);
+        QJsonObject obj;
+        obj.insert("Name", p.name);
+        obj.insert("Driver", p.driver);
+        obj.insert("Cpus", cpus);
+        obj.insert("Online", p.isOnline());
+        obj.insert("Governor", p.governor);
+        obj.insert("AvailableGovernors", QJsonArray::fromStringList(p.availableGovernors));
+        obj.insert("EnergyPerformancePreference", p.epp);
+        obj.insert("AvailableEnergyPerformancePreferences", QJsonArray::fromStringList(p.availableEpp));
+        if (p.hasBoost)
+            obj.insert("Boost", p.boost);
+        array.append(obj);
+    }
+    return QString::fromUtf8(QJsonDocument(array).toJson(QJsonDocument::Compact));
+}
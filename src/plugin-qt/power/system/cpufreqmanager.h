@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+#include <QList>
+#include <QObject>
+#include <QStringList>
+
+#include <optional>
+
+// 按 cpufreq/policyN 管理调频策略：混合架构（P/E 核）下各 policy 的可用 governor、
+// EPP 和 boost 可能不同，且离线 CPU 所在 policy 不可写，因此不能只看 cpu0
+class CpuFreqManager : public QObject {
+    Q_OBJECT
+public:
+    struct Policy {
+        QString name;
+        QString driver;
+        QList<int> cpus;
+        QStringList availableGovernors;
+        QString governor;
+        QStringList availableEpp;
+        QString epp;
+        bool hasBoost = false;
+        bool boost = false;
+
+        bool isOnline() const { return !cpus.isEmpty(); }
+        bool hasEpp() const { return !availableEpp.isEmpty(); }
+    };
+
+    // 未设置的字段保持不变
+    struct Settings {
+        QString governor;
+        QString epp;
+        std::optional<bool> boost;
+    };
+
+    explicit CpuFreqManager(const QString &cpuRoot = QStringLiteral("/sys/devices/system/cpu"),
+                            QObject *parent = nullptr);
+
+    void probe();
+    bool apply(const Settings &settings);
+
+    const QList<Policy> &policies() const { return m_policies; }
+    bool supportsGovernor(const QString &governor) const;
+    bool supportsEpp(const QString &epp) const;
+    bool hasBoost() const { return m_hasGlobalBoost || m_hasPolicyBoost; }
+    bool boost() const;
+    QString governor() const;
+    QString epp() const;
+    QString toJson() const;
+
+Q_SIGNALS:
+    void policiesChanged();
+
+private:
+    struct Write {
+        QString path;
+        QByteArray oldValue;
+    };
+
+    QString policyPath(const Policy &policy, const QString &attr) const;
+    bool writeTracked(QList<Write> &done, const QString &path, const QByteArray &value);
+    void rollback(const QList<Write> &done);
+    QList<Policy> onlinePolicies() const;
+
+    QString m_cpuRoot;
+    QList<Policy> m_policies;
+    bool m_hasGlobalBoost = false;
+    bool m_globalBoost = false;
+    bool m_hasPolicyBoost = false;
+};
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "energyrateestimator.h"
+
+#include <cmath>
+
+void EnergyRateEstimator::reset(Direction direction)
+{
+    m_direction = direction;
+    m_rate = 0.0;
+    m_hasAnchor = false;
+    m_rejects = 0;
+}
+
+void EnergyRateEstimator::addSample(qint64 msecs, qint64 energy, qint64 power)
+{
+    if (!m_hasAnchor) {
+        m_hasAnchor = true;
+        m_anchorTime = msecs;
+        m_anchorEnergy = energy;
+        if (m_rate <= 0.0 && power > 0)
+            m_rate = power;
+        return;
+    }
+
+    const qint64 dt = msecs - m_anchorTime;
+    if (dt < kMinIntervalMs)
+        return;
+
+    const qint64 delta = m_direction == Direction::Discharging ? m_anchorEnergy - energy
+                                                               : energy - m_anchorEnergy;
+    // 方向与状态不符（电量校准、状态切换中间态），重新取锚点
+    if (delta < 0) {
+        m_anchorTime = msecs;
+        m_anchorEnergy = energy;
+        return;
+    }
+
+    const double instant = delta * 3600000.0 / dt;
+    if (m_rate > 0.0 && (instant > m_rate * kOutlierRatio || instant < m_rate / kOutlierRatio)) {
+        // 保留锚点，下一个差分跨越更长的窗口，自然摊平突发
+        if (++m_rejects < kMaxRejects)
+            return;
+    }
+    m_rejects = 0;
+
+    const double alpha = m_rate > 0.0 ? 1.0 - std::exp(-static_cast<double>(dt) / kTimeConstantMs) : 1.0;
+    m_rate += alpha * (instant - m_rate);
+    m_anchorTime = msecs;
+    m_anchorEnergy = energy;
+}
+
+quint64 EnergyRateEstimator::timeToEmpty(qint64 energy) const
+{
+    if (m_direction != Direction::Discharging || m_rate <= 0.0 || energy <= 0)
+        return 0;
+    return static_cast<quint64>(energy * 3600.0 / m_rate);
+}
+
+quint64 EnergyRateEstimator::timeToFull(qint64 energy, qint64 energyFull) const
+{
+    if (m_direction != Direction::Charging || m_rate <= 0.0 || energyFull <= energy)
+        return 0;
+    return static_cast<quint64>((energyFull - energy) * 3600.0 / m_rate);
+}
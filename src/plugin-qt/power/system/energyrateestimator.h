@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include <QtGlobal>
+
+// 电池充放电功率估计：对 energy_now 的差分做按时间加权的 EWMA，
+// 偏离当前估计过多的样本视为突发负载并剔除，连续多次偏离才认为负载真的变了。
+// power_now 只在没有历史数据时作为初值，避免瞬时功率导致剩余时间大幅跳动。
+class EnergyRateEstimator
+{
+public:
+    enum class Direction { Discharging, Charging };
+
+    // energy_now 更新粒度较粗，两个样本至少间隔 20s 才计算差分
+    static constexpr qint64 kMinIntervalMs = 20000;
+    // EWMA 时间常数
+    static constexpr qint64 kTimeConstantMs = 600000;
+    // 瞬时速率超出估计值的该倍数（或低于其倒数）视为离群
+    static constexpr double kOutlierRatio = 3.0;
+    static constexpr int kMaxRejects = 3;
+
+    void reset(Direction direction);
+    void addSample(qint64 msecs, qint64 energy, qint64 power);
+
+    Direction direction() const { return m_direction; }
+    // 单位与 sysfs 一致：energy 为 µWh，速率为 µW；0 表示尚无估计
+    double rate() const { return m_rate; }
+    quint64 timeToEmpty(qint64 energy) const;
+    quint64 timeToFull(qint64 energy, qint64 energyFull) const;
+
+private:
+    Direction m_direction = Direction::Discharging;
+    double m_rate = 0.0;
+    bool m_hasAnchor = false;
+    qint64 m_anchorTime = 0;
+    qint64 m_anchorEnergy = 0;
+    int m_rejects = 0;
+};
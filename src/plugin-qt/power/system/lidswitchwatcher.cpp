@@ -0,0 +1,188 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "lidswitchwatcher.h"
+
+#include <QDir>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QSocketNotifier>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+Q_DECLARE_LOGGING_CATEGORY(logPowerSystem)
+
+namespace {
+constexpr size_t kBitsPerLong = sizeof(unsigned long) * 8;
+
+bool testBit(const unsigned long *bits, int bit)
+{
+    return bits[bit / kBitsPerLong] & (1UL << (bit % kBitsPerLong));
+}
+
+bool hasLidSwitch(int fd)
+{
+    unsigned long evBits[EV_MAX / kBitsPerLong + 1] = {};
+    unsigned long swBits[SW_MAX / kBitsPerLong + 1] = {};
+    if (ioctl(fd, EVIOCGBIT(0, sizeof(evBits)), evBits) < 0 || !testBit(evBits, EV_SW))
+        return false;
+    if (ioctl(fd, EVIOCGBIT(EV_SW, sizeof(swBits)), swBits) < 0)
+        return false;
+    return testBit(swBits, SW_LID);
+}
+}
+
+LidSwitchWatcher::LidSwitchWatcher(QObject *parent)
+    : QObject(parent)
+{
+}
+
+LidSwitchWatcher::~LidSwitchWatcher()
+{
+    close();
+}
+
+bool LidSwitchWatcher::open(const QString &inputDir)
+{
+    QDir dir(inputDir);
+    const QStringList entries = dir.entryList({ QStringLiteral("event*") }, QDir::System, QDir::Name);
+    for (const QString &entry : entries) {
+        const QString path = dir.filePath(entry);
+        int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0)
+            continue;
+        if (!hasLidSwitch(fd)) {
+            ::close(fd);
+            continue;
+        }
+        m_devicePath = path;
+        qInfo(logPowerSystem) << "Watching lid switch on" << path;
+        return openFd(fd, true);
+    }
+    return false;
+}
+
+bool LidSwitchWatcher::openFd(int fd, bool isDevice)
+{
+    close();
+    if (fd < 0)
+        return false;
+
+    m_fd = fd;
+    m_isDevice = isDevice;
+    m_partial.clear();
+    m_hasPending = false;
+    m_dropped = false;
+    queryState();
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &LidSwitchWatcher::onReadable);
+    return true;
+}
+
+void LidSwitchWatcher::close()
+{
+    // 可能在 notifier 自身的 activated 中调用，延迟删除
+    if (m_notifier) {
+        m_notifier->setEnabled(false);
+        m_notifier->deleteLater();
+        m_notifier = nullptr;
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+// 读取开关当前状态；测试管道没有 ioctl，保持原值
+bool LidSwitchWatcher::queryState()
+{
+    if (!m_isDevice)
+        return false;
+    unsigned long swState[SW_MAX / kBitsPerLong + 1] = {};
+    if (ioctl(m_fd, EVIOCGSW(sizeof(swState)), swState) < 0)
+        return false;
+    m_closed = testBit(swState, SW_LID);
+    return true;
+}
+
+void LidSwitchWatcher::onReadable()
+{
+    char buf[sizeof(input_event) * 16];
+    for (;;) {
+        ssize_t n = ::read(m_fd, buf, sizeof(buf));
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                qWarning(logPowerSystem) << "Lid switch device read failed:" << strerror(errno);
+                close();
+            }
+            break;
+        }
+        if (n == 0) {
+            // 设备被移除
+            qWarning(logPowerSystem) << "Lid switch device went away";
+            close();
+            break;
+        }
+
+        m_partial.append(buf, static_cast<int>(n));
+        const int whole = m_partial.size() / static_cast<int>(sizeof(input_event));
+        for (int i = 0; i < whole; ++i) {
+            input_event ev;
+            memcpy(&ev, m_partial.constData() + i * sizeof(input_event), sizeof(ev));
+            handleEvent(ev.type, ev.code, ev.value);
+        }
+        m_partial.remove(0, whole * static_cast<int>(sizeof(input_event)));
+
+        if (n < static_cast<ssize_t>(sizeof(buf)))
+            break;
+    }
+}
+
+void LidSwitchWatcher::handleEvent(quint16 type, quint16 code, qint32 value)
+{
+    if (type == EV_SW && code == SW_LID) {
+        if (!m_dropped) {
+            m_pendingClosed = value != 0;
+            m_hasPending = true;
+        }
+        return;
+    }
+
+    if (type != EV_SYN)
+        return;
+
+    if (code == SYN_DROPPED) {
+        // 内核缓冲区溢出，丢弃到下一个 SYN_REPORT 为止的事件，之后重新查询状态
+        m_dropped = true;
+        m_hasPending = false;
+        return;
+    }
+    if (code != SYN_REPORT)
+        return;
+
+    bool closed = m_closed;
+    if (m_dropped) {
+        m_dropped = false;
+        bool old = m_closed;
+        if (!queryState())
+            return;
+        closed = m_closed;
+        m_closed = old;
+    } else if (m_hasPending) {
+        closed = m_pendingClosed;
+        m_hasPending = false;
+    }
+
+    if (closed != m_closed) {
+        m_closed = closed;
+        Q_EMIT lidSwitched(closed);
+    }
+}
@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+#include <QByteArray>
+#include <QObject>
+
+class QSocketNotifier;
+
+// 直接读取带 SW_LID 的 evdev 输入设备，合盖/开盖在 SYN_REPORT 时立即通知，
+// 不必等待 UPower 的 PropertiesChanged 转发
+class LidSwitchWatcher : public QObject {
+    Q_OBJECT
+public:
+    explicit LidSwitchWatcher(QObject *parent = nullptr);
+    ~LidSwitchWatcher() override;
+
+    // 扫描 inputDir 下的 event* 设备，找到第一个支持 SW_LID 的设备并开始监听
+    bool open(const QString &inputDir = QStringLiteral("/dev/input"));
+    // 接管已打开的 evdev fd；isDevice 为 false 时不做 ioctl（测试用管道）
+    bool openFd(int fd, bool isDevice = true);
+    void close();
+
+    bool isOpen() const { return m_fd >= 0; }
+    bool isClosed() const { return m_closed; }
+    QString devicePath() const { return m_devicePath; }
+
+Q_SIGNALS:
+    void lidSwitched(bool closed);
+
+private:
+    void onReadable();
+    void handleEvent(quint16 type, quint16 code, qint32 value);
+    bool queryState();
+
+    int m_fd = -1;
+    bool m_isDevice = false;
+    QString m_devicePath;
+    QSocketNotifier *m_notifier = nullptr;
+    QByteArray m_partial;
+    bool m_closed = false;
+    bool m_pendingClosed = false;
+    bool m_hasPending = false;
+    bool m_dropped = false;
+};
@@ -4,11 +4,16 @@
 
 #include "powermanager.h"
 #include "batterymanager.h"
+#include "cpufreqmanager.h"
+#include "lidswitchwatcher.h"
+#include "powermodecontroller.h"
 #include "systemdbusproxy.h"
 #include "../powerconstants.h"
+#include "../propertieschangednotifier.h"
 
 #include <QDBusConnection>
 #include <QDBusInterface>
+#include <QDBusMessage>
 #include <QDBusReply>
 #include <QVariantMap>
 #include <QProcess>
@@ -40,12 +45,18 @@ bool SystemPowerManager::initialize()
         qWarning(logPowerSystem) << "registerObject failed";
         return false;
     }
+    // 属性变更合并后以 PropertiesChanged 通知客户端，notifier 由 this 持有
+    new PropertiesChangedNotifier(this, kPath, kInterface,
+        [this](const QDBusMessage &msg) { m_conn->send(msg); });
 
     initLidSwitch();
-    initPowerSavingDConfig();
+    // 电源模式的应用依赖 cpufreq 能力探测，需先于 DConfig 加载
     initCpuGovernor();
+    initPowerSavingDConfig();
 
-    auto *battery = new BatteryManager(this, this);
+    auto *battery = new BatteryManager(QStringLiteral("/sys/class/power_supply"), this);
+    connect(battery, &BatteryManager::hasBatteryChanged, this, &SystemPowerManager::updateHasBattery);
+    connect(battery, &BatteryManager::batteryInfoChanged, this, &SystemPowerManager::updateBatteryInfo);
     connect(battery, &BatteryManager::onBatteryChanged, this, [this](bool onBatt) {
         qDebug(logPowerSystem) << "onBatteryChanged:" << onBatt << " prev=" << m_onBattery;
         if (m_onBattery != onBatt) {
@@ -55,9 +66,8 @@ bool SystemPowerManager::initialize()
             updatePowerMode(false);
         }
     });
-    connect(battery, &BatteryManager::batteryChanged, this, [battery]() {
-        battery->probe();
-    });
+    battery->probe();
+    battery->startMonitor();
 
     return true;
 }
@@ -83,10 +93,26 @@ void SystemPowerManager::initLidSwitch()
 
     Q_EMIT hasLidSwitchChanged();
 
+    // 优先直接监听 evdev 的 SW_LID，合盖事件不再经过 UPower 转发
+    m_lidWatcher = new LidSwitchWatcher(this);
+    if (m_lidWatcher->open()) {
+        connect(m_lidWatcher, &LidSwitchWatcher::lidSwitched, this, [this](bool closed) {
+            updateLidClosed(closed);
+            handleLidSwitchEvent(closed);
+        });
+    } else {
+        delete m_lidWatcher;
+        m_lidWatcher = nullptr;
+    }
+
     // 读取初始状态
-    QDBusInterface upower(kUPowerService, kUPowerPath, "org.freedesktop.DBus.Properties",
-                          QDBusConnection::systemBus());
-    if (upower.isValid()) {
+    if (m_lidWatcher) {
+        m_lidClosed = m_lidWatcher->isClosed();
+        Q_EMIT lidClosedChanged();
+        handleLidSwitchEvent(m_lidClosed);
+    } else {
+        QDBusInterface upower(kUPowerService, kUPowerPath, "org.freedesktop.DBus.Properties",
+                              QDBusConnection::systemBus());
         QDBusReply<QVariant> reply = upower.call("Get", kUPowerService, "LidIsClosed");
         if (reply.isValid()) {
             bool closed = reply.value().toBool();
@@ -111,15 +137,24 @@ void SystemPowerManager::onUPowerPropertiesChanged(const QString &interface,
         return;
 
     if (changed.contains("LidIsClosed")) {
+        // evdev 打开期间完全以其为准：快速合盖再开盖后，UPower 迟到的转发
+        // 与当前状态不符，若照常处理会在开盖状态下再次触发合盖动作
+        if (m_lidWatcher && m_lidWatcher->isOpen())
+            return;
         bool closed = changed.value("LidIsClosed").toBool();
-        if (m_lidClosed != closed) {
-            m_lidClosed = closed;
-            Q_EMIT lidClosedChanged();
-        }
+        updateLidClosed(closed);
         handleLidSwitchEvent(closed);
     }
 }
 
+void SystemPowerManager::updateLidClosed(bool closed)
+{
+    if (m_lidClosed != closed) {
+        m_lidClosed = closed;
+        Q_EMIT lidClosedChanged();
+    }
+}
+
 void SystemPowerManager::handleLidSwitchEvent(bool closed)
 {
     qDebug(logPowerSystem) << "handleLidSwitchEvent: closed=" << closed;
@@ -192,36 +227,38 @@ void SystemPowerManager::initPowerSavingDConfig()
 
 void SystemPowerManager::initCpuGovernor()
 {
-    QFile gf("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
-    if (gf.open(QIODevice::ReadOnly)) {
-        QString gov = gf.readAll().trimmed();
-        gf.close();
-        if (!gov.isEmpty())
-            setCpuGovernor(gov);
-    }
+    m_cpuFreq = new CpuFreqManager(kCpuSysfsDir, this);
+    m_modeController = new PowerModeController(m_cpuFreq, kAcpiFirmwareDir, this);
+    m_modeController->probe();
+    connect(m_cpuFreq, &CpuFreqManager::policiesChanged, this, &SystemPowerManager::syncCpuFreqState);
+    m_cpuFreq->probe();
+}
 
-    QFile af("/sys/devices/system/cpu/cpu0/cpufreq/scaling_available_governors");
-    if (af.open(QIODevice::ReadOnly)) {
-        QStringList avail = QString(af.readAll()).split(' ', Qt::SkipEmptyParts);
-        af.close();
-        bool hp = avail.contains("performance") || avail.contains("ondemand");
-        bool ps = avail.contains("powersave") || avail.contains("ondemand");
-        if (m_hpSupported != hp) {
-            m_hpSupported = hp;
-            Q_EMIT isHighPerformanceSupportedChanged();
-        }
+void SystemPowerManager::syncCpuFreqState()
+{
+    // 没有 cpufreq 也没有 platform_profile 的环境（如部分虚拟机）保持默认值，
+    // 模式切换交给 deepin-power-control
+    if (m_cpuFreq->policies().isEmpty() && !m_modeController->hasPlatformProfile())
+        return;
 
-        if (m_psSupported != ps) {
-            m_psSupported = ps;
-            Q_EMIT isPowerSaveSupportedChanged();
-        }
-    }
+    // 各 policy governor 不一致时保留上次的值
+    const QString gov = m_cpuFreq->governor();
+    if (!gov.isEmpty())
+        setCpuGovernor(gov);
 
-    QFile bf("/sys/devices/system/cpu/cpufreq/boost");
-    if (bf.open(QIODevice::ReadOnly)) {
-        setCpuBoost(bf.readAll().trimmed() == "1");
-        bf.close();
+    bool hp = m_modeController->supportsMode("performance");
+    bool ps = m_modeController->supportsMode("powersave");
+    if (m_hpSupported != hp) {
+        m_hpSupported = hp;
+        Q_EMIT isHighPerformanceSupportedChanged();
     }
+    if (m_psSupported != ps) {
+        m_psSupported = ps;
+        Q_EMIT isPowerSaveSupportedChanged();
+    }
+
+    if (m_cpuFreq->hasBoost())
+        setCpuBoost(m_cpuFreq->boost());
 }
 
 void SystemPowerManager::updateHasBattery(bool has)
@@ -308,8 +345,10 @@ void SystemPowerManager::setMode(const QString &v)
         dspc = "balance";
     }
 
-    if (!QProcess::startDetached("/usr/sbin/deepin-power-control", {"set", dspc}))
-        qWarning(logPowerSystem) << "Failed to start deepin-power-control set" << dspc;
+    if (!m_modeController->apply(v)) {
+        qWarning(logPowerSystem) << "setMode: no in-process backend for" << v << ", fallback to deepin-power-control";
+        runPowerControl(dspc);
+    }
 
     setPowerSavingModeEnabled(v == "powersave");
 
@@ -319,14 +358,53 @@ void SystemPowerManager::setMode(const QString &v)
     }
 }
 
+void SystemPowerManager::runPowerControl(const QString &arg)
+{
+    // 外部工具只作为后备：运行中只保留最新一次请求，避免自动切换时反复拉起进程
+    if (m_powerControl && m_powerControl->state() != QProcess::NotRunning) {
+        m_pendingPowerControl = arg;
+        return;
+    }
+
+    if (!m_powerControl) {
+        m_powerControl = new QProcess(this);
+        connect(m_powerControl, &QProcess::finished, this, [this](int exitCode, QProcess::ExitStatus status) {
+            if (status != QProcess::NormalExit || exitCode != 0) {
+                qWarning(logPowerSystem) << "deepin-power-control failed, exit code" << exitCode
+                                         << m_powerControl->readAllStandardError();
+            }
+            if (!m_pendingPowerControl.isEmpty())
+                runPowerControl(std::exchange(m_pendingPowerControl, QString()));
+        });
+        connect(m_powerControl, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+            if (error != QProcess::FailedToStart)
+                return;
+            qWarning(logPowerSystem) << "Failed to start" << kPowerControlPath;
+            m_pendingPowerControl.clear();
+        });
+    }
+    m_powerControl->start(kPowerControlPath, { "set", arg });
+}
+
 void SystemPowerManager::SetCpuGovernor(const QString &gov)
 {
-    setCpuGovernor(gov);
+    CpuFreqManager::Settings settings;
+    settings.governor = gov;
+    if (!m_cpuFreq->apply(settings))
+        qWarning(logPowerSystem) << "SetCpuGovernor failed:" << gov;
 }
 
 void SystemPowerManager::SetCpuBoost(bool on)
 {
-    setCpuBoost(on);
+    CpuFreqManager::Settings settings;
+    settings.boost = on;
+    if (!m_cpuFreq->hasBoost() || !m_cpuFreq->apply(settings))
+        qWarning(logPowerSystem) << "SetCpuBoost failed:" << on;
+}
+
+QString SystemPowerManager::GetCpuPolicies()
+{
+    return m_cpuFreq->toJson();
 }
 
 void SystemPowerManager::LockCpuFreq(const QString &gov, int lockTime)
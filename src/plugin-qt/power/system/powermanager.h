@@ -8,6 +8,11 @@
 #include <QString>
 #include <DConfig>
 
+class CpuFreqManager;
+class LidSwitchWatcher;
+class PowerModeController;
+class QProcess;
+
 class SystemPowerManager : public QObject {
     Q_OBJECT
     Q_CLASSINFO("D-Bus Interface", "org.deepin.dde.Power1")
@@ -90,6 +95,7 @@ public Q_SLOTS:
     void SetCpuGovernor(const QString &gov);
     void SetCpuBoost(bool on);
     void LockCpuFreq(const QString &gov, int lockTime);
+    QString GetCpuPolicies();
 
 Q_SIGNALS:
     void onBatteryChanged();
@@ -116,8 +122,11 @@ Q_SIGNALS:
 
 private:
     void handleLidSwitchEvent(bool closed);
+    void updateLidClosed(bool closed);
     void updatePowerMode(bool init = false);
     void recalcBatteryLow();
+    void syncCpuFreqState();
+    void runPowerControl(const QString &arg);
 
     QDBusConnection *m_conn;
 
@@ -143,4 +152,9 @@ private:
     bool m_hpSupported = true;
     bool m_psSupported = true;
     Dtk::Core::DConfig *m_config = nullptr;
+    CpuFreqManager *m_cpuFreq = nullptr;
+    PowerModeController *m_modeController = nullptr;
+    LidSwitchWatcher *m_lidWatcher = nullptr;
+    QProcess *m_powerControl = nullptr;
+    QString m_pendingPowerControl;
 };
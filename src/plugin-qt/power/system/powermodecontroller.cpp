@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "powermodecontroller.h"
+#include "cpufreqmanager.h"
+
+#include <QFile>
+#include <QLoggingCategory>
+
+#include <functional>
+
+Q_DECLARE_LOGGING_CATEGORY(logPowerSystem)
+
+namespace {
+QString firstSupported(const QStringList &candidates, const std::function<bool(const QString &)> &supported)
+{
+    for (const QString &c : candidates) {
+        if (supported(c))
+            return c;
+    }
+    return {};
+}
+} // namespace
+
+PowerModeController::PowerModeController(CpuFreqManager *cpuFreq, const QString &platformProfileDir,
+                                         QObject *parent)
+    : QObject(parent)
+    , m_cpuFreq(cpuFreq)
+    , m_profileDir(platformProfileDir)
+{
+}
+
+void PowerModeController::probe()
+{
+    QFile choices(m_profileDir + "/platform_profile_choices");
+    m_profileChoices.clear();
+    if (choices.open(QIODevice::ReadOnly))
+        m_profileChoices = QString::fromLatin1(choices.readAll()).split(' ', Qt::SkipEmptyParts);
+    for (QString &c : m_profileChoices)
+        c = c.trimmed();
+
+    QFile profile(m_profileDir + "/platform_profile");
+    m_profile.clear();
+    if (profile.open(QIODevice::ReadOnly))
+        m_profile = QString::fromLatin1(profile.readAll().trimmed());
+}
+
+QString PowerModeController::profileForMode(const QString &mode) const
+{
+    auto supported = [this](const QString &p) { return m_profileChoices.contains(p); };
+    if (mode == "performance")
+        return firstSupported({ "performance" }, supported);
+    if (mode == "powersave")
+        return firstSupported({ "low-power", "quiet", "cool" }, supported);
+    return firstSupported({ "balanced" }, supported);
+}
+
+QString PowerModeController::eppForMode(const QString &mode) const
+{
+    auto supported = [this](const QString &e) { return m_cpuFreq->supportsEpp(e); };
+    if (mode == "performance")
+        return firstSupported({ "performance" }, supported);
+    if (mode == "powersave")
+        return firstSupported({ "power", "balance_power" }, supported);
+    return firstSupported({ "balance_performance", "default" }, supported);
+}
+
+QString PowerModeController::governorForMode(const QString &mode) const
+{
+    auto supported = [this](const QString &g) { return m_cpuFreq->supportsGovernor(g); };
+    // 支持 EPP 的驱动（intel_pstate、amd-pstate-epp）由 EPP 决定能效倾向，
+    // governor 固定为 powersave；performance governor 会锁定 EPP 且禁止修改
+    if (!eppForMode(mode).isEmpty())
+        return firstSupported({ "powersave" }, supported);
+    if (mode == "performance")
+        return firstSupported({ "performance" }, supported);
+    if (mode == "powersave")
+        return firstSupported({ "powersave", "conservative" }, supported);
+    return firstSupported({ "schedutil", "ondemand" }, supported);
+}
+
+bool PowerModeController::supportsMode(const QString &mode) const
+{
+    return !profileForMode(mode).isEmpty() || !eppForMode(mode).isEmpty()
+        || !governorForMode(mode).isEmpty();
+}
+
+bool PowerModeController::writeProfile(const QString &profile)
+{
+    // 不经缓冲直接写入，驱动拒绝的取值由 write() 返回而不是在 close() 时丢失
+    QFile f(m_profileDir + "/platform_profile");
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Unbuffered) || f.write(profile.toLatin1()) != profile.size()) {
+        qWarning(logPowerSystem) << "Failed to set platform_profile to" << profile;
+        return false;
+    }
+    m_profile = profile;
+    return true;
+}
+
+bool PowerModeController::apply(const QString &mode)
+{
+    if (!supportsMode(mode))
+        return false;
+
+    const QString oldProfile = m_profile;
+    const QString profile = profileForMode(mode);
+    if (!profile.isEmpty() && profile != m_profile && !writeProfile(profile))
+        return false;
+
+    CpuFreqManager::Settings settings;
+    settings.governor = governorForMode(mode);
+    settings.epp = eppForMode(mode);
+    if ((!settings.governor.isEmpty() || !settings.epp.isEmpty()) && !m_cpuFreq->apply(settings)) {
+        // CPU 侧失败时恢复 platform_profile，保证模式整体生效或整体不变
+        if (m_profile != oldProfile && !oldProfile.isEmpty())
+            writeProfile(oldProfile);
+        return false;
+    }
+
+    qInfo(logPowerSystem) << "Power mode" << mode << "applied: platform_profile=" << profile
+                          << "governor=" << settings.governor << "epp=" << settings.epp;
+    return true;
+}
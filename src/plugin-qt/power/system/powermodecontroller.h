@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+#include <QObject>
+#include <QStringList>
+
+class CpuFreqManager;
+
+// 把 balance/performance/powersave 三种电源模式映射到 ACPI platform_profile、
+// EPP（intel_pstate/amd-pstate-epp）以及 governor，并在进程内直接写入 sysfs
+class PowerModeController : public QObject {
+    Q_OBJECT
+public:
+    explicit PowerModeController(CpuFreqManager *cpuFreq,
+                                 const QString &platformProfileDir = QStringLiteral("/sys/firmware/acpi"),
+                                 QObject *parent = nullptr);
+
+    void probe();
+    bool supportsMode(const QString &mode) const;
+    bool apply(const QString &mode);
+
+    bool hasPlatformProfile() const { return !m_profileChoices.isEmpty(); }
+    QString platformProfile() const { return m_profile; }
+
+private:
+    QString profileForMode(const QString &mode) const;
+    QString eppForMode(const QString &mode) const;
+    QString governorForMode(const QString &mode) const;
+    bool writeProfile(const QString &profile);
+
+    CpuFreqManager *m_cpuFreq = nullptr;
+    QString m_profileDir;
+    QStringList m_profileChoices;
+    QString m_profile;
+};
@@ -0,0 +1,175 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "system/batterymanager.h"
+
+#include <QDir>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest>
+
+Q_LOGGING_CATEGORY(logPowerSystem, "dde.power.system")
+
+class BatteryManagerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void probeReadsInitialState();
+    void scriptedUeventSequence();
+    void acChangeRefreshesBatteryAfterSettle();
+    void desktopWithoutSuppliesStaysOnAC();
+
+private:
+    void writeAttr(const QString &supply, const QString &attr, const QByteArray &value);
+    void addBattery(const QString &name);
+    void addMains(const QString &name, bool online);
+
+    QScopedPointer<QTemporaryDir> m_root;
+};
+
+void BatteryManagerTest::init()
+{
+    m_root.reset(new QTemporaryDir);
+    QVERIFY(m_root->isValid());
+}
+
+void BatteryManagerTest::writeAttr(const QString &supply, const QString &attr, const QByteArray &value)
+{
+    QDir().mkpath(m_root->filePath(supply));
+    // 截断写入保持 inode 不变，与 sysfs 属性重新生成内容的行为一致
+    QFile file(m_root->filePath(supply + "/" + attr));
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(value + "\n");
+}
+
+void BatteryManagerTest::addBattery(const QString &name)
+{
+    writeAttr(name, "type", "Battery");
+    writeAttr(name, "capacity", "80");
+    writeAttr(name, "status", "Charging");
+    writeAttr(name, "energy_now", "40000000");
+    writeAttr(name, "power_now", "10000000");
+    writeAttr(name, "energy_full", "45000000");
+    writeAttr(name, "energy_full_design", "50000000");
+}
+
+void BatteryManagerTest::addMains(const QString &name, bool online)
+{
+    writeAttr(name, "type", "Mains");
+    writeAttr(name, "online", online ? "1" : "0");
+}
+
+void BatteryManagerTest::probeReadsInitialState()
+{
+    addBattery("BAT0");
+    addMains("AC", false);
+
+    BatteryManager manager(m_root->path());
+    QSignalSpy hasSpy(&manager, &BatteryManager::hasBatteryChanged);
+    QSignalSpy acSpy(&manager, &BatteryManager::onBatteryChanged);
+    QSignalSpy infoSpy(&manager, &BatteryManager::batteryInfoChanged);
+    manager.probe();
+
+    QCOMPARE(hasSpy.count(), 1);
+    QVERIFY(manager.hasBattery());
+    QCOMPARE(acSpy.count(), 1);
+    QVERIFY(manager.onBattery());
+    QCOMPARE(infoSpy.count(), 1);
+    const auto args = infoSpy.takeFirst();
+    QCOMPARE(args[0].toDouble(), 80.0);
+    QCOMPARE(args[1].toUInt(), 1u);
+    QCOMPARE(args[4].toDouble(), 90.0);
+}
+
+void BatteryManagerTest::scriptedUeventSequence()
+{
+    addBattery("BAT0");
+    addMains("AC", true);
+
+    BatteryManager manager(m_root->path());
+    manager.probe();
+    QVERIFY(!manager.onBattery());
+
+    QSignalSpy hasSpy(&manager, &BatteryManager::hasBatteryChanged);
+    QSignalSpy acSpy(&manager, &BatteryManager::onBatteryChanged);
+    QSignalSpy infoSpy(&manager, &BatteryManager::batteryInfoChanged);
+
+    // 拔掉电源
+    writeAttr("AC", "online", "0");
+    manager.handleUevent("change", "AC");
+    QCOMPARE(acSpy.count(), 1);
+    QCOMPARE(acSpy.last()[0].toBool(), true);
+
+    // 电池开始放电，只读取事件对应的设备
+    writeAttr("BAT0", "status", "Discharging");
+    writeAttr("BAT0", "capacity", "79");
+    manager.handleUevent("change", "BAT0");
+    QCOMPARE(infoSpy.count(), 1);
+    QCOMPARE(infoSpy.last()[0].toDouble(), 79.0);
+    QCOMPARE(infoSpy.last()[1].toUInt(), 2u);
+    QCOMPARE(infoSpy.last()[2].toULongLong(), 40000000ull * 3600 / 10000000);
+
+    // 无变化的 change 事件不产生信号
+    manager.handleUevent("change", "BAT0");
+    QCOMPARE(infoSpy.count(), 1);
+
+    // 未知设备的事件被忽略
+    manager.handleUevent("change", "hidpp_battery_0");
+    QCOMPARE(infoSpy.count(), 1);
+
+    // 移除电池后再插入一块新电池
+    QVERIFY(QDir(m_root->filePath("BAT0")).removeRecursively());
+    manager.handleUevent("remove", "BAT0");
+    QCOMPARE(hasSpy.count(), 1);
+    QVERIFY(!manager.hasBattery());
+
+    addBattery("BAT1");
+    manager.handleUevent("add", "BAT1");
+    QCOMPARE(hasSpy.count(), 2);
+    QVERIFY(manager.hasBattery());
+    QCOMPARE(infoSpy.last()[1].toUInt(), 1u);
+
+    // 接回电源
+    writeAttr("AC", "online", "1");
+    manager.handleUevent("change", "AC");
+    QCOMPARE(acSpy.count(), 2);
+    QCOMPARE(acSpy.last()[0].toBool(), false);
+}
+
+void BatteryManagerTest::acChangeRefreshesBatteryAfterSettle()
+{
+    addBattery("BAT0");
+    addMains("AC", true);
+
+    BatteryManager manager(m_root->path());
+    manager.probe();
+
+    QSignalSpy infoSpy(&manager, &BatteryManager::batteryInfoChanged);
+    writeAttr("AC", "online", "0");
+    manager.handleUevent("change", "AC");
+    QCOMPARE(infoSpy.count(), 0);
+
+    // 电池驱动稍后才更新状态，且没有发出 uevent
+    writeAttr("BAT0", "status", "Discharging");
+    QTRY_COMPARE_WITH_TIMEOUT(infoSpy.count(), 1, 3000);
+    QCOMPARE(infoSpy.last()[1].toUInt(), 2u);
+}
+
+void BatteryManagerTest::desktopWithoutSuppliesStaysOnAC()
+{
+    BatteryManager manager(m_root->path());
+    QSignalSpy hasSpy(&manager, &BatteryManager::hasBatteryChanged);
+    QSignalSpy acSpy(&manager, &BatteryManager::onBatteryChanged);
+    manager.probe();
+
+    QVERIFY(!manager.hasBattery());
+    QVERIFY(!manager.onBattery());
+    QCOMPARE(hasSpy.count(), 0);
+    QCOMPARE(acSpy.count(), 0);
+}
+
+QTEST_GUILESS_MAIN(BatteryManagerTest)
+
+#include "tst_batterymanager.moc"
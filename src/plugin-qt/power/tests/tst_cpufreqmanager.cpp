@@ -0,0 +1,239 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "system/cpufreqmanager.h"
+
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest>
+
+Q_LOGGING_CATEGORY(logPowerSystem, "dde.power.system")
+
+class CpuFreqManagerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void enumeratesHybridPolicies();
+    void offlinePolicyIsSkipped();
+    void appliesAcrossAllPolicies();
+    void rejectsUnsupportedGovernor();
+    void rollsBackOnPartialFailure();
+    void rollsBackOnRejectedWrite();
+    void perPolicyBoost();
+    void exportsJson();
+
+private:
+    void writeAttr(const QString &rel, const QByteArray &value);
+    QByteArray readAttr(const QString &rel) const;
+    // 模拟 P 核 policy0(cpu0-3) 与 E 核 policy4(cpu4-7) 的 intel_pstate 布局
+    void addHybridLayout();
+
+    QScopedPointer<QTemporaryDir> m_root;
+};
+
+void CpuFreqManagerTest::init()
+{
+    m_root.reset(new QTemporaryDir);
+    QVERIFY(m_root->isValid());
+}
+
+void CpuFreqManagerTest::writeAttr(const QString &rel, const QByteArray &value)
+{
+    const QString path = m_root->filePath(rel);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile f(path);
+    QVERIFY(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    f.write(value + "\n");
+}
+
+QByteArray CpuFreqManagerTest::readAttr(const QString &rel) const
+{
+    QFile f(m_root->filePath(rel));
+    if (!f.open(QIODevice::ReadOnly))
+        return {};
+    return f.readAll().trimmed();
+}
+
+void CpuFreqManagerTest::addHybridLayout()
+{
+    const QByteArray epps = "default performance balance_performance balance_power power";
+    writeAttr("cpufreq/policy0/affected_cpus", "0 1 2 3");
+    writeAttr("cpufreq/policy0/scaling_available_governors", "performance powersave");
+    writeAttr("cpufreq/policy0/scaling_governor", "powersave");
+    writeAttr("cpufreq/policy0/energy_performance_available_preferences", epps);
+    writeAttr("cpufreq/policy0/energy_performance_preference", "balance_performance");
+
+    writeAttr("cpufreq/policy4/affected_cpus", "4 5 6 7");
+    writeAttr("cpufreq/policy4/scaling_available_governors", "performance powersave");
+    writeAttr("cpufreq/policy4/scaling_governor", "powersave");
+    writeAttr("cpufreq/policy4/energy_performance_available_preferences", epps);
+    writeAttr("cpufreq/policy4/energy_performance_preference", "balance_power");
+
+    writeAttr("cpufreq/boost", "1");
+}
+
+void CpuFreqManagerTest::enumeratesHybridPolicies()
+{
+    addHybridLayout();
+    CpuFreqManager manager(m_root->path());
+    QSignalSpy spy(&manager, &CpuFreqManager::policiesChanged);
+    manager.probe();
+
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(manager.policies().size(), 2);
+    QCOMPARE(manager.policies().at(0).name, QStringLiteral("policy0"));
+    QCOMPARE(manager.policies().at(1).cpus, QList<int>({ 4, 5, 6, 7 }));
+    QCOMPARE(manager.governor(), QStringLiteral("powersave"));
+    // EPP 各 policy 不一致，报告为混合状态
+    QVERIFY(manager.epp().isEmpty());
+    QVERIFY(manager.supportsGovernor("performance"));
+    QVERIFY(!manager.supportsGovernor("schedutil"));
+    QVERIFY(manager.supportsEpp("power"));
+    QVERIFY(manager.hasBoost());
+    QVERIFY(manager.boost());
+}
+
+void CpuFreqManagerTest::offlinePolicyIsSkipped()
+{
+    addHybridLayout();
+    // policy8 的 CPU 全部离线，且只支持 schedutil
+    writeAttr("cpufreq/policy8/affected_cpus", "");
+    writeAttr("cpufreq/policy8/scaling_available_governors", "schedutil");
+    writeAttr("cpufreq/policy8/scaling_governor", "schedutil");
+
+    CpuFreqManager manager(m_root->path());
+    manager.probe();
+    QCOMPARE(manager.policies().size(), 3);
+    QVERIFY(!manager.policies().at(2).isOnline());
+    QCOMPARE(manager.governor(), QStringLiteral("powersave"));
+
+    CpuFreqManager::Settings settings;
+    settings.governor = "performance";
+    QVERIFY(manager.apply(settings));
+    QCOMPARE(readAttr("cpufreq/policy8/scaling_governor"), QByteArray("schedutil"));
+    QCOMPARE(manager.governor(), QStringLiteral("performance"));
+}
+
+void CpuFreqManagerTest::appliesAcrossAllPolicies()
+{
+    addHybridLayout();
+    CpuFreqManager manager(m_root->path());
+    manager.probe();
+
+    CpuFreqManager::Settings settings;
+    settings.governor = "powersave";
+    settings.epp = "power";
+    settings.boost = false;
+    QVERIFY(manager.apply(settings));
+
+    QCOMPARE(readAttr("cpufreq/policy0/energy_performance_preference"), QByteArray("power"));
+    QCOMPARE(readAttr("cpufreq/policy4/energy_performance_preference"), QByteArray("power"));
+    QCOMPARE(readAttr("cpufreq/boost"), QByteArray("0"));
+    QCOMPARE(manager.epp(), QStringLiteral("power"));
+    QVERIFY(!manager.boost());
+}
+
+void CpuFreqManagerTest::rejectsUnsupportedGovernor()
+{
+    addHybridLayout();
+    writeAttr("cpufreq/policy4/scaling_available_governors", "powersave");
+    CpuFreqManager manager(m_root->path());
+    manager.probe();
+
+    CpuFreqManager::Settings settings;
+    settings.governor = "performance";
+    QVERIFY(!manager.apply(settings));
+    // 校验失败时不写任何 policy
+    QCOMPARE(readAttr("cpufreq/policy0/scaling_governor"), QByteArray("powersave"));
+}
+
+void CpuFreqManagerTest::rollsBackOnPartialFailure()
+{
+    addHybridLayout();
+    // 把 policy4 的 EPP 属性替换成目录，写入必然失败（即使以 root 运行）
+    const QString epp4 = m_root->filePath("cpufreq/policy4/energy_performance_preference");
+    QVERIFY(QFile::remove(epp4));
+    QVERIFY(QDir().mkpath(epp4));
+
+    CpuFreqManager manager(m_root->path());
+    manager.probe();
+    QVERIFY(manager.policies().at(1).epp.isEmpty());
+
+    CpuFreqManager::Settings settings;
+    settings.governor = "performance";
+    settings.epp = "performance";
+    QVERIFY(!manager.apply(settings));
+
+    // 已写入的 governor 和 policy0 的 EPP 全部回滚
+    QCOMPARE(readAttr("cpufreq/policy0/scaling_governor"), QByteArray("powersave"));
+    QCOMPARE(readAttr("cpufreq/policy4/scaling_governor"), QByteArray("powersave"));
+    QCOMPARE(readAttr("cpufreq/policy0/energy_performance_preference"), QByteArray("balance_performance"));
+    QCOMPARE(manager.governor(), QStringLiteral("powersave"));
+}
+
+void CpuFreqManagerTest::rollsBackOnRejectedWrite()
+{
+    addHybridLayout();
+    // 指向只接受整数的 oom_score_adj：open 成功，write 返回 EINVAL，与 sysfs 拒绝取值相同
+    const QString epp4 = m_root->filePath("cpufreq/policy4/energy_performance_preference");
+    QVERIFY(QFile::remove(epp4));
+    QVERIFY(QFile::link("/proc/self/oom_score_adj", epp4));
+
+    CpuFreqManager manager(m_root->path());
+    manager.probe();
+    QVERIFY(manager.policies().at(1).hasEpp());
+
+    CpuFreqManager::Settings settings;
+    settings.governor = "performance";
+    settings.epp = "performance";
+    QVERIFY(!manager.apply(settings));
+
+    QCOMPARE(readAttr("cpufreq/policy0/scaling_governor"), QByteArray("powersave"));
+    QCOMPARE(readAttr("cpufreq/policy4/scaling_governor"), QByteArray("powersave"));
+    QCOMPARE(readAttr("cpufreq/policy0/energy_performance_preference"), QByteArray("balance_performance"));
+}
+
+void CpuFreqManagerTest::perPolicyBoost()
+{
+    addHybridLayout();
+    QVERIFY(QFile::remove(m_root->filePath("cpufreq/boost")));
+    writeAttr("cpufreq/policy0/boost", "1");
+    writeAttr("cpufreq/policy4/boost", "1");
+
+    CpuFreqManager manager(m_root->path());
+    manager.probe();
+    QVERIFY(manager.hasBoost());
+    QVERIFY(manager.boost());
+
+    CpuFreqManager::Settings settings;
+    settings.boost = false;
+    QVERIFY(manager.apply(settings));
+    QCOMPARE(readAttr("cpufreq/policy0/boost"), QByteArray("0"));
+    QCOMPARE(readAttr("cpufreq/policy4/boost"), QByteArray("0"));
+    QVERIFY(!manager.boost());
+}
+
+void CpuFreqManagerTest::exportsJson()
+{
+    addHybridLayout();
+    CpuFreqManager manager(m_root->path());
+    manager.probe();
+
+    const QJsonArray array = QJsonDocument::fromJson(manager.toJson().toUtf8()).array();
+    QCOMPARE(array.size(), 2);
+    const QJsonObject p4 = array.at(1).toObject();
+    QCOMPARE(p4.value("Name").toString(), QStringLiteral("policy4"));
+    QCOMPARE(p4.value("EnergyPerformancePreference").toString(), QStringLiteral("balance_power"));
+    QCOMPARE(p4.value("Cpus").toArray().size(), 4);
+    QVERIFY(p4.value("Online").toBool());
+}
+
+QTEST_GUILESS_MAIN(CpuFreqManagerTest)
+
+#include "tst_cpufreqmanager.moc"
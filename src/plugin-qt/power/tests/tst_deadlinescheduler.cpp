@@ -0,0 +1,151 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "session/deadlinescheduler.h"
+
+#include <QtTest>
+
+Q_LOGGING_CATEGORY(logPowerSession, "dde.power.session")
+
+class DeadlineSchedulerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void runsInDeadlineOrder();
+    void batchesWithinTolerance();
+    void clearDropsPendingAndReusesTimer();
+    void taskMayClearOrReschedule();
+    void firesFromEventLoop();
+
+private:
+    void schedule(DeadlineScheduler &s, qint64 delay, const QString &name);
+
+    qint64 m_now = 0;
+    QStringList m_ran;
+};
+
+void DeadlineSchedulerTest::init()
+{
+    m_now = 0;
+    m_ran.clear();
+}
+
+void DeadlineSchedulerTest::schedule(DeadlineScheduler &s, qint64 delay, const QString &name)
+{
+    s.schedule(delay, [this, name]() { m_ran.append(name); }, name);
+}
+
+void DeadlineSchedulerTest::runsInDeadlineOrder()
+{
+    DeadlineScheduler s;
+    s.setClock([this]() { return m_now; });
+    s.setTolerance(0);
+
+    schedule(s, 5000, "sleep");
+    schedule(s, 1, "screenSaverStart");
+    schedule(s, 3000, "lock");
+    schedule(s, 3000, "screenBlack");
+    QCOMPARE(s.pendingCount(), 4);
+    QCOMPARE(s.nextDeadline(), qint64(1));
+    QVERIFY(s.isArmed());
+
+    m_now = 1;
+    s.runDue();
+    QCOMPARE(m_ran, QStringList({ "screenSaverStart" }));
+    QCOMPARE(s.nextDeadline(), qint64(3000));
+
+    // 截止时间相同的任务按加入顺序执行
+    m_now = 3000;
+    s.runDue();
+    QCOMPARE(m_ran, QStringList({ "screenSaverStart", "lock", "screenBlack" }));
+
+    m_now = 4999;
+    s.runDue();
+    QCOMPARE(m_ran.size(), 3);
+
+    m_now = 5000;
+    s.runDue();
+    QCOMPARE(m_ran.last(), QStringLiteral("sleep"));
+    QCOMPARE(s.pendingCount(), 0);
+    QCOMPARE(s.nextDeadline(), qint64(-1));
+    QVERIFY(!s.isArmed());
+}
+
+void DeadlineSchedulerTest::batchesWithinTolerance()
+{
+    DeadlineScheduler s;
+    s.setClock([this]() { return m_now; });
+    s.setTolerance(500);
+
+    schedule(s, 1000, "a");
+    schedule(s, 1400, "b");
+    schedule(s, 1600, "c");
+
+    m_now = 1000;
+    s.runDue();
+    QCOMPARE(m_ran, QStringList({ "a", "b" }));
+    QCOMPARE(s.nextDeadline(), qint64(1600));
+}
+
+void DeadlineSchedulerTest::clearDropsPendingAndReusesTimer()
+{
+    DeadlineScheduler s;
+    s.setClock([this]() { return m_now; });
+    const int timersBefore = s.findChildren<QTimer *>().size();
+
+    // 模拟频繁的 idle on/off
+    for (int i = 0; i < 100; ++i) {
+        schedule(s, 1000, "lock");
+        schedule(s, 2000, "screenBlack");
+        s.clear();
+    }
+    QCOMPARE(s.pendingCount(), 0);
+    QVERIFY(!s.isArmed());
+    QCOMPARE(s.findChildren<QTimer *>().size(), timersBefore);
+
+    m_now = 10000;
+    s.runDue();
+    QVERIFY(m_ran.isEmpty());
+}
+
+void DeadlineSchedulerTest::taskMayClearOrReschedule()
+{
+    DeadlineScheduler s;
+    s.setClock([this]() { return m_now; });
+    s.setTolerance(1000);
+
+    s.schedule(100, [&]() {
+        m_ran.append("idleOff");
+        s.clear();
+    });
+    schedule(s, 200, "lock");
+    m_now = 100;
+    s.runDue();
+    QCOMPARE(m_ran, QStringList({ "idleOff" }));
+    QCOMPARE(s.pendingCount(), 0);
+
+    m_ran.clear();
+    s.schedule(0, [&]() {
+        m_ran.append("first");
+        schedule(s, 5000, "second");
+    });
+    s.runDue();
+    QCOMPARE(m_ran, QStringList({ "first" }));
+    QCOMPARE(s.nextDeadline(), m_now + 5000);
+    QVERIFY(s.isArmed());
+}
+
+void DeadlineSchedulerTest::firesFromEventLoop()
+{
+    DeadlineScheduler s;
+    schedule(s, 10, "a");
+    schedule(s, 20, "b");
+    QTRY_COMPARE(m_ran, QStringList({ "a", "b" }));
+    QVERIFY(!s.isArmed());
+}
+
+QTEST_GUILESS_MAIN(DeadlineSchedulerTest)
+
+#include "tst_deadlinescheduler.moc"
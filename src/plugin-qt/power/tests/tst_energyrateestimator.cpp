@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "session/warnlevelpolicy.h"
+#include "system/energyrateestimator.h"
+
+#include <QFile>
+#include <QtTest>
+
+class EnergyRateEstimatorTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void replayDischarge_data();
+    void replayDischarge();
+    void rejectsBurst();
+    void chargingTimeToFull();
+    void percentageHysteresis();
+
+private:
+    struct Sample {
+        qint64 secs;
+        qint64 energy;
+        qint64 power;
+        qint64 energyFull;
+    };
+    static QVector<Sample> loadTrace(const QString &path);
+};
+
+// 记录格式：秒,energy_now(µWh),power_now(µW),energy_full(µWh)；轨迹一直放电到 0
+QVector<EnergyRateEstimatorTest::Sample> EnergyRateEstimatorTest::loadTrace(const QString &path)
+{
+    QVector<Sample> samples;
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
+        return samples;
+    while (!f.atEnd()) {
+        const QByteArray line = f.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+        const QList<QByteArray> cols = line.split(',');
+        if (cols.size() != 4)
+            continue;
+        samples.append({ cols[0].toLongLong(), cols[1].toLongLong(), cols[2].toLongLong(), cols[3].toLongLong() });
+    }
+    return samples;
+}
+
+void EnergyRateEstimatorTest::replayDischarge_data()
+{
+    QTest::addColumn<QString>("trace");
+    QTest::addColumn<double>("maxMeanError");
+
+    QTest::newRow("office") << QFINDTESTDATA("data/discharge-office.csv") << 0.25;
+    QTest::newRow("build") << QFINDTESTDATA("data/discharge-build.csv") << 0.20;
+    QTest::newRow("video") << QFINDTESTDATA("data/discharge-video.csv") << 0.10;
+}
+
+void EnergyRateEstimatorTest::replayDischarge()
+{
+    QFETCH(QString, trace);
+    QFETCH(double, maxMeanError);
+
+    const QVector<Sample> samples = loadTrace(trace);
+    QVERIFY(samples.size() > 60);
+    const qint64 emptyAt = samples.last().secs;
+
+    WarnLevelPolicy::Thresholds thresholds;
+    thresholds.usePercentage = false;
+    thresholds.timeLow = 1200;
+    thresholds.timeDanger = 900;
+    thresholds.timeCritical = 600;
+    thresholds.timeAction = 300;
+    WarnLevelPolicy smoothed;
+    smoothed.setThresholds(thresholds);
+    // 对照组：直接用 power_now 计算剩余时间，不带回差
+    WarnLevelPolicy naive;
+    naive.setThresholds(thresholds);
+
+    EnergyRateEstimator estimator;
+    estimator.reset(EnergyRateEstimator::Direction::Discharging);
+
+    double smoothedError = 0.0, naiveError = 0.0;
+    int scored = 0, transitions = 0, naiveTransitions = 0;
+    uint level = WarnLevelPolicy::None;
+    uint naiveLevel = WarnLevelPolicy::None;
+    for (const Sample &s : samples) {
+        estimator.addSample(s.secs * 1000, s.energy, s.power);
+        const quint64 tte = estimator.timeToEmpty(s.energy);
+        const quint64 naiveTte = s.power > 0 ? static_cast<quint64>(s.energy) * 3600 / s.power : 0;
+
+        // 前 10 分钟为预热期，最后 10 分钟真实值过小，不计入误差
+        const qint64 truth = emptyAt - s.secs;
+        if (s.secs >= 600 && truth >= 600) {
+            smoothedError += qAbs(static_cast<double>(tte) - truth) / truth;
+            naiveError += qAbs(static_cast<double>(naiveTte) - truth) / truth;
+            ++scored;
+        }
+
+        const uint next = smoothed.update(0, tte);
+        if (next != level) {
+            // 放电过程中等级只应单调加重
+            QVERIFY2(next > level, qPrintable(QString("level dropped %1 -> %2 at %3s").arg(level).arg(next).arg(s.secs)));
+            ++transitions;
+            level = next;
+        }
+        const uint raw = naive.rawLevel(0, naiveTte);
+        if (raw != naiveLevel) {
+            ++naiveTransitions;
+            naiveLevel = raw;
+        }
+    }
+
+    QVERIFY(scored > 0);
+    smoothedError /= scored;
+    naiveError /= scored;
+    qInfo("mean relative error: smoothed %.3f, power_now %.3f; transitions %d vs %d",
+          smoothedError, naiveError, transitions, naiveTransitions);
+
+    QVERIFY(smoothedError < maxMeanError);
+    QVERIFY(smoothedError < naiveError);
+    QCOMPARE(level, uint(WarnLevelPolicy::Action));
+    QVERIFY(transitions <= 4);
+    QVERIFY(transitions < naiveTransitions);
+}
+
+void EnergyRateEstimatorTest::rejectsBurst()
+{
+    EnergyRateEstimator estimator;
+    estimator.reset(EnergyRateEstimator::Direction::Discharging);
+
+    // 10W 稳定放电，每分钟消耗约 166667 µWh
+    qint64 energy = 40000000;
+    const qint64 perMinute = 10000000 / 60;
+    estimator.addSample(0, energy, 10000000);
+    for (int i = 1; i <= 10; ++i)
+        estimator.addSample(i * 60000, energy -= perMinute, 10000000);
+    QVERIFY(qAbs(estimator.rate() - 10000000.0) < 100000.0);
+
+    // 单个 1 分钟的 60W 突发被剔除，估计值不变
+    estimator.addSample(11 * 60000, energy -= perMinute * 6, 60000000);
+    QVERIFY(qAbs(estimator.rate() - 10000000.0) < 100000.0);
+
+    // 持续的高负载在连续几次偏离后被接受
+    for (int i = 12; i <= 40; ++i)
+        estimator.addSample(i * 60000, energy -= perMinute * 4, 40000000);
+    QVERIFY(estimator.rate() > 25000000.0);
+
+    // 间隔过短的样本不参与计算
+    const double rate = estimator.rate();
+    estimator.addSample(40 * 60000 + 5000, energy - perMinute * 10, 0);
+    QCOMPARE(estimator.rate(), rate);
+}
+
+void EnergyRateEstimatorTest::chargingTimeToFull()
+{
+    EnergyRateEstimator estimator;
+    estimator.reset(EnergyRateEstimator::Direction::Charging);
+    QCOMPARE(estimator.timeToFull(20000000, 50000000), quint64(0));
+
+    // 以 30W 充电
+    qint64 energy = 20000000;
+    estimator.addSample(0, energy, 30000000);
+    for (int i = 1; i <= 5; ++i)
+        estimator.addSample(i * 60000, energy += 500000, 30000000);
+
+    QCOMPARE(estimator.timeToEmpty(energy), quint64(0));
+    const quint64 ttf = estimator.timeToFull(energy, 50000000);
+    QVERIFY(ttf > 3240 && ttf < 3360); // 27.5Wh / 30W ≈ 3300s
+
+    estimator.reset(EnergyRateEstimator::Direction::Discharging);
+    QCOMPARE(estimator.rate(), 0.0);
+}
+
+void EnergyRateEstimatorTest::percentageHysteresis()
+{
+    WarnLevelPolicy policy;
+    WarnLevelPolicy::Thresholds thresholds;
+    thresholds.notifyPercentage = 25;
+    policy.setThresholds(thresholds);
+
+    int transitions = 0;
+    uint level = policy.level();
+    const QList<double> trace = { 22, 21, 20, 21, 20, 21, 20, 19, 20, 21, 22, 23 };
+    for (double pct : trace) {
+        if (policy.update(pct, 0) != level) {
+            level = policy.level();
+            ++transitions;
+        }
+    }
+    // 22 -> Remind, 20 -> Low；在 19~22 之间抖动不再回到 Remind，直到 23%
+    QCOMPARE(transitions, 3);
+    QCOMPARE(level, uint(WarnLevelPolicy::Remind));
+
+    // 未知数据保持当前等级
+    QCOMPARE(policy.update(0, 0), uint(WarnLevelPolicy::Remind));
+}
+
+QTEST_GUILESS_MAIN(EnergyRateEstimatorTest)
+
+#include "tst_energyrateestimator.moc"
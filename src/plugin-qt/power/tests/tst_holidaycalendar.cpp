@@ -0,0 +1,224 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "session/holidaycalendar.h"
+
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest>
+
+Q_LOGGING_CATEGORY(logPowerSession, "dde.power.session")
+
+// 模拟日历服务：记录每次远程调用，回复由测试控制何时送达
+class FakeCalendarService
+{
+public:
+    struct Request {
+        int year;
+        int month;
+        HolidayCalendar::Reply reply;
+    };
+
+    HolidayCalendar::FetchFunc fetchFunc()
+    {
+        return [this](int year, int month, const HolidayCalendar::Reply &reply) {
+            ++calls;
+            pending.append({ year, month, reply });
+        };
+    }
+
+    // 2026 年 10 月：1-7 日放假，10 日(周六)调休上班
+    static QString monthJson(int year, int month)
+    {
+        if (year != 2026 || month != 10)
+            return QStringLiteral("[{\"List\":[]}]");
+        return QStringLiteral("[{\"List\":["
+                              "{\"Date\":\"2026-10-1\",\"Status\":1},"
+                              "{\"Date\":\"2026-10-2\",\"Status\":1},"
+                              "{\"Date\":\"2026-10-05\",\"Status\":1},"
+                              "{\"Date\":\"2026-10-6\",\"Status\":1},"
+                              "{\"Date\":\"2026-10-7\",\"Status\":1},"
+                              "{\"Date\":\"2026-10-10\",\"Status\":2}]}]");
+    }
+
+    void replyAll()
+    {
+        const auto requests = std::exchange(pending, {});
+        for (const auto &req : requests)
+            req.reply(monthJson(req.year, req.month));
+    }
+
+    int calls = 0;
+    QList<Request> pending;
+};
+
+class HolidayCalendarTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void weekdayFallbackBeforeFetch();
+    void bulkPrefetchFillsCache();
+    void freshCacheSkipsRemoteCalls();
+    void invalidateRefetches();
+    void staleRepliesAreDropped();
+    void failedMonthIsRetried();
+    void persistedAcrossRestart();
+    void nextWorkdayIsPureLookup();
+
+private:
+    QString cachePath() const { return m_dir->filePath("holidays.json"); }
+
+    QScopedPointer<QTemporaryDir> m_dir;
+    const QDate m_today { 2026, 9, 1 };
+};
+
+void HolidayCalendarTest::init()
+{
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+}
+
+void HolidayCalendarTest::weekdayFallbackBeforeFetch()
+{
+    FakeCalendarService service;
+    HolidayCalendar calendar(service.fetchFunc(), cachePath());
+
+    QVERIFY(calendar.isWorkday(QDate(2026, 10, 1)));   // 周四
+    QVERIFY(!calendar.isWorkday(QDate(2026, 10, 10))); // 周六
+    QCOMPARE(service.calls, 0);
+}
+
+void HolidayCalendarTest::bulkPrefetchFillsCache()
+{
+    FakeCalendarService service;
+    HolidayCalendar calendar(service.fetchFunc(), cachePath());
+    QSignalSpy spy(&calendar, &HolidayCalendar::updated);
+
+    calendar.prefetch(m_today);
+    QCOMPARE(service.calls, HolidayCalendar::kPrefetchMonths);
+    QVERIFY(calendar.hasPending());
+
+    // 请求未返回前重复 prefetch 不会再次发起
+    calendar.prefetch(m_today);
+    QCOMPARE(service.calls, HolidayCalendar::kPrefetchMonths);
+
+    service.replyAll();
+    QVERIFY(!calendar.hasPending());
+    QCOMPARE(spy.count(), 1);
+
+    QVERIFY(!calendar.isWorkday(QDate(2026, 10, 1)));
+    QVERIFY(!calendar.isWorkday(QDate(2026, 10, 5)));
+    QVERIFY(calendar.isWorkday(QDate(2026, 10, 8)));
+    QVERIFY(calendar.isWorkday(QDate(2026, 10, 10)));
+    QVERIFY(!calendar.isWorkday(QDate(2026, 10, 11)));
+}
+
+void HolidayCalendarTest::freshCacheSkipsRemoteCalls()
+{
+    FakeCalendarService service;
+    HolidayCalendar calendar(service.fetchFunc(), cachePath());
+    calendar.prefetch(m_today);
+    service.replyAll();
+    QCOMPARE(service.calls, HolidayCalendar::kPrefetchMonths);
+
+    calendar.prefetch(m_today.addDays(HolidayCalendar::kRefreshDays - 1));
+    QCOMPARE(service.calls, HolidayCalendar::kPrefetchMonths);
+
+    // 缓存过期后重新拉取
+    calendar.prefetch(m_today.addDays(HolidayCalendar::kRefreshDays));
+    QCOMPARE(service.calls, 2 * HolidayCalendar::kPrefetchMonths);
+}
+
+void HolidayCalendarTest::invalidateRefetches()
+{
+    FakeCalendarService service;
+    HolidayCalendar calendar(service.fetchFunc(), cachePath());
+    calendar.prefetch(m_today);
+    service.replyAll();
+
+    calendar.invalidate();
+    // 失效后旧数据仍可查询
+    QVERIFY(!calendar.isWorkday(QDate(2026, 10, 1)));
+
+    calendar.prefetch(m_today);
+    QCOMPARE(service.calls, 2 * HolidayCalendar::kPrefetchMonths);
+}
+
+void HolidayCalendarTest::staleRepliesAreDropped()
+{
+    FakeCalendarService service;
+    HolidayCalendar calendar(service.fetchFunc(), cachePath());
+    QSignalSpy spy(&calendar, &HolidayCalendar::updated);
+
+    calendar.prefetch(m_today);
+    const auto stale = std::exchange(service.pending, {});
+    calendar.invalidate();
+    QVERIFY(!calendar.hasPending());
+
+    for (const auto &req : stale)
+        req.reply(FakeCalendarService::monthJson(req.year, req.month));
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(calendar.isWorkday(QDate(2026, 10, 1)));
+}
+
+void HolidayCalendarTest::failedMonthIsRetried()
+{
+    FakeCalendarService service;
+    HolidayCalendar calendar(service.fetchFunc(), cachePath());
+
+    calendar.prefetch(m_today, 2);
+    QCOMPARE(service.calls, 2);
+    service.pending.takeFirst().reply(QString());
+    service.replyAll();
+
+    // 只有失败的九月需要重新拉取
+    calendar.prefetch(m_today, 2);
+    QCOMPARE(service.calls, 3);
+    QCOMPARE(service.pending.first().month, 9);
+}
+
+void HolidayCalendarTest::persistedAcrossRestart()
+{
+    {
+        FakeCalendarService service;
+        HolidayCalendar calendar(service.fetchFunc(), cachePath());
+        calendar.prefetch(m_today);
+        service.replyAll();
+    }
+    QVERIFY(QFile::exists(cachePath()));
+
+    FakeCalendarService service;
+    HolidayCalendar calendar(service.fetchFunc(), cachePath());
+    QVERIFY(!calendar.isWorkday(QDate(2026, 10, 2)));
+    QVERIFY(calendar.isWorkday(QDate(2026, 10, 10)));
+
+    calendar.prefetch(m_today.addDays(1));
+    QCOMPARE(service.calls, 0);
+}
+
+void HolidayCalendarTest::nextWorkdayIsPureLookup()
+{
+    FakeCalendarService service;
+    HolidayCalendar calendar(service.fetchFunc(), cachePath());
+    calendar.prefetch(m_today);
+    service.replyAll();
+    const int calls = service.calls;
+
+    // 与 getNextShutdownTime 相同的查找：国庆假期后的第一个工作日
+    QDate date(2026, 10, 1);
+    int i = 0;
+    for (; i < 366 && !calendar.isWorkday(date); ++i)
+        date = date.addDays(1);
+    QCOMPARE(date, QDate(2026, 10, 8));
+
+    // 一整年的逐日查询不产生任何远程调用
+    for (QDate d = m_today; d < m_today.addDays(366); d = d.addDays(1))
+        calendar.isWorkday(d);
+    QCOMPARE(service.calls, calls);
+}
+
+QTEST_GUILESS_MAIN(HolidayCalendarTest)
+
+#include "tst_holidaycalendar.moc"
@@ -0,0 +1,167 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "system/lidswitchwatcher.h"
+
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <fcntl.h>
+#include <linux/input.h>
+#include <unistd.h>
+
+Q_LOGGING_CATEGORY(logPowerSystem, "dde.power.system")
+
+class LidSwitchWatcherTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void emitsOnSynReport();
+    void ignoresRepeatedState();
+    void reassemblesSplitEvents();
+    void discardsAfterSynDropped();
+    void closesWhenDeviceGoesAway();
+    void openWithoutLidDevice();
+
+private:
+    static QByteArray event(quint16 type, quint16 code, qint32 value);
+    static QByteArray lid(bool closed);
+    void send(const QByteArray &data);
+
+    int m_writeFd = -1;
+    LidSwitchWatcher *m_watcher = nullptr;
+};
+
+QByteArray LidSwitchWatcherTest::event(quint16 type, quint16 code, qint32 value)
+{
+    input_event ev {};
+    ev.type = type;
+    ev.code = code;
+    ev.value = value;
+    return QByteArray(reinterpret_cast<const char *>(&ev), sizeof(ev));
+}
+
+QByteArray LidSwitchWatcherTest::lid(bool closed)
+{
+    return event(EV_SW, SW_LID, closed ? 1 : 0) + event(EV_SYN, SYN_REPORT, 0);
+}
+
+void LidSwitchWatcherTest::send(const QByteArray &data)
+{
+    QCOMPARE(::write(m_writeFd, data.constData(), data.size()), ssize_t(data.size()));
+}
+
+// 用管道模拟 evdev fd，写入端按内核格式注入 input_event
+void LidSwitchWatcherTest::init()
+{
+    int fds[2];
+    QCOMPARE(pipe2(fds, O_NONBLOCK | O_CLOEXEC), 0);
+    m_writeFd = fds[1];
+    m_watcher = new LidSwitchWatcher;
+    QVERIFY(m_watcher->openFd(fds[0], false));
+    QVERIFY(m_watcher->isOpen());
+    QVERIFY(!m_watcher->isClosed());
+}
+
+void LidSwitchWatcherTest::cleanup()
+{
+    delete m_watcher;
+    m_watcher = nullptr;
+    if (m_writeFd >= 0)
+        ::close(m_writeFd);
+    m_writeFd = -1;
+}
+
+void LidSwitchWatcherTest::emitsOnSynReport()
+{
+    QSignalSpy spy(m_watcher, &LidSwitchWatcher::lidSwitched);
+
+    // SYN_REPORT 之前不应通知
+    send(event(EV_SW, SW_LID, 1));
+    QTest::qWait(50);
+    QCOMPARE(spy.count(), 0);
+
+    send(event(EV_SYN, SYN_REPORT, 0));
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.takeFirst().at(0).toBool(), true);
+    QVERIFY(m_watcher->isClosed());
+
+    send(lid(false));
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.takeFirst().at(0).toBool(), false);
+    QVERIFY(!m_watcher->isClosed());
+}
+
+void LidSwitchWatcherTest::ignoresRepeatedState()
+{
+    QSignalSpy spy(m_watcher, &LidSwitchWatcher::lidSwitched);
+
+    // 其他开关与按键事件不影响合盖状态
+    send(event(EV_SW, SW_TABLET_MODE, 1) + event(EV_KEY, KEY_POWER, 1) + event(EV_SYN, SYN_REPORT, 0));
+    send(lid(true) + lid(true) + lid(true));
+    QTRY_COMPARE(spy.count(), 1);
+    QTest::qWait(50);
+    QCOMPARE(spy.count(), 1);
+
+    // 同一帧内合上又打开，以最后的值为准
+    send(event(EV_SW, SW_LID, 0) + event(EV_SW, SW_LID, 1) + event(EV_SYN, SYN_REPORT, 0));
+    QTest::qWait(50);
+    QCOMPARE(spy.count(), 1);
+}
+
+void LidSwitchWatcherTest::reassemblesSplitEvents()
+{
+    QSignalSpy spy(m_watcher, &LidSwitchWatcher::lidSwitched);
+
+    const QByteArray data = lid(true);
+    const int cut = static_cast<int>(sizeof(input_event)) + 3;
+    send(data.left(cut));
+    QTest::qWait(50);
+    QCOMPARE(spy.count(), 0);
+
+    send(data.mid(cut));
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.takeFirst().at(0).toBool(), true);
+}
+
+void LidSwitchWatcherTest::discardsAfterSynDropped()
+{
+    QSignalSpy spy(m_watcher, &LidSwitchWatcher::lidSwitched);
+
+    // SYN_DROPPED 之后直到 SYN_REPORT 的事件都不可信
+    send(event(EV_SYN, SYN_DROPPED, 0) + event(EV_SW, SW_LID, 1) + event(EV_SYN, SYN_REPORT, 0));
+    QTest::qWait(50);
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(!m_watcher->isClosed());
+
+    send(lid(true));
+    QTRY_COMPARE(spy.count(), 1);
+}
+
+void LidSwitchWatcherTest::closesWhenDeviceGoesAway()
+{
+    ::close(m_writeFd);
+    m_writeFd = -1;
+    QTRY_VERIFY(!m_watcher->isOpen());
+}
+
+void LidSwitchWatcherTest::openWithoutLidDevice()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QFile f(dir.filePath("event0"));
+    QVERIFY(f.open(QIODevice::WriteOnly));
+    f.close();
+
+    LidSwitchWatcher watcher;
+    QVERIFY(!watcher.open(dir.path()));
+    QVERIFY(!watcher.isOpen());
+}
+
+QTEST_GUILESS_MAIN(LidSwitchWatcherTest)
+
+#include "tst_lidswitchwatcher.moc"
@@ -0,0 +1,235 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "system/cpufreqmanager.h"
+#include "system/powermodecontroller.h"
+
+#include <QDir>
+#include <QTemporaryDir>
+#include <QtTest>
+
+Q_LOGGING_CATEGORY(logPowerSystem, "dde.power.system")
+
+class PowerModeControllerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void intelPstate();
+    void amdPstateEpp();
+    void acpiCpufreq();
+    void platformProfileOnly();
+    void platformProfileQuietFallback();
+    void noBackend();
+    void restoresProfileOnCpuFailure();
+    void rejectedProfileFailsMode();
+
+private:
+    void writeAttr(const QString &rel, const QByteArray &value);
+    QByteArray readAttr(const QString &rel) const;
+    void addPolicy(const QString &name, const QByteArray &driver, const QByteArray &governors,
+                   const QByteArray &governor, const QByteArray &epps = {}, const QByteArray &epp = {});
+    void addPlatformProfile(const QByteArray &choices, const QByteArray &current);
+
+    QScopedPointer<QTemporaryDir> m_root;
+};
+
+void PowerModeControllerTest::init()
+{
+    m_root.reset(new QTemporaryDir);
+    QVERIFY(m_root->isValid());
+}
+
+void PowerModeControllerTest::writeAttr(const QString &rel, const QByteArray &value)
+{
+    const QString path = m_root->filePath(rel);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile f(path);
+    QVERIFY(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    f.write(value + "\n");
+}
+
+QByteArray PowerModeControllerTest::readAttr(const QString &rel) const
+{
+    QFile f(m_root->filePath(rel));
+    if (!f.open(QIODevice::ReadOnly))
+        return {};
+    return f.readAll().trimmed();
+}
+
+void PowerModeControllerTest::addPolicy(const QString &name, const QByteArray &driver,
+                                        const QByteArray &governors, const QByteArray &governor,
+                                        const QByteArray &epps, const QByteArray &epp)
+{
+    const QString dir = "cpu/cpufreq/" + name + "/";
+    writeAttr(dir + "affected_cpus", name.mid(6).toLatin1());
+    writeAttr(dir + "scaling_driver", driver);
+    writeAttr(dir + "scaling_available_governors", governors);
+    writeAttr(dir + "scaling_governor", governor);
+    if (!epps.isEmpty()) {
+        writeAttr(dir + "energy_performance_available_preferences", epps);
+        writeAttr(dir + "energy_performance_preference", epp);
+    }
+}
+
+void PowerModeControllerTest::addPlatformProfile(const QByteArray &choices, const QByteArray &current)
+{
+    writeAttr("acpi/platform_profile_choices", choices);
+    writeAttr("acpi/platform_profile", current);
+}
+
+void PowerModeControllerTest::intelPstate()
+{
+    const QByteArray epps = "default performance balance_performance balance_power power";
+    addPolicy("policy0", "intel_pstate", "performance powersave", "powersave", epps, "balance_performance");
+    addPolicy("policy1", "intel_pstate", "performance powersave", "powersave", epps, "balance_performance");
+    addPlatformProfile("low-power balanced performance", "balanced");
+
+    CpuFreqManager cpu(m_root->filePath("cpu"));
+    cpu.probe();
+    PowerModeController controller(&cpu, m_root->filePath("acpi"));
+    controller.probe();
+
+    QVERIFY(controller.supportsMode("performance"));
+    QVERIFY(controller.supportsMode("powersave"));
+
+    QVERIFY(controller.apply("performance"));
+    // intel_pstate 下保持 powersave governor，通过 EPP 调整倾向
+    QCOMPARE(readAttr("cpu/cpufreq/policy0/scaling_governor"), QByteArray("powersave"));
+    QCOMPARE(readAttr("cpu/cpufreq/policy0/energy_performance_preference"), QByteArray("performance"));
+    QCOMPARE(readAttr("cpu/cpufreq/policy1/energy_performance_preference"), QByteArray("performance"));
+    QCOMPARE(readAttr("acpi/platform_profile"), QByteArray("performance"));
+
+    QVERIFY(controller.apply("powersave"));
+    QCOMPARE(readAttr("cpu/cpufreq/policy0/energy_performance_preference"), QByteArray("power"));
+    QCOMPARE(readAttr("acpi/platform_profile"), QByteArray("low-power"));
+
+    QVERIFY(controller.apply("balance"));
+    QCOMPARE(readAttr("cpu/cpufreq/policy1/energy_performance_preference"), QByteArray("balance_performance"));
+    QCOMPARE(controller.platformProfile(), QStringLiteral("balanced"));
+}
+
+void PowerModeControllerTest::amdPstateEpp()
+{
+    const QByteArray epps = "default performance balance_performance balance_power power";
+    addPolicy("policy0", "amd-pstate-epp", "performance powersave", "performance", epps, "performance");
+
+    CpuFreqManager cpu(m_root->filePath("cpu"));
+    cpu.probe();
+    PowerModeController controller(&cpu, m_root->filePath("acpi"));
+    controller.probe();
+    QVERIFY(!controller.hasPlatformProfile());
+
+    // performance governor 会锁定 EPP，切换时先改回 powersave 再写 EPP
+    QVERIFY(controller.apply("powersave"));
+    QCOMPARE(readAttr("cpu/cpufreq/policy0/scaling_governor"), QByteArray("powersave"));
+    QCOMPARE(readAttr("cpu/cpufreq/policy0/energy_performance_preference"), QByteArray("power"));
+
+    QVERIFY(controller.apply("balance"));
+    QCOMPARE(readAttr("cpu/cpufreq/policy0/energy_performance_preference"), QByteArray("balance_performance"));
+}
+
+void PowerModeControllerTest::acpiCpufreq()
+{
+    const QByteArray governors = "conservative ondemand userspace powersave performance schedutil";
+    addPolicy("policy0", "acpi-cpufreq", governors, "schedutil");
+    addPolicy("policy1", "acpi-cpufreq", governors, "schedutil");
+
+    CpuFreqManager cpu(m_root->filePath("cpu"));
+    cpu.probe();
+    PowerModeController controller(&cpu, m_root->filePath("acpi"));
+    controller.probe();
+
+    QVERIFY(controller.apply("performance"));
+    QCOMPARE(readAttr("cpu/cpufreq/policy0/scaling_governor"), QByteArray("performance"));
+    QCOMPARE(readAttr("cpu/cpufreq/policy1/scaling_governor"), QByteArray("performance"));
+
+    QVERIFY(controller.apply("powersave"));
+    QCOMPARE(readAttr("cpu/cpufreq/policy1/scaling_governor"), QByteArray("powersave"));
+
+    QVERIFY(controller.apply("balance"));
+    QCOMPARE(readAttr("cpu/cpufreq/policy0/scaling_governor"), QByteArray("schedutil"));
+}
+
+void PowerModeControllerTest::platformProfileOnly()
+{
+    addPlatformProfile("low-power balanced performance", "balanced");
+
+    CpuFreqManager cpu(m_root->filePath("cpu"));
+    cpu.probe();
+    PowerModeController controller(&cpu, m_root->filePath("acpi"));
+    controller.probe();
+
+    QVERIFY(controller.apply("performance"));
+    QCOMPARE(readAttr("acpi/platform_profile"), QByteArray("performance"));
+}
+
+void PowerModeControllerTest::platformProfileQuietFallback()
+{
+    addPlatformProfile("quiet balanced", "balanced");
+
+    CpuFreqManager cpu(m_root->filePath("cpu"));
+    cpu.probe();
+    PowerModeController controller(&cpu, m_root->filePath("acpi"));
+    controller.probe();
+
+    QVERIFY(!controller.supportsMode("performance"));
+    QVERIFY(controller.apply("powersave"));
+    QCOMPARE(readAttr("acpi/platform_profile"), QByteArray("quiet"));
+}
+
+void PowerModeControllerTest::noBackend()
+{
+    CpuFreqManager cpu(m_root->filePath("cpu"));
+    cpu.probe();
+    PowerModeController controller(&cpu, m_root->filePath("acpi"));
+    controller.probe();
+
+    // 没有任何可用后端时由调用方回退到 deepin-power-control
+    QVERIFY(!controller.supportsMode("balance"));
+    QVERIFY(!controller.apply("balance"));
+}
+
+void PowerModeControllerTest::restoresProfileOnCpuFailure()
+{
+    addPolicy("policy0", "acpi-cpufreq", "powersave performance", "powersave");
+    addPlatformProfile("low-power balanced performance", "balanced");
+    // governor 属性替换成目录，写入必然失败
+    const QString gov = m_root->filePath("cpu/cpufreq/policy0/scaling_governor");
+    QVERIFY(QFile::remove(gov));
+    QVERIFY(QDir().mkpath(gov));
+
+    CpuFreqManager cpu(m_root->filePath("cpu"));
+    cpu.probe();
+    PowerModeController controller(&cpu, m_root->filePath("acpi"));
+    controller.probe();
+
+    QVERIFY(!controller.apply("performance"));
+    QCOMPARE(readAttr("acpi/platform_profile"), QByteArray("balanced"));
+    QCOMPARE(controller.platformProfile(), QStringLiteral("balanced"));
+}
+
+void PowerModeControllerTest::rejectedProfileFailsMode()
+{
+    addPolicy("policy0", "acpi-cpufreq", "powersave performance", "powersave");
+    addPlatformProfile("low-power balanced performance", "balanced");
+    // 指向只接受整数的 oom_score_adj：open 成功，write 返回 EINVAL，与驱动拒绝取值相同
+    const QString profile = m_root->filePath("acpi/platform_profile");
+    QVERIFY(QFile::remove(profile));
+    QVERIFY(QFile::link("/proc/self/oom_score_adj", profile));
+
+    CpuFreqManager cpu(m_root->filePath("cpu"));
+    cpu.probe();
+    PowerModeController controller(&cpu, m_root->filePath("acpi"));
+    controller.probe();
+
+    // platform_profile 写入失败时模式整体不生效，CPU 侧保持不变
+    QVERIFY(!controller.apply("performance"));
+    QVERIFY(controller.platformProfile() != QStringLiteral("performance"));
+    QCOMPARE(readAttr("cpu/cpufreq/policy0/scaling_governor"), QByteArray("powersave"));
+}
+
+QTEST_GUILESS_MAIN(PowerModeControllerTest)
+
+#include "tst_powermodecontroller.moc"
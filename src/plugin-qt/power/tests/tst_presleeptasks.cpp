@@ -0,0 +1,155 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "session/presleeptasks.h"
+
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QtTest>
+
+Q_LOGGING_CATEGORY(logPowerSession, "dde.power.session")
+
+class PreSleepTasksTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void releasesWhenAllDone();
+    void slowParticipantHitsOwnBudget();
+    void overallBudgetCapsSleepDelay();
+    void lateDoneFromPreviousCycleIgnored();
+    void wakeCancelsPendingCycle();
+    void emptyRegistryFinishesImmediately();
+
+private:
+    // 模拟一个在 delayMs 后完成的异步参与者；delayMs < 0 表示永不完成
+    static PreSleepTasks::Task delayed(int delayMs, QList<PreSleepTasks::Done> *held = nullptr);
+};
+
+PreSleepTasks::Task PreSleepTasksTest::delayed(int delayMs, QList<PreSleepTasks::Done> *held)
+{
+    return [delayMs, held](const PreSleepTasks::Done &done) {
+        if (held)
+            held->append(done);
+        if (delayMs == 0)
+            done();
+        else if (delayMs > 0)
+            QTimer::singleShot(delayMs, done);
+    };
+}
+
+void PreSleepTasksTest::releasesWhenAllDone()
+{
+    PreSleepTasks tasks;
+    tasks.add("sync", 500, delayed(0));
+    tasks.add("lock", 500, delayed(30));
+    tasks.add("brightness", 500, delayed(60));
+    QSignalSpy spy(&tasks, &PreSleepTasks::finished);
+
+    QElapsedTimer clock;
+    clock.start();
+    tasks.start();
+    QVERIFY(tasks.isRunning());
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().at(0).toBool(), false);
+    // 最慢的参与者完成即释放，不必等到预算耗尽
+    QVERIFY(clock.elapsed() < 400);
+    QVERIFY(!tasks.isRunning());
+
+    const auto &report = tasks.lastReport();
+    QCOMPARE(report.size(), 3);
+    QCOMPARE(report.at(0).name, QStringLiteral("sync"));
+    QVERIFY(report.at(0).elapsedMs >= 0 && report.at(0).elapsedMs < 30);
+    QVERIFY(report.at(2).elapsedMs >= 60);
+    for (const auto &r : report)
+        QVERIFY(!r.timedOut);
+}
+
+void PreSleepTasksTest::slowParticipantHitsOwnBudget()
+{
+    PreSleepTasks tasks;
+    tasks.setOverallBudget(2000);
+    tasks.add("fast", 500, delayed(10));
+    tasks.add("stuck", 80, delayed(-1));
+    QSignalSpy spy(&tasks, &PreSleepTasks::finished);
+
+    QElapsedTimer clock;
+    clock.start();
+    tasks.start();
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().at(0).toBool(), true);
+    QVERIFY(clock.elapsed() >= 80);
+    QVERIFY(clock.elapsed() < 1000);
+
+    const auto &report = tasks.lastReport();
+    QVERIFY(!report.at(0).timedOut);
+    QVERIFY(report.at(1).timedOut);
+    QVERIFY(report.at(1).elapsedMs >= 80);
+}
+
+void PreSleepTasksTest::overallBudgetCapsSleepDelay()
+{
+    PreSleepTasks tasks;
+    tasks.setOverallBudget(100);
+    tasks.add("slow-a", 5000, delayed(3000));
+    tasks.add("slow-b", 5000, delayed(-1));
+    QSignalSpy spy(&tasks, &PreSleepTasks::finished);
+
+    QElapsedTimer clock;
+    clock.start();
+    tasks.start();
+    QTRY_COMPARE(spy.count(), 1);
+    QVERIFY(clock.elapsed() < 1000);
+    QCOMPARE(spy.first().at(0).toBool(), true);
+    for (const auto &r : tasks.lastReport())
+        QVERIFY(r.timedOut);
+}
+
+void PreSleepTasksTest::lateDoneFromPreviousCycleIgnored()
+{
+    QList<PreSleepTasks::Done> held;
+    PreSleepTasks tasks;
+    tasks.add("stuck", 50, delayed(-1, &held));
+    QSignalSpy spy(&tasks, &PreSleepTasks::finished);
+
+    tasks.start();
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(held.size(), 1);
+
+    // 第二次休眠开始后，上一轮迟到的 done 不能提前释放
+    tasks.start();
+    held.first()();
+    QTest::qWait(20);
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(tasks.isRunning());
+
+    held.last()();
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.last().at(0).toBool(), false);
+}
+
+void PreSleepTasksTest::wakeCancelsPendingCycle()
+{
+    PreSleepTasks tasks;
+    tasks.add("slow", 100, delayed(-1));
+    QSignalSpy spy(&tasks, &PreSleepTasks::finished);
+
+    tasks.start();
+    tasks.cancel();
+    QVERIFY(!tasks.isRunning());
+    QTest::qWait(200);
+    QCOMPARE(spy.count(), 0);
+}
+
+void PreSleepTasksTest::emptyRegistryFinishesImmediately()
+{
+    PreSleepTasks tasks;
+    QSignalSpy spy(&tasks, &PreSleepTasks::finished);
+    tasks.start();
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().at(0).toBool(), false);
+}
+
+QTEST_GUILESS_MAIN(PreSleepTasksTest)
+
+#include "tst_presleeptasks.moc"
@@ -0,0 +1,166 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "propertieschangednotifier.h"
+
+#include <QDBusMessage>
+#include <QtTest>
+
+// 模拟 PowerManager 的电池相关属性，refresh() 与 refreshBatteryInfo 一样无条件发出所有 NOTIFY
+class FakeBattery : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool OnBattery READ onBattery NOTIFY onBatteryChanged)
+    Q_PROPERTY(bool HasBattery READ hasBattery NOTIFY hasBatteryChanged)
+    Q_PROPERTY(double BatteryPercentage READ batteryPercentage NOTIFY batteryPercentageChanged)
+    Q_PROPERTY(uint BatteryStatus READ batteryStatus NOTIFY batteryStatusChanged)
+    Q_PROPERTY(quint64 BatteryTimeToEmpty READ batteryTimeToEmpty NOTIFY batteryTimeToEmptyChanged)
+    Q_PROPERTY(double BatteryCapacity READ batteryCapacity NOTIFY batteryCapacityChanged)
+    Q_PROPERTY(int Constant READ constant CONSTANT)
+
+public:
+    bool onBattery() const { return m_onBattery; }
+    bool hasBattery() const { return m_hasBattery; }
+    double batteryPercentage() const { return m_percentage; }
+    uint batteryStatus() const { return m_status; }
+    quint64 batteryTimeToEmpty() const { return m_tte; }
+    double batteryCapacity() const { return m_capacity; }
+    int constant() const { return 1; }
+
+    void refresh(bool onBattery, double pct, uint status, quint64 tte)
+    {
+        m_onBattery = onBattery;
+        m_hasBattery = true;
+        m_percentage = pct;
+        m_status = status;
+        m_tte = tte;
+        Q_EMIT onBatteryChanged();
+        Q_EMIT hasBatteryChanged();
+        Q_EMIT batteryPercentageChanged();
+        Q_EMIT batteryStatusChanged();
+        Q_EMIT batteryTimeToEmptyChanged();
+        Q_EMIT batteryCapacityChanged();
+    }
+
+Q_SIGNALS:
+    void onBatteryChanged();
+    void hasBatteryChanged();
+    void batteryPercentageChanged();
+    void batteryStatusChanged();
+    void batteryTimeToEmptyChanged();
+    void batteryCapacityChanged();
+
+private:
+    bool m_onBattery = false;
+    bool m_hasBattery = false;
+    double m_percentage = 100.0;
+    uint m_status = 0;
+    quint64 m_tte = 0;
+    double m_capacity = 100.0;
+};
+
+class PropertiesChangedNotifierTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void fullRefreshSendsOneMessage();
+    void unchangedRefreshSendsNothing();
+    void revertedValueIsDropped();
+    void flushSendsImmediately();
+
+private:
+    static QVariantMap changedOf(const QDBusMessage &msg);
+};
+
+QVariantMap PropertiesChangedNotifierTest::changedOf(const QDBusMessage &msg)
+{
+    return msg.arguments().value(1).toMap();
+}
+
+void PropertiesChangedNotifierTest::fullRefreshSendsOneMessage()
+{
+    FakeBattery battery;
+    QList<QDBusMessage> sent;
+    PropertiesChangedNotifier notifier(&battery, "/org/deepin/dde/Power1", "org.deepin.dde.Power1",
+                                       [&sent](const QDBusMessage &msg) { sent.append(msg); });
+
+    battery.refresh(true, 80.0, 2, 3600);
+    QCOMPARE(sent.size(), 0);
+    QVERIFY(notifier.hasPending());
+
+    QCoreApplication::processEvents();
+    QCOMPARE(sent.size(), 1);
+    QVERIFY(!notifier.hasPending());
+
+    const QDBusMessage &msg = sent.first();
+    QCOMPARE(msg.type(), QDBusMessage::SignalMessage);
+    QCOMPARE(msg.path(), QStringLiteral("/org/deepin/dde/Power1"));
+    QCOMPARE(msg.interface(), QStringLiteral("org.freedesktop.DBus.Properties"));
+    QCOMPARE(msg.member(), QStringLiteral("PropertiesChanged"));
+    QCOMPARE(msg.arguments().value(0).toString(), QStringLiteral("org.deepin.dde.Power1"));
+    QVERIFY(msg.arguments().value(2).toStringList().isEmpty());
+
+    // BatteryCapacity 未变化，不应出现在消息中
+    const QVariantMap changed = changedOf(msg);
+    QCOMPARE(changed.keys(), QStringList({ "BatteryPercentage", "BatteryStatus",
+                                           "BatteryTimeToEmpty", "HasBattery", "OnBattery" }));
+    QCOMPARE(changed.value("BatteryPercentage").toDouble(), 80.0);
+    QCOMPARE(changed.value("BatteryStatus").toUInt(), 2u);
+}
+
+void PropertiesChangedNotifierTest::unchangedRefreshSendsNothing()
+{
+    FakeBattery battery;
+    int messages = 0;
+    PropertiesChangedNotifier notifier(&battery, "/p", "i",
+                                       [&messages](const QDBusMessage &) { ++messages; });
+
+    battery.refresh(true, 80.0, 2, 3600);
+    QCoreApplication::processEvents();
+    QCOMPARE(messages, 1);
+
+    for (int i = 0; i < 5; ++i)
+        battery.refresh(true, 80.0, 2, 3600);
+    QCoreApplication::processEvents();
+    QCOMPARE(messages, 1);
+
+    battery.refresh(true, 79.0, 2, 3500);
+    QCoreApplication::processEvents();
+    QCOMPARE(messages, 2);
+}
+
+void PropertiesChangedNotifierTest::revertedValueIsDropped()
+{
+    FakeBattery battery;
+    QList<QDBusMessage> sent;
+    PropertiesChangedNotifier notifier(&battery, "/p", "i",
+                                       [&sent](const QDBusMessage &msg) { sent.append(msg); });
+
+    // 同一轮事件循环内改了又改回，客户端看到的值没有变化
+    battery.refresh(true, 80.0, 2, 3600);
+    battery.refresh(false, 100.0, 0, 0);
+    QCoreApplication::processEvents();
+    QCOMPARE(sent.size(), 1);
+    QCOMPARE(changedOf(sent.first()).keys(), QStringList({ "HasBattery" }));
+}
+
+void PropertiesChangedNotifierTest::flushSendsImmediately()
+{
+    FakeBattery battery;
+    int messages = 0;
+    PropertiesChangedNotifier notifier(&battery, "/p", "i",
+                                       [&messages](const QDBusMessage &) { ++messages; });
+
+    battery.refresh(true, 50.0, 2, 100);
+    notifier.flush();
+    QCOMPARE(messages, 1);
+
+    // 已排队的 flush 不再重复发送
+    QCoreApplication::processEvents();
+    QCOMPARE(messages, 1);
+}
+
+QTEST_GUILESS_MAIN(PropertiesChangedNotifierTest)
+
+#include "tst_propertieschangednotifier.moc"
@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "session/idle/idlewatcher_x11.h"
+#include "session/screen/screencontroller_x11.h"
+
+#include <QSignalSpy>
+#include <QtTest>
+
+Q_LOGGING_CATEGORY(logPowerSession, "dde.power.session")
+
+// 需要带 XSync/DPMS 扩展的 X server，例如：xvfb-run -a ctest -R power-x11
+class X11IdleWatcherTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void idleAndResume();
+    void shorterTimeoutWhileAlreadyIdle();
+    void dpmsMode();
+};
+
+void X11IdleWatcherTest::initTestCase()
+{
+    if (qEnvironmentVariableIsEmpty("DISPLAY"))
+        QSKIP("no X server available");
+}
+
+void X11IdleWatcherTest::idleAndResume()
+{
+    X11IdleWatcher watcher;
+    if (!watcher.isValid())
+        QSKIP("XSync IDLETIME counter is not available");
+
+    QSignalSpy idled(&watcher, &IdleWatcher::idled);
+    QSignalSpy resumed(&watcher, &IdleWatcher::resumed);
+
+    watcher.simulateActivity();
+    watcher.setTimeout(1);
+    QVERIFY(!watcher.isIdle());
+    QCOMPARE(idled.count(), 0);
+
+    // 由报警事件驱动，而不是轮询
+    QVERIFY(idled.wait(5000));
+    QCOMPARE(idled.count(), 1);
+    QVERIFY(watcher.isIdle());
+
+    QTest::qWait(100);
+    QVERIFY(watcher.idleTimeMs() >= 100);
+
+    watcher.simulateActivity();
+    QVERIFY(resumed.wait(3000));
+    QCOMPARE(resumed.count(), 1);
+    QVERIFY(!watcher.isIdle());
+    QCOMPARE(watcher.idleTimeMs(), 0u);
+
+    // 恢复后再次空闲
+    QVERIFY(idled.wait(5000));
+    QCOMPARE(idled.count(), 2);
+}
+
+void X11IdleWatcherTest::shorterTimeoutWhileAlreadyIdle()
+{
+    X11IdleWatcher watcher;
+    if (!watcher.isValid())
+        QSKIP("XSync IDLETIME counter is not available");
+
+    watcher.simulateActivity();
+    watcher.setTimeout(10);
+    QTest::qWait(1200);
+    QVERIFY(!watcher.isIdle());
+
+    // 已空闲时间超过新阈值，正向跨越报警不会再触发，需要立即进入空闲
+    QSignalSpy idled(&watcher, &IdleWatcher::idled);
+    watcher.setTimeout(1);
+    QCOMPARE(idled.count(), 1);
+    QVERIFY(watcher.isIdle());
+}
+
+void X11IdleWatcherTest::dpmsMode()
+{
+    X11ScreenController controller;
+    if (!controller.isValid())
+        QSKIP("DPMS is not available");
+
+    QCOMPARE(controller.outputCount(), 1);
+    QSignalSpy spy(&controller, &ScreenController::modeChanged);
+
+    controller.setAllModes(ScreenController::Off);
+    QCOMPARE(controller.mode(0), ScreenController::Off);
+    QVERIFY(controller.isAllOff());
+    QCOMPARE(spy.count(), 1);
+
+    controller.setAllModes(ScreenController::On);
+    QCOMPARE(controller.mode(0), ScreenController::On);
+    QCOMPARE(spy.count(), 2);
+}
+
+QTEST_GUILESS_MAIN(X11IdleWatcherTest)
+
+#include "tst_x11idlewatcher.moc"
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "appconfigupdater.h"
+
+#include <QDeadlineTimer>
+#include <QDebug>
+#include <QThread>
+
+const static int DEFAULT_COALESCE_INTERVAL = 100;
+
+AppConfigUpdater::AppConfigUpdater(QObject *parent)
+    : QObject(parent)
+    , m_coalesceInterval(DEFAULT_COALESCE_INTERVAL)
+    , m_busy(false)
+    , m_stopping(false)
+    , m_thread(QThread::create([this] {
+        run();
+    }))
+{
+    m_thread->setObjectName("xsettings-appconfig");
+    m_thread->start();
+}
+
+// 退出前把尚未执行的更新执行完
+AppConfigUpdater::~AppConfigUpdater()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wakeCondition.wakeAll();
+    }
+    m_thread->wait();
+    delete m_thread;
+}
+
+void AppConfigUpdater::setCoalesceInterval(int msec)
+{
+    QMutexLocker locker(&m_mutex);
+    m_coalesceInterval = msec;
+}
+
+void AppConfigUpdater::addTarget(const QString &name, ApplyFunc func)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_appliers.contains(name)) {
+        m_targetOrder.append(name);
+    }
+    m_appliers.insert(name, func);
+}
+
+void AppConfigUpdater::submit(const QString &name, const QVariant &value)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_appliers.contains(name)) {
+        qWarning() << "unknown app config target:" << name;
+        return;
+    }
+    m_pending.insert(name, value);
+    m_wakeCondition.wakeAll();
+}
+
+bool AppConfigUpdater::waitForIdle(int msec)
+{
+    QDeadlineTimer deadline(msec);
+    QMutexLocker locker(&m_mutex);
+    while (m_busy || !m_pending.isEmpty()) {
+        if (!m_idleCondition.wait(&m_mutex, deadline)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AppConfigUpdater::run()
+{
+    QMutexLocker locker(&m_mutex);
+    while (true) {
+        while (m_pending.isEmpty() && !m_stopping) {
+            m_wakeCondition.wait(&m_mutex);
+        }
+        if (m_pending.isEmpty()) {
+            break;
+        }
+
+        // 合并窗口内的提交只保留每个目标的最新值
+        QDeadlineTimer deadline(m_coalesceInterval);
+        while (!m_stopping && m_wakeCondition.wait(&m_mutex, deadline)) {
+        }
+
+        QVector<QPair<ApplyFunc, QVariant>> jobs;
+        for (const QString &name : m_targetOrder) {
+            auto iter = m_pending.constFind(name);
+            if (iter != m_pending.constEnd()) {
+                jobs.append(qMakePair(m_appliers.value(name), iter.value()));
+            }
+        }
+        m_pending.clear();
+        m_busy = true;
+
+        locker.unlock();
+        for (const auto &job : jobs) {
+            job.first(job.second);
+        }
+        locker.relock();
+
+        m_busy = false;
+        if (m_pending.isEmpty()) {
+            m_idleCondition.wakeAll();
+        }
+    }
+    m_idleCondition.wakeAll();
+}
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef APPCONFIGUPDATER_H
+#define APPCONFIGUPDATER_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QVariant>
+#include <QWaitCondition>
+
+#include <functional>
+
+class QThread;
+
+// 缩放、DPI 变化后需要同步到各应用配置（XResources、Firefox、Plymouth）
+// 这些操作在单独的工作线程中执行，每个目标只保留最新的状态，
+// 拖动缩放滑块产生的连续修改最终只会对每个目标写入一次
+class AppConfigUpdater : public QObject
+{
+    Q_OBJECT
+public:
+    typedef std::function<void(const QVariant &)> ApplyFunc;
+
+    explicit AppConfigUpdater(QObject *parent = nullptr);
+    ~AppConfigUpdater();
+
+    void setCoalesceInterval(int msec);
+    void addTarget(const QString &name, ApplyFunc func);
+    void submit(const QString &name, const QVariant &value);
+    bool waitForIdle(int msec);
+
+private:
+    void run();
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_wakeCondition;
+    QWaitCondition m_idleCondition;
+    QStringList m_targetOrder;
+    QHash<QString, ApplyFunc> m_appliers;
+    QHash<QString, QVariant> m_pending;
+    int m_coalesceInterval;
+    bool m_busy;
+    bool m_stopping;
+    QThread *m_thread;
+};
+
+#endif // APPCONFIGUPDATER_H
@@ -268,6 +268,11 @@ QSharedPointer<XSItemInfo> XSDataInfo::getPropItem(QString prop)
     return QSharedPointer<XSItemInfo>();
 }
 
+const QVector<QSharedPointer<XSItemInfo>> &XSDataInfo::getItems() const
+{
+    return items;
+}
+
 void XSDataInfo::inserItem(QSharedPointer<XSItemInfo> itemInfo)
 {
     items.push_back(itemInfo);
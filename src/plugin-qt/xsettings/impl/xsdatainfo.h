@@ -44,6 +44,7 @@ public:
     QByteArray marshalSettingData();
     QString listProps();
     QSharedPointer<XSItemInfo> getPropItem(QString prop);
+    const QVector<QSharedPointer<XSItemInfo>> &getItems() const;
     void inserItem(QSharedPointer<XSItemInfo> itemInfo);
     void increaseSerial();
     void increaseNumSettings();
@@ -12,8 +12,8 @@
 #include <QDir>
 #include <QDirIterator>
 #include <QProcessEnvironment>
+#include <QSaveFile>
 #include <QStandardPaths>
-#include <QThreadPool>
 #include <QtMath>
 
 #include <fcntl.h>
@@ -21,15 +21,35 @@
 const static int DPI_FALLBACK = 96;
 const static int BASE_CURSORSIZE = 24;
 const static QString PLYMOUTH_CONFIGFILE = "/etc/plymouth/plymouthd.conf";
+const static QString APP_CONFIG_XRESOURCES = "xresources";
+const static QString APP_CONFIG_FIREFOX = "firefox";
+const static QString APP_CONFIG_PLYMOUTH = "plymouth";
 
 XSettingsManager::XSettingsManager(QObject *parent)
     : QObject(parent)
     , m_settingDconfig(DTK_CORE_NAMESPACE::DConfig::create("org.deepin.dde.daemon", "org.deepin.XSettings"))
     , m_greeterInterface(new QDBusInterface("org.deepin.dde.Greeter1", "/org/deepin/dde/Greeter1", "org.deepin.dde.Greeter1", QDBusConnection::systemBus()))
-    , m_sysDaemonInterface(new QDBusInterface("com.deepin.daemon.Daemon", "/com/deepin/daemon/Daemon", "com.deepin.daemon.Daemon", QDBusConnection::systemBus()))
     , m_xcbUtils(XcbUtils::getInstance())
-{
+    , m_settingsWriter(m_settingsModel, [this](const QByteArray &data) {
+        return m_xcbUtils.changeSettingProp(data);
+    })
+    , m_scaleFactorDonePending(false)
+{
+    // 以下回调在 AppConfigUpdater 的工作线程中执行，只能访问线程安全的资源
+    m_appConfigUpdater.addTarget(APP_CONFIG_XRESOURCES, [this](const QVariant &value) {
+        m_xcbUtils.updateXResources(value.value<QVector<QPair<QString, QString>>>());
+    });
+    m_appConfigUpdater.addTarget(APP_CONFIG_FIREFOX, [this](const QVariant &value) {
+        updateFirefoxDPI(value.toDouble());
+    });
+    m_appConfigUpdater.addTarget(APP_CONFIG_PLYMOUTH, [this](const QVariant &value) {
+        applyPlymouthScaleFactor(value.toInt());
+        QMetaObject::invokeMethod(this, &XSettingsManager::handlePlymouthScaleApplied, Qt::QueuedConnection);
+    });
+
     connect(m_settingDconfig, &DTK_CORE_NAMESPACE::DConfig::valueChanged, this, &XSettingsManager::handleDConfigChangedCb);
+    connect(&m_xcbUtils, &XcbUtils::settingPropChanged, this, &XSettingsManager::reloadSettingsModel);
+    reloadSettingsModel();
 
     double scale = 0;
     if (m_settingDconfig->isValid()) {
@@ -42,13 +62,14 @@ XSettingsManager::XSettingsManager(QObject *parent)
         adjustScaleFactor(getRecommendedScaleFactor());
     }
 
-    setSettings(getSettingsInSchema());
-
-    updateDPI();
+    {
+        // 启动时的全部设置只写入一次属性
+        XSettingsWriter::Transaction transaction(m_settingsWriter);
+        setSettings(getSettingsInSchema());
+        updateDPI();
+    }
     updateXResources();
-    QThreadPool::globalInstance()->start([this]() {
-        updateFirefoxDPI();
-    });
+    m_appConfigUpdater.submit(APP_CONFIG_FIREFOX, getScaleFactor());
 }
 
 ArrayOfColor XSettingsManager::getColor(const QString &prop)
@@ -131,11 +152,7 @@ void XSettingsManager::emitSignalSetScaleFactor(bool done, bool emitSignal)
 
 QString XSettingsManager::listProps()
 {
-    QByteArray datas = getSettingPropValue();
-
-    XSDataInfo xSDataInfo(datas);
-
-    return xSDataInfo.listProps();
+    return m_settingsModel.listProps();
 }
 
 void XSettingsManager::setColor(const QString &prop, const ArrayOfColor &v)
@@ -459,7 +476,7 @@ void XSettingsManager::updateXResources()
         xresourceInfos.push_back(qMakePair(QString("Xft.dpi"), QString::number(xftDpi)));
     }
 
-    m_xcbUtils.updateXResources(xresourceInfos);
+    m_appConfigUpdater.submit(APP_CONFIG_XRESOURCES, QVariant::fromValue(xresourceInfos));
 }
 
 QStringList getFirefoxConfigs(const QString &path)
@@ -484,7 +501,7 @@ const QString ffKeyPixels = R"(user_pref("layout.css.devPixelsPerPx",)";
 bool setFirefoxDPI(double value, QString src, QString dest)
 {
     QFile file(src);
-    if (!file.open(QIODevice::ReadWrite | QIODevice::Text)) {
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         qWarning() << "failed to open file:" << file.errorString();
         return false;
     }
@@ -519,21 +536,31 @@ bool setFirefoxDPI(double value, QString src, QString dest)
         if (value == -1) {
             return false;
         }
-        QString tmp = lines[lines.length() - 1];
-        lines[lines.length() - 1] = target;
-        lines.append(tmp);
+        if (lines.isEmpty()) {
+            lines.append(target);
+        } else {
+            QString tmp = lines[lines.length() - 1];
+            lines[lines.length() - 1] = target;
+            lines.append(tmp);
+        }
+    }
+    file.close();
+
+    // 写入临时文件后整体替换，Firefox 不会读到写了一半的配置
+    QSaveFile saveFile(dest);
+    if (!saveFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "failed to open file:" << saveFile.errorString();
+        return false;
     }
-    file.seek(0);
-    file.resize(0);
-    QTextStream out(&file);
+    QTextStream out(&saveFile);
     for (const QString &line : lines) {
         out << line << "\n";
     }
-    file.close();
-    return true;
+    out.flush();
+    return saveFile.commit();
 }
 
-void XSettingsManager::updateFirefoxDPI()
+void XSettingsManager::updateFirefoxDPI(double scale)
 {
     QString homeDir = Utils::getUserHomeDir();
     if (homeDir == "") {
@@ -541,7 +568,6 @@ void XSettingsManager::updateFirefoxDPI()
     }
     QDir dir(homeDir);
     QString ffDir = dir.filePath(".mozilla/firefox");
-    double scale = getScaleFactor();
     if (scale <= 0) {
         scale = -1;
     }
@@ -558,38 +584,23 @@ void XSettingsManager::updateFirefoxDPI()
 
 XsValue XSettingsManager::getSettingValue(QString prop)
 {
-    QByteArray datas = getSettingPropValue();
-    XSDataInfo xsInfo(datas);
+    return m_settingsModel.getValue(prop);
+}
 
-    QSharedPointer<XSItemInfo> item = xsInfo.getPropItem(prop);
-    if (item.isNull()) {
-        qDebug() << "get item null:" << prop;
-        return XsValue();
+// 仅在启动和属性被外部修改时从 X 读取，其余读写都基于内存模型
+void XSettingsManager::reloadSettingsModel()
+{
+    // 本进程的内存模型是权威数据，尚未写出的修改直接覆盖外部写入
+    if (m_settingsWriter.hasPendingWrite()) {
+        m_settingsWriter.flush();
+        return;
     }
-    return item->getValue();
+    m_settingsModel.load(getSettingPropValue());
 }
 
 void XSettingsManager::setSettings(QVector<XsSetting> settings)
 {
-    QByteArray datas = getSettingPropValue();
-    XSDataInfo xsInfo(datas);
-    xsInfo.increaseSerial();
-
-    for (auto xsettingItem : settings) {
-        QSharedPointer<XSItemInfo> xsItem = xsInfo.getPropItem(xsettingItem.prop);
-        if (xsItem) {
-            qDebug() << "setSettings modify:" << xsItem->getHeadName();
-            xsItem->modifyProperty(xsettingItem);
-            continue;
-        }
-
-        QSharedPointer<XSItemInfo> xSItemInfo(new XSItemInfo(xsettingItem.prop, xsettingItem.value));
-        xsInfo.inserItem(xSItemInfo);
-        xsInfo.increaseNumSettings();
-    }
-
-    QByteArray value = xsInfo.marshalSettingData();
-    m_xcbUtils.changeSettingProp(value);
+    m_settingsWriter.setSettings(settings);
 }
 
 QVector<XsSetting> XSettingsManager::getSettingsInSchema()
@@ -674,6 +685,7 @@ void XSettingsManager::setSingleScaleFactor(double scale, bool emitSignal)
         m_settingDconfig->setValue(dcKeyGtkCursorThemeSize, cursorSize);
     }
 
+    m_appConfigUpdater.submit(APP_CONFIG_FIREFOX, scale);
     setScaleFactorForPlymouth(windowScale, emitSignal);
 }
 
@@ -683,14 +695,32 @@ void XSettingsManager::setScaleFactorForPlymouth(int factor, bool emitSignal)
         factor = 2;
     }
 
+    // 连续的修改只应用最后一次，完成信号在应用后发出
+    m_scaleFactorDonePending = m_scaleFactorDonePending || emitSignal;
+    m_appConfigUpdater.submit(APP_CONFIG_PLYMOUTH, factor);
+}
+
+// 在 AppConfigUpdater 的工作线程中执行
+void XSettingsManager::applyPlymouthScaleFactor(int factor)
+{
     QString theme = getPlymouthTheme(PLYMOUTH_CONFIGFILE);
     int currentFactor = getPlymouthThemeScaleFactor(theme);
     if (currentFactor == factor) {
-        emitSignalSetScaleFactor(true, emitSignal);
         return;
     }
 
-    m_sysDaemonInterface->call("ScalePlymouth", static_cast<uint32_t>(factor));
+    QDBusMessage msg = QDBusMessage::createMethodCall("com.deepin.daemon.Daemon", "/com/deepin/daemon/Daemon", "com.deepin.daemon.Daemon", "ScalePlymouth");
+    msg << static_cast<uint32_t>(factor);
+    QDBusMessage reply = QDBusConnection::systemBus().call(msg);
+    if (reply.type() == QDBusMessage::ErrorMessage) {
+        qWarning() << "scale plymouth failed:" << reply.errorMessage();
+    }
+}
+
+void XSettingsManager::handlePlymouthScaleApplied()
+{
+    bool emitSignal = m_scaleFactorDonePending;
+    m_scaleFactorDonePending = false;
     emitSignalSetScaleFactor(true, emitSignal);
 }
 
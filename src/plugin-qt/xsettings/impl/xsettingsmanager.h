@@ -4,7 +4,10 @@
 #ifndef XSETTINGSMANAGER_H
 #define XSETTINGSMANAGER_H
 
+#include "appconfigupdater.h"
 #include "dconfinfos.h"
+#include "xsettingsmodel.h"
+#include "xsettingswriter.h"
 #include "modules/api/keyfile.h"
 #include "modules/api/xcbutils.h"
 #include "modules/common/common.h"
@@ -40,6 +43,7 @@ Q_SIGNALS: // SIGNALS
 
 protected Q_SLOTS:
     void handleDConfigChangedCb(const QString &key);
+    void reloadSettingsModel();
 
 private:
     double getRecommendedScaleFactor();
@@ -47,7 +51,7 @@ private:
     void adjustScaleFactor(double recommendedScaleFactor);
     void updateDPI();
     void updateXResources();
-    void updateFirefoxDPI();
+    void updateFirefoxDPI(double scale);
     XsValue getSettingValue(QString prop);
     void setSettings(QVector<XsSetting> settings);
     QVector<XsSetting> getSettingsInSchema();
@@ -55,6 +59,8 @@ private:
     void setGSettingsByXProp(const QString &prop, XsValue value);
     void setSingleScaleFactor(double scale, bool emitSignal);
     void setScaleFactorForPlymouth(int factor, bool emitSignal);
+    void applyPlymouthScaleFactor(int factor);
+    void handlePlymouthScaleApplied();
     QString getPlymouthTheme(QString file);
     int getPlymouthThemeScaleFactor(QString theme);
     QString joinScreenScaleFactors(const ScaleFactors &factors);
@@ -69,12 +75,16 @@ private:
 private:
     DTK_CORE_NAMESPACE::DConfig *m_settingDconfig;
     QSharedPointer<QDBusInterface> m_greeterInterface;
-    QSharedPointer<QDBusInterface> m_sysDaemonInterface;
     // QVector<int> m_plymouthScalingTasks; //
     // bool m_plymouthScaling;              //
     // bool m_restartOSD;                   //
     XcbUtils &m_xcbUtils;
     DconfInfos m_dconfInfos;
+    XSettingsModel m_settingsModel;
+    XSettingsWriter m_settingsWriter;
+    bool m_scaleFactorDonePending;
+    // 工作线程会回调本对象，须最先析构
+    AppConfigUpdater m_appConfigUpdater;
 };
 
 #endif // XSETTINGSMANAGER_H
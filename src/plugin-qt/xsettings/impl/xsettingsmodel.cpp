@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "xsettingsmodel.h"
+
+#include <QDebug>
+
+XSettingsModel::XSettingsModel() { }
+
+void XSettingsModel::load(const QByteArray &datas)
+{
+    QByteArray buffer = datas;
+    m_dataInfo.reset(new XSDataInfo(buffer));
+
+    m_items.clear();
+    for (const auto &item : m_dataInfo->getItems()) {
+        m_items.insert(item->getHeadName(), item);
+    }
+}
+
+bool XSettingsModel::isLoaded() const
+{
+    return !m_dataInfo.isNull();
+}
+
+XsValue XSettingsModel::getValue(const QString &prop) const
+{
+    auto iter = m_items.constFind(prop);
+    if (iter == m_items.constEnd()) {
+        qDebug() << "get item null:" << prop;
+        return XsValue();
+    }
+    return iter.value()->getValue();
+}
+
+QString XSettingsModel::listProps() const
+{
+    if (m_dataInfo.isNull()) {
+        return "[]";
+    }
+    return m_dataInfo->listProps();
+}
+
+void XSettingsModel::applySettings(const QVector<XsSetting> &settings)
+{
+    if (m_dataInfo.isNull()) {
+        load(QByteArray());
+    }
+
+    for (const auto &xsettingItem : settings) {
+        auto iter = m_items.find(xsettingItem.prop);
+        if (iter != m_items.end()) {
+            qDebug() << "setSettings modify:" << xsettingItem.prop;
+            iter.value()->modifyProperty(xsettingItem);
+            continue;
+        }
+
+        QSharedPointer<XSItemInfo> xSItemInfo(new XSItemInfo(xsettingItem.prop, xsettingItem.value));
+        m_dataInfo->inserItem(xSItemInfo);
+        m_dataInfo->increaseNumSettings();
+        m_items.insert(xsettingItem.prop, xSItemInfo);
+    }
+}
+
+// 每次写入属性只增加一次 serial，与期间修改了多少项无关
+void XSettingsModel::increaseSerial()
+{
+    if (m_dataInfo.isNull()) {
+        load(QByteArray());
+    }
+    m_dataInfo->increaseSerial();
+}
+
+QByteArray XSettingsModel::marshalSettingData() const
+{
+    if (m_dataInfo.isNull()) {
+        return QByteArray();
+    }
+    return m_dataInfo->marshalSettingData();
+}
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef XSETTINGSMODEL_H
+#define XSETTINGSMODEL_H
+
+#include "xsdatainfo.h"
+
+#include <QHash>
+#include <QSharedPointer>
+#include <QVector>
+
+// _XSETTINGS_SETTINGS 属性的内存模型
+// 本进程是 _XSETTINGS_S0 的持有者，也是该属性唯一的写入者，因此读操作直接由内存中的
+// 数据应答，只有在属性被外部修改（PropertyNotify）时才需要重新从 X 读取
+class XSettingsModel
+{
+public:
+    XSettingsModel();
+
+    void load(const QByteArray &datas);
+    bool isLoaded() const;
+    XsValue getValue(const QString &prop) const;
+    QString listProps() const;
+    void applySettings(const QVector<XsSetting> &settings);
+    void increaseSerial();
+    QByteArray marshalSettingData() const;
+
+private:
+    QSharedPointer<XSDataInfo> m_dataInfo;
+    QHash<QString, QSharedPointer<XSItemInfo>> m_items;
+};
+
+#endif // XSETTINGSMODEL_H
@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "xsettingswriter.h"
+
+#include <QDebug>
+
+const static int DEFAULT_COALESCE_INTERVAL = 20;
+
+XSettingsWriter::Transaction::Transaction(XSettingsWriter &writer)
+    : m_writer(writer)
+{
+    m_writer.beginTransaction();
+}
+
+XSettingsWriter::Transaction::~Transaction()
+{
+    m_writer.commitTransaction();
+}
+
+XSettingsWriter::XSettingsWriter(XSettingsModel &model, WriteFunc writeFunc, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+    , m_writeFunc(writeFunc)
+    , m_transactionDepth(0)
+    , m_dirty(false)
+{
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(DEFAULT_COALESCE_INTERVAL);
+    connect(&m_flushTimer, &QTimer::timeout, this, &XSettingsWriter::flush);
+}
+
+XSettingsWriter::~XSettingsWriter()
+{
+    flush();
+}
+
+void XSettingsWriter::setCoalesceInterval(int msec)
+{
+    m_flushTimer.setInterval(msec);
+}
+
+void XSettingsWriter::beginTransaction()
+{
+    m_transactionDepth++;
+}
+
+void XSettingsWriter::commitTransaction()
+{
+    if (m_transactionDepth <= 0) {
+        qWarning() << "commit xsettings transaction without begin";
+        return;
+    }
+    m_transactionDepth--;
+    if (m_transactionDepth == 0) {
+        flush();
+    }
+}
+
+void XSettingsWriter::setSettings(const QVector<XsSetting> &settings)
+{
+    if (settings.isEmpty()) {
+        return;
+    }
+
+    // 内存模型立即更新，保证随后的读操作拿到最新值
+    m_model.applySettings(settings);
+    m_dirty = true;
+
+    // 窗口从第一次修改开始计时，持续的修改不会无限推迟写入
+    if (m_transactionDepth == 0 && !m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+bool XSettingsWriter::hasPendingWrite() const
+{
+    return m_dirty;
+}
+
+void XSettingsWriter::flush()
+{
+    m_flushTimer.stop();
+    if (!m_dirty) {
+        return;
+    }
+    m_dirty = false;
+
+    m_model.increaseSerial();
+    if (!m_writeFunc(m_model.marshalSettingData())) {
+        qWarning() << "write xsettings property failed";
+    }
+}
@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#ifndef XSETTINGSWRITER_H
+#define XSETTINGSWRITER_H
+
+#include "xsettingsmodel.h"
+
+#include <QObject>
+#include <QTimer>
+
+#include <functional>
+
+// 合并 _XSETTINGS_SETTINGS 的写入
+// 所有 XSETTINGS 客户端在属性变化时都会重新解析整个属性，因此短时间内的多次修改
+// （如切换主题时逐个 key 的 dconfig 回调）合并为一次写入、一次 serial 增加
+class XSettingsWriter : public QObject
+{
+    Q_OBJECT
+public:
+    typedef std::function<bool(const QByteArray &)> WriteFunc;
+
+    // 作用域内的修改在析构时一次性写入
+    class Transaction
+    {
+    public:
+        explicit Transaction(XSettingsWriter &writer);
+        ~Transaction();
+
+    private:
+        XSettingsWriter &m_writer;
+    };
+
+    XSettingsWriter(XSettingsModel &model, WriteFunc writeFunc, QObject *parent = nullptr);
+    ~XSettingsWriter();
+
+    void setCoalesceInterval(int msec);
+    void beginTransaction();
+    void commitTransaction();
+    void setSettings(const QVector<XsSetting> &settings);
+    bool hasPendingWrite() const;
+
+public Q_SLOTS:
+    void flush();
+
+private:
+    XSettingsModel &m_model;
+    WriteFunc m_writeFunc;
+    QTimer m_flushTimer;
+    int m_transactionDepth;
+    bool m_dirty;
+};
+
+#endif // XSETTINGSWRITER_H
@@ -4,7 +4,7 @@
 #include "keyfile.h"
 
 #include <QDebug>
-#include <QRegularExpression>
+#include <QStringView>
 
 KeyFile::KeyFile(char separtor)
     : modified(false)
@@ -112,53 +112,69 @@ bool KeyFile::loadFile(const QString &filePath)
         fp.close();
     }
 
-    QString lastSection;
     fp.setFileName(filePath);
 
     if (!fp.open(QIODevice::ReadOnly)) {
         return false;
     }
 
-    QString line;
-    while (!fp.atEnd()) {
-        line = fp.readLine();
-        // 移除行首空行
-        line.replace(QRegularExpression("^ +"), "");
-        if (line.front() == '#') {
+    QByteArray data = fp.readAll();
+    fp.close();
+
+    return parseData(data, mainKeyMap);
+}
+
+bool KeyFile::parseData(const QByteArray &data, MainKeyMap &keyMap)
+{
+    const QString content = QString::fromUtf8(data);
+    QStringView rest(content);
+    QString lastSection;
+    MainKeyMap::iterator sectionIter = keyMap.end();
+
+    while (!rest.isEmpty()) {
+        const qsizetype lineEnd = rest.indexOf(u'\n');
+        QStringView line = lineEnd == -1 ? rest : rest.left(lineEnd);
+        rest = lineEnd == -1 ? QStringView() : rest.mid(lineEnd + 1);
+
+        // 移除行首空格
+        qsizetype start = 0;
+        while (start < line.size() && line[start] == u' ') {
+            start++;
+        }
+        line = line.mid(start);
+        if (line.isEmpty() || line.front() == u'#') {
             continue;
         }
 
-        line.replace(QRegularExpression("\\t$"), "");
-        line.replace(QRegularExpression("\\r$"), "");
-        line.replace(QRegularExpression("\\n$"), "");
+        // 依次移除行尾的一个制表符和一个回车符
+        if (line.endsWith(u'\t')) {
+            line.chop(1);
+        }
+        if (line.endsWith(u'\r')) {
+            line.chop(1);
+        }
 
-        int lPos = line.indexOf('[');
-        int rPos = line.indexOf(']');
-        if (lPos != -1 && rPos != -1 && rPos > lPos && lPos == 0 && rPos + 1 == line.size()) {
+        const qsizetype rPos = line.indexOf(u']');
+        if (line.startsWith(u'[') && rPos != -1 && rPos + 1 == line.size()) {
             // 主键
-            QString section = line.mid(lPos + 1, line.size() - 2);
-            mainKeyMap.insert(section, KeyMap());
-            lastSection = section;
-        } else {
-            int index = line.indexOf('=');
-            if (index == -1) {
-                continue;
-            }
-
-            // 文件格式错误
-            if (lastSection.isEmpty()) {
-                return false;
-            }
-
-            // 子键
-            QString key = line.mid(0, index);
-            QString value = line.mid(index + 1, line.length() - index - 1);
-            if (mainKeyMap.count(lastSection) == 1) {
-                mainKeyMap[lastSection][key] = value;
-            }
+            lastSection = line.mid(1, line.size() - 2).toString();
+            sectionIter = keyMap.insert(lastSection, KeyMap());
+            continue;
+        }
+
+        const qsizetype index = line.indexOf(u'=');
+        if (index == -1) {
+            continue;
+        }
+
+        // 文件格式错误
+        if (lastSection.isEmpty()) {
+            return false;
         }
+
+        // 子键
+        sectionIter->insert(line.left(index).toString(), line.mid(index + 1).toString());
     }
-    fp.close();
 
     return true;
 }
@@ -30,6 +30,9 @@ public:
     bool loadFile(const QString &filePath);
     QStringList getMainKeys();
 
+    // 单次扫描解析 ini 格式内容，不使用正则
+    static bool parseData(const QByteArray &data, MainKeyMap &keyMap);
+
     // for test
     void print();
 
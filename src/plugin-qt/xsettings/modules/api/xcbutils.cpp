@@ -3,6 +3,9 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #include "xcbutils.h"
 
+#include <QHash>
+#include <QSocketNotifier>
+
 #include <X11/X.h>
 #include <X11/Xatom.h>
 #include <X11/Xlib.h>
@@ -23,6 +26,17 @@ XcbUtils &XcbUtils::getInstance()
 
 XcbUtils::XcbUtils(QObject *parent)
     : QObject(parent)
+    , window(XCB_WINDOW_NONE)
+    , settingsAtom(XCB_ATOM_NONE)
+    , pendingSettingWrites(0)
+    , eventNotifier(nullptr)
+    , randrFirstEvent(0)
+    , randrVersionQueried(false)
+    , randrMajorVersion(0)
+    , randrMinorVersion(0)
+    , outputsChanged(false)
+    , probeOutputs(false)
+    , monitorSizeInfosValid(false)
 {
     connection = xcb_connect(nullptr, nullptr);
     if (!connection) {
@@ -38,6 +52,96 @@ XcbUtils::XcbUtils(QObject *parent)
         qWarning() << "owned _XSETTINGS_S0 failed";
         return;
     }
+    watchSettingWindow();
+    watchRandrEvents();
+}
+
+// 监听设置窗口的 PropertyNotify，用于感知 _XSETTINGS_SETTINGS 的外部修改
+void XcbUtils::watchSettingWindow()
+{
+    settingsAtom = getAtom("_XSETTINGS_SETTINGS");
+
+    const uint32_t eventMask = XCB_EVENT_MASK_PROPERTY_CHANGE;
+    xcb_change_window_attributes(connection, window, XCB_CW_EVENT_MASK, &eventMask);
+    xcb_flush(connection);
+
+    eventNotifier = new QSocketNotifier(xcb_get_file_descriptor(connection), QSocketNotifier::Read, this);
+    connect(eventNotifier, &QSocketNotifier::activated, this, &XcbUtils::handleXcbEvents);
+}
+
+// 显示器信息缓存依赖 RandR 通知失效，热插拔、分辨率变化时才重新查询
+void XcbUtils::watchRandrEvents()
+{
+    const xcb_query_extension_reply_t *randr = xcb_get_extension_data(connection, &xcb_randr_id);
+    if (!randr || !randr->present) {
+        qWarning() << "randr extension is not present";
+        return;
+    }
+    // RandR 1.2 起才有 output/CRTC 通知，选择事件前须先协商版本
+    if (!queryRandrVersion() || (randrMajorVersion == 1 && randrMinorVersion < 2)) {
+        qWarning() << "randr version is lower than 1.2, monitor changes are not watched";
+        return;
+    }
+    randrFirstEvent = randr->first_event;
+
+    xcb_screen_t *screen = xcb_setup_roots_iterator(xcb_get_setup(connection)).data;
+    xcb_randr_select_input(connection, screen->root,
+                           XCB_RANDR_NOTIFY_MASK_SCREEN_CHANGE | XCB_RANDR_NOTIFY_MASK_OUTPUT_CHANGE | XCB_RANDR_NOTIFY_MASK_CRTC_CHANGE);
+    xcb_flush(connection);
+}
+
+// 与服务端协商 RandR 版本，只查询一次
+bool XcbUtils::queryRandrVersion()
+{
+    if (randrVersionQueried) {
+        return randrMajorVersion > 0;
+    }
+    randrVersionQueried = true;
+
+    xcb_randr_query_version_cookie_t cookie = xcb_randr_query_version(connection, XCB_RANDR_MAJOR_VERSION, XCB_RANDR_MINOR_VERSION);
+    xcb_randr_query_version_reply_t *reply = xcb_randr_query_version_reply(connection, cookie, nullptr);
+    if (!reply) {
+        qWarning() << "randr query version failed";
+        return false;
+    }
+    randrMajorVersion = reply->major_version;
+    randrMinorVersion = reply->minor_version;
+    free(reply);
+    qInfo() << QString("randr version %1.%2").arg(randrMajorVersion).arg(randrMinorVersion);
+    return randrMajorVersion > 0;
+}
+
+void XcbUtils::handleXcbEvents()
+{
+    xcb_generic_event_t *event = nullptr;
+    while ((event = xcb_poll_for_event(connection)) != nullptr) {
+        const uint8_t responseType = event->response_type & ~0x80;
+        if (randrFirstEvent != 0 && responseType == randrFirstEvent + XCB_RANDR_NOTIFY) {
+            auto notify = reinterpret_cast<xcb_randr_notify_event_t *>(event);
+            if (notify->subCode == XCB_RANDR_NOTIFY_OUTPUT_CHANGE) {
+                outputsChanged = true;
+            }
+            monitorSizeInfosValid = false;
+        } else if (randrFirstEvent != 0 && responseType == randrFirstEvent + XCB_RANDR_SCREEN_CHANGE_NOTIFY) {
+            // 热插拔后的首个屏幕变化：_current 可能仍是旧的 output 列表，下次查询重新探测
+            if (outputsChanged) {
+                outputsChanged = false;
+                probeOutputs = true;
+            }
+            monitorSizeInfosValid = false;
+        } else if (responseType == XCB_PROPERTY_NOTIFY) {
+            auto notify = reinterpret_cast<xcb_property_notify_event_t *>(event);
+            if (notify->window == window && notify->atom == settingsAtom) {
+                if (pendingSettingWrites > 0) {
+                    // 本进程自身写入产生的通知，内存模型已是最新
+                    pendingSettingWrites--;
+                } else {
+                    Q_EMIT settingPropChanged();
+                }
+            }
+        }
+        free(event);
+    }
 }
 
 xcb_window_t XcbUtils::createWindows()
@@ -184,51 +288,113 @@ QString XcbUtils::getXcbAtomName(xcb_atom_t atom)
 
 QList<XcbUtils::MonitorSizeInfo> XcbUtils::getMonitorSizeInfos()
 {
-    // 获取XCB版本信息
-    const xcb_setup_t *setup = xcb_get_setup(connection);
-    int majorVersion = setup->protocol_major_version;
-    int minorVersion = setup->protocol_minor_version;
-    qInfo() << QString("randr version %1.%2").arg(majorVersion).arg(minorVersion);
-    if (majorVersion < 1 || (majorVersion == 1 && minorVersion < 2)) {
+    // 没有事件监听时无法感知变化，不使用缓存
+    if (monitorSizeInfosValid && eventNotifier && randrFirstEvent != 0) {
+        return monitorSizeInfos;
+    }
+    // 先处理已到达的 RandR 通知，避免刚查询到的结果被旧通知置为失效
+    handleXcbEvents();
+    monitorSizeInfos = queryMonitorSizeInfos();
+    monitorSizeInfosValid = true;
+    return monitorSizeInfos;
+}
+
+// 获取屏幕的 output 和 crtc 列表，probe 为 true 时让服务端重新探测输出
+bool XcbUtils::fetchScreenResources(xcb_window_t root, bool probe, QVector<uint32_t> &outputs,
+                                    QVector<uint32_t> &crtcs, xcb_timestamp_t &configTimestamp)
+{
+    xcb_generic_error_t *error = nullptr;
+    if (probe) {
+        xcb_randr_get_screen_resources_cookie_t cookie = xcb_randr_get_screen_resources(connection, root);
+        xcb_randr_get_screen_resources_reply_t *resources = xcb_randr_get_screen_resources_reply(connection, cookie, &error);
+        if (error || !resources) {
+            qWarning() << "Error getting screen resources: " << (error ? error->error_code : 0);
+            free(error);
+            free(resources);
+            return false;
+        }
+        xcb_randr_output_t *outputData = xcb_randr_get_screen_resources_outputs(resources);
+        outputs = QVector<uint32_t>(outputData, outputData + xcb_randr_get_screen_resources_outputs_length(resources));
+        xcb_randr_crtc_t *crtcData = xcb_randr_get_screen_resources_crtcs(resources);
+        crtcs = QVector<uint32_t>(crtcData, crtcData + xcb_randr_get_screen_resources_crtcs_length(resources));
+        configTimestamp = resources->config_timestamp;
+        free(resources);
+        return true;
+    }
+
+    // 使用 _current 版本，不会触发显卡对输出的重新探测
+    xcb_randr_get_screen_resources_current_cookie_t cookie = xcb_randr_get_screen_resources_current(connection, root);
+    xcb_randr_get_screen_resources_current_reply_t *resources = xcb_randr_get_screen_resources_current_reply(connection, cookie, &error);
+    if (error || !resources) {
+        qWarning() << "Error getting current screen resources: " << (error ? error->error_code : 0);
+        free(error);
+        free(resources);
+        return false;
+    }
+    xcb_randr_output_t *outputData = xcb_randr_get_screen_resources_current_outputs(resources);
+    outputs = QVector<uint32_t>(outputData, outputData + xcb_randr_get_screen_resources_current_outputs_length(resources));
+    xcb_randr_crtc_t *crtcData = xcb_randr_get_screen_resources_current_crtcs(resources);
+    crtcs = QVector<uint32_t>(crtcData, crtcData + xcb_randr_get_screen_resources_current_crtcs_length(resources));
+    configTimestamp = resources->config_timestamp;
+    free(resources);
+    return true;
+}
+
+QList<XcbUtils::MonitorSizeInfo> XcbUtils::queryMonitorSizeInfos()
+{
+    if (!queryRandrVersion() || (randrMajorVersion == 1 && randrMinorVersion < 2)) {
         return {};
     }
+    const xcb_setup_t *setup = xcb_get_setup(connection);
     xcb_screen_iterator_t screen_iter = xcb_setup_roots_iterator(setup);
     xcb_window_t root = screen_iter.data->root;
-    xcb_randr_get_screen_resources_cookie_t cookie = xcb_randr_get_screen_resources(connection, root);
-    xcb_generic_error_t *error = nullptr;
-    xcb_randr_get_screen_resources_reply_t *resources = xcb_randr_get_screen_resources_reply(connection, cookie, &error);
-    if (error) {
-        qWarning() << "Error getting screen resources: " << error->error_code;
-        free(error);
+
+    // GetScreenResourcesCurrent 需要 RandR 1.3
+    const bool probe = probeOutputs || (randrMajorVersion == 1 && randrMinorVersion < 3);
+    QVector<uint32_t> outputs;
+    QVector<uint32_t> crtcs;
+    xcb_timestamp_t configTimestamp = XCB_CURRENT_TIME;
+    if (!fetchScreenResources(root, probe, outputs, crtcs, configTimestamp)) {
         return {};
     }
+    probeOutputs = false;
+    const int output_count = outputs.size();
+    const int crtc_count = crtcs.size();
 
-    xcb_randr_output_t *outputs = xcb_randr_get_screen_resources_outputs(resources);
-    int output_count = xcb_randr_get_screen_resources_outputs_length(resources);
-    QList<MonitorSizeInfo> monitors;
+    // 一次性发出全部 output 和 crtc 请求，再统一收取应答，多个显示器只需一次往返
+    QVector<xcb_randr_get_output_info_cookie_t> outputCookies;
+    outputCookies.reserve(output_count);
     for (int i = 0; i < output_count; i++) {
-        xcb_randr_output_t output = outputs[i];
-        xcb_randr_get_output_info_cookie_t info_cookie = xcb_randr_get_output_info(connection, output, resources->config_timestamp);
+        outputCookies.push_back(xcb_randr_get_output_info(connection, outputs[i], configTimestamp));
+    }
+    QVector<xcb_randr_get_crtc_info_cookie_t> crtcCookies;
+    crtcCookies.reserve(crtc_count);
+    for (int i = 0; i < crtc_count; i++) {
+        crtcCookies.push_back(xcb_randr_get_crtc_info(connection, crtcs[i], configTimestamp));
+    }
+
+    QHash<xcb_randr_crtc_t, xcb_randr_get_crtc_info_reply_t *> crtcInfos;
+    for (int i = 0; i < crtc_count; i++) {
+        xcb_randr_get_crtc_info_reply_t *crtc_info = xcb_randr_get_crtc_info_reply(connection, crtcCookies[i], nullptr);
+        if (crtc_info) {
+            crtcInfos.insert(crtcs[i], crtc_info);
+        }
+    }
 
-        xcb_randr_get_output_info_reply_t *output_info = xcb_randr_get_output_info_reply(connection, info_cookie, nullptr);
+    QList<MonitorSizeInfo> monitors;
+    for (int i = 0; i < output_count; i++) {
+        xcb_randr_get_output_info_reply_t *output_info = xcb_randr_get_output_info_reply(connection, outputCookies[i], nullptr);
 
         if (!output_info)
             continue;
 
         // 检查输出是否连接
-        if (output_info->connection != XCB_RANDR_CONNECTION_CONNECTED) {
+        if (output_info->connection != XCB_RANDR_CONNECTION_CONNECTED || output_info->crtc == XCB_NONE) {
             free(output_info);
             continue;
         }
 
-        if (output_info->crtc == XCB_NONE) {
-            free(output_info);
-            continue;
-        }
-        xcb_randr_get_crtc_info_cookie_t crtc_cookie = xcb_randr_get_crtc_info(connection, output_info->crtc, resources->config_timestamp);
-
-        xcb_randr_get_crtc_info_reply_t *crtc_info = xcb_randr_get_crtc_info_reply(connection, crtc_cookie, nullptr);
-
+        xcb_randr_get_crtc_info_reply_t *crtc_info = crtcInfos.value(output_info->crtc, nullptr);
         if (crtc_info) {
             MonitorSizeInfo monitor;
             monitor.width = crtc_info->width;
@@ -237,14 +403,14 @@ QList<XcbUtils::MonitorSizeInfo> XcbUtils::getMonitorSizeInfos()
             monitor.mmHeight = output_info->mm_height;
 
             monitors.push_back(monitor);
-
-            free(crtc_info);
         }
 
         free(output_info);
     }
 
-    free(resources);
+    for (auto crtc_info : crtcInfos) {
+        free(crtc_info);
+    }
     return monitors;
 }
 
@@ -306,7 +472,7 @@ bool XcbUtils::changeSettingProp(QByteArray data)
 {
     xcb_void_cookie_t cookie;
     xcb_generic_error_t *err;
-    xcb_atom_t atom = getAtom("_XSETTINGS_SETTINGS");
+    xcb_atom_t atom = settingsAtom != XCB_ATOM_NONE ? settingsAtom : getAtom("_XSETTINGS_SETTINGS");
     if (atom == 0) {
         return false;
     }
@@ -314,14 +480,23 @@ bool XcbUtils::changeSettingProp(QByteArray data)
     err = xcb_request_check(connection, cookie);
     if (err) {
         qWarning() << "xcb change setting prop failed," << err->error_code;
+        free(err);
         return false;
     }
+    if (eventNotifier) {
+        pendingSettingWrites++;
+        // xcb_request_check 可能已将 PropertyNotify 读入 xcb 内部队列，套接字上不会再有可读事件
+        QMetaObject::invokeMethod(this, &XcbUtils::handleXcbEvents, Qt::QueuedConnection);
+    }
     return true;
 }
 
 void XcbUtils::updateXResources(QVector<QPair<QString, QString>> xresourceInfos)
 {
-    QString datas = getXResources();
+    char *res = getXResources();
+    const QString oldDatas = res;
+    free(res);
+    QString datas = oldDatas;
 
     if (datas.isEmpty()) {
         xresourceInfos.push_back(qMakePair(QString("*customization"), QString("-color")));
@@ -344,8 +519,12 @@ void XcbUtils::updateXResources(QVector<QPair<QString, QString>> xresourceInfos)
     }
 
     datas = XcbUtils::marshalXResources(xresourceInfos);
+    if (datas == oldDatas) {
+        return;
+    }
 
-    XcbUtils::setXResources(const_cast<char *>(datas.toStdString().c_str()), datas.length());
+    const QByteArray bytes = datas.toUtf8();
+    XcbUtils::setXResources(const_cast<char *>(bytes.constData()), bytes.length());
 }
 
 char *XcbUtils::getXResources()
@@ -10,6 +10,8 @@
 #include <QObject>
 #include <QVector>
 
+class QSocketNotifier;
+
 class XcbUtils : public QObject
 {
     Q_OBJECT
@@ -38,14 +40,38 @@ public:
     QString getXcbAtomName(xcb_atom_t atom);
     QList<MonitorSizeInfo> getMonitorSizeInfos();
 
+Q_SIGNALS:
+    // _XSETTINGS_SETTINGS 被其他客户端修改，本进程自身的写入不会触发
+    void settingPropChanged();
+
+private Q_SLOTS:
+    void handleXcbEvents();
+
 private:
     XcbUtils(QObject *parent = nullptr);
+    void watchSettingWindow();
+    void watchRandrEvents();
+    bool queryRandrVersion();
+    QList<MonitorSizeInfo> queryMonitorSizeInfos();
+    bool fetchScreenResources(xcb_window_t root, bool probe, QVector<uint32_t> &outputs,
+                              QVector<uint32_t> &crtcs, xcb_timestamp_t &configTimestamp);
     XcbUtils(const XcbUtils &) = delete;
     XcbUtils &operator=(const XcbUtils &) = delete;
 
 private:
     xcb_connection_t *connection;
     xcb_window_t window;
+    xcb_atom_t settingsAtom;
+    int pendingSettingWrites;
+    QSocketNotifier *eventNotifier;
+    uint8_t randrFirstEvent;
+    bool randrVersionQueried;
+    uint32_t randrMajorVersion;
+    uint32_t randrMinorVersion;
+    bool outputsChanged;
+    bool probeOutputs;
+    bool monitorSizeInfosValid;
+    QList<MonitorSizeInfo> monitorSizeInfos;
 };
 
 #endif // XCBUTILS_H
@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "impl/appconfigupdater.h"
+
+#include <QMutex>
+#include <QSemaphore>
+#include <QtTest>
+
+class AppConfigUpdaterTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void rapidChangesWriteOncePerTarget();
+    void changesDuringApplyAreCoalesced();
+    void pendingChangesApplyOnDestruction();
+};
+
+namespace {
+struct Recorder
+{
+    QMutex mutex;
+    QHash<QString, QVariantList> writes;
+
+    AppConfigUpdater::ApplyFunc target(const QString &name)
+    {
+        return [this, name](const QVariant &value) {
+            QMutexLocker locker(&mutex);
+            writes[name].append(value);
+        };
+    }
+};
+} // namespace
+
+void AppConfigUpdaterTest::rapidChangesWriteOncePerTarget()
+{
+    Recorder recorder;
+    AppConfigUpdater updater;
+    updater.addTarget("xresources", recorder.target("xresources"));
+    updater.addTarget("firefox", recorder.target("firefox"));
+    updater.addTarget("plymouth", recorder.target("plymouth"));
+
+    // 模拟拖动缩放滑块：1.0 到 3.0 之间连续变化
+    const int steps = 50;
+    for (int i = 0; i <= steps; i++) {
+        const double scale = 1.0 + 2.0 * i / steps;
+        updater.submit("xresources", QString("Xft.dpi:\t%1").arg(int(96 * scale)));
+        updater.submit("firefox", scale);
+        updater.submit("plymouth", scale >= 1.7 ? 2 : 1);
+    }
+    QVERIFY(updater.waitForIdle(5000));
+
+    QMutexLocker locker(&recorder.mutex);
+    QCOMPARE(recorder.writes.size(), 3);
+    QCOMPARE(recorder.writes["xresources"], QVariantList{ QString("Xft.dpi:\t288") });
+    QCOMPARE(recorder.writes["firefox"], QVariantList{ 3.0 });
+    QCOMPARE(recorder.writes["plymouth"], QVariantList{ 2 });
+}
+
+void AppConfigUpdaterTest::changesDuringApplyAreCoalesced()
+{
+    QSemaphore started;
+    QSemaphore release;
+    QMutex mutex;
+    QVariantList writes;
+
+    AppConfigUpdater updater;
+    updater.setCoalesceInterval(0);
+    updater.addTarget("firefox", [&](const QVariant &value) {
+        {
+            QMutexLocker locker(&mutex);
+            writes.append(value);
+        }
+        started.release();
+        release.acquire();
+    });
+
+    updater.submit("firefox", 1.0);
+    QVERIFY(started.tryAcquire(1, 5000));
+
+    // 第一次写入尚未完成时的修改只保留最后一个
+    for (int i = 0; i < 20; i++) {
+        updater.submit("firefox", 1.25 + i * 0.05);
+    }
+    release.release();
+    QVERIFY(started.tryAcquire(1, 5000));
+    release.release();
+    QVERIFY(updater.waitForIdle(5000));
+
+    QMutexLocker locker(&mutex);
+    QCOMPARE(writes.size(), 2);
+    QCOMPARE(writes.first().toDouble(), 1.0);
+    QCOMPARE(writes.last().toDouble(), 1.25 + 19 * 0.05);
+}
+
+void AppConfigUpdaterTest::pendingChangesApplyOnDestruction()
+{
+    Recorder recorder;
+    {
+        AppConfigUpdater updater;
+        updater.setCoalesceInterval(60000);
+        updater.addTarget("firefox", recorder.target("firefox"));
+        updater.submit("firefox", 1.5);
+        updater.submit("firefox", 2.0);
+    }
+    QCOMPARE(recorder.writes["firefox"], QVariantList{ 2.0 });
+}
+
+QTEST_GUILESS_MAIN(AppConfigUpdaterTest)
+
+#include "tst_appconfigupdater.moc"
@@ -0,0 +1,217 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "modules/api/keyfile.h"
+
+#include <QBuffer>
+#include <QDirIterator>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace {
+// 基于正则的原实现，作为对照
+bool legacyParse(const QByteArray &data, MainKeyMap &mainKeyMap)
+{
+    QBuffer fp;
+    fp.setData(data);
+    fp.open(QIODevice::ReadOnly);
+
+    QString lastSection;
+    QString line;
+    while (!fp.atEnd()) {
+        line = fp.readLine();
+        line.replace(QRegularExpression("^ +"), "");
+        // 原实现对空行调用 front() 属于未定义行为，这里按跳过处理
+        if (line.isEmpty() || line.front() == '#') {
+            continue;
+        }
+
+        line.replace(QRegularExpression("\\t$"), "");
+        line.replace(QRegularExpression("\\r$"), "");
+        line.replace(QRegularExpression("\\n$"), "");
+
+        int lPos = line.indexOf('[');
+        int rPos = line.indexOf(']');
+        if (lPos != -1 && rPos != -1 && rPos > lPos && lPos == 0 && rPos + 1 == line.size()) {
+            QString section = line.mid(lPos + 1, line.size() - 2);
+            mainKeyMap.insert(section, KeyMap());
+            lastSection = section;
+        } else {
+            int index = line.indexOf('=');
+            if (index == -1) {
+                continue;
+            }
+            if (lastSection.isEmpty()) {
+                return false;
+            }
+            QString key = line.mid(0, index);
+            QString value = line.mid(index + 1, line.length() - index - 1);
+            if (mainKeyMap.count(lastSection) == 1) {
+                mainKeyMap[lastSection][key] = value;
+            }
+        }
+    }
+    return true;
+}
+
+void compareWithLegacy(const QByteArray &data)
+{
+    MainKeyMap expected;
+    MainKeyMap actual;
+    const bool expectedOk = legacyParse(data, expected);
+    const bool actualOk = KeyFile::parseData(data, actual);
+    if (expectedOk != actualOk || expected != actual) {
+        qWarning() << "mismatched input:" << data;
+    }
+    QCOMPARE(actualOk, expectedOk);
+    QCOMPARE(actual, expected);
+}
+} // namespace
+
+class KeyFileTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void parsesCommonLayout();
+    void edgeCasesMatchLegacy_data();
+    void edgeCasesMatchLegacy();
+    void shippedFilesMatchLegacy();
+    void fuzzMatchesLegacy();
+    void saveLoadRoundTrip();
+};
+
+void KeyFileTest::initTestCase()
+{
+    QLoggingCategory::setFilterRules(QStringLiteral("*.debug=false"));
+}
+
+void KeyFileTest::parsesCommonLayout()
+{
+    const QByteArray data = "# qt-theme.ini\n"
+                            "[Theme]\n"
+                            "  ScreenScaleFactors=1.25\r\n"
+                            "ScaleLogicalDpi=-1,-1\t\n"
+                            "IconThemeName=bloom\n"
+                            "\n"
+                            "[Daemon]\n"
+                            "Theme=deepin-logo";
+    MainKeyMap keyMap;
+    QVERIFY(KeyFile::parseData(data, keyMap));
+    QCOMPARE(keyMap.keys(), (QStringList{ "Daemon", "Theme" }));
+    QCOMPARE(keyMap["Theme"]["ScreenScaleFactors"], QString("1.25"));
+    QCOMPARE(keyMap["Theme"]["ScaleLogicalDpi"], QString("-1,-1"));
+    QCOMPARE(keyMap["Theme"]["IconThemeName"], QString("bloom"));
+    QCOMPARE(keyMap["Daemon"]["Theme"], QString("deepin-logo"));
+}
+
+void KeyFileTest::edgeCasesMatchLegacy_data()
+{
+    QTest::addColumn<QByteArray>("data");
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("key before section") << QByteArray("a=b\n[s]\n");
+    QTest::newRow("empty section name") << QByteArray("[]\na=b\n");
+    QTest::newRow("repeated section resets") << QByteArray("[s]\na=1\n[t]\nb=2\n[s]\nc=3\n");
+    QTest::newRow("tab then cr") << QByteArray("[s]\na=1\t\r\nb=2\r\t\n");
+    QTest::newRow("double trailing tab") << QByteArray("[s]\na=1\t\t\n");
+    QTest::newRow("value with equals") << QByteArray("[s]\nExec=env A=B app --x=y\n");
+    QTest::newRow("leading tab kept") << QByteArray("[s]\n\ta=1\n  \tb=2\n");
+    QTest::newRow("indented comment") << QByteArray("[s]\n   # a=1\n#b=2\n");
+    QTest::newRow("bracket in value") << QByteArray("[s]\na=[x]\n[x]y]\n[a]b]\n");
+    QTest::newRow("spaces only") << QByteArray("[s]\n   \n   ");
+    QTest::newRow("utf8") << QByteArray("[主题]\n名称=深色\n");
+    QTest::newRow("no trailing newline") << QByteArray("[s]\na=1\t");
+    QTest::newRow("lone cr") << QByteArray("[s]\r\na=1\r\r\n");
+}
+
+void KeyFileTest::edgeCasesMatchLegacy()
+{
+    QFETCH(QByteArray, data);
+    compareWithLegacy(data);
+}
+
+void KeyFileTest::shippedFilesMatchLegacy()
+{
+    int count = 0;
+    QDirIterator it(SOURCE_ROOT_DIR,
+                    { "*.ini", "*.conf", "*.service", "*.desktop", "*.in" },
+                    QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QFile file(it.next());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        compareWithLegacy(file.readAll());
+        count++;
+    }
+    QVERIFY(count > 0);
+}
+
+void KeyFileTest::fuzzMatchesLegacy()
+{
+    static const char alphabet[] = { ' ', ' ', '#', '[', ']', '=', '=', '\t', '\r', '\n', '\n', 'a', 'b', 'K' };
+    QRandomGenerator generator(20260418);
+
+    for (int round = 0; round < 5000; round++) {
+        QByteArray data;
+        const int length = generator.bounded(64);
+        for (int i = 0; i < length; i++) {
+            data.append(alphabet[generator.bounded(int(sizeof(alphabet)))]);
+        }
+        // 让大多数输入拥有合法的节，以覆盖子键分支
+        if (generator.bounded(4) != 0) {
+            data.prepend("[s]\n");
+        }
+        compareWithLegacy(data);
+        if (QTest::currentTestFailed()) {
+            return;
+        }
+    }
+}
+
+void KeyFileTest::saveLoadRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("qt-theme.ini");
+    QRandomGenerator generator(42);
+
+    for (int round = 0; round < 200; round++) {
+        KeyFile keyFile;
+        MainKeyMap expected;
+        const int sections = 1 + generator.bounded(4);
+        for (int s = 0; s < sections; s++) {
+            const QString section = QString("Section%1").arg(s);
+            const int keys = generator.bounded(6);
+            expected.insert(section, KeyMap());
+            for (int k = 0; k < keys; k++) {
+                const QString key = QString("Key%1").arg(k);
+                const QString value = QString("v %1,%2;[x]=y").arg(generator.bounded(1000)).arg(round);
+                keyFile.setKey(section, key, value);
+                expected[section][key] = value;
+            }
+            if (keys == 0) {
+                keyFile.setKey(section, "Empty", "");
+                expected[section]["Empty"] = "";
+            }
+        }
+        QVERIFY(keyFile.saveToFile(path));
+
+        KeyFile loaded;
+        QVERIFY(loaded.loadFile(path));
+        QCOMPARE(loaded.getMainKeys(), expected.keys());
+        for (auto sectionIter = expected.cbegin(); sectionIter != expected.cend(); ++sectionIter) {
+            for (auto keyIter = sectionIter->cbegin(); keyIter != sectionIter->cend(); ++keyIter) {
+                QVERIFY(loaded.containKey(sectionIter.key(), keyIter.key()));
+                QCOMPARE(loaded.getStr(sectionIter.key(), keyIter.key()), keyIter.value());
+            }
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(KeyFileTest)
+
+#include "tst_keyfile.moc"
@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "impl/xsdatainfo.h"
+#include "impl/xsettingsmodel.h"
+
+#include <QtTest>
+
+namespace {
+// 由 X 服务器上真实的 _XSETTINGS_SETTINGS 属性格式构造：
+// Net/ThemeName="deepin", Xft/DPI=98304, Gdk/WindowScalingFactor=1,
+// Qt/ActiveColor=(0,33023,65535,65535), Gtk/FontName="Noto Sans,10.5"
+const char settingsBlob[] =
+    "\x00\x00\x00\x00\x07\x00\x00\x00\x05\x00\x00\x00\x01\x00\x0d\x00\x4e\x65\x74\x2f\x54\x68\x65\x6d\x65\x4e\x61\x6d\x65\x00\x00\x00"
+    "\x03\x00\x00\x00\x06\x00\x00\x00\x64\x65\x65\x70\x69\x6e\x00\x00\x00\x00\x07\x00\x58\x66\x74\x2f\x44\x50\x49\x00\x02\x00\x00\x00"
+    "\x00\x80\x01\x00\x00\x00\x17\x00\x47\x64\x6b\x2f\x57\x69\x6e\x64\x6f\x77\x53\x63\x61\x6c\x69\x6e\x67\x46\x61\x63\x74\x6f\x72\x00"
+    "\x01\x00\x00\x00\x01\x00\x00\x00\x02\x00\x0e\x00\x51\x74\x2f\x41\x63\x74\x69\x76\x65\x43\x6f\x6c\x6f\x72\x00\x00\x05\x00\x00\x00"
+    "\x00\x00\xff\x80\xff\xff\xff\xff\x01\x00\x0c\x00\x47\x74\x6b\x2f\x46\x6f\x6e\x74\x4e\x61\x6d\x65\x01\x00\x00\x00\x0e\x00\x00\x00"
+    "\x4e\x6f\x74\x6f\x20\x53\x61\x6e\x73\x2c\x31\x30\x2e\x35\x00\x00";
+
+QByteArray fixture()
+{
+    return QByteArray(settingsBlob, sizeof(settingsBlob) - 1);
+}
+
+const QStringList fixtureProps = { "Net/ThemeName", "Xft/DPI", "Gdk/WindowScalingFactor", "Qt/ActiveColor", "Gtk/FontName" };
+
+XsValue decodeValue(const QByteArray &blob, const QString &prop)
+{
+    QByteArray datas = blob;
+    XSDataInfo info(datas);
+    QSharedPointer<XSItemInfo> item = info.getPropItem(prop);
+    return item.isNull() ? XsValue() : item->getValue();
+}
+} // namespace
+
+class XSettingsModelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void readsMatchDecodePath();
+    void listPropsMatchesDecodePath();
+    void unknownPropReturnsEmptyValue();
+    void appliedSettingsRoundTrip();
+    void emptyPropertyStartsEmptyModel();
+};
+
+void XSettingsModelTest::initTestCase()
+{
+    QLoggingCategory::setFilterRules(QStringLiteral("*.debug=false"));
+}
+
+void XSettingsModelTest::readsMatchDecodePath()
+{
+    XSettingsModel model;
+    model.load(fixture());
+    QVERIFY(model.isLoaded());
+
+    for (const QString &prop : fixtureProps) {
+        QCOMPARE(model.getValue(prop), decodeValue(fixture(), prop));
+    }
+    QCOMPARE(std::get<QString>(model.getValue("Net/ThemeName")), QString("deepin"));
+    QCOMPARE(std::get<int>(model.getValue("Xft/DPI")), 98304);
+    QCOMPARE(std::get<ColorValueInfo>(model.getValue("Qt/ActiveColor")), (ColorValueInfo{ 0, 33023, 65535, 65535 }));
+    QCOMPARE(std::get<QString>(model.getValue("Gtk/FontName")), QString("Noto Sans,10.5"));
+}
+
+void XSettingsModelTest::listPropsMatchesDecodePath()
+{
+    XSettingsModel model;
+    model.load(fixture());
+
+    QByteArray datas = fixture();
+    XSDataInfo info(datas);
+    QCOMPARE(model.listProps(), info.listProps());
+}
+
+void XSettingsModelTest::unknownPropReturnsEmptyValue()
+{
+    XSettingsModel model;
+    model.load(fixture());
+    QCOMPARE(model.getValue("Net/Unknown").index(), XsValue().index());
+    QCOMPARE(std::get<int>(model.getValue("Net/Unknown")), 0);
+}
+
+void XSettingsModelTest::appliedSettingsRoundTrip()
+{
+    XSettingsModel model;
+    model.load(fixture());
+
+    XsSetting dpi{ HeadTypeInteger, "Xft/DPI", 122880 };
+    XsSetting cursor{ HeadTypeString, "Gtk/CursorThemeName", QString("bloom") };
+    model.applySettings({ dpi, cursor });
+
+    const QByteArray marshaled = model.marshalSettingData();
+    QCOMPARE(std::get<int>(decodeValue(marshaled, "Xft/DPI")), 122880);
+    QCOMPARE(std::get<QString>(decodeValue(marshaled, "Gtk/CursorThemeName")), QString("bloom"));
+    for (const QString &prop : fixtureProps) {
+        QCOMPARE(model.getValue(prop), decodeValue(marshaled, prop));
+    }
+
+    XSettingsModel reloaded;
+    reloaded.load(marshaled);
+    QCOMPARE(reloaded.listProps(), model.listProps());
+    QCOMPARE(reloaded.marshalSettingData(), marshaled);
+}
+
+void XSettingsModelTest::emptyPropertyStartsEmptyModel()
+{
+    XSettingsModel model;
+    model.load(QByteArray());
+    QCOMPARE(model.listProps(), QString("[]"));
+
+    model.applySettings({ XsSetting{ HeadTypeInteger, "Xft/DPI", 98304 } });
+    QCOMPARE(std::get<int>(decodeValue(model.marshalSettingData(), "Xft/DPI")), 98304);
+}
+
+QTEST_GUILESS_MAIN(XSettingsModelTest)
+
+#include "tst_xsettingsmodel.moc"
@@ -0,0 +1,164 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "impl/xsdatainfo.h"
+#include "impl/xsettingsmodel.h"
+#include "impl/xsettingswriter.h"
+
+#include <QtTest>
+
+namespace {
+quint32 serialOf(const QByteArray &blob)
+{
+    return qFromLittleEndian<quint32>(blob.constData() + 4);
+}
+
+XsValue decodeValue(const QByteArray &blob, const QString &prop)
+{
+    QByteArray datas = blob;
+    XSDataInfo info(datas);
+    QSharedPointer<XSItemInfo> item = info.getPropItem(prop);
+    return item.isNull() ? XsValue() : item->getValue();
+}
+} // namespace
+
+class XSettingsWriterTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void burstProducesSingleWrite();
+    void separateBurstsWriteSeparately();
+    void transactionWritesOnCommit();
+    void nestedTransactionsWriteOnce();
+    void readsSeeUnflushedValues();
+
+private:
+    QVector<QByteArray> m_writes;
+};
+
+void XSettingsWriterTest::initTestCase()
+{
+    QLoggingCategory::setFilterRules(QStringLiteral("*.debug=false"));
+}
+
+void XSettingsWriterTest::init()
+{
+    m_writes.clear();
+}
+
+void XSettingsWriterTest::burstProducesSingleWrite()
+{
+    XSettingsModel model;
+    model.load(QByteArray());
+    XSettingsWriter writer(model, [this](const QByteArray &data) {
+        m_writes.append(data);
+        return true;
+    });
+
+    // 模拟切换主题时逐个 key 的 dconfig 回调
+    for (int i = 0; i < 12; i++) {
+        writer.setSettings({ XsSetting{ HeadTypeString, QString("Net/Key%1").arg(i), QString("v%1").arg(i) } });
+    }
+    writer.setSettings({ XsSetting{ HeadTypeString, "Net/Key0", QString("final") } });
+    QVERIFY(m_writes.isEmpty());
+
+    QTRY_COMPARE(m_writes.size(), 1);
+    QTest::qWait(100);
+    QCOMPARE(m_writes.size(), 1);
+    QVERIFY(!writer.hasPendingWrite());
+
+    const QByteArray blob = m_writes.first();
+    QCOMPARE(serialOf(blob), 1u);
+    QCOMPARE(std::get<QString>(decodeValue(blob, "Net/Key0")), QString("final"));
+    for (int i = 1; i < 12; i++) {
+        QCOMPARE(std::get<QString>(decodeValue(blob, QString("Net/Key%1").arg(i))), QString("v%1").arg(i));
+    }
+}
+
+void XSettingsWriterTest::separateBurstsWriteSeparately()
+{
+    XSettingsModel model;
+    model.load(QByteArray());
+    XSettingsWriter writer(model, [this](const QByteArray &data) {
+        m_writes.append(data);
+        return true;
+    });
+
+    writer.setSettings({ XsSetting{ HeadTypeInteger, "Xft/DPI", 98304 } });
+    QTRY_COMPARE(m_writes.size(), 1);
+    writer.setSettings({ XsSetting{ HeadTypeInteger, "Xft/DPI", 122880 } });
+    QTRY_COMPARE(m_writes.size(), 2);
+
+    QCOMPARE(serialOf(m_writes[0]), 1u);
+    QCOMPARE(serialOf(m_writes[1]), 2u);
+    QCOMPARE(std::get<int>(decodeValue(m_writes[1], "Xft/DPI")), 122880);
+}
+
+void XSettingsWriterTest::transactionWritesOnCommit()
+{
+    XSettingsModel model;
+    model.load(QByteArray());
+    XSettingsWriter writer(model, [this](const QByteArray &data) {
+        m_writes.append(data);
+        return true;
+    });
+
+    {
+        XSettingsWriter::Transaction transaction(writer);
+        writer.setSettings({ XsSetting{ HeadTypeInteger, "Xft/DPI", 98304 } });
+        writer.setSettings({ XsSetting{ HeadTypeInteger, "Gdk/WindowScalingFactor", 2 } });
+        QTest::qWait(100);
+        QVERIFY(m_writes.isEmpty());
+    }
+    QCOMPARE(m_writes.size(), 1);
+    QTest::qWait(100);
+    QCOMPARE(m_writes.size(), 1);
+    QCOMPARE(std::get<int>(decodeValue(m_writes.first(), "Gdk/WindowScalingFactor")), 2);
+}
+
+void XSettingsWriterTest::nestedTransactionsWriteOnce()
+{
+    XSettingsModel model;
+    model.load(QByteArray());
+    XSettingsWriter writer(model, [this](const QByteArray &data) {
+        m_writes.append(data);
+        return true;
+    });
+
+    writer.beginTransaction();
+    writer.setSettings({ XsSetting{ HeadTypeInteger, "Xft/DPI", 98304 } });
+    writer.beginTransaction();
+    writer.setSettings({ XsSetting{ HeadTypeInteger, "Xft/DPI", 122880 } });
+    writer.commitTransaction();
+    QVERIFY(m_writes.isEmpty());
+    writer.commitTransaction();
+
+    QCOMPARE(m_writes.size(), 1);
+    QCOMPARE(serialOf(m_writes.first()), 1u);
+    QCOMPARE(std::get<int>(decodeValue(m_writes.first(), "Xft/DPI")), 122880);
+}
+
+void XSettingsWriterTest::readsSeeUnflushedValues()
+{
+    XSettingsModel model;
+    model.load(QByteArray());
+    XSettingsWriter writer(model, [this](const QByteArray &data) {
+        m_writes.append(data);
+        return true;
+    });
+
+    writer.setSettings({ XsSetting{ HeadTypeString, "Net/ThemeName", QString("deepin-dark") } });
+    QVERIFY(writer.hasPendingWrite());
+    QCOMPARE(std::get<QString>(model.getValue("Net/ThemeName")), QString("deepin-dark"));
+
+    writer.flush();
+    QCOMPARE(m_writes.size(), 1);
+    QVERIFY(!writer.hasPendingWrite());
+}
+
+QTEST_GUILESS_MAIN(XSettingsWriterTest)
+
+#include "tst_xsettingswriter.moc"
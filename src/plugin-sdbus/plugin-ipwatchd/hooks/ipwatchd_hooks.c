@@ -10,8 +10,8 @@
  */
 
 int __attribute__((weak)) ipwd_hook_on_arp_packet(
-    const char *rcv_sip, const char *rcv_smac,
-    const char *rcv_dip, const char *rcv_dmac)
+    in_addr_t rcv_sip, const uint8_t *rcv_smac,
+    in_addr_t rcv_dip, const uint8_t *rcv_dmac)
 {
     (void)rcv_sip;
     (void)rcv_smac;
@@ -21,8 +21,8 @@ int __attribute__((weak)) ipwd_hook_on_arp_packet(
 }
 
 void __attribute__((weak)) ipwd_hook_on_conflict(
-    const char *device, const char *ip,
-    const char *mac, const char *remote_mac,
+    const char *device, in_addr_t ip,
+    const uint8_t *mac, const uint8_t *remote_mac,
     int is_active_mode)
 {
     (void)device;
@@ -34,8 +34,8 @@ void __attribute__((weak)) ipwd_hook_on_conflict(
 }
 
 void __attribute__((weak)) ipwd_hook_on_conflict_resolved(
-    const char *device, const char *ip,
-    const char *mac, const char *remote_mac)
+    const char *device, in_addr_t ip,
+    const uint8_t *mac, const uint8_t *remote_mac)
 {
     (void)device;
     (void)ip;
@@ -54,3 +54,19 @@ void __attribute__((weak)) ipwd_hook_on_pcap_ready(void *pcap_handle)
     (void)pcap_handle;
     // No-op
 }
+
+int __attribute__((weak)) ipwd_hook_devices_cached(void)
+{
+    return 0; // Query devices for every packet
+}
+
+int __attribute__((weak)) ipwd_hook_on_run_script(
+    const char *script, const char *device,
+    in_addr_t ip, const uint8_t *remote_mac)
+{
+    (void)script;
+    (void)device;
+    (void)ip;
+    (void)remote_mac;
+    return 0; // Run the script with system()
+}
@@ -11,8 +11,14 @@
  * These hooks allow external code to intercept and extend ipwatchd behavior
  * without modifying the core logic. All hooks use weak symbols, so they are
  * optional and have no-op default implementations.
+ *
+ * Addresses are passed in binary form: IPv4 addresses as in_addr_t in
+ * network byte order and MAC addresses as ETH_ALEN bytes.
  */
 
+#include <netinet/in.h>
+#include <stdint.h>
+
 /**
  * Hook called after parsing an ARP packet
  * 
@@ -23,8 +29,8 @@
  * @return 0 to continue normal processing, non-zero to skip further processing
  */
 int __attribute__((weak)) ipwd_hook_on_arp_packet(
-    const char *rcv_sip, const char *rcv_smac,
-    const char *rcv_dip, const char *rcv_dmac);
+    in_addr_t rcv_sip, const uint8_t *rcv_smac,
+    in_addr_t rcv_dip, const uint8_t *rcv_dmac);
 
 /**
  * Hook called when an IP conflict is detected
@@ -36,8 +42,8 @@ int __attribute__((weak)) ipwd_hook_on_arp_packet(
  * @param is_active_mode 1 if active mode, 0 if passive mode
  */
 void __attribute__((weak)) ipwd_hook_on_conflict(
-    const char *device, const char *ip,
-    const char *mac, const char *remote_mac,
+    const char *device, in_addr_t ip,
+    const uint8_t *mac, const uint8_t *remote_mac,
     int is_active_mode);
 
 /**
@@ -49,8 +55,8 @@ void __attribute__((weak)) ipwd_hook_on_conflict(
  * @param remote_mac Remote MAC address
  */
 void __attribute__((weak)) ipwd_hook_on_conflict_resolved(
-    const char *device, const char *ip,
-    const char *mac, const char *remote_mac);
+    const char *device, in_addr_t ip,
+    const uint8_t *mac, const uint8_t *remote_mac);
 
 /**
  * Hook called after configuration is loaded
@@ -64,4 +70,26 @@ void __attribute__((weak)) ipwd_hook_on_config_loaded(void);
  */
 void __attribute__((weak)) ipwd_hook_on_pcap_ready(void *pcap_handle);
 
+/**
+ * Hook asking whether the devices structure is kept current by the plugin
+ * 
+ * @return non-zero if IP, MAC and state of every device are already up to
+ *         date, 0 to let ipwd_analyse query them for each packet
+ */
+int __attribute__((weak)) ipwd_hook_devices_cached(void);
+
+/**
+ * Hook called before the user-defined script is run for a conflict
+ * 
+ * @param script Configured script
+ * @param device Network device name
+ * @param ip IP address in conflict
+ * @param remote_mac Remote MAC address causing conflict
+ * @return 0 to let ipwd_analyse run the script with system(), non-zero if
+ *         the plugin has taken care of it
+ */
+int __attribute__((weak)) ipwd_hook_on_run_script(
+    const char *script, const char *device,
+    in_addr_t ip, const uint8_t *remote_mac);
+
 #endif // IPWATCHD_HOOKS_H
@@ -0,0 +1,190 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "arp_filter.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+//! Longest expression fragment added per address
+#define IPWD_ARP_FILTER_TERM_LEN 64
+
+void ipwd_arp_filter_init(IPWD_S_ARP_FILTER *filter)
+{
+    memset(filter, 0, sizeof(*filter));
+    filter->naddrs = -1;
+}
+
+static int compare_addr(const void *a, const void *b)
+{
+    in_addr_t x = *(const in_addr_t *)a, y = *(const in_addr_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * Sort and deduplicate into out, which has room for IPWD_ARP_FILTER_MAX_ADDRS
+ * @return Number of unique addresses, -1 if there are too many or addrs is NULL
+ */
+static int normalize(const in_addr_t *addrs, int naddrs, in_addr_t *out)
+{
+    if (!addrs || naddrs < 0)
+        return -1;
+
+    in_addr_t *sorted = (in_addr_t *)malloc((naddrs + 1) * sizeof(in_addr_t));
+    if (!sorted)
+        return -1;
+    memcpy(sorted, addrs, naddrs * sizeof(in_addr_t));
+    qsort(sorted, naddrs, sizeof(in_addr_t), compare_addr);
+
+    int n = 0;
+    for (int i = 0; i < naddrs; i++)
+    {
+        if (n > 0 && out[n - 1] == sorted[i])
+            continue;
+        if (n == IPWD_ARP_FILTER_MAX_ADDRS)
+        {
+            n = -1;
+            break;
+        }
+        out[n++] = sorted[i];
+    }
+
+    free(sorted);
+    return n;
+}
+
+char *ipwd_arp_filter_build(const in_addr_t *addrs, int naddrs)
+{
+    if (!addrs)
+        return strdup("arp");
+
+    /* No address to watch: a valid program that rejects every packet */
+    if (naddrs == 0)
+        return strdup("arp and not arp");
+
+    size_t len = 64 + (size_t)naddrs * IPWD_ARP_FILTER_TERM_LEN;
+    char *expr = (char *)malloc(len);
+    if (!expr)
+        return NULL;
+
+    /* Offsets below assume 6-byte hardware and 4-byte protocol addresses */
+    size_t pos = (size_t)snprintf(expr, len, "arp and arp[4:2] = 0x0604 and (");
+    for (int i = 0; i < naddrs; i++)
+    {
+        uint32_t addr = ntohl(addrs[i]);
+        pos += (size_t)snprintf(expr + pos, len - pos, "%sarp[%d:4] = 0x%08x or arp[%d:4] = 0x%08x",
+                                i ? " or " : "", IPWD_ARP_SPA_OFFSET, addr, IPWD_ARP_TPA_OFFSET, addr);
+    }
+    snprintf(expr + pos, len - pos, ")");
+    return expr;
+}
+
+/**
+ * Normalize addrs into unique and compare it with the installed set
+ * @return 1 if the filter has to be replaced, 0 if it is installed already
+ */
+static int needs_update(const IPWD_S_ARP_FILTER *filter, const in_addr_t *addrs, int naddrs,
+                        in_addr_t *unique, int *n)
+{
+    *n = normalize(addrs, naddrs, unique);
+    return *n != filter->naddrs || (*n > 0 && memcmp(unique, filter->addrs, *n * sizeof(in_addr_t)) != 0);
+}
+
+static void remember(IPWD_S_ARP_FILTER *filter, const in_addr_t *unique, int n)
+{
+    filter->naddrs = n;
+    if (n > 0)
+        memcpy(filter->addrs, unique, n * sizeof(in_addr_t));
+}
+
+int ipwd_arp_filter_apply(IPWD_S_ARP_FILTER *filter, pcap_t *pcap, const in_addr_t *addrs, int naddrs)
+{
+    in_addr_t unique[IPWD_ARP_FILTER_MAX_ADDRS];
+    int n;
+
+    if (!needs_update(filter, addrs, naddrs, unique, &n))
+        return 0;
+
+    char *expr = ipwd_arp_filter_build(n < 0 ? NULL : unique, n);
+    if (!expr)
+        return -1;
+
+    struct bpf_program fp;
+    int rv = pcap_compile(pcap, &fp, expr, 1, PCAP_NETMASK_UNKNOWN);
+    free(expr);
+    if (rv == -1)
+        return -1;
+
+    /* The kernel swaps programs in one step, no packet sees a half-built filter */
+    rv = pcap_setfilter(pcap, &fp);
+    pcap_freecode(&fp);
+    if (rv == -1)
+        return -1;
+
+    remember(filter, unique, n);
+    return 1;
+}
+
+int ipwd_arp_filter_program(const in_addr_t *addrs, int naddrs, struct sock_filter *insns)
+{
+    if (!addrs)
+    {
+        insns[0] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, IPWD_ARP_FILTER_SNAPLEN);
+        return 1;
+    }
+    if (naddrs == 0)
+    {
+        insns[0] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0);
+        return 1;
+    }
+
+    /* Offsets are relative to the instruction after the jump; at most 2 * 64 + 3 fit in 8 bits */
+    const int reject = 2 * naddrs + 4;
+    const int accept = reject + 1;
+    int pc = 0;
+
+    /* Only Ethernet/IPv4 ARP has the addresses at the offsets below */
+    insns[pc++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 4);
+    insns[pc] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0x0604, 0, reject - pc - 1);
+    pc++;
+
+    static const int offsets[2] = { IPWD_ARP_SPA_OFFSET, IPWD_ARP_TPA_OFFSET };
+    for (int o = 0; o < 2; o++)
+    {
+        insns[pc++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsets[o]);
+        for (int i = 0; i < naddrs; i++)
+        {
+            insns[pc] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ntohl(addrs[i]), accept - pc - 1, 0);
+            pc++;
+        }
+    }
+
+    insns[pc++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0);
+    insns[pc++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, IPWD_ARP_FILTER_SNAPLEN);
+    return pc;
+}
+
+int ipwd_arp_filter_attach(IPWD_S_ARP_FILTER *filter, int fd, const in_addr_t *addrs, int naddrs)
+{
+    in_addr_t unique[IPWD_ARP_FILTER_MAX_ADDRS];
+    struct sock_filter insns[IPWD_ARP_FILTER_MAX_INSNS];
+    int n;
+
+    if (!needs_update(filter, addrs, naddrs, unique, &n))
+        return 0;
+
+    struct sock_fprog prog;
+    prog.len = (unsigned short)ipwd_arp_filter_program(n < 0 ? NULL : unique, n, insns);
+    prog.filter = insns;
+
+    /* Replaces the attached program in one step, as pcap_setfilter() does */
+    if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) < 0)
+        return -errno;
+
+    remember(filter, unique, n);
+    return 1;
+}
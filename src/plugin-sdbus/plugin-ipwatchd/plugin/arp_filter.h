@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef IPWATCHD_ARP_FILTER_H
+#define IPWATCHD_ARP_FILTER_H
+
+#include <linux/filter.h>
+#include <netinet/in.h>
+#include <pcap.h>
+
+/**
+ * Kernel-side capture filter for the ARP packets that matter.
+ *
+ * Conflict detection only looks at packets whose sender or target protocol
+ * address is one of the watched addresses, so the filter passes exactly
+ * those and the kernel drops the rest of the segment's ARP chatter before
+ * it is copied to userspace. A new filter is compiled in full and then
+ * installed with a single pcap_setfilter(), which replaces the old program
+ * atomically; if compiling fails the old filter stays in place.
+ *
+ * The same address set can be attached to a packet socket of our own, bound
+ * to ETH_P_ARP with SOCK_DGRAM so that packets start at the ARP header. The
+ * program for it is assembled here rather than compiled by libpcap, whose
+ * offsets assume a link-layer header in front.
+ */
+
+//! Offset of the sender protocol address in an Ethernet/IPv4 ARP header
+#define IPWD_ARP_SPA_OFFSET 14
+
+//! Offset of the target protocol address in an Ethernet/IPv4 ARP header
+#define IPWD_ARP_TPA_OFFSET 24
+
+//! Above this many addresses the filter passes all ARP
+#define IPWD_ARP_FILTER_MAX_ADDRS 64
+
+//! Bytes of an Ethernet/IPv4 ARP header, all a packet socket filter keeps of a packet
+#define IPWD_ARP_FILTER_SNAPLEN 28
+
+//! Length of the longest packet socket program
+#define IPWD_ARP_FILTER_MAX_INSNS (2 * IPWD_ARP_FILTER_MAX_ADDRS + 6)
+
+//! Installed filter, kept to skip recompiling an unchanged address set
+typedef struct
+{
+    in_addr_t addrs[IPWD_ARP_FILTER_MAX_ADDRS];     /**< Sorted, unique, network order */
+    int naddrs;                                     /**< Number of addrs, -1 for all ARP */
+} IPWD_S_ARP_FILTER;
+
+/**
+ * Initialize to the state of a plain "arp" filter
+ */
+void ipwd_arp_filter_init(IPWD_S_ARP_FILTER *filter);
+
+/**
+ * Build the filter expression for a set of addresses
+ * @param addrs Addresses in network order, duplicates allowed; NULL for all ARP
+ * @param naddrs Number of addresses; 0 yields a filter that passes nothing
+ * @return Expression to free(), NULL on allocation failure
+ */
+char *ipwd_arp_filter_build(const in_addr_t *addrs, int naddrs);
+
+/**
+ * Install the filter for a set of addresses unless it is already installed
+ * @param addrs Addresses in network order, duplicates allowed; NULL for all ARP
+ * @return 1 if a new filter was installed, 0 if unchanged, -1 on error
+ */
+int ipwd_arp_filter_apply(IPWD_S_ARP_FILTER *filter, pcap_t *pcap, const in_addr_t *addrs, int naddrs);
+
+/**
+ * Assemble the packet socket program for a set of addresses
+ * Accepted packets are truncated to IPWD_ARP_FILTER_SNAPLEN bytes
+ * @param addrs Sorted unique addresses in network order; NULL for all ARP
+ * @param naddrs Number of addresses, at most IPWD_ARP_FILTER_MAX_ADDRS
+ * @param insns Room for IPWD_ARP_FILTER_MAX_INSNS instructions
+ * @return Number of instructions
+ */
+int ipwd_arp_filter_program(const in_addr_t *addrs, int naddrs, struct sock_filter *insns);
+
+/**
+ * Attach the filter for a set of addresses to a packet socket unless it is already attached
+ * @param fd Socket delivering from the ARP header, see above
+ * @param addrs Addresses in network order, duplicates allowed; NULL for all ARP
+ * @return 1 if a new filter was attached, 0 if unchanged, negative errno on error
+ */
+int ipwd_arp_filter_attach(IPWD_S_ARP_FILTER *filter, int fd, const in_addr_t *addrs, int naddrs);
+
+#endif // IPWATCHD_ARP_FILTER_H
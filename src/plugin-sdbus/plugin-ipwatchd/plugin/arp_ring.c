@@ -0,0 +1,297 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "arp_ring.h"
+#include "arp_filter.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+//! Nominal frame size; TPACKET_V3 packs packets by their real length
+#define IPWD_ARP_RING_FRAME_SIZE 256
+
+struct IPWD_S_ARP_RING
+{
+    int fd;
+    uint8_t *map;                       /**< IPWD_ARP_RING_BLOCKS blocks shared with the kernel */
+    size_t map_len;
+    int current;                        /**< Next block to hand to userspace */
+    pthread_mutex_t stats_lock;
+    IPWD_S_CAPTURE_STATS stats;         /**< Totals; the kernel counters reset on each read */
+};
+
+/* Cooked header as libpcap builds it for the "any" device, all fields in network order */
+typedef struct
+{
+    uint16_t pkttype;
+    uint16_t hatype;
+    uint16_t halen;
+    uint8_t addr[8];
+    uint16_t protocol;
+} __attribute__((packed)) IPWD_S_SLL_HEADER;
+
+_Static_assert(sizeof(IPWD_S_SLL_HEADER) == IPWD_ARP_RING_SLL_LEN, "unexpected cooked header layout");
+
+/* Report errno and close what was opened so far */
+static void fail(int fd, int *error)
+{
+    if (error)
+        *error = -errno;
+    if (fd >= 0)
+        close(fd);
+}
+
+IPWD_S_ARP_RING *ipwd_arp_ring_open(int ifindex, int *error)
+{
+    /* Not bound yet: nothing is queued before the ring exists */
+    int fd = socket(AF_PACKET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0)
+    {
+        fail(-1, error);
+        return NULL;
+    }
+
+    int version = TPACKET_V3;
+    if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0)
+    {
+        fail(fd, error);
+        return NULL;
+    }
+
+    struct tpacket_req3 req;
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = IPWD_ARP_RING_BLOCK_SIZE;
+    req.tp_block_nr = IPWD_ARP_RING_BLOCKS;
+    req.tp_frame_size = IPWD_ARP_RING_FRAME_SIZE;
+    req.tp_frame_nr = IPWD_ARP_RING_BLOCK_SIZE / IPWD_ARP_RING_FRAME_SIZE * IPWD_ARP_RING_BLOCKS;
+    req.tp_retire_blk_tov = IPWD_ARP_RING_RETIRE_MSEC;
+    if (setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0)
+    {
+        fail(fd, error);
+        return NULL;
+    }
+
+    /* Before it is bound, so that no packet comes in untruncated */
+    struct sock_filter insns[IPWD_ARP_FILTER_MAX_INSNS];
+    struct sock_fprog prog;
+    prog.len = (unsigned short)ipwd_arp_filter_program(NULL, 0, insns);
+    prog.filter = insns;
+    if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) < 0)
+    {
+        fail(fd, error);
+        return NULL;
+    }
+
+    size_t map_len = (size_t)IPWD_ARP_RING_BLOCK_SIZE * IPWD_ARP_RING_BLOCKS;
+    uint8_t *map = (uint8_t *)mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        fail(fd, error);
+        return NULL;
+    }
+
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_ARP);
+    addr.sll_ifindex = ifindex;
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        munmap(map, map_len);
+        fail(fd, error);
+        return NULL;
+    }
+
+    IPWD_S_ARP_RING *ring = (IPWD_S_ARP_RING *)calloc(1, sizeof(IPWD_S_ARP_RING));
+    if (!ring)
+    {
+        munmap(map, map_len);
+        fail(fd, error);
+        return NULL;
+    }
+
+    ring->fd = fd;
+    ring->map = map;
+    ring->map_len = map_len;
+    pthread_mutex_init(&ring->stats_lock, NULL);
+    return ring;
+}
+
+void ipwd_arp_ring_free(IPWD_S_ARP_RING *ring)
+{
+    if (!ring)
+        return;
+
+    munmap(ring->map, ring->map_len);
+    close(ring->fd);
+    pthread_mutex_destroy(&ring->stats_lock);
+    free(ring);
+}
+
+int ipwd_arp_ring_fd(const IPWD_S_ARP_RING *ring)
+{
+    return ring ? ring->fd : -1;
+}
+
+/* Fill the cooked header from the packet's link-layer address */
+static void cook(IPWD_S_SLL_HEADER *cooked, const struct sockaddr_ll *sll)
+{
+    cooked->pkttype = htons(sll->sll_pkttype);
+    cooked->hatype = htons(sll->sll_hatype);
+    cooked->halen = htons(sll->sll_halen);
+    memcpy(cooked->addr, sll->sll_addr, sizeof(cooked->addr));
+    cooked->protocol = sll->sll_protocol;
+}
+
+/**
+ * Put the cooked header in front of a received packet and pass it on
+ * With SOCK_DGRAM the kernel leaves at least 16 bytes between the address
+ * and the packet (see tpacket_rcv), the room libpcap fills the same way
+ */
+static int deliver(struct tpacket3_hdr *hdr, pcap_handler cb, u_char *user)
+{
+    const struct sockaddr_ll *sll = (const struct sockaddr_ll *)((uint8_t *)hdr + TPACKET_ALIGN(sizeof(*hdr)));
+    uint8_t *packet = (uint8_t *)hdr + hdr->tp_mac;
+    IPWD_S_SLL_HEADER *cooked = (IPWD_S_SLL_HEADER *)(packet - IPWD_ARP_RING_SLL_LEN);
+
+    if ((uint8_t *)cooked < (const uint8_t *)(sll + 1))
+        return 0;
+
+    /* Sent by this host, not an answer from anyone else */
+    if (sll->sll_pkttype == PACKET_OUTGOING)
+        return 0;
+
+    cook(cooked, sll);
+
+    struct pcap_pkthdr header;
+    header.ts.tv_sec = hdr->tp_sec;
+    header.ts.tv_usec = hdr->tp_nsec / 1000;
+    header.caplen = hdr->tp_snaplen + IPWD_ARP_RING_SLL_LEN;
+    header.len = hdr->tp_len + IPWD_ARP_RING_SLL_LEN;
+
+    cb(user, &header, (const u_char *)cooked);
+    return 1;
+}
+
+int ipwd_arp_ring_dispatch(IPWD_S_ARP_RING *ring, pcap_handler cb, u_char *user)
+{
+    int count = 0;
+
+    for (;;)
+    {
+        struct tpacket_block_desc *block =
+            (struct tpacket_block_desc *)(ring->map + (size_t)ring->current * IPWD_ARP_RING_BLOCK_SIZE);
+
+        /* Pairs with the kernel's release when it retires the block */
+        if (!(__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER))
+            break;
+
+        struct tpacket3_hdr *hdr = (struct tpacket3_hdr *)((uint8_t *)block + block->hdr.bh1.offset_to_first_pkt);
+        for (uint32_t i = 0; i < block->hdr.bh1.num_pkts; i++)
+        {
+            count += deliver(hdr, cb, user);
+            hdr = (struct tpacket3_hdr *)((uint8_t *)hdr + hdr->tp_next_offset);
+        }
+
+        /* The callback is done with the block, the kernel may refill it */
+        __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+        ring->current = (ring->current + 1) % IPWD_ARP_RING_BLOCKS;
+    }
+
+    return count;
+}
+
+int ipwd_arp_ring_stats(IPWD_S_ARP_RING *ring, IPWD_S_CAPTURE_STATS *stats)
+{
+    struct tpacket_stats_v3 kstats;
+    socklen_t len = sizeof(kstats);
+    int rv = 0;
+
+    pthread_mutex_lock(&ring->stats_lock);
+    if (getsockopt(ring->fd, SOL_PACKET, PACKET_STATISTICS, &kstats, &len) < 0)
+    {
+        rv = -errno;
+    }
+    else
+    {
+        /* The kernel's packet count already includes the drops */
+        ring->stats.packets += kstats.tp_packets;
+        ring->stats.drops += kstats.tp_drops;
+    }
+    *stats = ring->stats;
+    pthread_mutex_unlock(&ring->stats_lock);
+    return rv;
+}
+
+int ipwd_arp_socket_open(int ifindex)
+{
+    int fd = socket(AF_PACKET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0)
+        return -errno;
+
+    /* Nothing is queued until the caller attached the addresses it waits for */
+    static const in_addr_t none[1];
+    struct sock_filter insns[IPWD_ARP_FILTER_MAX_INSNS];
+    struct sock_fprog prog;
+    prog.len = (unsigned short)ipwd_arp_filter_program(none, 0, insns);
+    prog.filter = insns;
+
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_ARP);
+    addr.sll_ifindex = ifindex;
+
+    if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) < 0 ||
+        bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        int err = -errno;
+        close(fd);
+        return err;
+    }
+    return fd;
+}
+
+int ipwd_arp_socket_dispatch(int fd, pcap_handler cb, u_char *user)
+{
+    uint8_t buf[IPWD_ARP_RING_SLL_LEN + IPWD_ARP_FILTER_SNAPLEN];
+    int count = 0;
+
+    for (;;)
+    {
+        struct sockaddr_ll sll;
+        socklen_t sll_len = sizeof(sll);
+        ssize_t len = recvfrom(fd, buf + IPWD_ARP_RING_SLL_LEN, IPWD_ARP_FILTER_SNAPLEN, MSG_TRUNC,
+                               (struct sockaddr *)&sll, &sll_len);
+        if (len < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return count;
+            return count ? count : -errno;
+        }
+
+        if (sll.sll_pkttype == PACKET_OUTGOING)
+            continue;
+
+        cook((IPWD_S_SLL_HEADER *)buf, &sll);
+
+        struct pcap_pkthdr header;
+        gettimeofday(&header.ts, NULL);
+        header.caplen = (len < IPWD_ARP_FILTER_SNAPLEN ? (uint32_t)len : IPWD_ARP_FILTER_SNAPLEN) + IPWD_ARP_RING_SLL_LEN;
+        header.len = (uint32_t)len + IPWD_ARP_RING_SLL_LEN;
+
+        cb(user, &header, buf);
+        count++;
+    }
+}
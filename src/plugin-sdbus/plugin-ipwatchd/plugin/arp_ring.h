@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef IPWATCHD_ARP_RING_H
+#define IPWATCHD_ARP_RING_H
+
+#include <pcap.h>
+#include <stdint.h>
+
+/**
+ * ARP capture through an AF_PACKET TPACKET_V3 ring.
+ *
+ * The socket is bound to ETH_P_ARP, so the kernel hands it nothing else,
+ * and its filter keeps only the 28-byte ARP header of each packet. Frames
+ * this host transmits, our own probes included, reach a packet socket as
+ * PACKET_OUTGOING; the kernel only loops them back to ETH_P_ALL sockets,
+ * and dispatch skips any that do arrive, so unlike libpcap's "any" capture
+ * only received ARP is passed on.
+ *
+ * Packets are packed into blocks of a ring shared with the kernel; a block
+ * is handed over when it is full or its retire timeout expires, so one poll
+ * wakeup delivers a whole burst without copies or per-packet syscalls.
+ * An empty block is never handed over: an idle ring does not wake the
+ * capture thread.
+ *
+ * Each packet is passed to a pcap_handler with a Linux cooked (DLT_LINUX_SLL)
+ * header in front, the same layout libpcap delivers for the "any" device,
+ * so ipwd_analyse() works unchanged. Except for ipwd_arp_ring_stats(), all
+ * functions must be called from the thread that owns the ring.
+ */
+
+//! Size of a ring block, a multiple of every page size
+#define IPWD_ARP_RING_BLOCK_SIZE (64 * 1024)
+
+//! Number of ring blocks
+#define IPWD_ARP_RING_BLOCKS 16
+
+/**
+ * Longest time a partly filled block waits before it is handed over
+ * The kernel re-arms this timer even when no packet arrives, so it sets
+ * the ring's idle wakeups (four per second); it is also the worst-case
+ * delivery latency for sparse ARP. Whoever cannot wait that long reads a
+ * socket from ipwd_arp_socket_open() beside the ring
+ */
+#define IPWD_ARP_RING_RETIRE_MSEC 250
+
+//! Length of the cooked header put in front of each packet
+#define IPWD_ARP_RING_SLL_LEN 16
+
+//! Capture counters
+typedef struct
+{
+    uint64_t packets;                   /**< Packets that passed the filter, dropped ones included */
+    uint64_t drops;                     /**< Packets dropped because the ring was full */
+} IPWD_S_CAPTURE_STATS;
+
+typedef struct IPWD_S_ARP_RING IPWD_S_ARP_RING;
+
+/**
+ * Open the ring and start capturing
+ * The socket starts with the all-ARP filter of ipwd_arp_filter_init()
+ * @param ifindex Interface to capture on, 0 for all interfaces
+ * @param error Set to a negative errno on failure, may be NULL
+ * @return Ring on success, NULL if TPACKET_V3 rings are unavailable or on error
+ */
+IPWD_S_ARP_RING *ipwd_arp_ring_open(int ifindex, int *error);
+
+/**
+ * Unmap the ring and close the socket
+ */
+void ipwd_arp_ring_free(IPWD_S_ARP_RING *ring);
+
+/**
+ * Socket to poll for readability and to attach filters to
+ */
+int ipwd_arp_ring_fd(const IPWD_S_ARP_RING *ring);
+
+/**
+ * Pass every packet of every block the kernel has handed over to cb
+ * and give the blocks back
+ * @param cb Called once per packet, with user as first argument
+ * @return Number of packets passed to cb
+ */
+int ipwd_arp_ring_dispatch(IPWD_S_ARP_RING *ring, pcap_handler cb, u_char *user);
+
+/**
+ * Read the counters accumulated since the ring was opened
+ * May be called from any thread
+ * @return 0 on success, negative errno on error
+ */
+int ipwd_arp_ring_stats(IPWD_S_ARP_RING *ring, IPWD_S_CAPTURE_STATS *stats);
+
+/**
+ * Open a packet socket for ARP without a ring
+ * Each packet can be read as soon as it arrives rather than when its block
+ * retires, at one syscall per packet: for short spells in which latency
+ * matters more than wakeups. Starts with a filter that passes nothing;
+ * attach addresses with ipwd_arp_filter_attach()
+ * @param ifindex Interface to capture on, 0 for all interfaces
+ * @return Non-blocking socket, negative errno on error
+ */
+int ipwd_arp_socket_open(int ifindex);
+
+/**
+ * Pass every packet queued on a socket from ipwd_arp_socket_open() to cb,
+ * in the form ipwd_arp_ring_dispatch() uses
+ * @param cb Called once per packet, with user as first argument
+ * @return Number of packets passed to cb, negative errno on error
+ */
+int ipwd_arp_socket_dispatch(int fd, pcap_handler cb, u_char *user);
+
+#endif // IPWATCHD_ARP_RING_H
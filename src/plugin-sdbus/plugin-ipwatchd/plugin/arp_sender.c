@@ -0,0 +1,209 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "arp_sender.h"
+#include <errno.h>
+#include <linux/if_packet.h>
+#include <net/if_arp.h>
+#include <netinet/if_ether.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+//! Offset of the ARP target protocol address, the only field a probe patches
+#define IPWD_ARP_FRAME_TPA (sizeof(struct ether_header) + offsetof(struct ether_arp, arp_tpa))
+
+//! One interface probes can be sent on
+typedef struct
+{
+    int ifindex;                                /**< Kernel interface index */
+    char name[IFNAMSIZ];                        /**< Interface name */
+    int fd;                                     /**< Send-only packet socket, -1 until first probe */
+    unsigned char frame[IPWD_ARP_FRAME_LEN];    /**< Probe frame without target address */
+} IPWD_S_ARP_IFACE;
+
+struct IPWD_S_ARP_SENDER
+{
+    pthread_mutex_t lock;
+    IPWD_S_ARP_IFACE *ifaces;
+    int nifaces;
+    int capacity;
+};
+
+_Static_assert(sizeof(struct ether_header) + sizeof(struct ether_arp) == IPWD_ARP_FRAME_LEN,
+               "unexpected ARP frame layout");
+
+IPWD_S_ARP_SENDER *ipwd_arp_sender_new(void)
+{
+    IPWD_S_ARP_SENDER *sender = (IPWD_S_ARP_SENDER *)calloc(1, sizeof(IPWD_S_ARP_SENDER));
+    if (!sender)
+        return NULL;
+
+    pthread_mutex_init(&sender->lock, NULL);
+    return sender;
+}
+
+void ipwd_arp_sender_free(IPWD_S_ARP_SENDER *sender)
+{
+    if (!sender)
+        return;
+
+    for (int i = 0; i < sender->nifaces; i++)
+    {
+        if (sender->ifaces[i].fd >= 0)
+            close(sender->ifaces[i].fd);
+    }
+    free(sender->ifaces);
+    pthread_mutex_destroy(&sender->lock);
+    free(sender);
+}
+
+/**
+ * Fill everything of a probe but the target address:
+ * broadcast from our MAC, who-has from 0.0.0.0 with an empty target MAC
+ */
+static void build_template(unsigned char *frame, const unsigned char *mac)
+{
+    struct ether_header *eth = (struct ether_header *)frame;
+    struct ether_arp *arp = (struct ether_arp *)(frame + sizeof(struct ether_header));
+
+    memset(frame, 0, IPWD_ARP_FRAME_LEN);
+    memset(eth->ether_dhost, 0xff, ETH_ALEN);
+    memcpy(eth->ether_shost, mac, ETH_ALEN);
+    eth->ether_type = htons(ETHERTYPE_ARP);
+
+    arp->arp_hrd = htons(ARPHRD_ETHER);
+    arp->arp_pro = htons(ETHERTYPE_IP);
+    arp->arp_hln = ETH_ALEN;
+    arp->arp_pln = sizeof(in_addr_t);
+    arp->arp_op = htons(ARPOP_REQUEST);
+    memcpy(arp->arp_sha, mac, ETH_ALEN);
+}
+
+static IPWD_S_ARP_IFACE *find_index(IPWD_S_ARP_SENDER *sender, int ifindex)
+{
+    for (int i = 0; i < sender->nifaces; i++)
+    {
+        if (sender->ifaces[i].ifindex == ifindex)
+            return &sender->ifaces[i];
+    }
+    return NULL;
+}
+
+static IPWD_S_ARP_IFACE *find_name(IPWD_S_ARP_SENDER *sender, const char *name)
+{
+    for (int i = 0; i < sender->nifaces; i++)
+    {
+        if (strcmp(sender->ifaces[i].name, name) == 0)
+            return &sender->ifaces[i];
+    }
+    return NULL;
+}
+
+void ipwd_arp_sender_update(IPWD_S_ARP_SENDER *sender, const IPWD_S_NL_LINK *link)
+{
+    if (!sender || !link)
+        return;
+
+    pthread_mutex_lock(&sender->lock);
+
+    IPWD_S_ARP_IFACE *iface = find_index(sender, link->ifindex);
+
+    if (!link->has_mac)
+    {
+        /* Link removed or without hardware address: nothing to probe from */
+        if (iface)
+        {
+            if (iface->fd >= 0)
+                close(iface->fd);
+            *iface = sender->ifaces[--sender->nifaces];
+        }
+        pthread_mutex_unlock(&sender->lock);
+        return;
+    }
+
+    if (!iface)
+    {
+        if (sender->nifaces == sender->capacity)
+        {
+            int capacity = sender->capacity ? sender->capacity * 2 : 8;
+            IPWD_S_ARP_IFACE *ifaces = (IPWD_S_ARP_IFACE *)realloc(sender->ifaces, capacity * sizeof(IPWD_S_ARP_IFACE));
+            if (!ifaces)
+            {
+                pthread_mutex_unlock(&sender->lock);
+                return;
+            }
+            sender->ifaces = ifaces;
+            sender->capacity = capacity;
+        }
+
+        iface = &sender->ifaces[sender->nifaces++];
+        memset(iface, 0, sizeof(*iface));
+        iface->ifindex = link->ifindex;
+        iface->fd = -1;
+    }
+
+    /* The socket is bound by index and survives renames and MAC changes */
+    memcpy(iface->name, link->name, IFNAMSIZ);
+    build_template(iface->frame, link->mac);
+
+    pthread_mutex_unlock(&sender->lock);
+}
+
+/**
+ * Open the send-only socket of an interface
+ * Protocol 0 keeps the kernel from queueing received frames on it
+ */
+static int open_socket(IPWD_S_ARP_IFACE *iface)
+{
+    int fd = socket(AF_PACKET, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0)
+        return -errno;
+
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_ifindex = iface->ifindex;
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        int err = -errno;
+        close(fd);
+        return err;
+    }
+
+    iface->fd = fd;
+    return 0;
+}
+
+int ipwd_arp_sender_probe(IPWD_S_ARP_SENDER *sender, const char *device, in_addr_t ip)
+{
+    if (!sender || !device)
+        return -EINVAL;
+
+    pthread_mutex_lock(&sender->lock);
+
+    IPWD_S_ARP_IFACE *iface = find_name(sender, device);
+    if (!iface)
+    {
+        pthread_mutex_unlock(&sender->lock);
+        return -ENODEV;
+    }
+
+    int rv = iface->fd >= 0 ? 0 : open_socket(iface);
+    if (rv == 0)
+    {
+        unsigned char frame[IPWD_ARP_FRAME_LEN];
+        memcpy(frame, iface->frame, IPWD_ARP_FRAME_LEN);
+        memcpy(frame + IPWD_ARP_FRAME_TPA, &ip, sizeof(ip));
+
+        if (send(iface->fd, frame, IPWD_ARP_FRAME_LEN, 0) < 0)
+            rv = -errno;
+    }
+
+    pthread_mutex_unlock(&sender->lock);
+    return rv;
+}
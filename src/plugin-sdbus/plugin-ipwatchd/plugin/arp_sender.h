@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef IPWATCHD_ARP_SENDER_H
+#define IPWATCHD_ARP_SENDER_H
+
+#include "netlink_monitor.h"
+
+/**
+ * Persistent ARP probe sender.
+ *
+ * Keeps one send-only AF_PACKET socket per interface, opened on the first
+ * probe, and a prebuilt probe frame carrying the interface's MAC. Sending
+ * a probe copies the frame, patches the target address and writes it, so
+ * no libnet context is set up and no address string is parsed per packet.
+ *
+ * The interface list follows netlink through ipwd_arp_sender_update().
+ * All functions may be called from any thread.
+ */
+
+//! Size of an Ethernet ARP frame without padding
+#define IPWD_ARP_FRAME_LEN 42
+
+typedef struct IPWD_S_ARP_SENDER IPWD_S_ARP_SENDER;
+
+/**
+ * Create a sender that knows no interface yet
+ * @return Sender on success, NULL on allocation failure
+ */
+IPWD_S_ARP_SENDER *ipwd_arp_sender_new(void);
+
+/**
+ * Close every socket and release the sender
+ */
+void ipwd_arp_sender_free(IPWD_S_ARP_SENDER *sender);
+
+/**
+ * Apply the new state of a link, as reported by the netlink monitor
+ * A link without MAC is forgotten and its socket closed; a changed MAC
+ * rebuilds the frame template, a rename keeps the socket
+ */
+void ipwd_arp_sender_update(IPWD_S_ARP_SENDER *sender, const IPWD_S_NL_LINK *link);
+
+/**
+ * Broadcast an RFC 5227 probe (sender IP 0.0.0.0) asking who has ip
+ * @param device Interface name
+ * @param ip Probed address (network order)
+ * @return 0 on success, -ENODEV if the interface is unknown, negative errno otherwise
+ */
+int ipwd_arp_sender_probe(IPWD_S_ARP_SENDER *sender, const char *device, in_addr_t ip);
+
+#endif // IPWATCHD_ARP_SENDER_H
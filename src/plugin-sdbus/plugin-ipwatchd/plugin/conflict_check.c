@@ -0,0 +1,281 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "conflict_check.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+//! One submitted request; queued first, then attached to a running check
+typedef struct IPWD_S_CHECK_REQUEST
+{
+    IPWD_S_CHECK_TARGET target;             /**< Requested address and interface */
+    void *waiter;                           /**< Handed back on completion */
+    struct IPWD_S_CHECK_REQUEST *next;      /**< Next request in the queue or check */
+} IPWD_S_CHECK_REQUEST;
+
+//! Probe sequence for one (ifindex, IP) shared by all of its waiters
+typedef struct IPWD_S_CHECK
+{
+    IPWD_S_CHECK_TARGET target;             /**< Probed address and interface */
+    IPWD_S_CHECK_REQUEST *waiters;          /**< Requests completed together */
+    int probes_sent;                        /**< Probes sent so far */
+    IPWD_S_LOOP_TIMER *timer;               /**< Next probe or end of window */
+    IPWD_S_CHECKER *checker;                /**< Owner, for timer callbacks */
+    struct IPWD_S_CHECK *next;              /**< Next running check */
+} IPWD_S_CHECK;
+
+struct IPWD_S_CHECKER
+{
+    IPWD_S_LOOP *loop;                      /**< Loop running probes and callbacks */
+    int wake_fd;                            /**< eventfd signalling queued requests */
+    pthread_mutex_t lock;                   /**< Protects the queue only */
+    IPWD_S_CHECK_REQUEST *queue;            /**< Submitted, not yet picked up */
+    IPWD_S_CHECK_REQUEST **queue_tail;      /**< Append position of the queue */
+    IPWD_S_CHECK *checks;                   /**< Running checks, loop thread only */
+    int nchecks;                            /**< Length of checks */
+    uint64_t latency_usec;                  /**< Capture delivery latency added to the window */
+    ipwd_check_probe_cb probe;              /**< Probe sender */
+    ipwd_check_done_cb done;                /**< Completion callback */
+    void *userdata;                         /**< Passed back to both callbacks */
+};
+
+static void complete_check(IPWD_S_CHECKER *checker, IPWD_S_CHECK *check, const unsigned char *conflict_mac)
+{
+    for (IPWD_S_CHECK **pos = &checker->checks; *pos; pos = &(*pos)->next)
+    {
+        if (*pos == check)
+        {
+            *pos = check->next;
+            checker->nchecks--;
+            break;
+        }
+    }
+
+    ipwd_loop_cancel_timer(checker->loop, check->timer);
+
+    /* Waiters may submit again from the callback; that only touches the queue */
+    IPWD_S_CHECK_REQUEST *req = check->waiters;
+    while (req)
+    {
+        IPWD_S_CHECK_REQUEST *next = req->next;
+        checker->done(req->waiter, &check->target, conflict_mac, checker->userdata);
+        free(req);
+        req = next;
+    }
+    free(check);
+}
+
+static void on_check_timer(void *userdata)
+{
+    IPWD_S_CHECK *check = (IPWD_S_CHECK *)userdata;
+    IPWD_S_CHECKER *checker = check->checker;
+
+    check->timer = NULL;
+
+    /* One interval after the last probe without an answer: the address is free */
+    if (check->probes_sent >= IPWD_CHECK_PROBES)
+    {
+        complete_check(checker, check, NULL);
+        return;
+    }
+
+    checker->probe(&check->target, checker->userdata);
+    check->probes_sent++;
+
+    uint64_t delay = IPWD_CHECK_INTERVAL_USEC;
+    if (check->probes_sent >= IPWD_CHECK_PROBES)
+        delay += checker->latency_usec;
+    check->timer = ipwd_loop_add_timer(checker->loop, delay, on_check_timer, check);
+    if (!check->timer)
+        complete_check(checker, check, NULL);
+}
+
+static void start_request(IPWD_S_CHECKER *checker, IPWD_S_CHECK_REQUEST *req)
+{
+    req->next = NULL;
+
+    /* Join a running check of the same address on the same interface */
+    for (IPWD_S_CHECK *check = checker->checks; check; check = check->next)
+    {
+        if (check->target.ifindex != req->target.ifindex || check->target.ip != req->target.ip)
+            continue;
+
+        IPWD_S_CHECK_REQUEST **tail = &check->waiters;
+        while (*tail)
+            tail = &(*tail)->next;
+        *tail = req;
+        return;
+    }
+
+    IPWD_S_CHECK *check = (IPWD_S_CHECK *)calloc(1, sizeof(IPWD_S_CHECK));
+    if (!check)
+    {
+        checker->done(req->waiter, &req->target, NULL, checker->userdata);
+        free(req);
+        return;
+    }
+
+    check->target = req->target;
+    check->waiters = req;
+    check->checker = checker;
+    check->next = checker->checks;
+    checker->checks = check;
+    checker->nchecks++;
+
+    /* First probe goes out right away, the timer paces the rest */
+    on_check_timer(check);
+}
+
+static void on_wake(int fd, short revents, void *userdata)
+{
+    (void)revents;
+    IPWD_S_CHECKER *checker = (IPWD_S_CHECKER *)userdata;
+    uint64_t value;
+
+    while (read(fd, &value, sizeof(value)) < 0 && errno == EINTR)
+        ;
+
+    pthread_mutex_lock(&checker->lock);
+    IPWD_S_CHECK_REQUEST *req = checker->queue;
+    checker->queue = NULL;
+    checker->queue_tail = &checker->queue;
+    pthread_mutex_unlock(&checker->lock);
+
+    while (req)
+    {
+        IPWD_S_CHECK_REQUEST *next = req->next;
+        start_request(checker, req);
+        req = next;
+    }
+}
+
+IPWD_S_CHECKER *ipwd_checker_new(IPWD_S_LOOP *loop, ipwd_check_probe_cb probe,
+                                 ipwd_check_done_cb done, void *userdata)
+{
+    if (!loop || !probe || !done)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    IPWD_S_CHECKER *checker = (IPWD_S_CHECKER *)calloc(1, sizeof(IPWD_S_CHECKER));
+    if (!checker)
+        return NULL;
+
+    checker->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (checker->wake_fd < 0)
+    {
+        int err = errno;
+        free(checker);
+        errno = err;
+        return NULL;
+    }
+
+    int rv = ipwd_loop_add_fd(loop, checker->wake_fd, on_wake, checker);
+    if (rv < 0)
+    {
+        close(checker->wake_fd);
+        free(checker);
+        errno = -rv;
+        return NULL;
+    }
+
+    pthread_mutex_init(&checker->lock, NULL);
+    checker->loop = loop;
+    checker->queue_tail = &checker->queue;
+    checker->probe = probe;
+    checker->done = done;
+    checker->userdata = userdata;
+    return checker;
+}
+
+void ipwd_checker_free(IPWD_S_CHECKER *checker)
+{
+    if (!checker)
+        return;
+
+    ipwd_loop_remove_fd(checker->loop, checker->wake_fd);
+
+    while (checker->checks)
+        complete_check(checker, checker->checks, NULL);
+
+    /* Requests that never reached the loop still get their answer */
+    IPWD_S_CHECK_REQUEST *req = checker->queue;
+    while (req)
+    {
+        IPWD_S_CHECK_REQUEST *next = req->next;
+        checker->done(req->waiter, &req->target, NULL, checker->userdata);
+        free(req);
+        req = next;
+    }
+
+    close(checker->wake_fd);
+    pthread_mutex_destroy(&checker->lock);
+    free(checker);
+}
+
+void ipwd_checker_set_latency(IPWD_S_CHECKER *checker, uint64_t usec)
+{
+    if (checker)
+        checker->latency_usec = usec;
+}
+
+int ipwd_checker_submit(IPWD_S_CHECKER *checker, const IPWD_S_CHECK_TARGET *target, void *waiter)
+{
+    if (!checker || !target)
+        return -EINVAL;
+
+    IPWD_S_CHECK_REQUEST *req = (IPWD_S_CHECK_REQUEST *)calloc(1, sizeof(IPWD_S_CHECK_REQUEST));
+    if (!req)
+        return -ENOMEM;
+
+    req->target = *target;
+    req->waiter = waiter;
+
+    pthread_mutex_lock(&checker->lock);
+    *checker->queue_tail = req;
+    checker->queue_tail = &req->next;
+    pthread_mutex_unlock(&checker->lock);
+
+    uint64_t one = 1;
+    while (write(checker->wake_fd, &one, sizeof(one)) < 0 && errno == EINTR)
+        ;
+    return 0;
+}
+
+void ipwd_checker_on_arp(IPWD_S_CHECKER *checker, in_addr_t sip, const unsigned char *smac)
+{
+    if (!checker)
+        return;
+
+    IPWD_S_CHECK *check = checker->checks;
+    while (check)
+    {
+        IPWD_S_CHECK *next = check->next;
+
+        /* Another host answering for the address; our own probes carry our MAC */
+        if (sip == check->target.ip && memcmp(smac, check->target.mac, ETH_ALEN) != 0)
+            complete_check(checker, check, smac);
+
+        check = next;
+    }
+}
+
+int ipwd_checker_active(const IPWD_S_CHECKER *checker)
+{
+    return checker ? checker->nchecks : 0;
+}
+
+int ipwd_checker_targets(const IPWD_S_CHECKER *checker, in_addr_t *ips, int max)
+{
+    int n = 0;
+    for (IPWD_S_CHECK *check = checker ? checker->checks : NULL; check && n < max; check = check->next)
+        ips[n++] = check->target.ip;
+    return n;
+}
@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef IPWATCHD_CONFLICT_CHECK_H
+#define IPWATCHD_CONFLICT_CHECK_H
+
+#include "event_loop.h"
+#include <net/ethernet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+
+/**
+ * Asynchronous IP conflict checks requested over D-Bus.
+ *
+ * Requests may be submitted from any thread. Everything else runs on the
+ * loop thread: probes are paced by loop timers, ARP traffic is fed in by
+ * the capture callback and each waiter is completed when its check's
+ * window closes or another host answers for the address. Requests for the
+ * same (ifindex, IP) while a check is running join that check instead of
+ * starting a second probe sequence.
+ */
+
+//! Number of ARP probes sent per check
+#define IPWD_CHECK_PROBES 5
+
+//! Interval between probes; the window closes one interval after the last probe
+#define IPWD_CHECK_INTERVAL_USEC 20000
+
+//! Address to check and the interface to probe it from
+typedef struct
+{
+    int ifindex;                        /**< Kernel interface index */
+    char device[IFNAMSIZ];              /**< Interface name */
+    in_addr_t ip;                       /**< Address to check (network order) */
+    unsigned char mac[ETH_ALEN];        /**< Local MAC of the interface, replies from it are ignored */
+} IPWD_S_CHECK_TARGET;
+
+typedef struct IPWD_S_CHECKER IPWD_S_CHECKER;
+
+/**
+ * Send one ARP probe for a target; called on the loop thread
+ * @return 0 on success, negative on error (the check carries on)
+ */
+typedef int (*ipwd_check_probe_cb)(const IPWD_S_CHECK_TARGET *target, void *userdata);
+
+/**
+ * Report the result of one request; called on the loop thread
+ * @param waiter Pointer given to ipwd_checker_submit
+ * @param target Checked address
+ * @param conflict_mac MAC of the host using the address, NULL if none answered
+ * @param userdata Pointer given to ipwd_checker_new
+ */
+typedef void (*ipwd_check_done_cb)(void *waiter, const IPWD_S_CHECK_TARGET *target,
+                                   const unsigned char *conflict_mac, void *userdata);
+
+/**
+ * Create a checker driven by a loop; call before the loop runs or on its thread
+ * @return Checker on success, NULL on error (errno is set)
+ */
+IPWD_S_CHECKER *ipwd_checker_new(IPWD_S_LOOP *loop, ipwd_check_probe_cb probe,
+                                 ipwd_check_done_cb done, void *userdata);
+
+/**
+ * Complete every outstanding request as if no host answered and release the
+ * checker; call on the loop thread or after the loop has stopped
+ */
+void ipwd_checker_free(IPWD_S_CHECKER *checker);
+
+/**
+ * Set how long captured ARP may take to reach ipwd_checker_on_arp
+ * The window after the last probe stays open that much longer, so that
+ * answers held back by the capture are not missed; call before submitting
+ * @param usec Delivery latency in microseconds, 0 by default
+ */
+void ipwd_checker_set_latency(IPWD_S_CHECKER *checker, uint64_t usec);
+
+/**
+ * Queue a request; callable from any thread
+ * @param waiter Opaque pointer handed back to the done callback exactly once
+ * @return 0 on success, negative errno on error (the done callback is not called)
+ */
+int ipwd_checker_submit(IPWD_S_CHECKER *checker, const IPWD_S_CHECK_TARGET *target, void *waiter);
+
+/**
+ * Feed a captured ARP packet to the running checks; loop thread only
+ */
+void ipwd_checker_on_arp(IPWD_S_CHECKER *checker, in_addr_t sip, const unsigned char *smac);
+
+/**
+ * Number of checks currently probing; loop thread only
+ */
+int ipwd_checker_active(const IPWD_S_CHECKER *checker);
+
+/**
+ * Addresses currently probed, whose answers must reach ipwd_checker_on_arp; loop thread only
+ * @param ips Receives up to max addresses (network order)
+ * @return Number of addresses stored
+ */
+int ipwd_checker_targets(const IPWD_S_CHECKER *checker, in_addr_t *ips, int max);
+
+#endif // IPWATCHD_CONFLICT_CHECK_H
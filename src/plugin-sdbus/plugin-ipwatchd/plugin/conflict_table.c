@@ -0,0 +1,245 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "conflict_table.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+//! Initial number of buckets, a power of two
+#define IPWD_CONFLICT_TABLE_MIN_BUCKETS 64
+
+struct IPWD_S_CONFLICT_TABLE
+{
+    IPCONFLICT_DEV_INFO **key_buckets;      /**< Heads of the (ip, remote_mac) chains */
+    IPCONFLICT_DEV_INFO **mac_buckets;      /**< Heads of the local MAC chains */
+    unsigned int nbuckets;                  /**< Size of both bucket arrays */
+    IPCONFLICT_DEV_INFO *head;              /**< Oldest entry */
+    IPCONFLICT_DEV_INFO *tail;              /**< Newest entry */
+    atomic_int count;                       /**< Number of entries */
+};
+
+/* FNV-1a, enough to spread addresses that often differ in the last bytes only */
+static uint32_t hash_bytes(uint32_t h, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static unsigned int key_bucket(const IPWD_S_CONFLICT_TABLE *table, in_addr_t ip, const uint8_t *remote_mac)
+{
+    uint32_t h = hash_bytes(2166136261u, (const uint8_t *)&ip, sizeof(ip));
+    return hash_bytes(h, remote_mac, ETH_ALEN) & (table->nbuckets - 1);
+}
+
+static unsigned int mac_bucket(const IPWD_S_CONFLICT_TABLE *table, const uint8_t *mac)
+{
+    return hash_bytes(2166136261u, mac, ETH_ALEN) & (table->nbuckets - 1);
+}
+
+static void link_indexes(IPWD_S_CONFLICT_TABLE *table, IPCONFLICT_DEV_INFO *info)
+{
+    IPCONFLICT_DEV_INFO **head = &table->key_buckets[key_bucket(table, info->ip, info->remote_mac)];
+    info->key_prev = NULL;
+    info->key_next = *head;
+    if (*head)
+        (*head)->key_prev = info;
+    *head = info;
+
+    head = &table->mac_buckets[mac_bucket(table, info->mac)];
+    info->mac_prev = NULL;
+    info->mac_next = *head;
+    if (*head)
+        (*head)->mac_prev = info;
+    *head = info;
+}
+
+/* Double the buckets and rehash; on allocation failure the table keeps working with longer chains */
+static void grow(IPWD_S_CONFLICT_TABLE *table)
+{
+    unsigned int nbuckets = table->nbuckets * 2;
+    IPCONFLICT_DEV_INFO **key_buckets = (IPCONFLICT_DEV_INFO **)calloc(nbuckets, sizeof(IPCONFLICT_DEV_INFO *));
+    IPCONFLICT_DEV_INFO **mac_buckets = (IPCONFLICT_DEV_INFO **)calloc(nbuckets, sizeof(IPCONFLICT_DEV_INFO *));
+    if (!key_buckets || !mac_buckets)
+    {
+        free(key_buckets);
+        free(mac_buckets);
+        return;
+    }
+
+    free(table->key_buckets);
+    free(table->mac_buckets);
+    table->key_buckets = key_buckets;
+    table->mac_buckets = mac_buckets;
+    table->nbuckets = nbuckets;
+
+    for (IPCONFLICT_DEV_INFO *info = table->head; info; info = info->all_next)
+        link_indexes(table, info);
+}
+
+IPWD_S_CONFLICT_TABLE *ipwd_conflict_table_new(void)
+{
+    IPWD_S_CONFLICT_TABLE *table = (IPWD_S_CONFLICT_TABLE *)calloc(1, sizeof(IPWD_S_CONFLICT_TABLE));
+    if (!table)
+        return NULL;
+
+    table->nbuckets = IPWD_CONFLICT_TABLE_MIN_BUCKETS;
+    table->key_buckets = (IPCONFLICT_DEV_INFO **)calloc(table->nbuckets, sizeof(IPCONFLICT_DEV_INFO *));
+    table->mac_buckets = (IPCONFLICT_DEV_INFO **)calloc(table->nbuckets, sizeof(IPCONFLICT_DEV_INFO *));
+    if (!table->key_buckets || !table->mac_buckets)
+    {
+        free(table->key_buckets);
+        free(table->mac_buckets);
+        free(table);
+        return NULL;
+    }
+
+    atomic_init(&table->count, 0);
+    return table;
+}
+
+void ipwd_conflict_table_free(IPWD_S_CONFLICT_TABLE *table)
+{
+    if (!table)
+        return;
+
+    IPCONFLICT_DEV_INFO *info = table->head;
+    while (info)
+    {
+        IPCONFLICT_DEV_INFO *next = info->all_next;
+        free(info);
+        info = next;
+    }
+
+    free(table->key_buckets);
+    free(table->mac_buckets);
+    free(table);
+}
+
+int ipwd_conflict_table_count(const IPWD_S_CONFLICT_TABLE *table)
+{
+    return table ? atomic_load(&((IPWD_S_CONFLICT_TABLE *)table)->count) : 0;
+}
+
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_insert(IPWD_S_CONFLICT_TABLE *table, const char *device,
+                                                in_addr_t ip, const uint8_t *mac, const uint8_t *remote_mac)
+{
+    IPCONFLICT_DEV_INFO *info = (IPCONFLICT_DEV_INFO *)calloc(1, sizeof(IPCONFLICT_DEV_INFO));
+    if (!info)
+        return NULL;
+
+    info->ip = ip;
+    memcpy(info->mac, mac, ETH_ALEN);
+    memcpy(info->remote_mac, remote_mac, ETH_ALEN);
+    strncpy(info->device, device, IFNAMSIZ - 1);
+
+    if ((unsigned int)atomic_load(&table->count) >= table->nbuckets)
+        grow(table);
+
+    link_indexes(table, info);
+
+    info->all_prev = table->tail;
+    if (table->tail)
+        table->tail->all_next = info;
+    else
+        table->head = info;
+    table->tail = info;
+
+    atomic_fetch_add(&table->count, 1);
+    return info;
+}
+
+void ipwd_conflict_table_remove(IPWD_S_CONFLICT_TABLE *table, IPCONFLICT_DEV_INFO *info)
+{
+    if (!table || !info)
+        return;
+
+    if (info->key_prev)
+        info->key_prev->key_next = info->key_next;
+    else
+        table->key_buckets[key_bucket(table, info->ip, info->remote_mac)] = info->key_next;
+    if (info->key_next)
+        info->key_next->key_prev = info->key_prev;
+
+    if (info->mac_prev)
+        info->mac_prev->mac_next = info->mac_next;
+    else
+        table->mac_buckets[mac_bucket(table, info->mac)] = info->mac_next;
+    if (info->mac_next)
+        info->mac_next->mac_prev = info->mac_prev;
+
+    if (info->all_prev)
+        info->all_prev->all_next = info->all_next;
+    else
+        table->head = info->all_next;
+    if (info->all_next)
+        info->all_next->all_prev = info->all_prev;
+    else
+        table->tail = info->all_prev;
+
+    atomic_fetch_sub(&table->count, 1);
+    free(info);
+}
+
+static IPCONFLICT_DEV_INFO *match_key(IPCONFLICT_DEV_INFO *info, in_addr_t ip, const uint8_t *remote_mac)
+{
+    while (info && !(info->ip == ip && memcmp(info->remote_mac, remote_mac, ETH_ALEN) == 0))
+        info = info->key_next;
+    return info;
+}
+
+static IPCONFLICT_DEV_INFO *match_mac(IPCONFLICT_DEV_INFO *info, const uint8_t *mac)
+{
+    while (info && memcmp(info->mac, mac, ETH_ALEN) != 0)
+        info = info->mac_next;
+    return info;
+}
+
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_find(const IPWD_S_CONFLICT_TABLE *table, in_addr_t ip,
+                                              const uint8_t *mac, const uint8_t *remote_mac)
+{
+    IPCONFLICT_DEV_INFO *info = ipwd_conflict_table_first_by_key(table, ip, remote_mac);
+    while (info && memcmp(info->mac, mac, ETH_ALEN) != 0)
+        info = ipwd_conflict_table_next_by_key(info);
+    return info;
+}
+
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_first_by_key(const IPWD_S_CONFLICT_TABLE *table,
+                                                      in_addr_t ip, const uint8_t *remote_mac)
+{
+    if (!table || atomic_load(&((IPWD_S_CONFLICT_TABLE *)table)->count) == 0)
+        return NULL;
+    return match_key(table->key_buckets[key_bucket(table, ip, remote_mac)], ip, remote_mac);
+}
+
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_next_by_key(const IPCONFLICT_DEV_INFO *info)
+{
+    return info ? match_key(info->key_next, info->ip, info->remote_mac) : NULL;
+}
+
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_first_by_mac(const IPWD_S_CONFLICT_TABLE *table, const uint8_t *mac)
+{
+    if (!table || atomic_load(&((IPWD_S_CONFLICT_TABLE *)table)->count) == 0)
+        return NULL;
+    return match_mac(table->mac_buckets[mac_bucket(table, mac)], mac);
+}
+
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_next_by_mac(const IPCONFLICT_DEV_INFO *info)
+{
+    return info ? match_mac(info->mac_next, info->mac) : NULL;
+}
+
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_first(const IPWD_S_CONFLICT_TABLE *table)
+{
+    return table ? table->head : NULL;
+}
+
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_next(const IPCONFLICT_DEV_INFO *info)
+{
+    return info ? info->all_next : NULL;
+}
@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef IPWATCHD_CONFLICT_TABLE_H
+#define IPWATCHD_CONFLICT_TABLE_H
+
+#include "reprobe.h"
+#include <net/ethernet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * Table of tracked IP conflicts.
+ *
+ * Entries are hashed by (IP, remote MAC), the key captured packets are
+ * matched on, and indexed a second time by local MAC for the per-interface
+ * walks of the resolve and address-change paths. All chains are doubly
+ * linked so an entry is removed in constant time, also while iterating.
+ *
+ * The table does no locking itself. Only ipwd_conflict_table_count() may be
+ * called without the caller's lock, so that a packet path can skip locking
+ * altogether while nothing is tracked.
+ */
+
+//! Structure for tracking IP conflict information
+typedef struct IPCONFLICT_DEV_INFO
+{
+    in_addr_t ip;                                   /**< IP address (network byte order) */
+    uint8_t mac[ETH_ALEN];                          /**< Local MAC address */
+    uint8_t remote_mac[ETH_ALEN];                   /**< Remote MAC address */
+    char device[IFNAMSIZ];                          /**< Network device name */
+    int signal_count;                               /**< Counter for signal emission */
+    time_t last_conflict_time;                      /**< Last time conflict was detected */
+    int probe_no_response_count;                    /**< Consecutive probes with no conflict response */
+    int probe_answered;                             /**< Conflict seen since the last probe */
+    IPWD_S_REPROBE reprobe;                         /**< Re-probe schedule, owned by the plugin */
+
+    /* Index links, owned by the table */
+    struct IPCONFLICT_DEV_INFO *key_prev, *key_next;  /**< Chain of the (ip, remote_mac) bucket */
+    struct IPCONFLICT_DEV_INFO *mac_prev, *mac_next;  /**< Chain of the local MAC bucket */
+    struct IPCONFLICT_DEV_INFO *all_prev, *all_next;  /**< All entries in insertion order */
+} IPCONFLICT_DEV_INFO;
+
+typedef struct IPWD_S_CONFLICT_TABLE IPWD_S_CONFLICT_TABLE;
+
+/**
+ * Create an empty table
+ * @return Table on success, NULL on allocation failure
+ */
+IPWD_S_CONFLICT_TABLE *ipwd_conflict_table_new(void);
+
+/**
+ * Release the table and every entry in it
+ */
+void ipwd_conflict_table_free(IPWD_S_CONFLICT_TABLE *table);
+
+/**
+ * Number of tracked conflicts; safe to call without the caller's lock
+ */
+int ipwd_conflict_table_count(const IPWD_S_CONFLICT_TABLE *table);
+
+/**
+ * Start tracking a conflict; counters and times are zero
+ * @return New entry, NULL on allocation failure
+ */
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_insert(IPWD_S_CONFLICT_TABLE *table, const char *device,
+                                                in_addr_t ip, const uint8_t *mac, const uint8_t *remote_mac);
+
+/**
+ * Stop tracking a conflict and free the entry
+ */
+void ipwd_conflict_table_remove(IPWD_S_CONFLICT_TABLE *table, IPCONFLICT_DEV_INFO *info);
+
+/**
+ * Look up the entry for a conflict between a local and a remote MAC
+ * @return Entry or NULL if not tracked
+ */
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_find(const IPWD_S_CONFLICT_TABLE *table, in_addr_t ip,
+                                              const uint8_t *mac, const uint8_t *remote_mac);
+
+/**
+ * First entry for (ip, remote_mac), any local MAC; continue with ipwd_conflict_table_next_by_key
+ */
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_first_by_key(const IPWD_S_CONFLICT_TABLE *table,
+                                                      in_addr_t ip, const uint8_t *remote_mac);
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_next_by_key(const IPCONFLICT_DEV_INFO *info);
+
+/**
+ * First entry of a local MAC; continue with ipwd_conflict_table_next_by_mac
+ */
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_first_by_mac(const IPWD_S_CONFLICT_TABLE *table, const uint8_t *mac);
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_next_by_mac(const IPCONFLICT_DEV_INFO *info);
+
+/**
+ * First entry in insertion order; continue with ipwd_conflict_table_next
+ */
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_first(const IPWD_S_CONFLICT_TABLE *table);
+IPCONFLICT_DEV_INFO *ipwd_conflict_table_next(const IPCONFLICT_DEV_INFO *info);
+
+#endif // IPWATCHD_CONFLICT_TABLE_H
@@ -0,0 +1,295 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "event_loop.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct
+{
+    int fd;                     /**< Watched descriptor, -1 for a free slot */
+    ipwd_loop_fd_cb cb;         /**< Readiness callback */
+    void *userdata;             /**< Passed back to the callback */
+} IPWD_S_LOOP_SOURCE;
+
+struct IPWD_S_LOOP_TIMER
+{
+    uint64_t deadline;          /**< Expiry, ipwd_loop_now() microseconds */
+    ipwd_loop_timer_cb cb;      /**< Expiry callback */
+    void *userdata;             /**< Passed back to the callback */
+    IPWD_S_LOOP_TIMER *next;    /**< Next timer by deadline */
+};
+
+struct IPWD_S_LOOP
+{
+    int wake_fd;                                    /**< eventfd used to interrupt poll */
+    int timer_fd;                                   /**< timerfd armed for the first timer */
+    IPWD_S_LOOP_TIMER *timers;                      /**< Pending timers sorted by deadline */
+    atomic_int quit;                                /**< Set by ipwd_loop_quit */
+    atomic_ulong wakeups;                           /**< poll returns, read by tests */
+    IPWD_S_LOOP_SOURCE sources[IPWD_LOOP_MAX_SOURCES];
+    int nsources;                                   /**< High-water mark of used slots */
+};
+
+IPWD_S_LOOP *ipwd_loop_new(void)
+{
+    IPWD_S_LOOP *loop = (IPWD_S_LOOP *)calloc(1, sizeof(IPWD_S_LOOP));
+    if (!loop)
+        return NULL;
+
+    loop->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (loop->wake_fd < 0)
+    {
+        free(loop);
+        return NULL;
+    }
+
+    loop->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (loop->timer_fd < 0)
+    {
+        int err = errno;
+        close(loop->wake_fd);
+        free(loop);
+        errno = err;
+        return NULL;
+    }
+
+    for (int i = 0; i < IPWD_LOOP_MAX_SOURCES; i++)
+        loop->sources[i].fd = -1;
+
+    atomic_init(&loop->quit, 0);
+    atomic_init(&loop->wakeups, 0);
+    return loop;
+}
+
+void ipwd_loop_free(IPWD_S_LOOP *loop)
+{
+    if (!loop)
+        return;
+
+    while (loop->timers)
+    {
+        IPWD_S_LOOP_TIMER *t = loop->timers;
+        loop->timers = t->next;
+        free(t);
+    }
+
+    close(loop->timer_fd);
+    close(loop->wake_fd);
+    free(loop);
+}
+
+uint64_t ipwd_loop_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Arm the timerfd for the first pending timer, or disarm it when none is left */
+static void arm_timer_fd(IPWD_S_LOOP *loop)
+{
+    struct itimerspec its = {0};
+
+    if (loop->timers)
+    {
+        /* An all-zero it_value disarms, so expire at least one nanosecond after the epoch */
+        uint64_t deadline = loop->timers->deadline;
+        its.it_value.tv_sec = deadline / 1000000;
+        its.it_value.tv_nsec = (deadline % 1000000) * 1000;
+        if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0)
+            its.it_value.tv_nsec = 1;
+    }
+
+    timerfd_settime(loop->timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+IPWD_S_LOOP_TIMER *ipwd_loop_add_timer(IPWD_S_LOOP *loop, uint64_t usec, ipwd_loop_timer_cb cb, void *userdata)
+{
+    if (!loop || !cb)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    IPWD_S_LOOP_TIMER *timer = (IPWD_S_LOOP_TIMER *)calloc(1, sizeof(IPWD_S_LOOP_TIMER));
+    if (!timer)
+        return NULL;
+
+    timer->deadline = ipwd_loop_now() + usec;
+    timer->cb = cb;
+    timer->userdata = userdata;
+
+    /* Timers with equal deadlines fire in the order they were added */
+    IPWD_S_LOOP_TIMER **pos = &loop->timers;
+    while (*pos && (*pos)->deadline <= timer->deadline)
+        pos = &(*pos)->next;
+    timer->next = *pos;
+    *pos = timer;
+
+    if (loop->timers == timer)
+        arm_timer_fd(loop);
+    return timer;
+}
+
+void ipwd_loop_cancel_timer(IPWD_S_LOOP *loop, IPWD_S_LOOP_TIMER *timer)
+{
+    if (!loop || !timer)
+        return;
+
+    for (IPWD_S_LOOP_TIMER **pos = &loop->timers; *pos; pos = &(*pos)->next)
+    {
+        if (*pos != timer)
+            continue;
+
+        int was_first = pos == &loop->timers;
+        *pos = timer->next;
+        free(timer);
+        if (was_first)
+            arm_timer_fd(loop);
+        return;
+    }
+}
+
+/* Run every timer that is due; callbacks may add or cancel timers */
+static void dispatch_timers(IPWD_S_LOOP *loop)
+{
+    uint64_t expirations;
+    while (read(loop->timer_fd, &expirations, sizeof(expirations)) < 0 && errno == EINTR)
+        ;
+
+    uint64_t now = ipwd_loop_now();
+    while (loop->timers && loop->timers->deadline <= now)
+    {
+        IPWD_S_LOOP_TIMER *timer = loop->timers;
+        ipwd_loop_timer_cb cb = timer->cb;
+        void *userdata = timer->userdata;
+
+        loop->timers = timer->next;
+        free(timer);
+        cb(userdata);
+    }
+
+    arm_timer_fd(loop);
+}
+
+int ipwd_loop_add_fd(IPWD_S_LOOP *loop, int fd, ipwd_loop_fd_cb cb, void *userdata)
+{
+    if (!loop || fd < 0 || !cb)
+        return -EINVAL;
+
+    for (int i = 0; i < IPWD_LOOP_MAX_SOURCES; i++)
+    {
+        IPWD_S_LOOP_SOURCE *s = &loop->sources[i];
+        if (s->fd >= 0)
+            continue;
+
+        s->fd = fd;
+        s->cb = cb;
+        s->userdata = userdata;
+        if (i >= loop->nsources)
+            loop->nsources = i + 1;
+        return 0;
+    }
+
+    return -ENOSPC;
+}
+
+void ipwd_loop_remove_fd(IPWD_S_LOOP *loop, int fd)
+{
+    if (!loop || fd < 0)
+        return;
+
+    for (int i = 0; i < loop->nsources; i++)
+    {
+        if (loop->sources[i].fd == fd)
+        {
+            loop->sources[i].fd = -1;
+            loop->sources[i].cb = NULL;
+            loop->sources[i].userdata = NULL;
+        }
+    }
+}
+
+int ipwd_loop_run(IPWD_S_LOOP *loop)
+{
+    struct pollfd pfds[IPWD_LOOP_MAX_SOURCES + 2];
+
+    if (!loop)
+        return -EINVAL;
+
+    for (;;)
+    {
+        /* Slot i of the sources maps to pfds[i + 2]; poll ignores negative fds */
+        int n = loop->nsources;
+        pfds[0].fd = loop->wake_fd;
+        pfds[0].events = POLLIN;
+        pfds[0].revents = 0;
+        pfds[1].fd = loop->timer_fd;
+        pfds[1].events = POLLIN;
+        pfds[1].revents = 0;
+        for (int i = 0; i < n; i++)
+        {
+            pfds[i + 2].fd = loop->sources[i].fd;
+            pfds[i + 2].events = POLLIN;
+            pfds[i + 2].revents = 0;
+        }
+
+        if (poll(pfds, n + 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -errno;
+        }
+        atomic_fetch_add(&loop->wakeups, 1);
+
+        /* Quit is only honoured once its eventfd write is seen, so the caller
+         * of ipwd_loop_quit never touches a loop that has already been freed */
+        if (pfds[0].revents & POLLIN)
+        {
+            uint64_t value;
+            while (read(loop->wake_fd, &value, sizeof(value)) < 0 && errno == EINTR)
+                ;
+            if (atomic_load(&loop->quit))
+                return 0;
+        }
+
+        if (pfds[1].revents & POLLIN)
+            dispatch_timers(loop);
+
+        for (int i = 0; i < n; i++)
+        {
+            IPWD_S_LOOP_SOURCE *s = &loop->sources[i];
+
+            /* Skip slots removed or reused by an earlier callback in this round */
+            if (!pfds[i + 2].revents || s->fd < 0 || s->fd != pfds[i + 2].fd)
+                continue;
+
+            s->cb(s->fd, pfds[i + 2].revents, s->userdata);
+        }
+    }
+}
+
+void ipwd_loop_quit(IPWD_S_LOOP *loop)
+{
+    if (!loop)
+        return;
+
+    uint64_t one = 1;
+    atomic_store(&loop->quit, 1);
+    while (write(loop->wake_fd, &one, sizeof(one)) < 0 && errno == EINTR)
+        ;
+}
+
+unsigned long ipwd_loop_wakeups(IPWD_S_LOOP *loop)
+{
+    return loop ? atomic_load(&loop->wakeups) : 0;
+}
@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef IPWATCHD_EVENT_LOOP_H
+#define IPWATCHD_EVENT_LOOP_H
+
+/**
+ * Minimal poll(2) based event loop driving the plugin's capture thread.
+ *
+ * The loop blocks until one of the registered descriptors becomes readable,
+ * so an idle network costs no wakeups. An internal eventfd lets other threads
+ * stop the loop. Sources may only be added or removed from the loop thread
+ * itself, or before the loop is run.
+ *
+ * One-shot timers share a single timerfd armed for the earliest deadline;
+ * it is disarmed while no timer is pending.
+ */
+
+#include <stdint.h>
+
+//! Maximum number of descriptors watched by one loop
+#define IPWD_LOOP_MAX_SOURCES 8
+
+typedef struct IPWD_S_LOOP IPWD_S_LOOP;
+typedef struct IPWD_S_LOOP_TIMER IPWD_S_LOOP_TIMER;
+
+/**
+ * Callback invoked when a watched descriptor is ready
+ * @param fd Ready descriptor
+ * @param revents Events reported by poll(2)
+ * @param userdata Pointer given at registration
+ */
+typedef void (*ipwd_loop_fd_cb)(int fd, short revents, void *userdata);
+
+/**
+ * Callback invoked when a timer expires; its handle is already released
+ * @param userdata Pointer given when the timer was added
+ */
+typedef void (*ipwd_loop_timer_cb)(void *userdata);
+
+/**
+ * Create a new event loop
+ * @return Loop on success, NULL on error (errno is set)
+ */
+IPWD_S_LOOP *ipwd_loop_new(void);
+
+/**
+ * Destroy a loop that is no longer running
+ */
+void ipwd_loop_free(IPWD_S_LOOP *loop);
+
+/**
+ * Watch a descriptor for readability
+ * @return 0 on success, negative errno on error
+ */
+int ipwd_loop_add_fd(IPWD_S_LOOP *loop, int fd, ipwd_loop_fd_cb cb, void *userdata);
+
+/**
+ * Stop watching a descriptor; safe to call from inside a callback
+ */
+void ipwd_loop_remove_fd(IPWD_S_LOOP *loop, int fd);
+
+/**
+ * Run a callback once after a delay; loop thread only
+ * @param usec Delay in microseconds from now
+ * @return Timer handle valid until it fires or is cancelled, NULL on error (errno is set)
+ */
+IPWD_S_LOOP_TIMER *ipwd_loop_add_timer(IPWD_S_LOOP *loop, uint64_t usec, ipwd_loop_timer_cb cb, void *userdata);
+
+/**
+ * Cancel a pending timer and release its handle; loop thread only
+ */
+void ipwd_loop_cancel_timer(IPWD_S_LOOP *loop, IPWD_S_LOOP_TIMER *timer);
+
+/**
+ * Current CLOCK_MONOTONIC time in microseconds, the clock timers run on
+ */
+uint64_t ipwd_loop_now(void);
+
+/**
+ * Dispatch events until ipwd_loop_quit() is called
+ * @return 0 after quit, negative errno if polling failed
+ */
+int ipwd_loop_run(IPWD_S_LOOP *loop);
+
+/**
+ * Ask the loop to return from ipwd_loop_run(); callable from any thread,
+ * also before the loop has started running
+ */
+void ipwd_loop_quit(IPWD_S_LOOP *loop);
+
+/**
+ * Number of times poll(2) returned since the loop was created
+ */
+unsigned long ipwd_loop_wakeups(IPWD_S_LOOP *loop);
+
+#endif // IPWATCHD_EVENT_LOOP_H
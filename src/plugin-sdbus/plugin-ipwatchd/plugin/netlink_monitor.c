@@ -0,0 +1,430 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "netlink_monitor.h"
+#include <errno.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+//! Size of the receive buffer, large enough for one dump datagram
+#define IPWD_NL_BUFSIZ 32768
+
+//! Maximum time to wait for a dump reply
+#define IPWD_NL_DUMP_TIMEOUT_MS 1000
+
+typedef struct
+{
+    IPWD_S_NL_LINK link;        /**< Public state */
+    unsigned int link_gen;      /**< Dump generation that last reported the link */
+    unsigned int addr_gen;      /**< Dump generation that last reported the address */
+} IPWD_S_NL_ENTRY;
+
+struct IPWD_S_NETLINK
+{
+    int fd;                     /**< NETLINK_ROUTE socket, -1 if closed */
+    unsigned int seq;           /**< Sequence number of the last request */
+    unsigned int gen;           /**< Generation of the dump in progress */
+    IPWD_S_NL_ENTRY *links;     /**< Dynamically allocated array of links */
+    int nlinks;                 /**< Number of used entries */
+    int capacity;               /**< Number of allocated entries */
+    ipwd_netlink_cb cb;         /**< Change callback */
+    void *userdata;             /**< Passed back to the callback */
+};
+
+IPWD_S_NETLINK *ipwd_netlink_new(ipwd_netlink_cb cb, void *userdata)
+{
+    IPWD_S_NETLINK *nl = (IPWD_S_NETLINK *)calloc(1, sizeof(IPWD_S_NETLINK));
+    if (!nl)
+        return NULL;
+
+    nl->fd = -1;
+    nl->cb = cb;
+    nl->userdata = userdata;
+    return nl;
+}
+
+void ipwd_netlink_free(IPWD_S_NETLINK *nl)
+{
+    if (!nl)
+        return;
+
+    if (nl->fd >= 0)
+        close(nl->fd);
+    free(nl->links);
+    free(nl);
+}
+
+int ipwd_netlink_fd(const IPWD_S_NETLINK *nl)
+{
+    return nl ? nl->fd : -1;
+}
+
+const IPWD_S_NL_LINK *ipwd_netlink_find(const IPWD_S_NETLINK *nl, const char *name)
+{
+    if (!nl || !name)
+        return NULL;
+
+    for (int i = 0; i < nl->nlinks; i++)
+    {
+        if (strcmp(nl->links[i].link.name, name) == 0)
+            return &nl->links[i].link;
+    }
+    return NULL;
+}
+
+/**
+ * Report a change to the callback if any tracked field differs
+ */
+static void commit_link(IPWD_S_NETLINK *nl, const IPWD_S_NL_LINK *link, const IPWD_S_NL_LINK *old)
+{
+    if (!nl->cb || link->name[0] == '\0')
+        return;
+
+    if (strcmp(link->name, old->name) == 0 &&
+        link->has_mac == old->has_mac &&
+        memcmp(link->mac, old->mac, ETH_ALEN) == 0 &&
+        link->ip == old->ip)
+        return;
+
+    nl->cb(link, old, nl->userdata);
+}
+
+static IPWD_S_NL_ENTRY *find_index(IPWD_S_NETLINK *nl, int ifindex)
+{
+    for (int i = 0; i < nl->nlinks; i++)
+    {
+        if (nl->links[i].link.ifindex == ifindex)
+            return &nl->links[i];
+    }
+    return NULL;
+}
+
+static IPWD_S_NL_ENTRY *get_index(IPWD_S_NETLINK *nl, int ifindex)
+{
+    IPWD_S_NL_ENTRY *entry = find_index(nl, ifindex);
+    if (entry)
+        return entry;
+
+    if (nl->nlinks == nl->capacity)
+    {
+        int capacity = nl->capacity ? nl->capacity * 2 : 8;
+        IPWD_S_NL_ENTRY *links = (IPWD_S_NL_ENTRY *)realloc(nl->links, capacity * sizeof(IPWD_S_NL_ENTRY));
+        if (!links)
+            return NULL;
+        nl->links = links;
+        nl->capacity = capacity;
+    }
+
+    entry = &nl->links[nl->nlinks++];
+    memset(entry, 0, sizeof(*entry));
+    entry->link.ifindex = ifindex;
+    return entry;
+}
+
+/**
+ * Drop a link from the table and report it as gone
+ */
+static void remove_entry(IPWD_S_NETLINK *nl, IPWD_S_NL_ENTRY *entry)
+{
+    IPWD_S_NL_LINK old = entry->link;
+    IPWD_S_NL_LINK gone = entry->link;
+    gone.ip = 0;
+    gone.has_mac = 0;
+    memset(gone.mac, 0, ETH_ALEN);
+
+    /* Remove before notifying so the callback sees a consistent table */
+    *entry = nl->links[--nl->nlinks];
+    commit_link(nl, &gone, &old);
+}
+
+static void handle_link(IPWD_S_NETLINK *nl, const struct nlmsghdr *h)
+{
+    const struct ifinfomsg *ifi = (const struct ifinfomsg *)NLMSG_DATA(h);
+    int len = (int)h->nlmsg_len - (int)NLMSG_LENGTH(sizeof(*ifi));
+    if (len < 0)
+        return;
+
+    if (h->nlmsg_type == RTM_DELLINK)
+    {
+        IPWD_S_NL_ENTRY *entry = find_index(nl, ifi->ifi_index);
+        if (entry)
+            remove_entry(nl, entry);
+        return;
+    }
+
+    IPWD_S_NL_ENTRY *entry = get_index(nl, ifi->ifi_index);
+    if (!entry)
+        return;
+
+    IPWD_S_NL_LINK *link = &entry->link;
+    IPWD_S_NL_LINK old = *link;
+    entry->link_gen = nl->gen;
+    for (const struct rtattr *rta = IFLA_RTA(ifi); RTA_OK(rta, len); rta = RTA_NEXT(rta, len))
+    {
+        if (rta->rta_type == IFLA_IFNAME)
+        {
+            size_t n = RTA_PAYLOAD(rta);
+            if (n > IFNAMSIZ)
+                n = IFNAMSIZ;
+            memset(link->name, 0, IFNAMSIZ);
+            memcpy(link->name, RTA_DATA(rta), n);
+            link->name[IFNAMSIZ - 1] = '\0';
+        }
+        else if (rta->rta_type == IFLA_ADDRESS && RTA_PAYLOAD(rta) == ETH_ALEN)
+        {
+            memcpy(link->mac, RTA_DATA(rta), ETH_ALEN);
+            link->has_mac = 1;
+        }
+    }
+
+    commit_link(nl, link, &old);
+}
+
+static void handle_addr(IPWD_S_NETLINK *nl, const struct nlmsghdr *h)
+{
+    const struct ifaddrmsg *ifa = (const struct ifaddrmsg *)NLMSG_DATA(h);
+    int len = (int)h->nlmsg_len - (int)NLMSG_LENGTH(sizeof(*ifa));
+    if (len < 0 || ifa->ifa_family != AF_INET)
+        return;
+
+    /* SIOCGIFADDR reports the primary address only */
+    if (ifa->ifa_flags & IFA_F_SECONDARY)
+        return;
+
+    in_addr_t local = 0, address = 0;
+    for (const struct rtattr *rta = IFA_RTA(ifa); RTA_OK(rta, len); rta = RTA_NEXT(rta, len))
+    {
+        if (RTA_PAYLOAD(rta) != sizeof(in_addr_t))
+            continue;
+        if (rta->rta_type == IFA_LOCAL)
+            memcpy(&local, RTA_DATA(rta), sizeof(local));
+        else if (rta->rta_type == IFA_ADDRESS)
+            memcpy(&address, RTA_DATA(rta), sizeof(address));
+    }
+
+    /* IFA_ADDRESS is the peer on point-to-point links, IFA_LOCAL is ours */
+    in_addr_t ip = local ? local : address;
+    if (!ip)
+        return;
+
+    if (h->nlmsg_type == RTM_DELADDR)
+    {
+        IPWD_S_NL_ENTRY *entry = find_index(nl, (int)ifa->ifa_index);
+        if (!entry || entry->link.ip != ip)
+            return;
+
+        IPWD_S_NL_LINK old = entry->link;
+        entry->link.ip = 0;
+        commit_link(nl, &entry->link, &old);
+        return;
+    }
+
+    IPWD_S_NL_ENTRY *entry = get_index(nl, (int)ifa->ifa_index);
+    if (!entry)
+        return;
+
+    IPWD_S_NL_LINK old = entry->link;
+    entry->link.ip = ip;
+    entry->addr_gen = nl->gen;
+    commit_link(nl, &entry->link, &old);
+}
+
+int ipwd_netlink_process(IPWD_S_NETLINK *nl, const void *buf, size_t len)
+{
+    int rv = 0;
+
+    if (!nl || !buf)
+        return -EINVAL;
+
+    for (const struct nlmsghdr *h = (const struct nlmsghdr *)buf; NLMSG_OK(h, len); h = NLMSG_NEXT(h, len))
+    {
+        switch (h->nlmsg_type)
+        {
+            case RTM_NEWLINK:
+            case RTM_DELLINK:
+                handle_link(nl, h);
+                break;
+
+            case RTM_NEWADDR:
+            case RTM_DELADDR:
+                handle_addr(nl, h);
+                break;
+
+            case NLMSG_ERROR:
+            {
+                const struct nlmsgerr *err = (const struct nlmsgerr *)NLMSG_DATA(h);
+                if (h->nlmsg_len >= NLMSG_LENGTH(sizeof(*err)) && err->error < 0)
+                    rv = err->error;
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    return rv;
+}
+
+/**
+ * Request a dump and apply replies until NLMSG_DONE
+ * Notifications arriving in between are applied in order as well
+ */
+static int dump(IPWD_S_NETLINK *nl, int type)
+{
+    struct
+    {
+        struct nlmsghdr h;
+        struct rtgenmsg g;
+    } req;
+    char buf[IPWD_NL_BUFSIZ] __attribute__((aligned(NLMSG_ALIGNTO)));
+
+    memset(&req, 0, sizeof(req));
+    req.h.nlmsg_len = NLMSG_LENGTH(sizeof(req.g));
+    req.h.nlmsg_type = type;
+    req.h.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.h.nlmsg_seq = ++nl->seq;
+    req.g.rtgen_family = type == RTM_GETADDR ? AF_INET : AF_UNSPEC;
+
+    if (send(nl->fd, &req, req.h.nlmsg_len, 0) < 0)
+        return -errno;
+
+    for (;;)
+    {
+        ssize_t n = recv(nl->fd, buf, sizeof(buf), 0);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                return -errno;
+
+            struct pollfd pfd = { nl->fd, POLLIN, 0 };
+            int rv = poll(&pfd, 1, IPWD_NL_DUMP_TIMEOUT_MS);
+            if (rv == 0)
+                return -ETIMEDOUT;
+            if (rv < 0 && errno != EINTR)
+                return -errno;
+            continue;
+        }
+
+        int rv = ipwd_netlink_process(nl, buf, (size_t)n);
+
+        size_t left = (size_t)n;
+        for (const struct nlmsghdr *h = (const struct nlmsghdr *)buf; NLMSG_OK(h, left); h = NLMSG_NEXT(h, left))
+        {
+            if (h->nlmsg_seq != nl->seq)
+                continue;
+            if (h->nlmsg_type == NLMSG_DONE)
+                return 0;
+            if (h->nlmsg_type == NLMSG_ERROR)
+                return rv < 0 ? rv : -EIO;
+        }
+    }
+}
+
+/**
+ * Rebuild the table from full dumps
+ * Links and addresses the dumps no longer report were removed while
+ * notifications were being dropped, so they are retired here
+ */
+static int resync(IPWD_S_NETLINK *nl)
+{
+    nl->gen++;
+
+    int rv = dump(nl, RTM_GETLINK);
+    if (rv < 0)
+        return rv;
+
+    for (int i = nl->nlinks - 1; i >= 0; i--)
+    {
+        if (nl->links[i].link_gen != nl->gen)
+            remove_entry(nl, &nl->links[i]);
+    }
+
+    rv = dump(nl, RTM_GETADDR);
+    if (rv < 0)
+        return rv;
+
+    for (int i = 0; i < nl->nlinks; i++)
+    {
+        IPWD_S_NL_ENTRY *entry = &nl->links[i];
+        if (entry->link.ip && entry->addr_gen != nl->gen)
+        {
+            IPWD_S_NL_LINK old = entry->link;
+            entry->link.ip = 0;
+            commit_link(nl, &entry->link, &old);
+        }
+    }
+    return 0;
+}
+
+int ipwd_netlink_open(IPWD_S_NETLINK *nl)
+{
+    if (!nl)
+        return -EINVAL;
+    if (nl->fd >= 0)
+        return 0;
+
+    nl->fd = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (nl->fd < 0)
+        return -errno;
+
+    /* Subscribe before dumping so no change slips between the two */
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR;
+    if (bind(nl->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        int rv = -errno;
+        close(nl->fd);
+        nl->fd = -1;
+        return rv;
+    }
+
+    int rv = resync(nl);
+    if (rv < 0)
+    {
+        close(nl->fd);
+        nl->fd = -1;
+    }
+    return rv;
+}
+
+int ipwd_netlink_dispatch(IPWD_S_NETLINK *nl)
+{
+    char buf[IPWD_NL_BUFSIZ] __attribute__((aligned(NLMSG_ALIGNTO)));
+
+    if (!nl || nl->fd < 0)
+        return -EBADF;
+
+    for (;;)
+    {
+        ssize_t n = recv(nl->fd, buf, sizeof(buf), 0);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return 0;
+            /* Socket buffer overran and notifications were lost */
+            if (errno == ENOBUFS)
+            {
+                int rv = resync(nl);
+                if (rv < 0)
+                    return rv;
+                continue;
+            }
+            return -errno;
+        }
+
+        ipwd_netlink_process(nl, buf, (size_t)n);
+    }
+}
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef IPWATCHD_NETLINK_MONITOR_H
+#define IPWATCHD_NETLINK_MONITOR_H
+
+#include <net/ethernet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <stddef.h>
+
+/**
+ * Interface address table kept current through rtnetlink.
+ *
+ * The table is filled by a dump at open time and then follows
+ * RTMGRP_LINK / RTMGRP_IPV4_IFADDR notifications, so readers never need
+ * to query the kernel. Only the primary IPv4 address of each link is
+ * tracked, matching what SIOCGIFADDR reports.
+ */
+
+//! Cached state of one network interface
+typedef struct
+{
+    int ifindex;                        /**< Kernel interface index */
+    char name[IFNAMSIZ];                /**< Interface name */
+    unsigned char mac[ETH_ALEN];        /**< Hardware address */
+    int has_mac;                        /**< Non-zero if mac is valid */
+    in_addr_t ip;                       /**< Primary IPv4 address (network order), 0 if none */
+} IPWD_S_NL_LINK;
+
+typedef struct IPWD_S_NETLINK IPWD_S_NETLINK;
+
+/**
+ * Callback invoked whenever a link's name, MAC or primary address changes
+ * @param link New state; ip is 0 and has_mac is 0 when the link was removed
+ * @param old Previous state; all zero for a newly seen link
+ * @param userdata Pointer given to ipwd_netlink_new
+ */
+typedef void (*ipwd_netlink_cb)(const IPWD_S_NL_LINK *link, const IPWD_S_NL_LINK *old, void *userdata);
+
+/**
+ * Create an empty table
+ * @return Table on success, NULL on allocation failure
+ */
+IPWD_S_NETLINK *ipwd_netlink_new(ipwd_netlink_cb cb, void *userdata);
+
+/**
+ * Close the socket and release the table
+ */
+void ipwd_netlink_free(IPWD_S_NETLINK *nl);
+
+/**
+ * Subscribe to link and IPv4 address changes and dump the current state
+ * @return 0 on success, negative errno on error
+ */
+int ipwd_netlink_open(IPWD_S_NETLINK *nl);
+
+/**
+ * Descriptor to watch for readability, -1 before ipwd_netlink_open
+ */
+int ipwd_netlink_fd(const IPWD_S_NETLINK *nl);
+
+/**
+ * Read and apply every pending notification without blocking
+ * Resynchronizes with a full dump if the kernel dropped notifications
+ * @return 0 on success, negative errno on error
+ */
+int ipwd_netlink_dispatch(IPWD_S_NETLINK *nl);
+
+/**
+ * Apply one datagram of rtnetlink messages to the table
+ * @return 0 on success, negative errno if the datagram carried an error
+ */
+int ipwd_netlink_process(IPWD_S_NETLINK *nl, const void *buf, size_t len);
+
+/**
+ * Look up a link by name
+ * @return Cached state or NULL if unknown
+ */
+const IPWD_S_NL_LINK *ipwd_netlink_find(const IPWD_S_NETLINK *nl, const char *name);
+
+#endif // IPWATCHD_NETLINK_MONITOR_H
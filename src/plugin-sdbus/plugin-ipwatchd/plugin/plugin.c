@@ -6,6 +6,9 @@
 #include "plugin_adapter.h"
 #include <pthread.h>
 
+static pthread_t thread;
+static int thread_started = 0;
+
 /**
  * Plugin entry point - called by deepin-service-manager
  */
@@ -27,16 +30,17 @@ int DSMRegister(const char *name, void *data)
     
     /* Initialize plugin */
     if (ipwd_plugin_init("/var/lib/ipwatchd/ipwatchd.conf") != 0) {
+        ipwd_plugin_cleanup();
         return -1;
     }
     
-    /* Start ipwatchd in separate thread */
-    pthread_t thread;
+    /* Start ipwatchd in separate thread, joined on unload */
     if (pthread_create(&thread, NULL, (void *)ipwd_plugin_start, NULL) != 0) {
+        ipwd_plugin_cleanup();
         return -1;
     }
     
-    pthread_detach(thread);
+    thread_started = 1;
     return 0;
 }
 
@@ -49,5 +53,10 @@ int DSMUnRegister(const char *name, void *data)
     (void)data;
     
     ipwd_plugin_stop();
+    if (thread_started) {
+        pthread_join(thread, NULL);
+        thread_started = 0;
+    }
+    ipwd_plugin_cleanup();
     return 0;
 }
@@ -5,24 +5,85 @@
 #include "plugin_adapter.h"
 #include "hooks/ipwatchd_hooks.h"
 #include "service.h"
+#include "event_loop.h"
+#include "netlink_monitor.h"
+#include "conflict_check.h"
+#include "arp_sender.h"
+#include "reprobe.h"
+#include "arp_filter.h"
+#include "arp_ring.h"
+#include "script_runner.h"
+#include <errno.h>
+#include <net/if.h>
+#include <poll.h>
 #include <pthread.h>
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <systemd/sd-event.h>
 #include <unistd.h>
 #include <time.h>
 
 /* Forward declarations */
-static void *periodic_probe_thread(void *arg);
+static int reprobe_conflict(void *owner, void *userdata);
+static int check_conflict(void *owner, void *userdata);
+static void on_reprobe_timer(void *userdata);
+static void on_script_timer(void *userdata);
+static int send_check_probe(const IPWD_S_CHECK_TARGET *target, void *userdata);
+static void finish_check(void *waiter, const IPWD_S_CHECK_TARGET *target,
+                         const unsigned char *conflict_mac, void *userdata);
 
 /* Plugin-specific global data */
-IPWD_S_CHECK_CONTEXT check_context = {0};
-IPCONFLICT_DEV_INFO *ipconflict_dev_info = NULL;
+static IPWD_S_CONFLICT_TABLE *conflicts = NULL;
 static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 static pcap_t *plugin_pcap_handle = NULL;
-static volatile int exit_flag = 0;
-static int timeout_ms = 100;
-static pthread_t probe_thread;
-static volatile int probe_thread_running = 0;
+static IPWD_S_LOOP *main_loop = NULL;
+static IPWD_S_NETLINK *netlink = NULL;
+static IPWD_S_CHECKER *checker = NULL;
+static IPWD_S_ARP_SENDER *sender = NULL;
+static IPWD_S_REPROBER *reprober = NULL;
+static IPWD_S_LOOP_TIMER *reprobe_timer = NULL;
+static uint64_t reprobe_timer_deadline = 0;
+static IPWD_S_ARP_FILTER capture_filter;
+static IPWD_S_ARP_RING *ring = NULL;
+static int capture_open = 0;
+static int check_fd = -1;
+static IPWD_S_ARP_FILTER check_filter;
+static IPWD_S_SCRIPT_RUNNER *scripts = NULL;
+static IPWD_S_LOOP_TIMER *script_timer = NULL;
+
+//! A D-Bus conflict check, replied to on the bus thread once the capture thread completes it
+typedef struct IPWD_S_CHECK_REPLY
+{
+    sd_bus_message *m;                          /**< Call to answer, NULL once the caller gave up */
+    char mac[IPWD_MAX_DEVICE_ADDRESS_LEN];      /**< Conflicting MAC, empty if none */
+    int abandoned;                              /**< Already answered on timeout, only to be freed */
+    struct IPWD_S_CHECK_REPLY *next;
+} IPWD_S_CHECK_REPLY;
+
+/* Completed checks; sd-bus is not thread-safe, so only the bus thread replies */
+static pthread_mutex_t reply_mutex = PTHREAD_MUTEX_INITIALIZER;
+static IPWD_S_CHECK_REPLY *replies = NULL;
+static IPWD_S_CHECK_REPLY **replies_tail = &replies;
+static int reply_fd = -1;
+static sd_event_source *reply_source = NULL;
+
+//! Script shipped with ipwatchd, it only shows a desktop notification
+static const char default_script[] = "/usr/sbin/ipwatchd-script";
+
+//! Longest a synchronous RequestIPConflictCheck waits: the probe window, the ring's delivery latency and a margin
+static const uint64_t check_wait_usec = IPWD_CHECK_PROBES * IPWD_CHECK_INTERVAL_USEC
+                                        + IPWD_ARP_RING_RETIRE_MSEC * 1000ULL + 1000000ULL;
+
+//! Interval at which finished conflict scripts are collected
+static const uint64_t script_reap_usec = 200000;
+
+_Static_assert(IPWD_ARP_RING_SLL_LEN + IPWD_ARP_FILTER_SNAPLEN >= IPWD_ARP_HEADER_SIZE + sizeof(IPWD_S_ARP_HEADER),
+               "capture snaplen shorter than what ipwd_analyse reads");
+_Static_assert(IPWD_ARP_RING_RETIRE_MSEC * 1000ULL < IPWD_REPROBE_WINDOW_USEC,
+               "re-probe answers would arrive after the response window");
 
 /* Global variables required by ipwatchd core - defined here for plugin */
 int debug_flag = 0;
@@ -34,271 +95,257 @@ pcap_t *h_pcap = NULL;
 
 /* Hook implementations */
 
+/**
+ * D-Bus boundary: signals carry addresses as strings
+ */
+static void emit_conflict(in_addr_t ip, const uint8_t *mac, const uint8_t *remote_mac, int is_conflict)
+{
+    char ip_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
+    char mac_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
+    char remote_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
+    
+    emit_is_conflict(ipwd_format_ip(ip, ip_str), ipwd_format_mac(mac, mac_str),
+                     ipwd_format_mac(remote_mac, remote_str), is_conflict);
+}
+
+/**
+ * Arm the loop timer for the earliest re-probe step
+ * Left disarmed while no conflict is tracked
+ */
+static void arm_reprobe_timer(void)
+{
+    uint64_t next = ipwd_reprober_next(reprober);
+    if (reprobe_timer && reprobe_timer_deadline == next)
+        return;
+    
+    if (reprobe_timer)
+    {
+        ipwd_loop_cancel_timer(main_loop, reprobe_timer);
+        reprobe_timer = NULL;
+    }
+    if (next == IPWD_REPROBE_NEVER)
+        return;
+    
+    uint64_t now = ipwd_loop_now();
+    reprobe_timer = ipwd_loop_add_timer(main_loop, next > now ? next - now : 0, on_reprobe_timer, NULL);
+    reprobe_timer_deadline = next;
+}
+
+static void on_reprobe_timer(void *userdata)
+{
+    (void)userdata;
+    
+    /* The handle is released before the callback runs */
+    reprobe_timer = NULL;
+    ipwd_reprober_run(reprober, ipwd_loop_now());
+    arm_reprobe_timer();
+}
+
+static void on_script_timer(void *userdata)
+{
+    (void)userdata;
+    
+    /* Poll again while scripts run; no SIGCHLD handler in a shared host process */
+    script_timer = NULL;
+    if (ipwd_script_runner_reap(scripts) > 0)
+        script_timer = ipwd_loop_add_timer(main_loop, script_reap_usec, on_script_timer, NULL);
+}
+
+/**
+ * Stop tracking a conflict: unschedule its probes and free it
+ */
+static void drop_conflict(IPCONFLICT_DEV_INFO *info)
+{
+    ipwd_reprober_remove(reprober, &info->reprobe);
+    ipwd_conflict_table_remove(conflicts, info);
+}
+
 /**
  * Hook: Called after parsing ARP packet
- * Handles IP conflict check requests from D-Bus and updates probe counters
+ * Feeds running D-Bus conflict checks and updates probe counters
  */
-int ipwd_hook_on_arp_packet(const char *rcv_sip, const char *rcv_smac,
-                             const char *rcv_dip, const char *rcv_dmac)
+int ipwd_hook_on_arp_packet(in_addr_t rcv_sip, const uint8_t *rcv_smac,
+                             in_addr_t rcv_dip, const uint8_t *rcv_dmac)
 {
     (void)rcv_dip;
     (void)rcv_dmac;
     
-    pthread_mutex_lock(&mutex);
+    /* Checks live on the capture thread, no locking needed */
+    ipwd_checker_on_arp(checker, rcv_sip, rcv_smac);
     
-    /* Check if we're waiting for a D-Bus reply */
-    if (check_context.wait_reply)
-    {
-        ipwd_message(IPWD_MSG_TYPE_DEBUG, "Hook: Checking packet - waiting for IP:%s, got IP:%s MAC:%s (my MAC:%s)",
-                    check_context.ip, rcv_sip, rcv_smac, check_context.dev.mac);
-        
-        /* Ignore packets from our own MAC address */
-        if (strcasecmp(rcv_smac, check_context.dev.mac) == 0)
-        {
-            ipwd_message(IPWD_MSG_TYPE_DEBUG, "Ignoring packet from our own MAC: %s", rcv_smac);
-            pthread_mutex_unlock(&mutex);
-            return 0;
-        }
-        
-        /* Check if this packet indicates a conflict */
-        if (strcasecmp(rcv_sip, check_context.ip) == 0)
-        {
-            ipwd_message(IPWD_MSG_TYPE_DEBUG, "!!! IP conflict detected: %s with MAC %s",
-                        check_context.ip, rcv_smac);
-            check_context.conflic_mac = strdup(rcv_smac);
-        }
-    }
+    /* Nothing tracked: the usual case */
+    if (ipwd_conflict_table_count(conflicts) == 0)
+        return 0;
     
-    /* Update probe counters for tracked conflicts */
-    IPCONFLICT_DEV_INFO *info = ipconflict_dev_info ? ipconflict_dev_info->next : NULL;
+    /* Update probe counters for tracked conflicts with this remote host */
     time_t now = time(NULL);
-    
-    while (info)
+    for (IPCONFLICT_DEV_INFO *info = ipwd_conflict_table_first_by_key(conflicts, rcv_sip, rcv_smac);
+         info; info = ipwd_conflict_table_next_by_key(info))
     {
-        /* Check if this packet is related to a tracked conflict */
-        if (strcasecmp(rcv_sip, info->ip) == 0)
-        {
-            if (strcasecmp(rcv_smac, info->remote_mac) == 0)
-            {
-                /* Conflict still exists - reset probe counter */
-                info->probe_no_response_count = 0;
-                info->last_conflict_time = now;
-            }
-        }
-        
-        info = info->next;
+        /* Conflict still exists - reset probe counter */
+        info->probe_no_response_count = 0;
+        info->probe_answered = 1;
+        info->last_conflict_time = now;
     }
     
-    pthread_mutex_unlock(&mutex);
     return 0; /* Continue normal processing */
 }
 
 /**
  * Hook: Called when IP conflict is detected
- * Manages conflict tracking list and emits D-Bus signal
+ * Manages conflict tracking table and emits D-Bus signal
  */
-void ipwd_hook_on_conflict(const char *device, const char *ip,
-                           const char *mac, const char *remote_mac,
+void ipwd_hook_on_conflict(const char *device, in_addr_t ip,
+                           const uint8_t *mac, const uint8_t *remote_mac,
                            int is_active_mode)
 {
     (void)is_active_mode;
     
-    pthread_mutex_lock(&mutex);
-    
     /* Emit D-Bus signal */
-    emit_is_conflict(ip, mac, remote_mac, 1);
+    emit_conflict(ip, mac, remote_mac, 1);
     
-    /* Check if this conflict is already in the list */
-    int exist = 0;
-    IPCONFLICT_DEV_INFO *tail = ipconflict_dev_info;
-    IPCONFLICT_DEV_INFO *info = ipconflict_dev_info ? ipconflict_dev_info->next : NULL;
-    time_t now = time(NULL);
-    
-    while (info)
+    /* Add new conflict to table unless already tracked */
+    IPCONFLICT_DEV_INFO *info = ipwd_conflict_table_find(conflicts, ip, mac, remote_mac);
+    if (!info && conflicts)
     {
-        if (strcasecmp(info->ip, ip) == 0 &&
-            strcasecmp(info->mac, mac) == 0 &&
-            strcasecmp(info->remote_mac, remote_mac) == 0)
+        info = ipwd_conflict_table_insert(conflicts, device, ip, mac, remote_mac);
+        if (info && ipwd_reprober_add(reprober, &info->reprobe, info, ipwd_loop_now()) == 0)
         {
-            /* Reset counters - conflict still exists */
-            if (info->signal_count < 3)
-            {
-                info->signal_count = 3;
-            }
-            info->probe_no_response_count = 0;
-            info->last_conflict_time = now;
-            exist = 1;
-            break;
+            arm_reprobe_timer();
         }
-        tail = info;
-        info = info->next;
     }
     
-    /* Add new conflict to list */
-    if (!exist && tail)
+    if (info)
     {
-        IPCONFLICT_DEV_INFO *newinfo = (IPCONFLICT_DEV_INFO *)malloc(sizeof(IPCONFLICT_DEV_INFO));
-        if (newinfo)
+        /* Reset counters - conflict still exists */
+        if (info->signal_count < 3)
         {
-            strncpy(newinfo->ip, ip, IPWD_MAX_DEVICE_ADDRESS_LEN - 1);
-            strncpy(newinfo->mac, mac, IPWD_MAX_DEVICE_ADDRESS_LEN - 1);
-            strncpy(newinfo->remote_mac, remote_mac, IPWD_MAX_DEVICE_ADDRESS_LEN - 1);
-            strncpy(newinfo->device, device, IPWD_MAX_DEVICE_NAME_LEN - 1);
-            newinfo->signal_count = 3;
-            newinfo->last_conflict_time = now;
-            newinfo->last_probe_time = 0;
-            newinfo->probe_no_response_count = 0;
-            newinfo->next = NULL;
-            tail->next = newinfo;
+            info->signal_count = 3;
         }
+        info->probe_no_response_count = 0;
+        info->probe_answered = 1;
+        info->last_conflict_time = time(NULL);
     }
-    
-    pthread_mutex_unlock(&mutex);
 }
 
 /**
  * Hook: Called when conflict is resolved
  * Decrements counter and emits resolve signal when appropriate
  */
-void ipwd_hook_on_conflict_resolved(const char *device, const char *ip,
-                                    const char *mac, const char *remote_mac)
+void ipwd_hook_on_conflict_resolved(const char *device, in_addr_t ip,
+                                    const uint8_t *mac, const uint8_t *remote_mac)
 {
     (void)device;
     (void)remote_mac;  /* Not used - we check all conflicts for this device */
     
-    pthread_mutex_lock(&mutex);
-    
-    /* Find and update all conflict entries for this MAC address */
-    IPCONFLICT_DEV_INFO *pre = ipconflict_dev_info;
-    IPCONFLICT_DEV_INFO *info = pre ? pre->next : NULL;
+    /* Called for every packet and device; nothing to do while nothing is tracked */
+    if (ipwd_conflict_table_count(conflicts) == 0)
+        return;
     
-    int processed_count = 0;
+    /* Update all conflict entries of this local MAC address */
+    IPCONFLICT_DEV_INFO *info = ipwd_conflict_table_first_by_mac(conflicts, mac);
     
     while (info)
     {
-        /* Match only by MAC address - any non-conflict packet means things are improving */
-        if (strcasecmp(info->mac, mac) == 0)
+        IPCONFLICT_DEV_INFO *next = ipwd_conflict_table_next_by_mac(info);
+        
+        /* Check if this specific conflict is resolved:
+         * 1. IP changed (local or remote modified IP) - conflict no longer exists
+         * 2. Remote MAC changed - remote device changed IP
+         */
+        if (info->ip != ip)
         {
-            processed_count++;
-            
-            /* Check if this specific conflict is resolved:
-             * 1. IP changed (local or remote modified IP) - conflict no longer exists
-             * 2. Remote MAC changed - remote device changed IP
-             */
-            int conflict_resolved = 0;
-            if (strcasecmp(info->ip, ip) != 0)
+            if (debug_flag)
             {
+                char old_ip[IPWD_MAX_DEVICE_ADDRESS_LEN], new_ip[IPWD_MAX_DEVICE_ADDRESS_LEN];
+                char local[IPWD_MAX_DEVICE_ADDRESS_LEN], remote[IPWD_MAX_DEVICE_ADDRESS_LEN];
                 ipwd_message(IPWD_MSG_TYPE_DEBUG, 
                             "Conflict resolved: IP changed from %s to %s (MAC:%s, Remote:%s)",
-                            info->ip, ip, info->mac, info->remote_mac);
-                conflict_resolved = 1;
+                            ipwd_format_ip(info->ip, old_ip), ipwd_format_ip(ip, new_ip),
+                            ipwd_format_mac(info->mac, local), ipwd_format_mac(info->remote_mac, remote));
             }
             
-            if (conflict_resolved)
+            /* Immediately resolve - IP changed means conflict is definitely gone */
+            ipwd_message(IPWD_MSG_TYPE_DEBUG, 
+                        "Emitting IPConflictReslove signal immediately");
+            emit_conflict(info->ip, info->mac, info->remote_mac, 0);
+            drop_conflict(info);
+        }
+        else
+        {
+            /* Same IP, just a normal packet - decrement counter (debounce) */
+            if (info->signal_count > 0)
             {
-                /* Immediately resolve - IP changed means conflict is definitely gone */
-                ipwd_message(IPWD_MSG_TYPE_DEBUG, 
-                            "Emitting IPConflictReslove signal immediately");
-                emit_is_conflict(info->ip, info->mac, info->remote_mac, 0);
-                
-                /* Remove from list */
-                IPCONFLICT_DEV_INFO *to_free = info;
-                pre->next = info->next;
-                info = info->next;
-                free(to_free);
-                continue;  /* Don't advance pre since we removed current node */
+                info->signal_count--;
             }
-            else
+            
+            /* Also increment probe no-response counter - indicates network is healthy */
+            info->probe_no_response_count++;
+            
+            if (info->signal_count == 0)
             {
-                /* Same IP, just a normal packet - decrement counter (debounce) */
-                if (info->signal_count > 0)
+                /* Debounce complete - no conflict seen for a while */
+                if (debug_flag)
                 {
-                    info->signal_count--;
-                }
-                
-                /* Also increment probe no-response counter - indicates network is healthy */
-                info->probe_no_response_count++;
-                
-                if (info->signal_count == 0)
-                {
-                    /* Debounce complete - no conflict seen for a while */
+                    char ip_str[IPWD_MAX_DEVICE_ADDRESS_LEN], remote[IPWD_MAX_DEVICE_ADDRESS_LEN];
                     ipwd_message(IPWD_MSG_TYPE_DEBUG, 
                                 "Signal count reached 0! Emitting IPConflictReslove signal for IP:%s Remote:%s", 
-                                info->ip, info->remote_mac);
-                    emit_is_conflict(info->ip, info->mac, info->remote_mac, 0);
-                    
-                    /* Remove from list */
-                    IPCONFLICT_DEV_INFO *to_free = info;
-                    pre->next = info->next;
-                    info = info->next;
-                    free(to_free);
-                    continue;  /* Don't advance pre since we removed current node */
+                                ipwd_format_ip(info->ip, ip_str), ipwd_format_mac(info->remote_mac, remote));
                 }
+                emit_conflict(info->ip, info->mac, info->remote_mac, 0);
+                drop_conflict(info);
             }
         }
-        pre = info;
-        info = info->next;
+        
+        info = next;
     }
-    
-    pthread_mutex_unlock(&mutex);
 }
 
 /**
  * Clear all conflicts for a specific MAC address
  */
-static void clear_conflicts_by_mac(const char *mac)
+static void clear_conflicts_by_mac(const uint8_t *mac)
 {
-    pthread_mutex_lock(&mutex);
-    
-    IPCONFLICT_DEV_INFO *pre = ipconflict_dev_info;
-    IPCONFLICT_DEV_INFO *info = pre ? pre->next : NULL;
+    IPCONFLICT_DEV_INFO *info = ipwd_conflict_table_first_by_mac(conflicts, mac);
     int cleared_count = 0;
     
     while (info)
     {
-        if (strcasecmp(info->mac, mac) == 0)
-        {
-            ipwd_message(IPWD_MSG_TYPE_DEBUG,
-                        "Clearing conflict: IP=%s MAC=%s Remote=%s",
-                        info->ip, info->mac, info->remote_mac);
-            
-            /* Emit resolve signal */
-            emit_is_conflict(info->ip, info->mac, info->remote_mac, 0);
-            
-            /* Remove from list */
-            IPCONFLICT_DEV_INFO *to_free = info;
-            pre->next = info->next;
-            info = info->next;
-            cleared_count++;
-            free(to_free);
-            continue;
-        }
+        IPCONFLICT_DEV_INFO *next = ipwd_conflict_table_next_by_mac(info);
+        char ip_str[IPWD_MAX_DEVICE_ADDRESS_LEN], remote[IPWD_MAX_DEVICE_ADDRESS_LEN];
+        ipwd_message(IPWD_MSG_TYPE_DEBUG,
+                    "Clearing conflict: IP=%s Remote=%s",
+                    ipwd_format_ip(info->ip, ip_str), ipwd_format_mac(info->remote_mac, remote));
         
-        pre = info;
-        info = info->next;
+        /* Emit resolve signal */
+        emit_conflict(info->ip, info->mac, info->remote_mac, 0);
+        drop_conflict(info);
+        cleared_count++;
+        info = next;
     }
     
     if (cleared_count > 0)
     {
+        char mac_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
         ipwd_message(IPWD_MSG_TYPE_DEBUG, "Cleared %d conflicts for MAC %s",
-                    cleared_count, mac);
+                    cleared_count, ipwd_format_mac(mac, mac_str));
     }
-    
-    pthread_mutex_unlock(&mutex);
 }
 
 /**
  * Hook: Called when a device's IP address changes
  * Clears all conflict entries for the old IP
  */
-void ipwd_hook_on_ip_changed(const char *device, const char *old_ip,
-                             const char *new_ip, const char *mac)
+void ipwd_hook_on_ip_changed(const char *device, in_addr_t old_ip,
+                             in_addr_t new_ip, const uint8_t *mac)
 {
-    (void)device;
+    char old_str[IPWD_MAX_DEVICE_ADDRESS_LEN], new_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
+    char mac_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
     
     ipwd_message(IPWD_MSG_TYPE_DEBUG, 
                 "IP changed on device %s: %s -> %s (MAC: %s), clearing old conflicts",
-                device, old_ip, new_ip, mac);
+                device, ipwd_format_ip(old_ip, old_str), ipwd_format_ip(new_ip, new_str),
+                ipwd_format_mac(mac, mac_str));
     
     /* Clear all conflicts for this MAC address */
     clear_conflicts_by_mac(mac);
@@ -309,15 +356,251 @@ void ipwd_hook_on_ip_changed(const char *device, const char *old_ip,
  */
 void ipwd_hook_on_config_loaded(void)
 {
-    /* Initialize conflict tracking list */
-    if (!ipconflict_dev_info)
+    /* Initialize conflict tracking table */
+    if (!conflicts)
+    {
+        conflicts = ipwd_conflict_table_new();
+    }
+}
+
+/**
+ * Hook: Tell ipwd_analyse whether devices are kept current from netlink
+ * Without netlink the analysis falls back to querying every device per packet
+ */
+int ipwd_hook_devices_cached(void)
+{
+    return netlink != NULL;
+}
+
+/**
+ * Hook: Start the user-defined script without waiting for it
+ * Repeated conflicts and floods are dropped by the runner's limits; the
+ * default script only notifies the desktop, which the IPConflict signal does
+ */
+int ipwd_hook_on_run_script(const char *script, const char *device,
+                            in_addr_t ip, const uint8_t *remote_mac)
+{
+    char ip_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
+    
+    if (strcmp(script, default_script) == 0)
     {
-        ipconflict_dev_info = (IPCONFLICT_DEV_INFO *)malloc(sizeof(IPCONFLICT_DEV_INFO));
-        if (ipconflict_dev_info)
+        ipwd_message(IPWD_MSG_TYPE_DEBUG, "Not running %s, conflicts are signalled over D-Bus", script);
+        return 1;
+    }
+    if (!scripts)
+        return 1;
+    
+    int rv = ipwd_script_runner_run(scripts, device, ip, remote_mac, ipwd_loop_now());
+    switch (rv)
+    {
+        case IPWD_SCRIPT_STARTED:
+            if (!script_timer)
+                script_timer = ipwd_loop_add_timer(main_loop, script_reap_usec, on_script_timer, NULL);
+            break;
+        case IPWD_SCRIPT_DUPLICATE:
+            ipwd_message(IPWD_MSG_TYPE_DEBUG, "Script already run for conflict on %s", ipwd_format_ip(ip, ip_str));
+            break;
+        case IPWD_SCRIPT_BUSY:
+        case IPWD_SCRIPT_RATE_LIMITED:
+            ipwd_message(IPWD_MSG_TYPE_INFO, "Too many conflict scripts, not running %s for %s",
+                         script, ipwd_format_ip(ip, ip_str));
+            break;
+        default:
+            ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to execute user-defined script %s: %s", script, strerror(-rv));
+            break;
+    }
+    return 1;
+}
+
+/**
+ * Feed an answer read from the check socket to the running D-Bus checks
+ * The ring delivers the same packet to ipwd_analyse() once its block retires
+ */
+static void on_check_packet(u_char *args, const struct pcap_pkthdr *header, const u_char *packet)
+{
+    (void)args;
+    
+    if (header->caplen < IPWD_ARP_HEADER_SIZE + sizeof(IPWD_S_ARP_HEADER))
+        return;
+    
+    const IPWD_S_ARP_HEADER *arpaddr = (const IPWD_S_ARP_HEADER *)(packet + IPWD_ARP_HEADER_SIZE);
+    in_addr_t sip;
+    memcpy(&sip, arpaddr->arp_spa, sizeof(sip));
+    ipwd_checker_on_arp(checker, sip, arpaddr->arp_sha);
+}
+
+static void close_check_socket(void)
+{
+    if (check_fd < 0)
+        return;
+    
+    ipwd_loop_remove_fd(main_loop, check_fd);
+    close(check_fd);
+    check_fd = -1;
+}
+
+/* Without the check socket, answers arrive when their ring block retires */
+static void fall_back_to_ring(const char *what, int err)
+{
+    ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to %s conflict check socket: %s, waiting out the ring's retire timeout",
+                 what, strerror(err));
+    close_check_socket();
+    ipwd_checker_set_latency(checker, IPWD_ARP_RING_RETIRE_MSEC * 1000ULL);
+}
+
+static void on_check_readable(int fd, short revents, void *userdata)
+{
+    (void)userdata;
+    
+    int rv = ipwd_arp_socket_dispatch(fd, on_check_packet, NULL);
+    if (rv < 0)
+        fall_back_to_ring("read", -rv);
+    else if (revents & (POLLERR | POLLNVAL))
+        fall_back_to_ring("read", EIO);
+}
+
+/**
+ * While D-Bus checks run on the ring, read their answers from a packet socket
+ * without one, so that a lone answer is not held back until its block retires
+ * and the checks keep their plain probe window. Closed again with the last check,
+ * the idle capture keeps the ring's long retire timeout
+ */
+static void refresh_check_socket(void)
+{
+    in_addr_t targets[IPWD_ARP_FILTER_MAX_ADDRS];
+    int n = ring ? ipwd_checker_targets(checker, targets, IPWD_ARP_FILTER_MAX_ADDRS) : 0;
+    
+    if (n == 0)
+    {
+        close_check_socket();
+        return;
+    }
+    
+    if (check_fd < 0)
+    {
+        int fd = ipwd_arp_socket_open(0);
+        if (fd < 0)
+        {
+            fall_back_to_ring("open", -fd);
+            return;
+        }
+        int rv = ipwd_loop_add_fd(main_loop, fd, on_check_readable, NULL);
+        if (rv < 0)
+        {
+            close(fd);
+            fall_back_to_ring("watch", -rv);
+            return;
+        }
+        check_fd = fd;
+        ipwd_arp_filter_init(&check_filter);
+    }
+    
+    /* As many as fit: pass all ARP rather than miss an answer */
+    int rv = ipwd_arp_filter_attach(&check_filter, check_fd, n < IPWD_ARP_FILTER_MAX_ADDRS ? targets : NULL, n);
+    if (rv < 0)
+    {
+        fall_back_to_ring("filter", -rv);
+        return;
+    }
+    ipwd_checker_set_latency(checker, 0);
+}
+
+/**
+ * Narrow the capture filter to the watched addresses and the running D-Bus checks
+ * All ARP passes while addresses are not followed through netlink
+ */
+static void refresh_capture_filter(void)
+{
+    if (!ring && !h_pcap)
+        return;
+    
+    in_addr_t addrs[2 * IPWD_ARP_FILTER_MAX_ADDRS];
+    const int max = (int)(sizeof(addrs) / sizeof(addrs[0]));
+    int n = 0;
+    
+    for (int i = 0; i < devices.devnum && n < max; i++)
+    {
+        if (devices.dev[i].addr)
+            addrs[n++] = devices.dev[i].addr;
+    }
+    n += ipwd_checker_targets(checker, addrs + n, max - n);
+    
+    /* Too many to list: the filter would not fit, pass all ARP instead */
+    int complete = netlink && n < max;
+    
+    int rv = ring ? ipwd_arp_filter_attach(&capture_filter, ipwd_arp_ring_fd(ring), complete ? addrs : NULL, n)
+                  : ipwd_arp_filter_apply(&capture_filter, h_pcap, complete ? addrs : NULL, n);
+    if (rv < 0)
+    {
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to update capture filter - %s",
+                    ring ? strerror(-rv) : pcap_geterr(h_pcap));
+    }
+    else if (rv > 0)
+    {
+        ipwd_message(IPWD_MSG_TYPE_DEBUG, "Capture filter now passes %s",
+                    capture_filter.naddrs < 0 ? "all ARP" : "ARP of watched addresses only");
+    }
+    
+    refresh_check_socket();
+}
+
+/**
+ * Netlink reported a change of a link: mirror it into the devices structure
+ * Runs on the capture thread, the same thread that reads devices in ipwd_analyse
+ */
+static void on_link_changed(const IPWD_S_NL_LINK *link, const IPWD_S_NL_LINK *old, void *userdata)
+{
+    (void)userdata;
+    
+    /* Probe frames follow the MAC of every link, watched or not */
+    ipwd_arp_sender_update(sender, link);
+    
+    /* String forms are kept for messages, replies and the user script */
+    char ip[IPWD_MAX_DEVICE_ADDRESS_LEN] = {0};
+    char mac[IPWD_MAX_DEVICE_ADDRESS_LEN] = {0};
+    
+    if (link->ip)
+        ipwd_format_ip(link->ip, ip);
+    if (link->has_mac)
+        ipwd_format_mac(link->mac, mac);
+    
+    for (int i = 0; i < devices.devnum; i++)
+    {
+        IPWD_S_DEV *dev = &devices.dev[i];
+        if (strcmp(dev->device, link->name) != 0)
+            continue;
+        
+        /* The address of this device went away or was replaced */
+        if (old->ip && old->ip != link->ip && strcmp(old->name, link->name) == 0)
         {
-            memset(ipconflict_dev_info, 0, sizeof(IPCONFLICT_DEV_INFO));
-            ipconflict_dev_info->next = NULL;
+            ipwd_hook_on_ip_changed(dev->device, old->ip, link->ip, old->mac);
         }
+        
+        memcpy(dev->ip, ip, sizeof(dev->ip));
+        memcpy(dev->mac, mac, sizeof(dev->mac));
+        dev->addr = link->ip;
+        memcpy(&dev->hwaddr, link->mac, ETH_ALEN);
+        dev->state = (link->ip && link->has_mac) ? IPWD_DEVICE_STATE_USABLE : IPWD_DEVICE_STATE_UNUSABLE;
+        
+        ipwd_message(IPWD_MSG_TYPE_DEBUG, "Device info (netlink): %s %s-%s", dev->device, dev->ip, dev->mac);
+    }
+    
+    refresh_capture_filter();
+}
+
+static void on_netlink_readable(int fd, short revents, void *userdata)
+{
+    (void)revents;
+    (void)userdata;
+    
+    int rv = ipwd_netlink_dispatch(netlink);
+    if (rv < 0)
+    {
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Netlink monitor failed: %s, querying devices per packet", strerror(-rv));
+        ipwd_loop_remove_fd(main_loop, fd);
+        ipwd_netlink_free(netlink);
+        netlink = NULL;
+        refresh_capture_filter();
     }
 }
 
@@ -329,6 +612,134 @@ void ipwd_hook_on_pcap_ready(void *pcap_handle)
     plugin_pcap_handle = (pcap_t *)pcap_handle;
 }
 
+/**
+ * Bus thread: reply to every completed check
+ * @param wait_for Check the caller waits for, may be NULL
+ * @return 1 if wait_for was among the replies sent, 0 otherwise
+ */
+static int send_replies(const IPWD_S_CHECK_REPLY *wait_for)
+{
+    uint64_t count;
+    if (read(reply_fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+    {
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to read conflict check eventfd: %s", strerror(errno));
+    }
+    
+    pthread_mutex_lock(&reply_mutex);
+    IPWD_S_CHECK_REPLY *reply = replies;
+    replies = NULL;
+    replies_tail = &replies;
+    pthread_mutex_unlock(&reply_mutex);
+    
+    int found = 0;
+    while (reply)
+    {
+        IPWD_S_CHECK_REPLY *next = reply->next;
+        found |= reply == wait_for;
+        sd_bus_reply_method_return(reply->m, "s", reply->mac);
+        sd_bus_message_unref(reply->m);
+        free(reply);
+        reply = next;
+    }
+    return found;
+}
+
+static int on_replies_ready(sd_event_source *source, int fd, uint32_t revents, void *userdata)
+{
+    (void)source;
+    (void)fd;
+    (void)revents;
+    (void)userdata;
+    
+    send_replies(NULL);
+    return 0;
+}
+
+/**
+ * Bus thread: watch the completion eventfd from the event loop driving the bus
+ * Without one, RequestIPConflictCheck waits for its own check instead
+ */
+static int open_reply_channel(void)
+{
+    if (reply_fd >= 0)
+        return 0;
+    
+    reply_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (reply_fd < 0)
+    {
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to create conflict check eventfd: %s", strerror(errno));
+        return -1;
+    }
+    
+    sd_event *event = service_get_dbus() ? sd_bus_get_event(service_get_dbus()) : NULL;
+    int rv = event ? sd_event_add_io(event, &reply_source, reply_fd, EPOLLIN, on_replies_ready, NULL) : -ENODEV;
+    if (rv < 0)
+    {
+        ipwd_message(IPWD_MSG_TYPE_INFO, "No sd-event loop on the bus (%s), conflict checks are answered synchronously",
+                     strerror(-rv));
+        reply_source = NULL;
+    }
+    return 0;
+}
+
+/**
+ * Bus thread: close what open_reply_channel() set up, once the capture thread is gone
+ */
+static void close_reply_channel(void)
+{
+    if (reply_fd < 0)
+        return;
+    
+    /* Checks the capture thread completed on its way out */
+    send_replies(NULL);
+    
+    reply_source = sd_event_source_unref(reply_source);
+    close(reply_fd);
+    reply_fd = -1;
+}
+
+/**
+ * Bus thread: send replies until the one for reply went out, for at most check_wait_usec
+ * A check that is not completed by then is answered with no conflict
+ */
+static void wait_for_reply(IPWD_S_CHECK_REPLY *reply)
+{
+    struct pollfd pfd = { reply_fd, POLLIN, 0 };
+    uint64_t deadline = ipwd_loop_now() + check_wait_usec;
+    
+    for (;;)
+    {
+        uint64_t now = ipwd_loop_now();
+        int timeout = now < deadline ? (int)((deadline - now + 999) / 1000) : 0;
+        int rv = poll(&pfd, 1, timeout);
+        if (rv < 0 && errno != EINTR)
+            break;
+        if (send_replies(reply))
+            return;
+        if (rv == 0)
+            break;
+    }
+    
+    /* The capture thread may complete it meanwhile; whoever takes reply_mutex first answers */
+    pthread_mutex_lock(&reply_mutex);
+    int queued = 0;
+    for (IPWD_S_CHECK_REPLY *r = replies; r; r = r->next)
+        queued |= r == reply;
+    reply->abandoned = !queued;
+    pthread_mutex_unlock(&reply_mutex);
+    
+    if (queued)
+    {
+        send_replies(NULL);
+        return;
+    }
+    
+    ipwd_message(IPWD_MSG_TYPE_ERROR, "Conflict check not completed within %llu ms, replying without a result",
+                 (unsigned long long)(check_wait_usec / 1000));
+    sd_bus_reply_method_return(reply->m, "s", "");
+    reply->m = sd_bus_message_unref(reply->m);
+}
+
 /* Plugin adapter functions */
 
 int ipwd_plugin_init(const char *config_file)
@@ -358,11 +769,112 @@ int ipwd_plugin_init(const char *config_file)
         return -1;
     }
     
+    /* Created here so that ipwd_plugin_stop() works even before the capture thread runs */
+    pthread_mutex_lock(&mutex);
+    if (!main_loop)
+        main_loop = ipwd_loop_new();
+    IPWD_S_LOOP *loop = main_loop;
+    pthread_mutex_unlock(&mutex);
+    if (!loop)
+    {
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to create event loop: %s", strerror(errno));
+        return -1;
+    }
+    
+    if (open_reply_channel() < 0)
+        return -1;
+    
     ipwd_message(IPWD_MSG_TYPE_INFO, "IPwatchD plugin initialized");
     return 0;
 }
 
-int ipwd_plugin_start(void)
+/**
+ * Capture fd is readable: drain everything pcap has buffered
+ * In non-blocking mode pcap_dispatch returns 0 once the buffer is empty
+ */
+static void on_pcap_readable(int fd, short revents, void *userdata)
+{
+    (void)userdata;
+    
+    int rv;
+    while ((rv = pcap_dispatch(h_pcap, -1, ipwd_analyse, NULL)) > 0)
+        ;
+    
+    if (rv == PCAP_ERROR || (revents & (POLLERR | POLLNVAL)))
+    {
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Capture failed - %s", 
+                    rv == PCAP_ERROR ? pcap_geterr(h_pcap) : "descriptor error");
+        ipwd_loop_remove_fd(main_loop, fd);
+        ipwd_loop_quit(main_loop);
+    }
+}
+
+/**
+ * Ring has blocks ready: pass every packet in them to the analysis
+ * Blocks are handed over when full or after IPWD_ARP_RING_RETIRE_MSEC
+ */
+static void on_ring_readable(int fd, short revents, void *userdata)
+{
+    (void)userdata;
+    
+    ipwd_arp_ring_dispatch(ring, ipwd_analyse, NULL);
+    
+    if (revents & (POLLERR | POLLNVAL))
+    {
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Capture failed - descriptor error");
+        ipwd_loop_remove_fd(main_loop, fd);
+        ipwd_loop_quit(main_loop);
+    }
+}
+
+/**
+ * Capture through a TPACKET_V3 ring on all interfaces
+ * Skipped with IPWATCHD_CAPTURE=pcap
+ * @return 0 on success, -1 to fall back to libpcap
+ */
+static int open_ring_capture(void)
+{
+    const char *capture_env = getenv("IPWATCHD_CAPTURE");
+    if (capture_env && strcasecmp(capture_env, "pcap") == 0)
+        return -1;
+    
+    int err = 0;
+    ring = ipwd_arp_ring_open(0, &err);
+    if (!ring)
+    {
+        ipwd_message(IPWD_MSG_TYPE_INFO, "TPACKET_V3 capture unavailable: %s, using libpcap", strerror(-err));
+        return -1;
+    }
+    
+    if (!main_loop || ipwd_loop_add_fd(main_loop, ipwd_arp_ring_fd(ring), on_ring_readable, NULL) < 0)
+    {
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to watch ring capture descriptor, using libpcap");
+        ipwd_arp_ring_free(ring);
+        ring = NULL;
+        return -1;
+    }
+    
+    ipwd_message(IPWD_MSG_TYPE_INFO, "Capturing ARP through a TPACKET_V3 ring");
+    return 0;
+}
+
+/**
+ * Capture through libpcap on the "any" pseudodevice
+ * @return 0 on success, -1 on error
+ */
+/**
+ * Close the libpcap handle, on shutdown and on every failed step of opening it
+ */
+static void close_pcap_capture(void)
+{
+    if (h_pcap)
+    {
+        pcap_close(h_pcap);
+        h_pcap = NULL;
+    }
+}
+
+static int open_pcap_capture(void)
 {
     char errbuf[PCAP_ERRBUF_SIZE];
     struct bpf_program fp;
@@ -401,68 +913,158 @@ int ipwd_plugin_start(void)
         return -1;
     }
     
-    pcap_set_snaplen(h_pcap, BUFSIZ);
+    /* ipwd_analyse reads nothing past the ARP header */
+    pcap_set_snaplen(h_pcap, IPWD_ARP_RING_SLL_LEN + IPWD_ARP_FILTER_SNAPLEN);
     pcap_set_promisc(h_pcap, 0);
-    pcap_set_timeout(h_pcap, timeout_ms);
+    /* Deliver each packet as it arrives instead of waiting for a ring block to fill or time out */
+    pcap_set_immediate_mode(h_pcap, 1);
     
     if (pcap_activate(h_pcap) != 0)
     {
         ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to activate pcap - %s", pcap_geterr(h_pcap));
-        pcap_close(h_pcap);
+        close_pcap_capture();
         return -1;
     }
     
-    /* Compile and set filter */
+    /* Compile and set filter; narrowed to our addresses once netlink reported them */
     if (pcap_compile(h_pcap, &fp, "arp", 0, 0) == -1)
     {
         ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to compile filter - %s", pcap_geterr(h_pcap));
+        close_pcap_capture();
         return -1;
     }
     
-    if (pcap_setfilter(h_pcap, &fp) == -1)
+    int rv = pcap_setfilter(h_pcap, &fp);
+    pcap_freecode(&fp);
+    if (rv == -1)
     {
         ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to set filter - %s", pcap_geterr(h_pcap));
+        close_pcap_capture();
         return -1;
     }
     
-    pcap_freecode(&fp);
+    if (pcap_setnonblock(h_pcap, 1, errbuf) == -1)
+    {
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to set non-blocking mode - %s", errbuf);
+        close_pcap_capture();
+        return -1;
+    }
+    
+    int pcap_fd = pcap_get_selectable_fd(h_pcap);
+    if (pcap_fd < 0 || !main_loop || ipwd_loop_add_fd(main_loop, pcap_fd, on_pcap_readable, NULL) < 0)
+    {
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to watch capture descriptor");
+        close_pcap_capture();
+        return -1;
+    }
     
     /* Call hook */
     ipwd_hook_on_pcap_ready(h_pcap);
     
-    /* Start periodic probe thread */
-    probe_thread_running = 1;
-    if (pthread_create(&probe_thread, NULL, periodic_probe_thread, NULL) != 0)
+    return 0;
+}
+
+int ipwd_plugin_start(void)
+{
+    /* Capture through the ring where the kernel supports it, libpcap otherwise */
+    ipwd_arp_filter_init(&capture_filter);
+    if (open_ring_capture() < 0 && open_pcap_capture() < 0)
+        return -1;
+    
+    /* Counters can be read over D-Bus from here on */
+    pthread_mutex_lock(&mutex);
+    capture_open = 1;
+    pthread_mutex_unlock(&mutex);
+    
+    /* Probes reuse one socket per interface; links are added by the netlink dump below */
+    sender = ipwd_arp_sender_new();
+    
+    /* Keep device addresses current from netlink instead of per-packet ioctls */
+    netlink = ipwd_netlink_new(on_link_changed, NULL);
+    int rv = netlink ? ipwd_netlink_open(netlink) : -ENOMEM;
+    if (rv == 0)
+        rv = ipwd_loop_add_fd(main_loop, ipwd_netlink_fd(netlink), on_netlink_readable, NULL);
+    if (rv < 0)
     {
-        ipwd_message(IPWD_MSG_TYPE_ERROR, "Failed to create probe thread");
-        probe_thread_running = 0;
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to monitor netlink: %s, querying devices per packet", strerror(-rv));
+        ipwd_netlink_free(netlink);
+        netlink = NULL;
     }
-    else
+    
+    /* D-Bus conflict checks are probed and answered from this loop */
+    IPWD_S_CHECKER *new_checker = ipwd_checker_new(main_loop, send_check_probe, finish_check, NULL);
+    if (!new_checker)
     {
-        ipwd_message(IPWD_MSG_TYPE_DEBUG, "Periodic probe thread created");
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to create conflict checker: %s", strerror(errno));
     }
     
-    ipwd_message(IPWD_MSG_TYPE_INFO, "IPwatchD plugin started");
+    /* The ring holds sparse ARP back until its block retires; the check socket lifts that while it is open */
+    ipwd_checker_set_latency(new_checker, ring ? IPWD_ARP_RING_RETIRE_MSEC * 1000ULL : 0);
+    pthread_mutex_lock(&mutex);
+    checker = new_checker;
+    pthread_mutex_unlock(&mutex);
     
-    /* Main loop */
-    while (!exit_flag)
+    /* Only ARP of our addresses is copied to userspace from here on */
+    refresh_capture_filter();
+    
+    /* Tracked conflicts are re-probed from this loop, each on its own schedule */
+    reprober = ipwd_reprober_new(reprobe_conflict, check_conflict, NULL, (unsigned int)(ipwd_loop_now() ^ getpid()));
+    if (!reprober)
     {
-        /* Main loop continuously processes ARP packets */
-        /* The ipwd_hook_on_arp_packet callback will update check_context when needed */
-        pcap_dispatch(h_pcap, -1, ipwd_analyse, NULL);
-        usleep(1000); /* 1ms sleep to free CPU */
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to create re-probe schedule, conflicts resolve by traffic and timeout only");
     }
     
-    /* Stop probe thread */
-    if (probe_thread_running)
+    /* Conflict scripts are spawned from this loop and reaped by its timer */
+    if (config.script && strcmp(config.script, default_script) != 0)
     {
-        probe_thread_running = 0;
-        pthread_join(probe_thread, NULL);
-        ipwd_message(IPWD_MSG_TYPE_DEBUG, "Probe thread joined");
+        scripts = ipwd_script_runner_new(config.script);
+        if (!scripts)
+        {
+            ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to create script runner, %s will not be run", config.script);
+        }
     }
     
+    ipwd_message(IPWD_MSG_TYPE_INFO, "IPwatchD plugin started");
+    
+    /* Main loop: sleeps in poll until ARP traffic, a probe timer or ipwd_plugin_stop() wakes it */
+    /* The ipwd_hook_on_arp_packet callback feeds running conflict checks */
+    rv = ipwd_loop_run(main_loop);
+    if (rv < 0)
+    {
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Event loop failed: %s", strerror(-rv));
+    }
+    
+    /* Answer checks still in flight before the loop goes away */
+    pthread_mutex_lock(&mutex);
+    IPWD_S_CHECKER *old_checker = checker;
+    checker = NULL;
+    pthread_mutex_unlock(&mutex);
+    ipwd_checker_free(old_checker);
+    
     /* Cleanup */
-    pcap_close(h_pcap);
+    close_check_socket();
+    ipwd_reprober_free(reprober);
+    reprober = NULL;
+    reprobe_timer = NULL;
+    ipwd_script_runner_free(scripts);
+    scripts = NULL;
+    script_timer = NULL;
+    /* ipwd_plugin_stop() may run concurrently and must not quit a freed loop */
+    pthread_mutex_lock(&mutex);
+    IPWD_S_LOOP *old_loop = main_loop;
+    main_loop = NULL;
+    pthread_mutex_unlock(&mutex);
+    ipwd_loop_free(old_loop);
+    ipwd_netlink_free(netlink);
+    netlink = NULL;
+    ipwd_arp_sender_free(sender);
+    sender = NULL;
+    pthread_mutex_lock(&mutex);
+    capture_open = 0;
+    pthread_mutex_unlock(&mutex);
+    ipwd_arp_ring_free(ring);
+    ring = NULL;
+    close_pcap_capture();
     closelog();
     
     if (config.script)
@@ -477,16 +1079,9 @@ int ipwd_plugin_start(void)
         devices.dev = NULL;
     }
     
-    /* Free conflict list */
-    IPCONFLICT_DEV_INFO *info = ipconflict_dev_info;
-    while (info)
-    {
-        IPCONFLICT_DEV_INFO *tmp = info;
-        info = info->next;
-        free(tmp);
-    }
-    
-    pthread_mutex_destroy(&mutex);
+    /* Free conflict table */
+    ipwd_conflict_table_free(conflicts);
+    conflicts = NULL;
     
     ipwd_message(IPWD_MSG_TYPE_INFO, "IPwatchD plugin stopped");
     return 0;
@@ -494,29 +1089,44 @@ int ipwd_plugin_start(void)
 
 void ipwd_plugin_stop(void)
 {
-    exit_flag = 1;
+    pthread_mutex_lock(&mutex);
+    ipwd_loop_quit(main_loop);
+    pthread_mutex_unlock(&mutex);
+}
+
+void ipwd_plugin_cleanup(void)
+{
+    /* Left behind when ipwd_plugin_start() failed before running the loop */
+    pthread_mutex_lock(&mutex);
+    IPWD_S_LOOP *old_loop = main_loop;
+    main_loop = NULL;
+    pthread_mutex_unlock(&mutex);
+    ipwd_loop_free(old_loop);
+    
+    close_reply_channel();
 }
 
-int ipwd_check_context_verify(void)
+int ipwd_check_context_verify(IPWD_S_CHECK_CONTEXT *ctx)
 {
-    if (!check_context.ip || !check_context.misc)
+    if (!ctx->ip || !ctx->misc)
     {
         ipwd_message(IPWD_MSG_TYPE_ERROR, "Invalid check context");
         return -1;
     }
     
-    struct in_addr sip, dip;
-    if (inet_aton(check_context.ip, &sip) == 0 || sip.s_addr == 0)
+    struct in_addr sip;
+    if (inet_aton(ctx->ip, &sip) == 0 || sip.s_addr == 0)
     {
-        ipwd_message(IPWD_MSG_TYPE_ERROR, "Invalid IP address: %s", check_context.ip);
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Invalid IP address: %s", ctx->ip);
         return -1;
     }
+    ctx->addr = sip.s_addr;
     
-    memset(&check_context.dev, 0, sizeof(IPWD_S_DEV));
-    check_context.dev.state = IPWD_DEVICE_STATE_UNUSABLE;
+    memset(&ctx->dev, 0, sizeof(IPWD_S_DEV));
+    ctx->dev.state = IPWD_DEVICE_STATE_UNUSABLE;
     
     /* Auto-select device or use specified one */
-    if (check_context.misc[0] == '\0')
+    if (ctx->misc[0] == '\0')
     {
         /* Auto-select: prefer same subnet */
         for (int i = 0; i < devices.devnum; i++)
@@ -528,24 +1138,24 @@ int ipwd_check_context_verify(void)
             if (ipwd_devinfo(dev.device, dev.ip, dev.mac) == IPWD_RV_ERROR)
                 continue;
             
-            if (inet_aton(dev.ip, &dip) != 0)
+            if (ipwd_devinfo_binary(&dev) != IPWD_RV_ERROR)
             {
                 uint8_t *p = (uint8_t*)&sip.s_addr;
-                uint8_t *q = (uint8_t*)&dip.s_addr;
+                uint8_t *q = (uint8_t*)&dev.addr;
                 
                 /* Prefer same subnet (first 3 bytes match) */
                 if (p[0] == q[0] && p[1] == q[1] && p[2] == q[2])
                 {
-                    memcpy(&check_context.dev, &dev, sizeof(IPWD_S_DEV));
-                    check_context.dev.state = IPWD_DEVICE_STATE_USABLE;
+                    memcpy(&ctx->dev, &dev, sizeof(IPWD_S_DEV));
+                    ctx->dev.state = IPWD_DEVICE_STATE_USABLE;
                     break;
                 }
                 
                 /* Fallback to first usable device */
-                if (check_context.dev.state == IPWD_DEVICE_STATE_UNUSABLE)
+                if (ctx->dev.state == IPWD_DEVICE_STATE_UNUSABLE)
                 {
-                    memcpy(&check_context.dev, &dev, sizeof(IPWD_S_DEV));
-                    check_context.dev.state = IPWD_DEVICE_STATE_USABLE;
+                    memcpy(&ctx->dev, &dev, sizeof(IPWD_S_DEV));
+                    ctx->dev.state = IPWD_DEVICE_STATE_USABLE;
                 }
             }
         }
@@ -553,24 +1163,25 @@ int ipwd_check_context_verify(void)
     else
     {
         /* Use specified device */
-        strncpy(check_context.dev.device, check_context.misc, IPWD_MAX_DEVICE_NAME_LEN - 1);
+        strncpy(ctx->dev.device, ctx->misc, IPWD_MAX_DEVICE_NAME_LEN - 1);
         for (int i = 0; i < devices.devnum; i++)
         {
-            if (strcasecmp(check_context.dev.device, devices.dev[i].device) == 0)
+            if (strcasecmp(ctx->dev.device, devices.dev[i].device) == 0)
             {
-                if (ipwd_devinfo(check_context.dev.device, check_context.dev.ip, 
-                                check_context.dev.mac) != IPWD_RV_ERROR)
+                if (ipwd_devinfo(ctx->dev.device, ctx->dev.ip, 
+                                ctx->dev.mac) != IPWD_RV_ERROR &&
+                    ipwd_devinfo_binary(&ctx->dev) != IPWD_RV_ERROR)
                 {
-                    check_context.dev.state = IPWD_DEVICE_STATE_USABLE;
+                    ctx->dev.state = IPWD_DEVICE_STATE_USABLE;
                 }
                 break;
             }
         }
     }
     
-    if (check_context.dev.state == IPWD_DEVICE_STATE_UNUSABLE)
+    if (ctx->dev.state == IPWD_DEVICE_STATE_UNUSABLE)
     {
-        ipwd_message(IPWD_MSG_TYPE_ALERT, "Cannot find usable device for IP %s", check_context.ip);
+        ipwd_message(IPWD_MSG_TYPE_ALERT, "Cannot find usable device for IP %s", ctx->ip);
         return -1;
     }
     
@@ -578,158 +1189,181 @@ int ipwd_check_context_verify(void)
 }
 
 /**
- * Send ARP probe for a specific conflict entry
- * Must be called with mutex locked
+ * Send an ARP probe for ip from device
+ * Goes through the persistent sender; libnet is only used for interfaces
+ * the sender does not know, i.e. while netlink monitoring is unavailable
+ * @param mac Local MAC for the libnet path, NULL to query the device
+ * @return 0 on success, -1 on error
  */
-static void send_conflict_probe(IPCONFLICT_DEV_INFO *info)
+static int send_probe(const char *device, in_addr_t ip, const uint8_t *mac)
 {
-    /* Find device info for sending ARP */
-    char local_ip[IPWD_MAX_DEVICE_ADDRESS_LEN] = {0};
-    char local_mac[IPWD_MAX_DEVICE_ADDRESS_LEN] = {0};
+    char ip_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
+    char mac_str[IPWD_MAX_DEVICE_ADDRESS_LEN] = {0};
     
-    if (ipwd_devinfo(info->device, local_ip, local_mac) == IPWD_RV_ERROR)
+    int rv = sender ? ipwd_arp_sender_probe(sender, device, ip) : -ENODEV;
+    if (rv != -ENODEV)
     {
-        return;
+        if (rv < 0)
+        {
+            ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to send ARP probe for IP:%s on device:%s: %s",
+                        ipwd_format_ip(ip, ip_str), device, strerror(-rv));
+            return -1;
+        }
+        return 0;
     }
     
-    /* Send ARP request to check if conflict still exists */
-    ipwd_genarp(info->device, "0.0.0.0", local_mac,
-                info->ip, "ff:ff:ff:ff:ff:ff", ARPOP_REQUEST);
+    if (mac)
+    {
+        ipwd_format_mac(mac, mac_str);
+    }
+    else
+    {
+        char local_ip[IPWD_MAX_DEVICE_ADDRESS_LEN] = {0};
+        if (ipwd_devinfo(device, local_ip, mac_str) == IPWD_RV_ERROR)
+            return -1;
+    }
+    
+    rv = ipwd_genarp(device, "0.0.0.0", mac_str, ipwd_format_ip(ip, ip_str), "ff:ff:ff:ff:ff:ff", ARPOP_REQUEST);
+    return rv == IPWD_RV_ERROR ? -1 : 0;
+}
+
+/**
+ * Checker: send one probe of a D-Bus conflict check
+ */
+static int send_check_probe(const IPWD_S_CHECK_TARGET *target, void *userdata)
+{
+    (void)userdata;
+    
+    char ip_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
     
-    info->last_probe_time = time(NULL);
+    /* Answers for the checked address must pass the capture filter */
+    refresh_capture_filter();
+    
+    int rv = send_probe(target->device, target->ip, target->mac);
+    ipwd_message(IPWD_MSG_TYPE_DEBUG, "ARP probe for IP:%s on device:%s sent, result:%d",
+                ipwd_format_ip(target->ip, ip_str), target->device, rv);
+    return rv;
 }
 
 /**
- * Periodic probe thread - actively checks if conflicts are resolved
- * Probes every 5 seconds
+ * Checker: reply to a D-Bus conflict check once its window closed
  */
-static void *periodic_probe_thread(void *arg)
+static void finish_check(void *waiter, const IPWD_S_CHECK_TARGET *target,
+                         const unsigned char *conflict_mac, void *userdata)
 {
-    (void)arg;
+    (void)userdata;
     
-    ipwd_message(IPWD_MSG_TYPE_DEBUG, "Periodic probe thread started (interval: 5 seconds)");
+    IPWD_S_CHECK_REPLY *reply = (IPWD_S_CHECK_REPLY *)waiter;
+    char ip_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
     
-    while (probe_thread_running)
+    ipwd_format_ip(target->ip, ip_str);
+    if (conflict_mac)
     {
-        /* Sleep for 5 seconds between probe cycles */
-        for (int i = 0; i < 5 && probe_thread_running; i++)
-        {
-            sleep(1);
-        }
-        
-        if (!probe_thread_running)
-            break;
-        
-        pthread_mutex_lock(&mutex);
-        
-        IPCONFLICT_DEV_INFO *pre = ipconflict_dev_info;
-        IPCONFLICT_DEV_INFO *info = pre ? pre->next : NULL;
-        time_t now = time(NULL);
-        int probed_count = 0;
-        
-        while (info)
-        {
-            /* Check if we should probe this conflict */
-            int should_probe = 1;  /* Always probe in each cycle */
-            int should_timeout = 0;
-            
-            /* Timeout if no conflict seen for 5 minutes */
-            if ((now - info->last_conflict_time) >= 300)
-            {
-                should_timeout = 1;
-            }
-            
-            if (should_timeout)
-            {
-                ipwd_message(IPWD_MSG_TYPE_DEBUG,
-                            "Conflict timeout (5min): IP=%s MAC=%s Remote=%s - auto-resolving",
-                            info->ip, info->mac, info->remote_mac);
-                
-                emit_is_conflict(info->ip, info->mac, info->remote_mac, 0);
-                
-                /* Remove from list */
-                IPCONFLICT_DEV_INFO *to_free = info;
-                pre->next = info->next;
-                info = info->next;
-                free(to_free);
-                continue;
-            }
-            else if (should_probe)
-            {
-                send_conflict_probe(info);
-                probed_count++;
-            }
-            
-            pre = info;
-            info = info->next;
-        }
+        ipwd_format_mac(conflict_mac, reply->mac);
+        ipwd_message(IPWD_MSG_TYPE_DEBUG, "Conflict detected for IP:%s! Returning MAC: %s", ip_str, reply->mac);
+    }
+    else
+    {
+        ipwd_message(IPWD_MSG_TYPE_DEBUG, "No conflict detected for IP:%s, returning empty string", ip_str);
+    }
+    
+    /* The bus thread sends the reply and drops the message, unless it already answered on timeout */
+    pthread_mutex_lock(&reply_mutex);
+    int abandoned = reply->abandoned;
+    if (!abandoned)
+    {
+        *replies_tail = reply;
+        replies_tail = &reply->next;
+    }
+    pthread_mutex_unlock(&reply_mutex);
+    
+    uint64_t one = 1;
+    if (abandoned)
+    {
+        free(reply);
+    }
+    else if (write(reply_fd, &one, sizeof(one)) < 0)
+    {
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to signal conflict check reply: %s", strerror(errno));
+    }
+    
+    refresh_capture_filter();
+}
+
+/**
+ * Send ARP probe for a specific conflict entry
+ * @return 0 on success, -1 on error
+ */
+static int send_conflict_probe(IPCONFLICT_DEV_INFO *info)
+{
+    /* Send ARP request from the current MAC to check if conflict still exists */
+    return send_probe(info->device, info->ip, NULL);
+}
+
+/**
+ * Re-prober: a conflict is due for its next probe
+ */
+static int reprobe_conflict(void *owner, void *userdata)
+{
+    (void)userdata;
+    
+    IPCONFLICT_DEV_INFO *info = (IPCONFLICT_DEV_INFO *)owner;
+    
+    /* Timeout if no conflict seen for 5 minutes */
+    if ((time(NULL) - info->last_conflict_time) >= 300)
+    {
+        char ip_str[IPWD_MAX_DEVICE_ADDRESS_LEN], remote[IPWD_MAX_DEVICE_ADDRESS_LEN];
+        ipwd_message(IPWD_MSG_TYPE_DEBUG,
+                    "Conflict timeout (5min): IP=%s Remote=%s - auto-resolving",
+                    ipwd_format_ip(info->ip, ip_str), ipwd_format_mac(info->remote_mac, remote));
         
-        pthread_mutex_unlock(&mutex);
+        emit_conflict(info->ip, info->mac, info->remote_mac, 0);
+        drop_conflict(info);
+        return IPWD_REPROBE_DONE;
+    }
+    
+    info->probe_answered = 0;
+    return send_conflict_probe(info) == 0 ? IPWD_REPROBE_SENT : IPWD_REPROBE_FAILED;
+}
+
+/**
+ * Re-prober: the response window of a probe closed
+ * Three consecutive probes without a conflicting answer resolve the conflict
+ */
+static int check_conflict(void *owner, void *userdata)
+{
+    (void)userdata;
+    
+    IPCONFLICT_DEV_INFO *info = (IPCONFLICT_DEV_INFO *)owner;
+    
+    if (info->probe_answered)
+    {
+        /* Got conflict response - reset counter */
+        info->probe_no_response_count = 0;
+        return IPWD_REPROBE_ANSWERED;
+    }
+    
+    /* No new conflict seen since probe - increment no-response counter */
+    info->probe_no_response_count++;
+    
+    char ip_str[IPWD_MAX_DEVICE_ADDRESS_LEN], remote[IPWD_MAX_DEVICE_ADDRESS_LEN];
+    ipwd_message(IPWD_MSG_TYPE_DEBUG,
+                "Probe no-response for IP=%s Remote=%s, count now=%d",
+                ipwd_format_ip(info->ip, ip_str), ipwd_format_mac(info->remote_mac, remote),
+                info->probe_no_response_count);
+    
+    if (info->probe_no_response_count >= 3)
+    {
+        ipwd_message(IPWD_MSG_TYPE_DEBUG,
+                    "Conflict resolved by probe (3 no-response): IP=%s Remote=%s",
+                    ip_str, remote);
         
-        /* Wait 2 seconds for ARP responses to arrive */
-        if (probed_count > 0)
-        {
-            sleep(2);
-            
-            /* Now check which probes got no response */
-            pthread_mutex_lock(&mutex);
-            
-            pre = ipconflict_dev_info;
-            info = pre ? pre->next : NULL;
-            time_t check_time = time(NULL);
-            
-            while (info)
-            {
-                /* Check if this conflict was just probed (last_probe_time close to 'now') */
-                if (info->last_probe_time > 0 && (check_time - info->last_probe_time) <= 5)
-                {
-                    /* Check if we got a conflict response after the probe
-                     * If last_conflict_time is older than last_probe_time, no response */
-                    if (info->last_conflict_time < info->last_probe_time)
-                    {
-                        /* No new conflict seen since probe - increment no-response counter */
-                        info->probe_no_response_count++;
-                        
-                        ipwd_message(IPWD_MSG_TYPE_DEBUG,
-                                    "Probe no-response for IP=%s Remote=%s, count now=%d (last_conflict=%ld, last_probe=%ld)",
-                                    info->ip, info->remote_mac, info->probe_no_response_count,
-                                    (long)info->last_conflict_time, (long)info->last_probe_time);
-                        
-                        /* If we've had 3 consecutive probes with no conflict response,
-                         * consider it resolved */
-                        if (info->probe_no_response_count >= 3)
-                        {
-                            ipwd_message(IPWD_MSG_TYPE_DEBUG,
-                                        "Conflict resolved by probe (3 no-response): IP=%s Remote=%s",
-                                        info->ip, info->remote_mac);
-                            
-                            emit_is_conflict(info->ip, info->mac, info->remote_mac, 0);
-                            
-                            /* Remove from list */
-                            IPCONFLICT_DEV_INFO *to_free = info;
-                            pre->next = info->next;
-                            info = info->next;
-                            free(to_free);
-                            continue;
-                        }
-                    }
-                    else
-                    {
-                        /* Got conflict response - reset counter */
-                        info->probe_no_response_count = 0;
-                    }
-                }
-                
-                pre = info;
-                info = info->next;
-            }
-            
-            pthread_mutex_unlock(&mutex);
-        }
+        emit_conflict(info->ip, info->mac, info->remote_mac, 0);
+        drop_conflict(info);
+        return IPWD_REPROBE_DONE;
     }
     
-    ipwd_message(IPWD_MSG_TYPE_DEBUG, "Periodic probe thread stopped");
-    return NULL;
+    return IPWD_REPROBE_SILENT;
 }
 
 int ipwd_conflict_check(sd_bus_message *m, void *userdata, sd_bus_error *ret_error)
@@ -737,70 +1371,91 @@ int ipwd_conflict_check(sd_bus_message *m, void *userdata, sd_bus_error *ret_err
     (void)userdata;
     (void)ret_error;
     
-    pthread_mutex_lock(&mutex);
-
+    IPWD_S_CHECK_CONTEXT ctx;
+    IPWD_S_CHECK_TARGET target;
+    memset(&ctx, 0, sizeof(ctx));
+    memset(&target, 0, sizeof(target));
+    
     /* Get parameters from D-Bus */
-    sd_bus_message_read(m, "ss", &check_context.ip, &check_context.misc);
-    check_context.wait_reply = true;
-    check_context.msg = m;
-    check_context.conflic_mac = NULL;
+    sd_bus_message_read(m, "ss", &ctx.ip, &ctx.misc);
     
     /* Verify and select device */
-    if (ipwd_check_context_verify() < 0)
+    if (ipwd_check_context_verify(&ctx) < 0)
     {
         sd_bus_reply_method_return(m, "s", "");
-        check_context.wait_reply = false;
-        pthread_mutex_unlock(&mutex);
         return 0;
     }
     
-    pthread_mutex_unlock(&mutex);
-    
-    /* Send ARP probes and let main loop handle responses */
-    #define PCAP_MAX_TIMES 5
-    ipwd_message(IPWD_MSG_TYPE_DEBUG, "Starting ARP probe for IP:%s on device:%s MAC:%s", 
-                check_context.ip, check_context.dev.device, check_context.dev.mac);
+    strncpy(target.device, ctx.dev.device, IFNAMSIZ - 1);
+    target.ifindex = if_nametoindex(ctx.dev.device);
+    target.ip = ctx.addr;
+    memcpy(target.mac, &ctx.dev.hwaddr, ETH_ALEN);
     
-    for (int i = 0; i < PCAP_MAX_TIMES; i++)
+    /* The capture thread completes the check, the reply is sent from this thread */
+    IPWD_S_CHECK_REPLY *reply = (IPWD_S_CHECK_REPLY *)calloc(1, sizeof(IPWD_S_CHECK_REPLY));
+    int rv = reply ? 0 : -ENOMEM;
+    if (reply)
     {
+        reply->m = sd_bus_message_ref(m);
         pthread_mutex_lock(&mutex);
-        int rv = ipwd_genarp(check_context.dev.device, "0.0.0.0", check_context.dev.mac,
-                   check_context.ip, "ff:ff:ff:ff:ff:ff", ARPOP_REQUEST);
-        ipwd_message(IPWD_MSG_TYPE_DEBUG, "ARP probe %d/%d sent, result:%d", i+1, PCAP_MAX_TIMES, rv);
-        
-        /* Check if conflict already detected by main loop */
-        int found = (check_context.conflic_mac != NULL);
+        rv = checker ? ipwd_checker_submit(checker, &target, reply) : -ENOTCONN;
         pthread_mutex_unlock(&mutex);
-        
-        if (found)
+    }
+    
+    if (rv < 0)
+    {
+        ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to start conflict check for IP:%s - %s", ctx.ip, strerror(-rv));
+        sd_bus_reply_method_return(m, "s", "");
+        if (reply)
         {
-            ipwd_message(IPWD_MSG_TYPE_DEBUG, "Conflict found early at probe %d", i+1);
-            break;
+            sd_bus_message_unref(reply->m);
+            free(reply);
         }
-            
-        /* Wait for main loop to process responses */
-        usleep(20000); /* 20ms - give main loop time to process */
+        return 0;
     }
     
-    ipwd_message(IPWD_MSG_TYPE_DEBUG, "ARP probing complete, checking result...");
+    ipwd_message(IPWD_MSG_TYPE_DEBUG, "Conflict check queued for IP:%s on device:%s MAC:%s", 
+                ctx.ip, ctx.dev.device, ctx.dev.mac);
     
-    pthread_mutex_lock(&mutex);
+    /* Nothing watches the eventfd without an sd-event loop: wait for this check here */
+    if (!reply_source)
+        wait_for_reply(reply);
+    return 1;
+}
+
+int ipwd_capture_statistics(sd_bus_message *m, void *userdata, sd_bus_error *ret_error)
+{
+    (void)userdata;
+    (void)ret_error;
     
-    /* Reply with result */
-    if (check_context.conflic_mac)
+    const char *backend = "none";
+    IPWD_S_CAPTURE_STATS stats;
+    memset(&stats, 0, sizeof(stats));
+    
+    /* Only socket counters are read; the capture thread keeps dispatching meanwhile */
+    pthread_mutex_lock(&mutex);
+    if (capture_open && ring)
     {
-        ipwd_message(IPWD_MSG_TYPE_DEBUG, "Conflict detected! Returning MAC: %s", check_context.conflic_mac);
-        sd_bus_reply_method_return(m, "s", check_context.conflic_mac);
-        free(check_context.conflic_mac);
-        check_context.conflic_mac = NULL;
+        backend = "tpacket_v3";
+        int rv = ipwd_arp_ring_stats(ring, &stats);
+        if (rv < 0)
+            ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to read capture statistics - %s", strerror(-rv));
     }
-    else
+    else if (capture_open)
     {
-        ipwd_message(IPWD_MSG_TYPE_DEBUG, "No conflict detected, returning empty string");
-        sd_bus_reply_method_return(m, "s", "");
+        struct pcap_stat ps;
+        backend = "pcap";
+        if (pcap_stats(h_pcap, &ps) == 0)
+        {
+            stats.packets = ps.ps_recv;
+            stats.drops = ps.ps_drop;
+        }
+        else
+        {
+            ipwd_message(IPWD_MSG_TYPE_ERROR, "Unable to read capture statistics - %s", pcap_geterr(h_pcap));
+        }
     }
-    
-    check_context.wait_reply = false;
     pthread_mutex_unlock(&mutex);
-    return 0;
+    
+    return sd_bus_reply_method_return(m, "stt", backend, stats.packets, stats.drops);
 }
@@ -6,36 +6,22 @@
 #define PLUGIN_ADAPTER_H
 
 #include "upstream/ipwatchd.h"
+#include "conflict_table.h"
 #include <systemd/sd-bus.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /* Plugin-specific data structures */
 
-//! Structure for IP conflict check context (D-Bus method)
+//! Structure for IP conflict check context (one per D-Bus request)
 typedef struct
 {
-    const char* ip;              /**< IP address to check */
+    const char* ip;              /**< IP address to check, as received over D-Bus */
     const char* misc;            /**< Device name or empty for auto-select */
-    sd_bus_message *msg;         /**< D-Bus message for reply */
     IPWD_S_DEV dev;             /**< Selected device for checking */
-    bool wait_reply;            /**< Flag indicating D-Bus call is waiting */
-    char *conflic_mac;          /**< MAC address of conflicting device (if found) */
+    in_addr_t addr;             /**< IP address to check (network byte order) */
 } IPWD_S_CHECK_CONTEXT;
 
-//! Structure for tracking IP conflict information
-typedef struct IPCONFLICT_DEV_INFO
-{
-    char ip[IPWD_MAX_DEVICE_ADDRESS_LEN];          /**< IP address */
-    char mac[IPWD_MAX_DEVICE_ADDRESS_LEN];         /**< Local MAC address */
-    char remote_mac[IPWD_MAX_DEVICE_ADDRESS_LEN];  /**< Remote MAC address */
-    char device[IPWD_MAX_DEVICE_NAME_LEN];         /**< Network device name */
-    struct IPCONFLICT_DEV_INFO *next;              /**< Next node in list */
-    int signal_count;                               /**< Counter for signal emission */
-    time_t last_conflict_time;                      /**< Last time conflict was detected */
-    time_t last_probe_time;                         /**< Last time we probed this conflict */
-    int probe_no_response_count;                    /**< Consecutive probes with no conflict response */
-} IPCONFLICT_DEV_INFO;
-
 /* Plugin adapter functions */
 
 /**
@@ -56,23 +42,43 @@ int ipwd_plugin_start(void);
  */
 void ipwd_plugin_stop(void);
 
+/**
+ * Release what ipwd_plugin_init() set up on the bus thread
+ * Call from the bus thread once the thread running ipwd_plugin_start() has exited
+ */
+void ipwd_plugin_cleanup(void);
+
 /**
  * D-Bus method: Check for IP conflict
+ * Returns at once; the capture thread completes the check when the probe
+ * window closes or another host answers for the address, and the reply is
+ * sent from the bus thread's sd-event loop. Without an sd-event loop on the
+ * bus the call waits for its check instead, and replies with no conflict if
+ * the check is not completed within the probe window, the ring's delivery
+ * latency and one more second.
  * @param m D-Bus message
  * @param userdata User data (unused)
  * @param ret_error Error return
- * @return 0 on success
+ * @return 1 when the reply is deferred, 0 when already sent
  */
 int ipwd_conflict_check(sd_bus_message *m, void *userdata, sd_bus_error *ret_error);
 
+/**
+ * D-Bus method: Report capture counters
+ * Replies with the capture backend ("tpacket_v3", "pcap" or "none"),
+ * the packets that passed the filter and the packets dropped of them
+ * @param m D-Bus message
+ * @param userdata User data (unused)
+ * @param ret_error Error return
+ * @return Result of sending the reply
+ */
+int ipwd_capture_statistics(sd_bus_message *m, void *userdata, sd_bus_error *ret_error);
+
 /**
  * Verify and select device for IP conflict check
+ * @param ctx Request with ip and misc set; dev and addr are filled in
  * @return 0 on success, negative on error
  */
-int ipwd_check_context_verify(void);
-
-/* Access to plugin-specific data */
-extern IPWD_S_CHECK_CONTEXT check_context;
-extern IPCONFLICT_DEV_INFO *ipconflict_dev_info;
+int ipwd_check_context_verify(IPWD_S_CHECK_CONTEXT *ctx);
 
 #endif // PLUGIN_ADAPTER_H
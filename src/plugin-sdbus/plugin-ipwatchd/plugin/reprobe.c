@@ -0,0 +1,208 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "reprobe.h"
+#include <errno.h>
+#include <stdlib.h>
+
+struct IPWD_S_REPROBER
+{
+    ipwd_reprobe_probe_cb probe_cb;
+    ipwd_reprobe_check_cb check_cb;
+    void *userdata;
+    unsigned int seed;                  /**< State of rand_r for the jitter */
+    IPWD_S_REPROBE **heap;              /**< Min-heap on deadline */
+    int nentries;
+    int capacity;
+};
+
+IPWD_S_REPROBER *ipwd_reprober_new(ipwd_reprobe_probe_cb probe_cb, ipwd_reprobe_check_cb check_cb,
+                                   void *userdata, unsigned int seed)
+{
+    IPWD_S_REPROBER *reprober = (IPWD_S_REPROBER *)calloc(1, sizeof(IPWD_S_REPROBER));
+    if (!reprober)
+        return NULL;
+
+    reprober->probe_cb = probe_cb;
+    reprober->check_cb = check_cb;
+    reprober->userdata = userdata;
+    reprober->seed = seed;
+    return reprober;
+}
+
+void ipwd_reprober_free(IPWD_S_REPROBER *reprober)
+{
+    if (!reprober)
+        return;
+
+    for (int i = 0; i < reprober->nentries; i++)
+        reprober->heap[i]->heap_index = -1;
+    free(reprober->heap);
+    free(reprober);
+}
+
+static void heap_set(IPWD_S_REPROBER *reprober, int i, IPWD_S_REPROBE *entry)
+{
+    reprober->heap[i] = entry;
+    entry->heap_index = i;
+}
+
+static void sift_up(IPWD_S_REPROBER *reprober, int i)
+{
+    IPWD_S_REPROBE *entry = reprober->heap[i];
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (reprober->heap[parent]->deadline <= entry->deadline)
+            break;
+        heap_set(reprober, i, reprober->heap[parent]);
+        i = parent;
+    }
+    heap_set(reprober, i, entry);
+}
+
+static void sift_down(IPWD_S_REPROBER *reprober, int i)
+{
+    IPWD_S_REPROBE *entry = reprober->heap[i];
+    for (;;)
+    {
+        int child = 2 * i + 1;
+        if (child >= reprober->nentries)
+            break;
+        if (child + 1 < reprober->nentries && reprober->heap[child + 1]->deadline < reprober->heap[child]->deadline)
+            child++;
+        if (entry->deadline <= reprober->heap[child]->deadline)
+            break;
+        heap_set(reprober, i, reprober->heap[child]);
+        i = child;
+    }
+    heap_set(reprober, i, entry);
+}
+
+/* Room for the entry is guaranteed by the caller */
+static void schedule(IPWD_S_REPROBER *reprober, IPWD_S_REPROBE *entry, uint64_t deadline)
+{
+    entry->deadline = deadline;
+    heap_set(reprober, reprober->nentries++, entry);
+    sift_up(reprober, entry->heap_index);
+}
+
+/**
+ * Interval for the given number of answered probes, jittered
+ */
+static uint64_t next_interval(IPWD_S_REPROBER *reprober, int backoff)
+{
+    uint64_t interval = IPWD_REPROBE_INTERVAL_USEC;
+    while (backoff-- > 0 && interval < IPWD_REPROBE_MAX_INTERVAL_USEC)
+        interval *= 2;
+    if (interval > IPWD_REPROBE_MAX_INTERVAL_USEC)
+        interval = IPWD_REPROBE_MAX_INTERVAL_USEC;
+
+    uint64_t spread = interval * IPWD_REPROBE_JITTER_PERCENT / 100;
+    uint64_t r = (uint64_t)rand_r(&reprober->seed) % (2 * spread + 1);
+    return interval - spread + r;
+}
+
+int ipwd_reprober_add(IPWD_S_REPROBER *reprober, IPWD_S_REPROBE *entry, void *owner, uint64_t now)
+{
+    if (!reprober || !entry)
+        return -EINVAL;
+
+    /* One slot stays free for the entry ipwd_reprober_run() has out, should a callback add */
+    if (reprober->nentries + 1 >= reprober->capacity)
+    {
+        int capacity = reprober->capacity ? reprober->capacity * 2 : 16;
+        IPWD_S_REPROBE **heap = (IPWD_S_REPROBE **)realloc(reprober->heap, capacity * sizeof(IPWD_S_REPROBE *));
+        if (!heap)
+            return -ENOMEM;
+        reprober->heap = heap;
+        reprober->capacity = capacity;
+    }
+
+    entry->owner = owner;
+    entry->waiting = 0;
+    entry->backoff = 0;
+    schedule(reprober, entry, now + next_interval(reprober, 0));
+    return 0;
+}
+
+void ipwd_reprober_remove(IPWD_S_REPROBER *reprober, IPWD_S_REPROBE *entry)
+{
+    /* Zeroed records that were never added are recognized as well */
+    if (!reprober || !entry || entry->heap_index < 0 || entry->heap_index >= reprober->nentries ||
+        reprober->heap[entry->heap_index] != entry)
+        return;
+
+    int i = entry->heap_index;
+    entry->heap_index = -1;
+
+    IPWD_S_REPROBE *last = reprober->heap[--reprober->nentries];
+    if (last == entry)
+        return;
+
+    heap_set(reprober, i, last);
+    sift_down(reprober, i);
+    sift_up(reprober, last->heap_index);
+}
+
+uint64_t ipwd_reprober_next(const IPWD_S_REPROBER *reprober)
+{
+    if (!reprober || reprober->nentries == 0)
+        return IPWD_REPROBE_NEVER;
+    return reprober->heap[0]->deadline;
+}
+
+/**
+ * Advance one entry that is already out of the heap
+ */
+static void step(IPWD_S_REPROBER *reprober, IPWD_S_REPROBE *entry, uint64_t now)
+{
+    int rv;
+
+    if (!entry->waiting)
+    {
+        rv = reprober->probe_cb(entry->owner, reprober->userdata);
+        if (rv == IPWD_REPROBE_DONE)
+            return;
+        if (rv == IPWD_REPROBE_SENT)
+        {
+            entry->waiting = 1;
+            schedule(reprober, entry, now + IPWD_REPROBE_WINDOW_USEC);
+            return;
+        }
+        schedule(reprober, entry, now + next_interval(reprober, entry->backoff));
+        return;
+    }
+
+    entry->waiting = 0;
+    rv = reprober->check_cb(entry->owner, reprober->userdata);
+    if (rv == IPWD_REPROBE_DONE)
+        return;
+
+    if (rv == IPWD_REPROBE_ANSWERED)
+    {
+        /* Stop doubling once the cap is reached */
+        if ((IPWD_REPROBE_INTERVAL_USEC << entry->backoff) < IPWD_REPROBE_MAX_INTERVAL_USEC)
+            entry->backoff++;
+    }
+    else
+    {
+        entry->backoff = 0;
+    }
+    schedule(reprober, entry, now + next_interval(reprober, entry->backoff));
+}
+
+void ipwd_reprober_run(IPWD_S_REPROBER *reprober, uint64_t now)
+{
+    if (!reprober)
+        return;
+
+    while (reprober->nentries > 0 && reprober->heap[0]->deadline <= now)
+    {
+        /* Taken out first so callbacks may remove it, its slot stays for rescheduling */
+        IPWD_S_REPROBE *entry = reprober->heap[0];
+        ipwd_reprober_remove(reprober, entry);
+        step(reprober, entry, now);
+    }
+}
@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef IPWATCHD_REPROBE_H
+#define IPWATCHD_REPROBE_H
+
+#include <stdint.h>
+
+/**
+ * Per-conflict re-probe schedule.
+ *
+ * Every tracked conflict is probed on its own schedule: a probe, a response
+ * window, then the next probe after an interval that doubles while the
+ * conflicting host keeps answering and drops back to the base interval when
+ * it does not. Each interval is jittered so conflicts recorded together do
+ * not keep probing in bursts.
+ *
+ * The scheduler has no clock and no timer of its own. The owner arms a
+ * single timer for ipwd_reprober_next() and calls ipwd_reprober_run() with
+ * the current time when it expires, which also lets tests drive it with a
+ * simulated clock. Not thread-safe; all calls belong to one thread.
+ */
+
+//! Interval between probes of a conflict nobody answers for
+#define IPWD_REPROBE_INTERVAL_USEC 5000000ULL
+
+//! Upper bound of the backed-off interval
+#define IPWD_REPROBE_MAX_INTERVAL_USEC 80000000ULL
+
+//! Time an answer to a probe may take
+#define IPWD_REPROBE_WINDOW_USEC 2000000ULL
+
+//! Intervals are spread by up to this many percent either way
+#define IPWD_REPROBE_JITTER_PERCENT 20
+
+//! ipwd_reprober_next() while nothing is scheduled
+#define IPWD_REPROBE_NEVER UINT64_MAX
+
+/* Results of the probe and check callbacks */
+#define IPWD_REPROBE_SENT 0         /**< Probe sent, open the response window */
+#define IPWD_REPROBE_FAILED 1       /**< Probe not sent, retry after the current interval */
+#define IPWD_REPROBE_ANSWERED 2     /**< Conflict seen during the window, back off */
+#define IPWD_REPROBE_SILENT 3       /**< No answer, probe again after the base interval */
+#define IPWD_REPROBE_DONE 4         /**< The entry was removed, forget it */
+
+//! Schedule state of one conflict, embedded in the caller's record
+typedef struct IPWD_S_REPROBE
+{
+    void *owner;                /**< Record passed to the callbacks */
+    uint64_t deadline;          /**< Next step, microseconds on the caller's clock */
+    int waiting;                /**< A probe is out and deadline closes its window */
+    int backoff;                /**< Consecutive answered probes */
+    int heap_index;             /**< Position in the schedule, -1 if not scheduled */
+} IPWD_S_REPROBE;
+
+typedef struct IPWD_S_REPROBER IPWD_S_REPROBER;
+
+/**
+ * Callback sending the next probe of a conflict
+ * @return IPWD_REPROBE_SENT, IPWD_REPROBE_FAILED or IPWD_REPROBE_DONE
+ */
+typedef int (*ipwd_reprobe_probe_cb)(void *owner, void *userdata);
+
+/**
+ * Callback evaluating a conflict once the response window of its probe closed
+ * @return IPWD_REPROBE_ANSWERED, IPWD_REPROBE_SILENT or IPWD_REPROBE_DONE
+ */
+typedef int (*ipwd_reprobe_check_cb)(void *owner, void *userdata);
+
+/**
+ * Create an empty schedule
+ * @param seed Seed of the jitter, fixed in tests
+ * @return Scheduler on success, NULL on allocation failure
+ */
+IPWD_S_REPROBER *ipwd_reprober_new(ipwd_reprobe_probe_cb probe_cb, ipwd_reprobe_check_cb check_cb,
+                                   void *userdata, unsigned int seed);
+
+/**
+ * Release the scheduler; scheduled entries are left to their owners
+ */
+void ipwd_reprober_free(IPWD_S_REPROBER *reprober);
+
+/**
+ * Schedule the first probe of a conflict one jittered base interval from now
+ * @return 0 on success, negative errno on error
+ */
+int ipwd_reprober_add(IPWD_S_REPROBER *reprober, IPWD_S_REPROBE *entry, void *owner, uint64_t now);
+
+/**
+ * Unschedule a conflict; safe to call from the callbacks and for unscheduled entries
+ */
+void ipwd_reprober_remove(IPWD_S_REPROBER *reprober, IPWD_S_REPROBE *entry);
+
+/**
+ * Earliest deadline, IPWD_REPROBE_NEVER if nothing is scheduled
+ */
+uint64_t ipwd_reprober_next(const IPWD_S_REPROBER *reprober);
+
+/**
+ * Run every step due at now, in deadline order
+ */
+void ipwd_reprober_run(IPWD_S_REPROBER *reprober, uint64_t now);
+
+#endif // IPWATCHD_REPROBE_H
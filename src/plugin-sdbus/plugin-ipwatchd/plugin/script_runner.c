@@ -0,0 +1,233 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "script_runner.h"
+#include "upstream/ipwatchd.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <net/ethernet.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+//! A conflict the script was started for
+typedef struct
+{
+    in_addr_t ip;
+    uint8_t mac[ETH_ALEN];
+    int used;
+    uint64_t started;                   /**< Time of the last start */
+} IPWD_S_SCRIPT_RECENT;
+
+struct IPWD_S_SCRIPT_RUNNER
+{
+    char *command;                      /**< Copy of the command, split in place */
+    char **argv;                        /**< Command words, then room for device, ip, mac and NULL */
+    int argc;                           /**< Command words in argv */
+    pid_t running[IPWD_SCRIPT_MAX_RUNNING];
+    int nrunning;
+    int tokens;                         /**< Starts left in the bucket */
+    uint64_t refilled;                  /**< Time up to which tokens were added, 0 before the first run */
+    IPWD_S_SCRIPT_RECENT recent[IPWD_SCRIPT_DEDUP_SLOTS];
+    unsigned long started;
+};
+
+IPWD_S_SCRIPT_RUNNER *ipwd_script_runner_new(const char *command)
+{
+    if (!command)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    IPWD_S_SCRIPT_RUNNER *runner = (IPWD_S_SCRIPT_RUNNER *)calloc(1, sizeof(IPWD_S_SCRIPT_RUNNER));
+    if (!runner)
+        return NULL;
+
+    runner->command = strdup(command);
+    runner->argv = (char **)calloc(strlen(command) / 2 + 1 + 4, sizeof(char *));
+    if (!runner->command || !runner->argv)
+    {
+        ipwd_script_runner_free(runner);
+        return NULL;
+    }
+
+    /* Words separated by blanks, like the shell saw them; no quoting or expansion */
+    char *save = NULL;
+    for (char *word = strtok_r(runner->command, " \t", &save); word; word = strtok_r(NULL, " \t", &save))
+        runner->argv[runner->argc++] = word;
+
+    if (runner->argc == 0)
+    {
+        ipwd_script_runner_free(runner);
+        errno = EINVAL;
+        return NULL;
+    }
+    runner->tokens = IPWD_SCRIPT_BURST;
+    return runner;
+}
+
+void ipwd_script_runner_free(IPWD_S_SCRIPT_RUNNER *runner)
+{
+    if (!runner)
+        return;
+
+    ipwd_script_runner_reap(runner);
+    free(runner->argv);
+    free(runner->command);
+    free(runner);
+}
+
+int ipwd_script_runner_reap(IPWD_S_SCRIPT_RUNNER *runner)
+{
+    int i = 0;
+    while (i < runner->nrunning)
+    {
+        int status;
+        pid_t rv = waitpid(runner->running[i], &status, WNOHANG);
+
+        /* Still running, or interrupted: look again next time */
+        if (rv == 0 || (rv < 0 && errno == EINTR))
+        {
+            i++;
+            continue;
+        }
+
+        /* Exited, or already collected by the host process (ECHILD) */
+        runner->running[i] = runner->running[--runner->nrunning];
+    }
+    return runner->nrunning;
+}
+
+unsigned long ipwd_script_runner_started(const IPWD_S_SCRIPT_RUNNER *runner)
+{
+    return runner ? runner->started : 0;
+}
+
+static IPWD_S_SCRIPT_RECENT *find_recent(IPWD_S_SCRIPT_RUNNER *runner, in_addr_t ip, const uint8_t *mac)
+{
+    for (int i = 0; i < IPWD_SCRIPT_DEDUP_SLOTS; i++)
+    {
+        IPWD_S_SCRIPT_RECENT *recent = &runner->recent[i];
+        if (recent->used && recent->ip == ip && memcmp(recent->mac, mac, ETH_ALEN) == 0)
+            return recent;
+    }
+    return NULL;
+}
+
+/* Free slot or the one started longest ago */
+static IPWD_S_SCRIPT_RECENT *oldest_recent(IPWD_S_SCRIPT_RUNNER *runner)
+{
+    IPWD_S_SCRIPT_RECENT *oldest = &runner->recent[0];
+    for (int i = 0; i < IPWD_SCRIPT_DEDUP_SLOTS; i++)
+    {
+        if (!runner->recent[i].used)
+            return &runner->recent[i];
+        if (runner->recent[i].started < oldest->started)
+            oldest = &runner->recent[i];
+    }
+    return oldest;
+}
+
+static void refill(IPWD_S_SCRIPT_RUNNER *runner, uint64_t now)
+{
+    if (runner->refilled == 0 || runner->tokens >= IPWD_SCRIPT_BURST)
+    {
+        runner->refilled = now;
+        return;
+    }
+
+    uint64_t periods = (now - runner->refilled) / IPWD_SCRIPT_REFILL_USEC;
+    if (periods >= (uint64_t)(IPWD_SCRIPT_BURST - runner->tokens))
+    {
+        runner->tokens = IPWD_SCRIPT_BURST;
+        runner->refilled = now;
+        return;
+    }
+    runner->tokens += (int)periods;
+    runner->refilled += periods * IPWD_SCRIPT_REFILL_USEC;
+}
+
+/**
+ * Start the command with device ip mac appended, stdin from /dev/null and default signal handling
+ * @return 0 on success, negative errno on error
+ */
+static int spawn(IPWD_S_SCRIPT_RUNNER *runner, const char *device, in_addr_t ip, const uint8_t *mac, pid_t *pid)
+{
+    char ip_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
+    char mac_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
+
+    /* Same forms as the log and the D-Bus signals */
+    char **argv = runner->argv;
+    argv[runner->argc] = (char *)device;
+    argv[runner->argc + 1] = ipwd_format_ip(ip, ip_str);
+    argv[runner->argc + 2] = ipwd_format_mac(mac, mac_str);
+    argv[runner->argc + 3] = NULL;
+
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    sigset_t mask, defaults;
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+
+    /* The capture thread's signal mask and ignored signals are not the script's business */
+    sigemptyset(&mask);
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    sigaddset(&defaults, SIGCHLD);
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    int rv = posix_spawn(pid, argv[0], &actions, &attr, argv, environ);
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    return -rv;
+}
+
+int ipwd_script_runner_run(IPWD_S_SCRIPT_RUNNER *runner, const char *device, in_addr_t ip,
+                           const uint8_t *mac, uint64_t now)
+{
+    if (!runner || !device || !mac)
+        return -EINVAL;
+
+    ipwd_script_runner_reap(runner);
+
+    IPWD_S_SCRIPT_RECENT *recent = find_recent(runner, ip, mac);
+    if (recent && now - recent->started < IPWD_SCRIPT_DEDUP_USEC)
+        return IPWD_SCRIPT_DUPLICATE;
+
+    if (runner->nrunning >= IPWD_SCRIPT_MAX_RUNNING)
+        return IPWD_SCRIPT_BUSY;
+
+    refill(runner, now);
+    if (runner->tokens == 0)
+        return IPWD_SCRIPT_RATE_LIMITED;
+
+    pid_t pid;
+    int rv = spawn(runner, device, ip, mac, &pid);
+    if (rv < 0)
+        return rv;
+
+    runner->running[runner->nrunning++] = pid;
+    runner->tokens--;
+    runner->started++;
+
+    if (!recent)
+        recent = oldest_recent(runner);
+    recent->used = 1;
+    recent->ip = ip;
+    memcpy(recent->mac, mac, ETH_ALEN);
+    recent->started = now;
+    return IPWD_SCRIPT_STARTED;
+}
@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef IPWATCHD_SCRIPT_RUNNER_H
+#define IPWATCHD_SCRIPT_RUNNER_H
+
+#include <netinet/in.h>
+#include <stdint.h>
+
+/**
+ * Non-blocking runner for the user-defined conflict script.
+ *
+ * The configured command is split into words on blanks and started with
+ * posix_spawn() as `command [args...] device ip mac`, with the addresses in
+ * the form of the log and the D-Bus signals. There is no shell, so quotes,
+ * variables and redirections in the command are not interpreted. Scripts
+ * are never waited for: finished children are collected with
+ * waitpid(WNOHANG) by ipwd_script_runner_reap(), which only looks at the
+ * runner's own children. Starts are limited three ways: the same IP
+ * and remote MAC start the script once per IPWD_SCRIPT_DEDUP_USEC, a token
+ * bucket bounds the overall rate and at most IPWD_SCRIPT_MAX_RUNNING
+ * scripts run at once. Conflicts over a limit are dropped, not queued.
+ *
+ * Time is passed in by the caller, in microseconds of a monotonic clock.
+ * Not thread-safe; the plugin uses it from the capture thread only.
+ */
+
+//! Scripts running at once
+#define IPWD_SCRIPT_MAX_RUNNING 4
+
+//! Scripts that may start in a burst
+#define IPWD_SCRIPT_BURST 8
+
+//! One more start is allowed per this interval once the burst is spent
+#define IPWD_SCRIPT_REFILL_USEC 2000000ULL
+
+//! The same IP and remote MAC start the script at most once per this interval
+#define IPWD_SCRIPT_DEDUP_USEC 60000000ULL
+
+//! Number of recent (IP, MAC) pairs remembered for deduplication
+#define IPWD_SCRIPT_DEDUP_SLOTS 64
+
+//! Script started
+#define IPWD_SCRIPT_STARTED 0
+//! Same IP and remote MAC started the script within IPWD_SCRIPT_DEDUP_USEC
+#define IPWD_SCRIPT_DUPLICATE 1
+//! IPWD_SCRIPT_MAX_RUNNING scripts are still running
+#define IPWD_SCRIPT_BUSY 2
+//! Token bucket empty
+#define IPWD_SCRIPT_RATE_LIMITED 3
+
+typedef struct IPWD_S_SCRIPT_RUNNER IPWD_S_SCRIPT_RUNNER;
+
+/**
+ * Create a runner for a command
+ * @param command Absolute path of an executable, optionally followed by
+ *                arguments separated by blanks; copied
+ * @return Runner on success, NULL with errno set on allocation failure or an empty command
+ */
+IPWD_S_SCRIPT_RUNNER *ipwd_script_runner_new(const char *command);
+
+/**
+ * Collect finished scripts and release the runner
+ * Scripts still running are not waited for
+ */
+void ipwd_script_runner_free(IPWD_S_SCRIPT_RUNNER *runner);
+
+/**
+ * Start the script for a conflict unless a limit applies
+ * @param device Interface in conflict
+ * @param ip Address in conflict (network order)
+ * @param mac Remote MAC address, ETH_ALEN bytes
+ * @param now Current time in microseconds
+ * @return IPWD_SCRIPT_* outcome, negative errno if the script could not be started
+ */
+int ipwd_script_runner_run(IPWD_S_SCRIPT_RUNNER *runner, const char *device, in_addr_t ip,
+                           const uint8_t *mac, uint64_t now);
+
+/**
+ * Collect the scripts that have finished, without blocking
+ * @return Number of scripts still running
+ */
+int ipwd_script_runner_reap(IPWD_S_SCRIPT_RUNNER *runner);
+
+/**
+ * Number of scripts started since the runner was created
+ */
+unsigned long ipwd_script_runner_started(const IPWD_S_SCRIPT_RUNNER *runner);
+
+#endif // IPWATCHD_SCRIPT_RUNNER_H
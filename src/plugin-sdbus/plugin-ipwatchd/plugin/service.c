@@ -16,6 +16,7 @@ static const char *dbus_interface = "org.deepin.dde.IPWatchD1";
 static const sd_bus_vtable ipwatchd_vtable[] = {
     SD_BUS_VTABLE_START(0),
     SD_BUS_METHOD("RequestIPConflictCheck", "ss", "s", ipwd_conflict_check, SD_BUS_VTABLE_UNPRIVILEGED),
+    SD_BUS_METHOD("GetCaptureStatistics", "", "stt", ipwd_capture_statistics, SD_BUS_VTABLE_UNPRIVILEGED),
     SD_BUS_SIGNAL("IPConflict", "sss", 0),
     SD_BUS_SIGNAL("IPConflictReslove", "sss", 0),
     SD_BUS_VTABLE_END
@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * Replays a synthetic ARP capture through ipwd_analyse, once with devices
+ * queried per packet and once with the netlink-maintained cache, and counts
+ * the socket/ioctl calls made for device lookups. The binary is linked with
+ * --wrap=socket,--wrap=ioctl so the upstream code is measured unmodified.
+ */
+
+#include "upstream/ipwatchd.h"
+#include "hooks/ipwatchd_hooks.h"
+#include "check.h"
+#include <stdarg.h>
+#include <time.h>
+
+//! Number of packets in the replayed capture
+#define BENCH_PACKETS 20000
+
+//! Number of watched interfaces
+#define BENCH_DEVICES 4
+
+//! Number of distinct remote hosts talking on the segment
+#define BENCH_HOSTS 200
+
+int debug_flag = 0;
+int syslog_flag = 0;
+int testing_flag = 0;
+IPWD_S_DEVS devices = {0};
+IPWD_S_CONFIG config = {0};
+
+static int cached_mode = 0;
+static unsigned long socket_calls = 0;
+static unsigned long ioctl_calls = 0;
+
+int __real_socket(int domain, int type, int protocol);
+int __real_ioctl(int fd, unsigned long request, void *arg);
+
+int __wrap_socket(int domain, int type, int protocol)
+{
+    socket_calls++;
+    return __real_socket(domain, type, protocol);
+}
+
+/* Answers interface queries for the fake bench interfaces */
+int __wrap_ioctl(int fd, unsigned long request, ...)
+{
+    va_list ap;
+    va_start(ap, request);
+    void *arg = va_arg(ap, void *);
+    va_end(ap);
+
+    ioctl_calls++;
+
+    struct ifreq *ifr = (struct ifreq *)arg;
+    int index = -1;
+    if (request == SIOCGIFADDR || request == SIOCGIFHWADDR)
+        sscanf(ifr->ifr_name, "bench%d", &index);
+    if (index < 0 || index >= BENCH_DEVICES)
+        return __real_ioctl(fd, request, arg);
+
+    if (request == SIOCGIFADDR)
+    {
+        struct sockaddr_in *sin = (struct sockaddr_in *)&ifr->ifr_addr;
+        sin->sin_family = AF_INET;
+        sin->sin_addr.s_addr = htonl(0x0a000001 + index);
+    }
+    else
+    {
+        unsigned char mac[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, (unsigned char)(index + 1) };
+        memcpy(ifr->ifr_hwaddr.sa_data, mac, ETH_ALEN);
+    }
+    return 0;
+}
+
+int ipwd_hook_devices_cached(void)
+{
+    return cached_mode;
+}
+
+static void setup_devices(void)
+{
+    devices.devnum = BENCH_DEVICES;
+    devices.dev = (IPWD_S_DEV *)calloc(BENCH_DEVICES, sizeof(IPWD_S_DEV));
+    for (int i = 0; i < BENCH_DEVICES; i++)
+    {
+        snprintf(devices.dev[i].device, IPWD_MAX_DEVICE_NAME_LEN, "bench%d", i);
+        snprintf(devices.dev[i].ip, IPWD_MAX_DEVICE_ADDRESS_LEN, "10.0.0.%d", i + 1);
+        snprintf(devices.dev[i].mac, IPWD_MAX_DEVICE_ADDRESS_LEN, "2:0:0:0:0:%d", i + 1);
+        ipwd_devinfo_binary(&devices.dev[i]);
+        devices.dev[i].mode = IPWD_PROTECTION_MODE_PASSIVE;
+        devices.dev[i].state = IPWD_DEVICE_STATE_USABLE;
+    }
+    config.defend_interval = 10;
+}
+
+/* Builds the capture: ordinary request/reply chatter between remote hosts */
+static u_char *build_capture(void)
+{
+    const size_t size = IPWD_ARP_HEADER_SIZE + sizeof(IPWD_S_ARP_HEADER);
+    u_char *capture = (u_char *)calloc(BENCH_PACKETS, size);
+    for (int i = 0; i < BENCH_PACKETS; i++)
+    {
+        IPWD_S_ARP_HEADER *arp = (IPWD_S_ARP_HEADER *)(capture + i * size + IPWD_ARP_HEADER_SIZE);
+        int host = i % BENCH_HOSTS;
+        in_addr_t sip = htonl(0x0a000100 + host);
+        in_addr_t dip = htonl(0x0a000100 + (host * 7 + 3) % BENCH_HOSTS);
+        unsigned char smac[ETH_ALEN] = { 0x52, 0x54, 0x00, 0x00, (unsigned char)(host >> 8), (unsigned char)host };
+
+        memcpy(arp->arp_sha, smac, ETH_ALEN);
+        memcpy(arp->arp_spa, &sip, 4);
+        memcpy(arp->arp_tpa, &dip, 4);
+    }
+    return capture;
+}
+
+static double replay(const u_char *capture)
+{
+    const size_t size = IPWD_ARP_HEADER_SIZE + sizeof(IPWD_S_ARP_HEADER);
+    struct pcap_pkthdr header;
+    struct timespec start, end;
+
+    memset(&header, 0, sizeof(header));
+    header.caplen = header.len = size;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_PACKETS; i++)
+        ipwd_analyse(NULL, &header, capture + i * size);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / BENCH_PACKETS;
+}
+
+int main(void)
+{
+    setup_devices();
+    u_char *capture = build_capture();
+
+    cached_mode = 0;
+    socket_calls = ioctl_calls = 0;
+    double polled_ns = replay(capture);
+    unsigned long polled_syscalls = socket_calls + ioctl_calls;
+
+    cached_mode = 1;
+    socket_calls = ioctl_calls = 0;
+    double cached_ns = replay(capture);
+    unsigned long cached_syscalls = socket_calls + ioctl_calls;
+
+    printf("per-packet device queries: %8.1f ns/packet, %lu syscalls\n", polled_ns, polled_syscalls);
+    printf("netlink device cache:      %8.1f ns/packet, %lu syscalls\n", cached_ns, cached_syscalls);
+
+    /* One socket and two ioctls per device per packet before the cache */
+    CHECK(polled_syscalls == (unsigned long)BENCH_PACKETS * BENCH_DEVICES * 3);
+    CHECK(cached_syscalls == 0);
+
+    /* Both modes see the same devices */
+    for (int i = 0; i < BENCH_DEVICES; i++)
+        CHECK(devices.dev[i].state == IPWD_DEVICE_STATE_USABLE);
+
+    free(capture);
+    free(devices.dev);
+
+    if (failures)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
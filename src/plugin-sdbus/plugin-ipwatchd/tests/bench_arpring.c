@@ -0,0 +1,386 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * Replays synthetic ARP storms on the loopback interface into the TPACKET_V3
+ * ring and into libpcap as the plugin configures it, and reports delivered
+ * and dropped packets and the consumer's CPU time per packet. Each burst is
+ * written before the consumer reads, like a storm arriving while the capture
+ * thread is busy. libpcap sees frames sent on lo twice, outgoing and
+ * incoming; the ring only gets the incoming copy.
+ * The ring is also run from the plugin's event loop to account for its
+ * wakeups: none while idle, one per retired block, with the retire timeout
+ * as the delivery latency of a lone packet. The ring-less socket that
+ * conflict checks read meanwhile delivers it at once.
+ * Needs CAP_NET_RAW and is skipped without it.
+ */
+
+#include "plugin/arp_filter.h"
+#include "plugin/arp_ring.h"
+#include "plugin/event_loop.h"
+#include "check.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <net/if_arp.h>
+#include <netinet/if_ether.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+//! Frames per burst
+#define BENCH_BURST 20000
+
+//! One frame in this many is for a watched address
+#define BENCH_OURS_EVERY 20
+
+//! Consumer gives up after this long without a packet, past a partly filled block's retire timeout
+#define BENCH_IDLE_MSEC (2 * IPWD_ARP_RING_RETIRE_MSEC)
+
+typedef struct
+{
+    unsigned long packets;
+    unsigned long malformed;            /**< Not a cooked Ethernet/IPv4 ARP packet of the expected length */
+    unsigned long ours;
+} BENCH_COUNT;
+
+typedef struct
+{
+    IPWD_S_ARP_RING *ring;
+    BENCH_COUNT count;
+    atomic_int delivered;
+} BENCH_IDLE;
+
+static in_addr_t ours[2];
+
+static double cpu_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Same checks ipwd_analyse relies on: cooked header, then the ARP header */
+static void count_packet(u_char *user, const struct pcap_pkthdr *header, const u_char *packet)
+{
+    BENCH_COUNT *count = (BENCH_COUNT *)user;
+    const struct ether_arp *arp = (const struct ether_arp *)(packet + IPWD_ARP_RING_SLL_LEN);
+    in_addr_t spa, tpa;
+
+    count->packets++;
+    if (header->caplen < IPWD_ARP_RING_SLL_LEN + sizeof(struct ether_arp) ||
+        packet[14] != 0x08 || packet[15] != 0x06 || ntohs(arp->arp_hrd) != ARPHRD_ETHER)
+    {
+        count->malformed++;
+        return;
+    }
+
+    memcpy(&spa, arp->arp_spa, sizeof(spa));
+    memcpy(&tpa, arp->arp_tpa, sizeof(tpa));
+    for (int i = 0; i < 2; i++)
+        count->ours += spa == ours[i] || tpa == ours[i];
+}
+
+static int open_sender(int ifindex)
+{
+    int fd = socket(AF_PACKET, SOCK_RAW | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_ifindex = ifindex;
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Who-has chatter among 10.20.0.0/16, every BENCH_OURS_EVERY-th frame asks for one of ours */
+static int send_burst(int fd, int n)
+{
+    unsigned char frame[sizeof(struct ether_header) + sizeof(struct ether_arp)];
+    struct ether_header *eth = (struct ether_header *)frame;
+    struct ether_arp *arp = (struct ether_arp *)(frame + sizeof(*eth));
+    static const unsigned char mac[ETH_ALEN] = { 0x52, 0x54, 0x00, 0xab, 0xcd, 0xef };
+
+    memset(frame, 0, sizeof(frame));
+    memset(eth->ether_dhost, 0xff, ETH_ALEN);
+    memcpy(eth->ether_shost, mac, ETH_ALEN);
+    eth->ether_type = htons(ETHERTYPE_ARP);
+    arp->arp_hrd = htons(ARPHRD_ETHER);
+    arp->arp_pro = htons(ETHERTYPE_IP);
+    arp->arp_hln = ETH_ALEN;
+    arp->arp_pln = 4;
+    arp->arp_op = htons(ARPOP_REQUEST);
+    memcpy(arp->arp_sha, mac, ETH_ALEN);
+
+    int sent = 0;
+    for (int i = 0; i < n; i++)
+    {
+        in_addr_t spa = htonl(0x0a140000 + (uint32_t)(i % 60000) + 1);
+        in_addr_t tpa = i % BENCH_OURS_EVERY == 0 ? ours[(i / BENCH_OURS_EVERY) % 2]
+                                                  : htonl(0x0a140000 + (uint32_t)((i * 7) % 60000) + 1);
+        memcpy(arp->arp_spa, &spa, sizeof(spa));
+        memcpy(arp->arp_tpa, &tpa, sizeof(tpa));
+        sent += send(fd, frame, sizeof(frame), 0) == (ssize_t)sizeof(frame);
+    }
+    return sent;
+}
+
+/* Drain until the capture stays idle; returns consumer CPU seconds */
+static double drain_ring(IPWD_S_ARP_RING *ring, BENCH_COUNT *count)
+{
+    struct pollfd pfd = { ipwd_arp_ring_fd(ring), POLLIN, 0 };
+    double cpu = 0;
+
+    while (poll(&pfd, 1, BENCH_IDLE_MSEC) > 0)
+    {
+        double start = cpu_now();
+        ipwd_arp_ring_dispatch(ring, count_packet, (u_char *)count);
+        cpu += cpu_now() - start;
+    }
+    return cpu;
+}
+
+static double drain_pcap(pcap_t *pcap, BENCH_COUNT *count)
+{
+    struct pollfd pfd = { pcap_get_selectable_fd(pcap), POLLIN, 0 };
+    double cpu = 0;
+
+    while (poll(&pfd, 1, BENCH_IDLE_MSEC) > 0)
+    {
+        double start = cpu_now();
+        while (pcap_dispatch(pcap, -1, count_packet, (u_char *)count) > 0)
+            ;
+        cpu += cpu_now() - start;
+    }
+    return cpu;
+}
+
+static double mono_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void on_ring_readable(int fd, short revents, void *userdata)
+{
+    (void)fd;
+    (void)revents;
+    BENCH_IDLE *idle = (BENCH_IDLE *)userdata;
+    atomic_fetch_add(&idle->delivered, ipwd_arp_ring_dispatch(idle->ring, count_packet, (u_char *)&idle->count));
+}
+
+static void *run_loop(void *arg)
+{
+    ipwd_loop_run((IPWD_S_LOOP *)arg);
+    return NULL;
+}
+
+/* The capture loop as the plugin runs it: idle, then a single watched ARP */
+static void bench_idle(int ifindex, int sender)
+{
+    BENCH_IDLE idle;
+    memset(&idle, 0, sizeof(idle));
+    atomic_init(&idle.delivered, 0);
+
+    int error = 0;
+    idle.ring = ipwd_arp_ring_open(ifindex, &error);
+    CHECK(idle.ring != NULL);
+    if (!idle.ring)
+        return;
+
+    IPWD_S_ARP_FILTER filter;
+    ipwd_arp_filter_init(&filter);
+    CHECK(ipwd_arp_filter_attach(&filter, ipwd_arp_ring_fd(idle.ring), ours, 2) == 1);
+
+    IPWD_S_LOOP *loop = ipwd_loop_new();
+    pthread_t thread;
+    CHECK(loop != NULL);
+    CHECK(ipwd_loop_add_fd(loop, ipwd_arp_ring_fd(idle.ring), on_ring_readable, &idle) == 0);
+    CHECK(pthread_create(&thread, NULL, run_loop, loop) == 0);
+
+    /* Several retire periods pass, empty blocks are not handed over */
+    int idle_ms = 4 * IPWD_ARP_RING_RETIRE_MSEC;
+    struct timespec pause = { idle_ms / 1000, (idle_ms % 1000) * 1000000L };
+    nanosleep(&pause, NULL);
+    unsigned long idle_wakeups = ipwd_loop_wakeups(loop);
+    CHECK(idle_wakeups == 0);
+
+    /* A lone packet waits for its block to retire */
+    double sent_ms = mono_ms();
+    CHECK(send_burst(sender, 1) == 1);
+    while (atomic_load(&idle.delivered) == 0 && mono_ms() - sent_ms < 4 * IPWD_ARP_RING_RETIRE_MSEC)
+    {
+        struct timespec tick = { 0, 1000000L };
+        nanosleep(&tick, NULL);
+    }
+    double latency = mono_ms() - sent_ms;
+    CHECK(atomic_load(&idle.delivered) == 1);
+    CHECK(latency < 2 * IPWD_ARP_RING_RETIRE_MSEC);
+    CHECK(ipwd_loop_wakeups(loop) == 1);
+
+    printf("ring, idle loop: %lu wakeups in %d ms, lone packet after %.0f ms with %lu wakeup "
+           "(retire timeout %d ms, %d kernel timer expiries per second)\n",
+           idle_wakeups, idle_ms, latency, ipwd_loop_wakeups(loop),
+           IPWD_ARP_RING_RETIRE_MSEC, 1000 / IPWD_ARP_RING_RETIRE_MSEC);
+
+    ipwd_loop_quit(loop);
+    pthread_join(thread, NULL);
+    ipwd_loop_free(loop);
+    ipwd_arp_ring_free(idle.ring);
+}
+
+/* The ring-less socket opened while conflict checks run: nothing before its filter, then each packet at once */
+static void bench_check_socket(int ifindex, int sender)
+{
+    int fd = ipwd_arp_socket_open(ifindex);
+    CHECK(fd >= 0);
+    if (fd < 0)
+        return;
+
+    BENCH_COUNT count;
+    memset(&count, 0, sizeof(count));
+    CHECK(send_burst(sender, 1) == 1);
+    CHECK(ipwd_arp_socket_dispatch(fd, count_packet, (u_char *)&count) == 0);
+
+    IPWD_S_ARP_FILTER filter;
+    ipwd_arp_filter_init(&filter);
+    CHECK(ipwd_arp_filter_attach(&filter, fd, ours, 2) == 1);
+
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    double sent_ms = mono_ms();
+    CHECK(send_burst(sender, 1) == 1);
+    CHECK(poll(&pfd, 1, 4 * IPWD_ARP_RING_RETIRE_MSEC) == 1);
+    double latency = mono_ms() - sent_ms;
+    CHECK(ipwd_arp_socket_dispatch(fd, count_packet, (u_char *)&count) == 1);
+    CHECK(count.malformed == 0 && count.ours == 1);
+    CHECK(latency < IPWD_ARP_RING_RETIRE_MSEC / 5);
+
+    printf("check socket: lone packet after %.2f ms\n", latency);
+    close(fd);
+}
+
+static void report(const char *name, int sent, const BENCH_COUNT *count, unsigned long drops, double cpu)
+{
+    printf("%-28s %6d frames sent, %6lu delivered, %6lu dropped, %6lu for watched addresses, %.2f us CPU per packet\n",
+           name, sent, count->packets, drops, count->ours, count->packets ? cpu * 1e6 / count->packets : 0.0);
+}
+
+static void bench_ring(int ifindex, int sender, int filtered)
+{
+    int error = 0;
+    IPWD_S_ARP_RING *ring = ipwd_arp_ring_open(ifindex, &error);
+    CHECK(ring != NULL);
+    if (!ring)
+    {
+        fprintf(stderr, "TPACKET_V3 ring unavailable: %s\n", strerror(-error));
+        return;
+    }
+
+    IPWD_S_ARP_FILTER filter;
+    ipwd_arp_filter_init(&filter);
+    CHECK(ipwd_arp_filter_attach(&filter, ipwd_arp_ring_fd(ring), filtered ? ours : NULL, 2) == filtered);
+
+    BENCH_COUNT count;
+    memset(&count, 0, sizeof(count));
+    int sent = send_burst(sender, BENCH_BURST);
+    double cpu = drain_ring(ring, &count);
+
+    IPWD_S_CAPTURE_STATS stats;
+    CHECK(ipwd_arp_ring_stats(ring, &stats) == 0);
+    CHECK(count.malformed == 0);
+    CHECK(stats.packets == count.packets + stats.drops);
+    if (filtered)
+    {
+        /* Only watched addresses pass, few enough to fit the ring */
+        CHECK(stats.drops == 0);
+        CHECK(count.packets == count.ours);
+        CHECK(count.ours == (unsigned long)(BENCH_BURST / BENCH_OURS_EVERY));
+    }
+    report(filtered ? "ring, watched addresses" : "ring, all ARP", sent, &count, stats.drops, cpu);
+
+    ipwd_arp_ring_free(ring);
+}
+
+/* libpcap as ipwd_plugin_start() sets it up */
+static void bench_pcap(int sender)
+{
+    char errbuf[PCAP_ERRBUF_SIZE];
+    struct bpf_program fp;
+    pcap_t *pcap = pcap_create("lo", errbuf);
+    if (!pcap)
+    {
+        printf("libpcap: skipped (%s)\n", errbuf);
+        return;
+    }
+
+    pcap_set_snaplen(pcap, BUFSIZ);
+    pcap_set_promisc(pcap, 0);
+    pcap_set_immediate_mode(pcap, 1);
+    if (pcap_activate(pcap) != 0 || pcap_compile(pcap, &fp, "arp", 0, 0) == -1)
+    {
+        printf("libpcap: skipped (%s)\n", pcap_geterr(pcap));
+        pcap_close(pcap);
+        return;
+    }
+    pcap_setfilter(pcap, &fp);
+    pcap_freecode(&fp);
+    pcap_setnonblock(pcap, 1, errbuf);
+
+    BENCH_COUNT count;
+    memset(&count, 0, sizeof(count));
+    int sent = send_burst(sender, BENCH_BURST);
+    double cpu = drain_pcap(pcap, &count);
+
+    struct pcap_stat stats;
+    memset(&stats, 0, sizeof(stats));
+    pcap_stats(pcap, &stats);
+    CHECK(count.malformed == 0);
+    report("libpcap, all ARP", sent, &count, stats.ps_drop, cpu);
+
+    pcap_close(pcap);
+}
+
+int main(void)
+{
+    int ifindex = (int)if_nametoindex("lo");
+    int sender = ifindex > 0 ? open_sender(ifindex) : -1;
+    if (sender < 0)
+    {
+        printf("Skipped: no packet socket on lo (%s)\n", strerror(errno));
+        return 0;
+    }
+
+    ours[0] = inet_addr("192.0.2.10");
+    ours[1] = inet_addr("198.51.100.20");
+
+    bench_idle(ifindex, sender);
+    bench_check_socket(ifindex, sender);
+    bench_ring(ifindex, sender, 1);
+    bench_ring(ifindex, sender, 0);
+    bench_pcap(sender);
+
+    close(sender);
+
+    if (failures)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All capture benchmarks completed\n");
+    return 0;
+}
@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * Sends ARP probes on the loopback interface, once through ipwd_genarp with
+ * a libnet context per packet and once through the persistent sender, and
+ * reports probes per second. A packet socket on the same interface checks
+ * that the sender's frames match what libnet builds. Needs CAP_NET_RAW and
+ * is skipped without it.
+ */
+
+#include "upstream/ipwatchd.h"
+#include "plugin/arp_sender.h"
+#include "check.h"
+#include <net/if_arp.h>
+#include <netinet/if_ether.h>
+#include <linux/if_packet.h>
+#include <time.h>
+
+//! Number of probes per measurement
+#define BENCH_PROBES 20000
+
+//! Probed address, from the documentation range
+#define BENCH_TARGET "192.0.2.77"
+
+int debug_flag = 0;
+int syslog_flag = 0;
+int testing_flag = 0;
+IPWD_S_DEVS devices = {0};
+IPWD_S_CONFIG config = {0};
+
+static double elapsed_s(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* Packet socket seeing every ARP frame on the interface */
+static int open_listener(int ifindex)
+{
+    int fd = socket(AF_PACKET, SOCK_RAW | SOCK_CLOEXEC, htons(ETH_P_ARP));
+    if (fd < 0)
+        return -1;
+
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_ARP);
+    addr.sll_ifindex = ifindex;
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    struct timeval tv = { 1, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+/* Next probe for the bench target; loopback delivers each frame twice, outgoing and incoming */
+static int receive_probe(int fd, unsigned char *frame)
+{
+    in_addr_t target = inet_addr(BENCH_TARGET);
+    for (;;)
+    {
+        ssize_t len = recv(fd, frame, IPWD_ARP_FRAME_LEN, 0);
+        if (len < 0)
+            return -1;
+        struct ether_arp *arp = (struct ether_arp *)(frame + sizeof(struct ether_header));
+        if (len == IPWD_ARP_FRAME_LEN && memcmp(arp->arp_tpa, &target, sizeof(target)) == 0)
+            return 0;
+    }
+}
+
+static void drain(int fd)
+{
+    unsigned char frame[IPWD_ARP_FRAME_LEN];
+    while (recv(fd, frame, sizeof(frame), MSG_DONTWAIT) >= 0)
+        ;
+}
+
+int main(void)
+{
+    IPWD_S_NL_LINK link;
+    memset(&link, 0, sizeof(link));
+    strcpy(link.name, "lo");
+    link.ifindex = if_nametoindex(link.name);
+    link.has_mac = 1;
+    link.mac[0] = 0x02;
+    link.mac[5] = 0x42;
+
+    int listener = link.ifindex ? open_listener(link.ifindex) : -1;
+    if (listener < 0)
+    {
+        printf("Skipped: no packet socket on lo (%s)\n", strerror(errno));
+        return 0;
+    }
+
+    IPWD_S_ARP_SENDER *sender = ipwd_arp_sender_new();
+    ipwd_arp_sender_update(sender, &link);
+    in_addr_t target = inet_addr(BENCH_TARGET);
+    unsigned char expected[IPWD_ARP_FRAME_LEN], frame[IPWD_ARP_FRAME_LEN];
+    struct timespec start, end;
+
+    /* Reference frame from libnet, if it can send here */
+    int have_libnet = ipwd_genarp(link.name, "0.0.0.0", "02:00:00:00:00:42", BENCH_TARGET,
+                                  "ff:ff:ff:ff:ff:ff", ARPOP_REQUEST) == IPWD_RV_SUCCESS;
+    if (have_libnet)
+    {
+        CHECK(receive_probe(listener, expected) == 0);
+        CHECK(ipwd_arp_sender_probe(sender, link.name, target) == 0);
+        CHECK(receive_probe(listener, frame) == 0);
+        CHECK(memcmp(frame, expected, IPWD_ARP_FRAME_LEN) == 0);
+    }
+
+    /* A changed MAC is picked up without reopening anything */
+    link.mac[5] = 0x43;
+    ipwd_arp_sender_update(sender, &link);
+    drain(listener);
+    CHECK(ipwd_arp_sender_probe(sender, link.name, target) == 0);
+    CHECK(receive_probe(listener, frame) == 0);
+    CHECK(frame[6 + 5] == 0x43 && frame[sizeof(struct ether_header) + 8 + 5] == 0x43);
+
+    double libnet_rate = 0;
+    if (have_libnet)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < BENCH_PROBES; i++)
+        {
+            ipwd_genarp(link.name, "0.0.0.0", "02:00:00:00:00:43", BENCH_TARGET, "ff:ff:ff:ff:ff:ff", ARPOP_REQUEST);
+            if (i % 256 == 0)
+                drain(listener);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        libnet_rate = BENCH_PROBES / elapsed_s(&start, &end);
+        printf("libnet context per probe: %10.0f probes/s\n", libnet_rate);
+    }
+
+    int errors = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_PROBES; i++)
+    {
+        errors += ipwd_arp_sender_probe(sender, link.name, target) < 0;
+        if (i % 256 == 0)
+            drain(listener);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double sender_rate = BENCH_PROBES / elapsed_s(&start, &end);
+    printf("persistent sender:        %10.0f probes/s\n", sender_rate);
+
+    CHECK(errors == 0);
+    if (have_libnet)
+        CHECK(sender_rate > libnet_rate);
+
+    /* Removed links are forgotten */
+    link.has_mac = 0;
+    ipwd_arp_sender_update(sender, &link);
+    CHECK(ipwd_arp_sender_probe(sender, link.name, target) == -ENODEV);
+
+    ipwd_arp_sender_free(sender);
+    close(listener);
+
+    if (failures)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef IPWATCHD_TESTS_CHECK_H
+#define IPWATCHD_TESTS_CHECK_H
+
+#include <stdio.h>
+
+/*
+ * Shared assertion for the plugin tests and benchmarks: a failed CHECK is
+ * reported with its location and counted, and the test keeps running.
+ * main() returns non-zero when failures is set.
+ */
+
+static int failures = 0;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+#endif // IPWATCHD_TESTS_CHECK_H
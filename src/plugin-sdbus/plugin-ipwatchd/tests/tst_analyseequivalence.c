@@ -0,0 +1,260 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * ipwd_analyse compares addresses in binary form. This replays a random
+ * capture through it and through a copy of the former string-based logic
+ * (inet_ntoa/ether_ntoa + strcasecmp) and requires both to produce the
+ * same hook calls in the same order. It also reports the cost of both.
+ */
+
+#include "upstream/ipwatchd.h"
+#include "hooks/ipwatchd_hooks.h"
+#include "check.h"
+#include <time.h>
+
+//! Number of packets in the replayed capture
+#define TEST_PACKETS 20000
+
+//! Number of watched interfaces, the last one has no address
+#define TEST_DEVICES 3
+
+//! Maximum number of recorded hook calls
+#define TEST_MAX_EVENTS (TEST_PACKETS * (TEST_DEVICES + 1))
+
+//! Size of one recorded hook call
+#define TEST_EVENT_LEN 96
+
+int debug_flag = 0;
+int syslog_flag = 0;
+int testing_flag = 0;
+IPWD_S_DEVS devices = {0};
+IPWD_S_CONFIG config = {0};
+
+typedef struct
+{
+    char (*events)[TEST_EVENT_LEN];
+    int count;
+    int enabled;
+} TEST_RECORDER;
+
+static TEST_RECORDER recorder;
+
+static void record(const char *kind, const char *a, const char *b, const char *c, const char *d)
+{
+    if (!recorder.enabled || recorder.count >= TEST_MAX_EVENTS)
+        return;
+    snprintf(recorder.events[recorder.count++], TEST_EVENT_LEN, "%s %s %s %s %s", kind, a, b, c, d);
+}
+
+/* Hooks of the binary implementation, formatted only for comparison */
+
+int ipwd_hook_devices_cached(void)
+{
+    return 1;
+}
+
+int ipwd_hook_on_arp_packet(in_addr_t rcv_sip, const uint8_t *rcv_smac,
+                            in_addr_t rcv_dip, const uint8_t *rcv_dmac)
+{
+    char sip[IPWD_MAX_DEVICE_ADDRESS_LEN], smac[IPWD_MAX_DEVICE_ADDRESS_LEN];
+    char dip[IPWD_MAX_DEVICE_ADDRESS_LEN], dmac[IPWD_MAX_DEVICE_ADDRESS_LEN];
+    if (recorder.enabled)
+        record("packet", ipwd_format_ip(rcv_sip, sip), ipwd_format_mac(rcv_smac, smac),
+               ipwd_format_ip(rcv_dip, dip), ipwd_format_mac(rcv_dmac, dmac));
+    return 0;
+}
+
+void ipwd_hook_on_conflict(const char *device, in_addr_t ip, const uint8_t *mac,
+                           const uint8_t *remote_mac, int is_active_mode)
+{
+    (void)is_active_mode;
+    char ip_str[IPWD_MAX_DEVICE_ADDRESS_LEN], mac_str[IPWD_MAX_DEVICE_ADDRESS_LEN], remote[IPWD_MAX_DEVICE_ADDRESS_LEN];
+    if (recorder.enabled)
+        record("conflict", device, ipwd_format_ip(ip, ip_str), ipwd_format_mac(mac, mac_str),
+               ipwd_format_mac(remote_mac, remote));
+}
+
+void ipwd_hook_on_conflict_resolved(const char *device, in_addr_t ip, const uint8_t *mac,
+                                    const uint8_t *remote_mac)
+{
+    char ip_str[IPWD_MAX_DEVICE_ADDRESS_LEN], mac_str[IPWD_MAX_DEVICE_ADDRESS_LEN], remote[IPWD_MAX_DEVICE_ADDRESS_LEN];
+    if (recorder.enabled)
+        record("resolved", device, ipwd_format_ip(ip, ip_str), ipwd_format_mac(mac, mac_str),
+               ipwd_format_mac(remote_mac, remote));
+}
+
+/* Former string-based analysis, reduced to its decisions */
+static void legacy_analyse(const u_char *packet)
+{
+    const IPWD_S_ARP_HEADER *arpaddr = (const IPWD_S_ARP_HEADER *)(packet + IPWD_ARP_HEADER_SIZE);
+    char rcv_sip[IPWD_MAX_DEVICE_ADDRESS_LEN], rcv_smac[IPWD_MAX_DEVICE_ADDRESS_LEN];
+    char rcv_dip[IPWD_MAX_DEVICE_ADDRESS_LEN], rcv_dmac[IPWD_MAX_DEVICE_ADDRESS_LEN];
+    struct in_addr addr;
+
+    memcpy(&addr, arpaddr->arp_spa, sizeof(addr));
+    memset(rcv_sip, '\0', IPWD_MAX_DEVICE_ADDRESS_LEN);
+    strncpy(rcv_sip, inet_ntoa(addr), IPWD_MAX_DEVICE_ADDRESS_LEN - 1);
+    memset(rcv_smac, '\0', IPWD_MAX_DEVICE_ADDRESS_LEN);
+    strncpy(rcv_smac, ether_ntoa((const struct ether_addr *)arpaddr->arp_sha), IPWD_MAX_DEVICE_ADDRESS_LEN - 1);
+    memcpy(&addr, arpaddr->arp_tpa, sizeof(addr));
+    memset(rcv_dip, '\0', IPWD_MAX_DEVICE_ADDRESS_LEN);
+    strncpy(rcv_dip, inet_ntoa(addr), IPWD_MAX_DEVICE_ADDRESS_LEN - 1);
+    memset(rcv_dmac, '\0', IPWD_MAX_DEVICE_ADDRESS_LEN);
+    strncpy(rcv_dmac, ether_ntoa((const struct ether_addr *)arpaddr->arp_tha), IPWD_MAX_DEVICE_ADDRESS_LEN - 1);
+
+    record("packet", rcv_sip, rcv_smac, rcv_dip, rcv_dmac);
+
+    for (int i = 0; i < devices.devnum; i++)
+    {
+        if (devices.dev[i].state == IPWD_DEVICE_STATE_UNUSABLE)
+            continue;
+        if (strcasecmp(rcv_smac, devices.dev[i].mac) == 0)
+            return;
+    }
+
+    for (int i = 0; i < devices.devnum; i++)
+    {
+        if (devices.dev[i].state == IPWD_DEVICE_STATE_UNUSABLE)
+            continue;
+
+        if (!((strcasecmp(rcv_sip, devices.dev[i].ip) == 0) && (strcasecmp(rcv_smac, devices.dev[i].mac) != 0)))
+        {
+            record("resolved", devices.dev[i].device, devices.dev[i].ip, devices.dev[i].mac, rcv_smac);
+            continue;
+        }
+
+        record("conflict", devices.dev[i].device, devices.dev[i].ip, devices.dev[i].mac, rcv_smac);
+    }
+}
+
+static void setup_devices(void)
+{
+    devices.devnum = TEST_DEVICES;
+    devices.dev = (IPWD_S_DEV *)calloc(TEST_DEVICES, sizeof(IPWD_S_DEV));
+    for (int i = 0; i < TEST_DEVICES; i++)
+    {
+        IPWD_S_DEV *dev = &devices.dev[i];
+        snprintf(dev->device, IPWD_MAX_DEVICE_NAME_LEN, "eth%d", i);
+        snprintf(dev->ip, IPWD_MAX_DEVICE_ADDRESS_LEN, "192.168.%d.10", i);
+        snprintf(dev->mac, IPWD_MAX_DEVICE_ADDRESS_LEN, "0:e0:4c:%x:a%d:b", 0x10 + i, i);
+        CHECK(ipwd_devinfo_binary(dev) == IPWD_RV_SUCCESS);
+        dev->mode = IPWD_PROTECTION_MODE_PASSIVE;
+        dev->state = i == TEST_DEVICES - 1 ? IPWD_DEVICE_STATE_UNUSABLE : IPWD_DEVICE_STATE_USABLE;
+    }
+    /* Never hold back conflicts so every one reaches the hook */
+    config.defend_interval = -1;
+}
+
+/*
+ * Random capture. With conflicts, sources are often our own addresses or
+ * MACs to hit every branch; without, it is ordinary chatter between hosts
+ * as seen most of the time.
+ */
+static u_char *build_capture(size_t size, int conflicts)
+{
+    u_char *capture = (u_char *)calloc(TEST_PACKETS, size);
+    unsigned int seed = 42;
+
+    for (int i = 0; i < TEST_PACKETS; i++)
+    {
+        IPWD_S_ARP_HEADER *arp = (IPWD_S_ARP_HEADER *)(capture + i * size + IPWD_ARP_HEADER_SIZE);
+        const IPWD_S_DEV *dev = &devices.dev[rand_r(&seed) % TEST_DEVICES];
+        in_addr_t sip = htonl(0x0a010000 + rand_r(&seed) % 0x100);
+        if (conflicts && rand_r(&seed) % 3)
+            sip = dev->addr;
+        in_addr_t dip = htonl(0xc0a80000 + rand_r(&seed) % 0x300);
+
+        if (conflicts && rand_r(&seed) % 4 == 0)
+            memcpy(arp->arp_sha, &dev->hwaddr, ETH_ALEN);
+        else
+            for (int k = 0; k < ETH_ALEN; k++)
+                arp->arp_sha[k] = (u_int8_t)rand_r(&seed);
+        for (int k = 0; k < ETH_ALEN; k++)
+            arp->arp_tha[k] = rand_r(&seed) % 2 ? 0 : (u_int8_t)rand_r(&seed);
+        memcpy(arp->arp_spa, &sip, 4);
+        memcpy(arp->arp_tpa, &dip, 4);
+    }
+    return capture;
+}
+
+static double elapsed_ns(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+int main(void)
+{
+    const size_t size = IPWD_ARP_HEADER_SIZE + sizeof(IPWD_S_ARP_HEADER);
+    struct pcap_pkthdr header;
+    struct timespec start, end;
+
+    setup_devices();
+    u_char *capture = build_capture(size, 1);
+    memset(&header, 0, sizeof(header));
+    header.caplen = header.len = size;
+
+    /* Equivalence */
+    char (*expected)[TEST_EVENT_LEN] = calloc(TEST_MAX_EVENTS, TEST_EVENT_LEN);
+    recorder.events = expected;
+    recorder.count = 0;
+    recorder.enabled = 1;
+    for (int i = 0; i < TEST_PACKETS; i++)
+        legacy_analyse(capture + i * size);
+    int expected_count = recorder.count;
+
+    char (*actual)[TEST_EVENT_LEN] = calloc(TEST_MAX_EVENTS, TEST_EVENT_LEN);
+    recorder.events = actual;
+    recorder.count = 0;
+    for (int i = 0; i < TEST_PACKETS; i++)
+        ipwd_analyse(NULL, &header, capture + i * size);
+    int actual_count = recorder.count;
+
+    CHECK(expected_count == actual_count);
+    int conflicts = 0;
+    for (int i = 0; i < expected_count && i < actual_count; i++)
+    {
+        if (strcmp(expected[i], actual[i]) != 0)
+        {
+            fprintf(stderr, "event %d differs:\n  string: %s\n  binary: %s\n", i, expected[i], actual[i]);
+            failures++;
+            break;
+        }
+        conflicts += strncmp(actual[i], "conflict", 8) == 0;
+    }
+    /* The capture must exercise the conflict branch */
+    CHECK(conflicts > 0);
+    printf("%d hook calls identical, %d conflicts\n", actual_count, conflicts);
+
+    /* Cost, without recording; conflicts would mostly measure syslog */
+    recorder.enabled = 0;
+    free(capture);
+    capture = build_capture(size, 0);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < TEST_PACKETS; i++)
+        legacy_analyse(capture + i * size);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double legacy_ns = elapsed_ns(&start, &end) / TEST_PACKETS;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < TEST_PACKETS; i++)
+        ipwd_analyse(NULL, &header, capture + i * size);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double binary_ns = elapsed_ns(&start, &end) / TEST_PACKETS;
+
+    printf("string comparison: %8.1f ns/packet\n", legacy_ns);
+    printf("binary comparison: %8.1f ns/packet\n", binary_ns);
+
+    free(expected);
+    free(actual);
+    free(capture);
+    free(devices.dev);
+
+    if (failures)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
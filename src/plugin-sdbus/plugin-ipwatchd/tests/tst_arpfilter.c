@@ -0,0 +1,335 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * Capture filter against a pcap savefile: a synthetic segment with ARP
+ * chatter between many hosts, some packets involving our addresses and
+ * non-ARP frames carrying our addresses at the same offsets. The file is
+ * written once with Ethernet and once with the cooked headers of the "any"
+ * device, read back through the installed filter and every delivered
+ * packet is compared to what the filter is meant to pass. The program
+ * assembled for the capture ring is checked on the same traffic.
+ */
+
+#include "arp_filter.h"
+#include "check.h"
+#include <arpa/inet.h>
+#include <net/ethernet.h>
+#include <net/if_arp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+//! Number of packets in the savefile
+#define TEST_PACKETS 100000
+
+//! Number of remote hosts chattering on the segment
+#define TEST_HOSTS 1000
+
+//! Length of a cooked (DLT_LINUX_SLL) header
+#define TEST_SLL_LEN 16
+
+//! Room for the largest test frame
+#define TEST_FRAME_LEN 64
+
+typedef struct
+{
+    uint32_t seq;                       /**< Packet number, stored in the trailer */
+    int is_arp;
+    in_addr_t spa;
+    in_addr_t tpa;
+} TEST_PACKET;
+
+static TEST_PACKET packets[TEST_PACKETS];
+static in_addr_t ours[3];
+
+static in_addr_t host(int i)
+{
+    return htonl(0x0a140000 + (uint32_t)i);
+}
+
+/* Segment traffic: mostly chatter, a few percent for our addresses */
+static void generate(void)
+{
+    unsigned int seed = 7;
+    ours[0] = host(TEST_HOSTS + 1);
+    ours[1] = host(TEST_HOSTS + 2);
+    ours[2] = inet_addr("192.168.7.1");
+
+    for (int i = 0; i < TEST_PACKETS; i++)
+    {
+        TEST_PACKET *p = &packets[i];
+        int kind = rand_r(&seed) % 1000;
+        p->seq = (uint32_t)i;
+        p->is_arp = 1;
+        p->spa = host(rand_r(&seed) % TEST_HOSTS);
+        p->tpa = host(rand_r(&seed) % TEST_HOSTS);
+
+        if (kind < 3)
+            p->tpa = ours[rand_r(&seed) % 3];           /* someone asks for us */
+        else if (kind < 5)
+            p->spa = ours[rand_r(&seed) % 3];           /* conflicting sender */
+        else if (kind < 10)
+        {
+            p->is_arp = 0;                              /* IPv4 frame with our address at the ARP offsets */
+            p->spa = p->tpa = ours[0];
+        }
+    }
+}
+
+static int expected(const TEST_PACKET *p, const in_addr_t *addrs, int naddrs)
+{
+    if (!p->is_arp)
+        return 0;
+    if (!addrs)
+        return 1;
+    for (int i = 0; i < naddrs; i++)
+    {
+        if (p->spa == addrs[i] || p->tpa == addrs[i])
+            return 1;
+    }
+    return 0;
+}
+
+static size_t build_frame(const TEST_PACKET *p, int linktype, unsigned char *frame)
+{
+    static const unsigned char remote[ETH_ALEN] = { 0x52, 0x54, 0x00, 0x12, 0x34, 0x56 };
+    size_t l2 = linktype == DLT_EN10MB ? sizeof(struct ether_header) : TEST_SLL_LEN;
+    uint16_t proto = htons(p->is_arp ? ETHERTYPE_ARP : ETHERTYPE_IP);
+
+    memset(frame, 0, TEST_FRAME_LEN);
+    if (linktype == DLT_EN10MB)
+    {
+        struct ether_header *eth = (struct ether_header *)frame;
+        memset(eth->ether_dhost, 0xff, ETH_ALEN);
+        memcpy(eth->ether_shost, remote, ETH_ALEN);
+        eth->ether_type = proto;
+    }
+    else
+    {
+        /* packet type, ARPHRD type, address length, address, protocol */
+        frame[1] = 1;
+        frame[3] = ARPHRD_ETHER;
+        frame[5] = ETH_ALEN;
+        memcpy(frame + 6, remote, ETH_ALEN);
+        memcpy(frame + 14, &proto, 2);
+    }
+
+    unsigned char *arp = frame + l2;
+    arp[1] = ARPHRD_ETHER;
+    arp[2] = 0x08;
+    arp[4] = ETH_ALEN;
+    arp[5] = 4;
+    arp[7] = ARPOP_REQUEST;
+    memcpy(arp + 8, remote, ETH_ALEN);
+    memcpy(arp + IPWD_ARP_SPA_OFFSET, &p->spa, 4);
+    memcpy(arp + IPWD_ARP_TPA_OFFSET, &p->tpa, 4);
+
+    /* Trailer identifies the packet when it is read back */
+    memcpy(arp + 28, &p->seq, sizeof(p->seq));
+    return l2 + 28 + sizeof(p->seq);
+}
+
+static void write_savefile(const char *path, int linktype)
+{
+    pcap_t *dead = pcap_open_dead(linktype, 65535);
+    pcap_dumper_t *dumper = dead ? pcap_dump_open(dead, path) : NULL;
+    CHECK(dumper != NULL);
+    if (!dumper)
+        return;
+
+    unsigned char frame[TEST_FRAME_LEN];
+    struct pcap_pkthdr header;
+    memset(&header, 0, sizeof(header));
+    for (int i = 0; i < TEST_PACKETS; i++)
+    {
+        header.caplen = header.len = (uint32_t)build_frame(&packets[i], linktype, frame);
+        pcap_dump((u_char *)dumper, &header, frame);
+    }
+    pcap_dump_close(dumper);
+    pcap_close(dead);
+}
+
+/* Replay the savefile through the filter for addrs and compare packet by packet */
+static int replay(const char *path, int linktype, const in_addr_t *addrs, int naddrs)
+{
+    char errbuf[PCAP_ERRBUF_SIZE];
+    pcap_t *pcap = pcap_open_offline(path, errbuf);
+    CHECK(pcap != NULL);
+    if (!pcap)
+        return -1;
+
+    IPWD_S_ARP_FILTER filter;
+    ipwd_arp_filter_init(&filter);
+    filter.naddrs = -2;   /* force installation, also for all ARP */
+    CHECK(ipwd_arp_filter_apply(&filter, pcap, addrs, naddrs) == 1);
+
+    size_t l2 = linktype == DLT_EN10MB ? sizeof(struct ether_header) : TEST_SLL_LEN;
+    struct pcap_pkthdr *header;
+    const u_char *data;
+    int delivered = 0, wanted = 0, next = 0, mismatches = 0;
+
+    for (int i = 0; i < TEST_PACKETS; i++)
+        wanted += expected(&packets[i], addrs, naddrs);
+
+    while (pcap_next_ex(pcap, &header, &data) == 1)
+    {
+        uint32_t seq;
+        memcpy(&seq, data + l2 + 28, sizeof(seq));
+
+        /* Everything skipped since the previous delivery must have been rejectable */
+        for (; next < (int)seq; next++)
+            mismatches += expected(&packets[next], addrs, naddrs);
+        mismatches += !expected(&packets[seq], addrs, naddrs);
+        next = (int)seq + 1;
+        delivered++;
+    }
+    for (; next < TEST_PACKETS; next++)
+        mismatches += expected(&packets[next], addrs, naddrs);
+
+    CHECK(mismatches == 0);
+    CHECK(delivered == wanted);
+    pcap_close(pcap);
+    return delivered;
+}
+
+static void test_expression(void)
+{
+    in_addr_t addrs[2] = { inet_addr("10.0.0.1"), inet_addr("192.168.1.254") };
+    char *expr = ipwd_arp_filter_build(addrs, 2);
+    CHECK(expr && strstr(expr, "arp[14:4] = 0x0a000001") && strstr(expr, "arp[24:4] = 0xc0a801fe"));
+    free(expr);
+
+    expr = ipwd_arp_filter_build(NULL, 0);
+    CHECK(expr && strcmp(expr, "arp") == 0);
+    free(expr);
+}
+
+/* Filters cannot be set on pcap_open_dead() handles, a savefile is needed */
+static void test_unchanged_set_is_not_reinstalled(const char *path)
+{
+    char errbuf[PCAP_ERRBUF_SIZE];
+    pcap_t *pcap = pcap_open_offline(path, errbuf);
+    CHECK(pcap != NULL);
+    if (!pcap)
+        return;
+
+    IPWD_S_ARP_FILTER filter;
+    ipwd_arp_filter_init(&filter);
+
+    /* Starts as the plain "arp" filter the plugin installs first */
+    CHECK(ipwd_arp_filter_apply(&filter, pcap, NULL, 0) == 0);
+
+    in_addr_t a[3] = { ours[1], ours[0], ours[1] };
+    in_addr_t b[2] = { ours[0], ours[1] };
+    CHECK(ipwd_arp_filter_apply(&filter, pcap, a, 3) == 1);
+    CHECK(filter.naddrs == 2);
+    CHECK(ipwd_arp_filter_apply(&filter, pcap, b, 2) == 0);
+    CHECK(ipwd_arp_filter_apply(&filter, pcap, b, 1) == 1);
+
+    /* More addresses than fit fall back to all ARP */
+    in_addr_t many[IPWD_ARP_FILTER_MAX_ADDRS + 1];
+    for (int i = 0; i <= IPWD_ARP_FILTER_MAX_ADDRS; i++)
+        many[i] = host(i);
+    CHECK(ipwd_arp_filter_apply(&filter, pcap, many, IPWD_ARP_FILTER_MAX_ADDRS + 1) == 1);
+    CHECK(filter.naddrs == -1);
+
+    pcap_close(pcap);
+}
+
+/*
+ * The packet socket program runs in the kernel as well when attached to a
+ * datagram socket pair, which delivers what it accepts truncated to its
+ * return value; packets start at the ARP header as with SOCK_DGRAM
+ */
+static void test_socket_program(const in_addr_t *addrs, int naddrs, int npackets)
+{
+    int fds[2];
+    CHECK(socketpair(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0, fds) == 0);
+
+    IPWD_S_ARP_FILTER filter;
+    ipwd_arp_filter_init(&filter);
+    int expect_attach = addrs != NULL;
+    CHECK(ipwd_arp_filter_attach(&filter, fds[1], addrs, naddrs) == expect_attach);
+    CHECK(ipwd_arp_filter_attach(&filter, fds[1], addrs, naddrs) == 0);
+    if (!addrs)
+    {
+        /* A plain socket has no all-ARP program yet, unlike the capture ring */
+        filter.naddrs = -2;
+        CHECK(ipwd_arp_filter_attach(&filter, fds[1], NULL, 0) == 1);
+    }
+
+    unsigned char frame[TEST_FRAME_LEN];
+    unsigned char received[TEST_FRAME_LEN];
+    int mismatches = 0, delivered = 0, truncated = 0;
+    size_t l2 = sizeof(struct ether_header);
+
+    for (int i = 0; i < npackets; i++)
+    {
+        /* A socket bound to ETH_P_ARP never sees the other frames */
+        if (!packets[i].is_arp)
+            continue;
+
+        size_t len = build_frame(&packets[i], DLT_EN10MB, frame);
+        CHECK(send(fds[0], frame + l2, len - l2, 0) == (ssize_t)(len - l2));
+        ssize_t n = recv(fds[1], received, sizeof(received), MSG_DONTWAIT);
+
+        mismatches += (n > 0) != expected(&packets[i], addrs, naddrs);
+        delivered += n > 0;
+        truncated += n > 0 && n != IPWD_ARP_FILTER_SNAPLEN;
+    }
+
+    CHECK(mismatches == 0);
+    CHECK(truncated == 0);
+    CHECK(delivered > 0 || naddrs == 0);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+int main(void)
+{
+    static const int linktypes[] = { DLT_EN10MB, DLT_LINUX_SLL };
+    char path[] = "/tmp/tst-ipwatchd-arpfilter-XXXXXX";
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    if (fd >= 0)
+        close(fd);
+
+    generate();
+    test_expression();
+    test_socket_program(ours, 3, 20000);
+    test_socket_program(ours + 2, 1, 20000);
+    test_socket_program(ours, 0, 2000);
+    test_socket_program(NULL, 0, 2000);
+
+    for (size_t t = 0; t < sizeof(linktypes) / sizeof(linktypes[0]); t++)
+    {
+        write_savefile(path, linktypes[t]);
+        if (t == 0)
+            test_unchanged_set_is_not_reinstalled(path);
+
+        int all = replay(path, linktypes[t], NULL, 0);
+        int narrow = replay(path, linktypes[t], ours, 2);
+        int renumbered = replay(path, linktypes[t], ours + 1, 2);
+        int none = replay(path, linktypes[t], ours, 0);
+
+        CHECK(none == 0);
+        CHECK(narrow > 0 && narrow * 50 < all);
+        CHECK(renumbered > 0);
+        printf("%s: %d packets, %d ARP, %d for our addresses, %d after renumbering\n",
+               linktypes[t] == DLT_EN10MB ? "ethernet" : "cooked", TEST_PACKETS, all, narrow, renumbered);
+    }
+
+    unlink(path);
+
+    if (failures)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All capture filter tests passed\n");
+    return 0;
+}
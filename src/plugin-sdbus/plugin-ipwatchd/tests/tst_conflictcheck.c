@@ -0,0 +1,353 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * Asynchronous conflict checks with parallel callers. Caller threads stand
+ * in for concurrent D-Bus method calls, the probe callback for ipwd_genarp
+ * and a loop timer for the ARP reply a conflicting host would send.
+ */
+
+#include "conflict_check.h"
+#include "check.h"
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//! Number of concurrent callers per test
+#define TEST_CALLERS 8
+
+typedef struct
+{
+    IPWD_S_LOOP *loop;
+    IPWD_S_CHECKER *checker;
+    in_addr_t conflicting_ip;           /**< Address some other host answers for */
+    unsigned char remote_mac[ETH_ALEN];
+    int answer_from_self;               /**< Also answer with our own MAC first */
+    int answer_last_only;               /**< Only the last probe is answered */
+    uint64_t reply_usec;                /**< Delay of the answer, 5 ms if 0 */
+    int probes;                         /**< Probes sent, loop thread only */
+    atomic_int done;                    /**< Completed requests */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} TEST_ENV;
+
+typedef struct
+{
+    TEST_ENV *env;
+    IPWD_S_CHECK_TARGET target;
+    int completions;
+    int conflict;
+    unsigned char mac[ETH_ALEN];
+    long submitted_ms;
+    long completed_ms;
+    pthread_barrier_t *start;
+} TEST_CALLER;
+
+typedef struct
+{
+    TEST_ENV *env;
+    in_addr_t ip;
+    unsigned char mac[ETH_ALEN];
+} TEST_REPLY;
+
+static const unsigned char local_mac[ETH_ALEN] = { 0x52, 0x54, 0x00, 0x00, 0x00, 0x01 };
+
+static long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static void deliver_reply(void *userdata)
+{
+    TEST_REPLY *reply = (TEST_REPLY *)userdata;
+    ipwd_checker_on_arp(reply->env->checker, reply->ip, reply->mac);
+    free(reply);
+}
+
+static void schedule_reply(TEST_ENV *env, in_addr_t ip, const unsigned char *mac, uint64_t usec)
+{
+    TEST_REPLY *reply = (TEST_REPLY *)calloc(1, sizeof(TEST_REPLY));
+    reply->env = env;
+    reply->ip = ip;
+    memcpy(reply->mac, mac, ETH_ALEN);
+    ipwd_loop_add_timer(env->loop, usec, deliver_reply, reply);
+}
+
+static int on_probe(const IPWD_S_CHECK_TARGET *target, void *userdata)
+{
+    TEST_ENV *env = (TEST_ENV *)userdata;
+    env->probes++;
+
+    /* A host using the address answers a little later, like on the wire */
+    if (target->ip == env->conflicting_ip && (!env->answer_last_only || env->probes % IPWD_CHECK_PROBES == 0))
+    {
+        if (env->answer_from_self)
+            schedule_reply(env, target->ip, target->mac, 1000);
+        schedule_reply(env, target->ip, env->remote_mac, env->reply_usec ? env->reply_usec : 5000);
+    }
+    return 0;
+}
+
+static void on_done(void *waiter, const IPWD_S_CHECK_TARGET *target,
+                    const unsigned char *conflict_mac, void *userdata)
+{
+    TEST_ENV *env = (TEST_ENV *)userdata;
+    TEST_CALLER *caller = (TEST_CALLER *)waiter;
+
+    CHECK(target->ip == caller->target.ip);
+    caller->completions++;
+    caller->completed_ms = now_ms();
+    caller->conflict = conflict_mac != NULL;
+    if (conflict_mac)
+        memcpy(caller->mac, conflict_mac, ETH_ALEN);
+
+    pthread_mutex_lock(&env->lock);
+    atomic_fetch_add(&env->done, 1);
+    pthread_cond_broadcast(&env->cond);
+    pthread_mutex_unlock(&env->lock);
+}
+
+static void *loop_thread(void *arg)
+{
+    TEST_ENV *env = (TEST_ENV *)arg;
+    ipwd_loop_run(env->loop);
+    return NULL;
+}
+
+static void *caller_thread(void *arg)
+{
+    TEST_CALLER *caller = (TEST_CALLER *)arg;
+    pthread_barrier_wait(caller->start);
+    caller->submitted_ms = now_ms();
+    CHECK(ipwd_checker_submit(caller->env->checker, &caller->target, caller) == 0);
+    return NULL;
+}
+
+static void env_init(TEST_ENV *env, pthread_t *thread)
+{
+    memset(env, 0, sizeof(*env));
+    env->loop = ipwd_loop_new();
+    env->checker = ipwd_checker_new(env->loop, on_probe, on_done, env);
+    CHECK(env->checker != NULL);
+    env->remote_mac[0] = 0x02;
+    env->remote_mac[5] = 0x99;
+    atomic_init(&env->done, 0);
+    pthread_mutex_init(&env->lock, NULL);
+    pthread_cond_init(&env->cond, NULL);
+    CHECK(pthread_create(thread, NULL, loop_thread, env) == 0);
+}
+
+static int env_wait(TEST_ENV *env, int expected)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += 2;
+
+    pthread_mutex_lock(&env->lock);
+    while (atomic_load(&env->done) < expected)
+    {
+        if (pthread_cond_timedwait(&env->cond, &env->lock, &deadline) != 0)
+            break;
+    }
+    pthread_mutex_unlock(&env->lock);
+    return atomic_load(&env->done) >= expected;
+}
+
+static void env_finish(TEST_ENV *env, pthread_t thread)
+{
+    ipwd_loop_quit(env->loop);
+    pthread_join(thread, NULL);
+    ipwd_checker_free(env->checker);
+    ipwd_loop_free(env->loop);
+    pthread_mutex_destroy(&env->lock);
+    pthread_cond_destroy(&env->cond);
+}
+
+static void set_target(TEST_CALLER *caller, int ifindex, const char *ip)
+{
+    caller->target.ifindex = ifindex;
+    snprintf(caller->target.device, IFNAMSIZ, "eth%d", ifindex);
+    caller->target.ip = inet_addr(ip);
+    memcpy(caller->target.mac, local_mac, ETH_ALEN);
+}
+
+static void run_callers(TEST_CALLER *callers, int n)
+{
+    pthread_t threads[TEST_CALLERS];
+    pthread_barrier_t start;
+
+    pthread_barrier_init(&start, NULL, n);
+    for (int i = 0; i < n; i++)
+    {
+        callers[i].start = &start;
+        CHECK(pthread_create(&threads[i], NULL, caller_thread, &callers[i]) == 0);
+    }
+    for (int i = 0; i < n; i++)
+        pthread_join(threads[i], NULL);
+    pthread_barrier_destroy(&start);
+}
+
+static void test_same_ip_is_merged(void)
+{
+    TEST_ENV env;
+    pthread_t thread;
+    TEST_CALLER callers[TEST_CALLERS];
+    env_init(&env, &thread);
+
+    memset(callers, 0, sizeof(callers));
+    for (int i = 0; i < TEST_CALLERS; i++)
+    {
+        callers[i].env = &env;
+        set_target(&callers[i], 2, "192.168.1.20");
+    }
+
+    long start = now_ms();
+    run_callers(callers, TEST_CALLERS);
+    CHECK(env_wait(&env, TEST_CALLERS));
+    long elapsed = now_ms() - start;
+
+    /* One probe sequence answers every caller, no serialization behind each other */
+    CHECK(env.probes == IPWD_CHECK_PROBES);
+    for (int i = 0; i < TEST_CALLERS; i++)
+        CHECK(callers[i].completions == 1 && callers[i].conflict == 0);
+    CHECK(elapsed >= IPWD_CHECK_PROBES * IPWD_CHECK_INTERVAL_USEC / 1000);
+    CHECK(elapsed < 2 * IPWD_CHECK_PROBES * IPWD_CHECK_INTERVAL_USEC / 1000);
+    printf("%d callers, one address: %ld ms, %d probes\n", TEST_CALLERS, elapsed, env.probes);
+
+    env_finish(&env, thread);
+}
+
+static void test_distinct_ips_run_in_parallel(void)
+{
+    TEST_ENV env;
+    pthread_t thread;
+    TEST_CALLER callers[TEST_CALLERS];
+    env_init(&env, &thread);
+    env.conflicting_ip = inet_addr("10.0.0.3");
+    env.answer_from_self = 1;
+
+    /* Four addresses with two callers each; the same address on another
+     * interface is a separate check */
+    static const char *ips[] = { "10.0.0.1", "10.0.0.2", "10.0.0.3", "10.0.0.4" };
+    memset(callers, 0, sizeof(callers));
+    for (int i = 0; i < TEST_CALLERS; i++)
+    {
+        callers[i].env = &env;
+        set_target(&callers[i], i == TEST_CALLERS - 1 ? 3 : 2, ips[i % 4]);
+    }
+
+    long start = now_ms();
+    run_callers(callers, TEST_CALLERS);
+    CHECK(env_wait(&env, TEST_CALLERS));
+    long elapsed = now_ms() - start;
+
+    for (int i = 0; i < TEST_CALLERS; i++)
+    {
+        CHECK(callers[i].completions == 1);
+        if (callers[i].target.ip == env.conflicting_ip)
+        {
+            /* Answered by the other host, not by our own MAC, and early */
+            CHECK(callers[i].conflict == 1);
+            CHECK(memcmp(callers[i].mac, env.remote_mac, ETH_ALEN) == 0);
+            CHECK(callers[i].completed_ms - callers[i].submitted_ms < IPWD_CHECK_INTERVAL_USEC / 1000);
+        }
+        else
+        {
+            CHECK(callers[i].conflict == 0);
+        }
+    }
+
+    /* Five checks overlap in time instead of taking five windows */
+    CHECK(elapsed < 2 * IPWD_CHECK_PROBES * IPWD_CHECK_INTERVAL_USEC / 1000);
+    CHECK(env.probes == 4 * IPWD_CHECK_PROBES + 1);
+    printf("%d callers, five checks: %ld ms, %d probes\n", TEST_CALLERS, elapsed, env.probes);
+
+    env_finish(&env, thread);
+}
+
+static void test_window_covers_capture_latency(void)
+{
+    TEST_ENV env;
+    pthread_t thread;
+    TEST_CALLER callers[2];
+    env_init(&env, &thread);
+
+    /* The ring hands ARP over when a block retires: the answer to the last
+     * probe arrives after the plain window has closed */
+    uint64_t latency = 3 * IPWD_CHECK_INTERVAL_USEC;
+    ipwd_checker_set_latency(env.checker, latency);
+    env.conflicting_ip = inet_addr("10.1.0.1");
+    env.answer_last_only = 1;
+    env.reply_usec = 2 * IPWD_CHECK_INTERVAL_USEC;
+
+    memset(callers, 0, sizeof(callers));
+    callers[0].env = &env;
+    callers[1].env = &env;
+    set_target(&callers[0], 2, "10.1.0.1");
+    set_target(&callers[1], 2, "10.1.0.2");
+    run_callers(callers, 2);
+    CHECK(env_wait(&env, 2));
+
+    CHECK(callers[0].completions == 1 && callers[0].conflict == 1);
+    CHECK(memcmp(callers[0].mac, env.remote_mac, ETH_ALEN) == 0);
+
+    /* A free address is reported once the delayed window has closed */
+    long free_ms = callers[1].completed_ms - callers[1].submitted_ms;
+    CHECK(callers[1].completions == 1 && callers[1].conflict == 0);
+    CHECK(free_ms >= (long)((IPWD_CHECK_PROBES * IPWD_CHECK_INTERVAL_USEC + latency) / 1000));
+    printf("capture latency %llu ms: late answer seen, free address after %ld ms\n",
+           (unsigned long long)(latency / 1000), free_ms);
+
+    env_finish(&env, thread);
+}
+
+static void test_free_completes_pending(void)
+{
+    TEST_ENV env;
+    TEST_CALLER callers[2];
+    memset(&env, 0, sizeof(env));
+    memset(callers, 0, sizeof(callers));
+
+    /* Loop never runs: requests stay queued until the plugin shuts down */
+    env.loop = ipwd_loop_new();
+    env.checker = ipwd_checker_new(env.loop, on_probe, on_done, &env);
+    pthread_mutex_init(&env.lock, NULL);
+    pthread_cond_init(&env.cond, NULL);
+    for (int i = 0; i < 2; i++)
+    {
+        callers[i].env = &env;
+        set_target(&callers[i], 2, "172.16.0.1");
+        CHECK(ipwd_checker_submit(env.checker, &callers[i].target, &callers[i]) == 0);
+    }
+
+    ipwd_checker_free(env.checker);
+    CHECK(callers[0].completions == 1 && callers[1].completions == 1);
+    CHECK(callers[0].conflict == 0 && env.probes == 0);
+
+    ipwd_loop_free(env.loop);
+    pthread_mutex_destroy(&env.lock);
+    pthread_cond_destroy(&env.cond);
+}
+
+int main(void)
+{
+    test_same_ip_is_merged();
+    test_distinct_ips_run_in_parallel();
+    test_window_covers_capture_latency();
+    test_free_completes_pending();
+
+    if (failures)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All conflict check tests passed\n");
+    return 0;
+}
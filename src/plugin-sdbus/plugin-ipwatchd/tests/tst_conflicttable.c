@@ -0,0 +1,227 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * Conflict table under load: thousands of tracked conflicts, random
+ * insert/remove/lookup cross-checked against a plain array, removal while
+ * walking an index, and the per-packet lookup cost compared to the former
+ * linear list walk.
+ */
+
+#include "conflict_table.h"
+#include "check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//! Number of tracked conflicts in the stress run
+#define TEST_ENTRIES 5000
+
+//! Number of random operations cross-checked against the reference
+#define TEST_OPERATIONS 200000
+
+//! Number of local interfaces
+#define TEST_LOCAL_MACS 4
+
+typedef struct
+{
+    in_addr_t ip;
+    uint8_t mac[ETH_ALEN];
+    uint8_t remote_mac[ETH_ALEN];
+    IPCONFLICT_DEV_INFO *info;
+} TEST_REF;
+
+static TEST_REF refs[TEST_ENTRIES * 2];
+static int nrefs = 0;
+static unsigned int seed = 1;
+
+static void random_key(TEST_REF *ref)
+{
+    /* Few addresses and local MACs so chains share buckets and keys */
+    ref->ip = htonl(0x0a000000 + rand_r(&seed) % 500);
+    memset(ref->mac, 0, ETH_ALEN);
+    ref->mac[0] = 0x52;
+    ref->mac[5] = (uint8_t)(rand_r(&seed) % TEST_LOCAL_MACS);
+    for (int k = 0; k < ETH_ALEN; k++)
+        ref->remote_mac[k] = (uint8_t)(rand_r(&seed) % 4);
+}
+
+static int ref_find(const TEST_REF *key)
+{
+    for (int i = 0; i < nrefs; i++)
+    {
+        if (refs[i].ip == key->ip && memcmp(refs[i].mac, key->mac, ETH_ALEN) == 0 &&
+            memcmp(refs[i].remote_mac, key->remote_mac, ETH_ALEN) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static void ref_remove(IPWD_S_CONFLICT_TABLE *table, int i)
+{
+    ipwd_conflict_table_remove(table, refs[i].info);
+    refs[i] = refs[--nrefs];
+}
+
+static void verify(IPWD_S_CONFLICT_TABLE *table)
+{
+    CHECK(ipwd_conflict_table_count(table) == nrefs);
+
+    int all = 0;
+    for (IPCONFLICT_DEV_INFO *info = ipwd_conflict_table_first(table); info; info = ipwd_conflict_table_next(info))
+        all++;
+    CHECK(all == nrefs);
+
+    int by_mac = 0;
+    for (int m = 0; m < TEST_LOCAL_MACS; m++)
+    {
+        uint8_t mac[ETH_ALEN] = { 0x52, 0, 0, 0, 0, (uint8_t)m };
+        for (IPCONFLICT_DEV_INFO *info = ipwd_conflict_table_first_by_mac(table, mac); info;
+             info = ipwd_conflict_table_next_by_mac(info))
+        {
+            CHECK(memcmp(info->mac, mac, ETH_ALEN) == 0);
+            by_mac++;
+        }
+    }
+    CHECK(by_mac == nrefs);
+
+    for (int i = 0; i < nrefs; i++)
+    {
+        CHECK(ipwd_conflict_table_find(table, refs[i].ip, refs[i].mac, refs[i].remote_mac) == refs[i].info);
+
+        /* Every entry sharing the key is reachable through the key chain */
+        int expected = 0, found = 0;
+        for (int j = 0; j < nrefs; j++)
+            expected += refs[j].ip == refs[i].ip && memcmp(refs[j].remote_mac, refs[i].remote_mac, ETH_ALEN) == 0;
+        for (IPCONFLICT_DEV_INFO *info = ipwd_conflict_table_first_by_key(table, refs[i].ip, refs[i].remote_mac);
+             info; info = ipwd_conflict_table_next_by_key(info))
+            found++;
+        CHECK(found == expected);
+    }
+}
+
+static void test_random_operations(void)
+{
+    IPWD_S_CONFLICT_TABLE *table = ipwd_conflict_table_new();
+    TEST_REF key;
+
+    while (nrefs < TEST_ENTRIES)
+    {
+        random_key(&key);
+        if (ref_find(&key) >= 0)
+            continue;
+        key.info = ipwd_conflict_table_insert(table, "eth0", key.ip, key.mac, key.remote_mac);
+        CHECK(key.info != NULL);
+        refs[nrefs++] = key;
+    }
+    verify(table);
+
+    for (int op = 0; op < TEST_OPERATIONS; op++)
+    {
+        random_key(&key);
+        int i = ref_find(&key);
+        IPCONFLICT_DEV_INFO *info = ipwd_conflict_table_find(table, key.ip, key.mac, key.remote_mac);
+        CHECK(i >= 0 ? info == refs[i].info : info == NULL);
+
+        if (i >= 0 && rand_r(&seed) % 2)
+            ref_remove(table, i);
+        else if (i < 0 && nrefs < TEST_ENTRIES * 2)
+        {
+            key.info = ipwd_conflict_table_insert(table, "eth1", key.ip, key.mac, key.remote_mac);
+            refs[nrefs++] = key;
+        }
+
+        if (op % 50000 == 0)
+            verify(table);
+    }
+    verify(table);
+
+    /* Clearing one interface while walking its index leaves the others intact */
+    uint8_t mac[ETH_ALEN] = { 0x52, 0, 0, 0, 0, 1 };
+    IPCONFLICT_DEV_INFO *info = ipwd_conflict_table_first_by_mac(table, mac);
+    while (info)
+    {
+        IPCONFLICT_DEV_INFO *next = ipwd_conflict_table_next_by_mac(info);
+        ipwd_conflict_table_remove(table, info);
+        info = next;
+    }
+    for (int i = nrefs - 1; i >= 0; i--)
+    {
+        if (memcmp(refs[i].mac, mac, ETH_ALEN) == 0)
+            refs[i] = refs[--nrefs];
+    }
+    CHECK(ipwd_conflict_table_first_by_mac(table, mac) == NULL);
+    verify(table);
+
+    printf("%d random operations, %d entries left\n", TEST_OPERATIONS, nrefs);
+    ipwd_conflict_table_free(table);
+    nrefs = 0;
+}
+
+static double elapsed_ns(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+static void test_lookup_cost(void)
+{
+    IPWD_S_CONFLICT_TABLE *table = ipwd_conflict_table_new();
+    struct timespec start, end;
+    const int lookups = 100000;
+    volatile int hits = 0;
+
+    /* Distinct remote hosts, as after a spoofing burst */
+    for (nrefs = 0; nrefs < TEST_ENTRIES; nrefs++)
+    {
+        TEST_REF *ref = &refs[nrefs];
+        ref->ip = htonl(0xc0a80001);
+        memset(ref->mac, 0, ETH_ALEN);
+        ref->mac[0] = 0x52;
+        memcpy(ref->remote_mac, (uint8_t[ETH_ALEN]){ 0x02, 0, 0, 0, (uint8_t)(nrefs >> 8), (uint8_t)nrefs }, ETH_ALEN);
+        ref->info = ipwd_conflict_table_insert(table, "eth0", ref->ip, ref->mac, ref->remote_mac);
+    }
+
+    /* Packet path of the former list: compare every entry */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < lookups; i++)
+    {
+        const TEST_REF *key = &refs[(i * 7919) % nrefs];
+        for (int j = 0; j < nrefs; j++)
+            hits += refs[j].ip == key->ip && memcmp(refs[j].remote_mac, key->remote_mac, ETH_ALEN) == 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double list_ns = elapsed_ns(&start, &end) / lookups;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < lookups; i++)
+    {
+        const TEST_REF *key = &refs[(i * 7919) % nrefs];
+        for (IPCONFLICT_DEV_INFO *info = ipwd_conflict_table_first_by_key(table, key->ip, key->remote_mac);
+             info; info = ipwd_conflict_table_next_by_key(info))
+            hits++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double table_ns = elapsed_ns(&start, &end) / lookups;
+
+    CHECK(hits == 2 * lookups);
+    printf("%d tracked conflicts: list walk %8.1f ns/packet, hash lookup %8.1f ns/packet\n",
+           nrefs, list_ns, table_ns);
+
+    ipwd_conflict_table_free(table);
+    nrefs = 0;
+}
+
+int main(void)
+{
+    test_random_operations();
+    test_lookup_cost();
+
+    if (failures)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All conflict table tests passed\n");
+    return 0;
+}
@@ -0,0 +1,257 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * Event loop behaviour of the capture thread. A pipe stands in for the pcap
+ * selectable fd: the loop must not wake up while it is idle, must dispatch
+ * as soon as data arrives and must return promptly on ipwd_plugin_stop.
+ * Timers must fire in deadline order without extra wakeups.
+ */
+
+#include "event_loop.h"
+#include "check.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct
+{
+    IPWD_S_LOOP *loop;
+    int fds[2];
+    atomic_int dispatched;
+    atomic_int finished;
+    int rv;
+    int remove_on_read;
+} TEST_CTX;
+
+static long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static void sleep_ms(int ms)
+{
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+static int wait_for(atomic_int *value, int expected, int timeout_ms)
+{
+    long deadline = now_ms() + timeout_ms;
+    while (atomic_load(value) < expected && now_ms() < deadline)
+        sleep_ms(1);
+    return atomic_load(value) >= expected;
+}
+
+static void on_readable(int fd, short revents, void *userdata)
+{
+    (void)revents;
+    TEST_CTX *ctx = (TEST_CTX *)userdata;
+    char buf[64];
+    while (read(fd, buf, sizeof(buf)) == (ssize_t)sizeof(buf))
+        ;
+    if (ctx->remove_on_read)
+        ipwd_loop_remove_fd(ctx->loop, fd);
+    atomic_fetch_add(&ctx->dispatched, 1);
+}
+
+static void *run_thread(void *arg)
+{
+    TEST_CTX *ctx = (TEST_CTX *)arg;
+    ctx->rv = ipwd_loop_run(ctx->loop);
+    atomic_store(&ctx->finished, 1);
+    return NULL;
+}
+
+static void setup(TEST_CTX *ctx)
+{
+    ctx->loop = ipwd_loop_new();
+    CHECK(ctx->loop != NULL);
+    CHECK(pipe(ctx->fds) == 0);
+    atomic_init(&ctx->dispatched, 0);
+    atomic_init(&ctx->finished, 0);
+    ctx->rv = -1;
+    ctx->remove_on_read = 0;
+    CHECK(ipwd_loop_add_fd(ctx->loop, ctx->fds[0], on_readable, ctx) == 0);
+}
+
+static void teardown(TEST_CTX *ctx)
+{
+    ipwd_loop_free(ctx->loop);
+    close(ctx->fds[0]);
+    close(ctx->fds[1]);
+}
+
+static void test_idle_has_no_wakeups(void)
+{
+    TEST_CTX ctx;
+    pthread_t thread;
+    setup(&ctx);
+    CHECK(pthread_create(&thread, NULL, run_thread, &ctx) == 0);
+
+    /* The old loop woke up every millisecond; an idle loop must not wake at all */
+    sleep_ms(500);
+    CHECK(ipwd_loop_wakeups(ctx.loop) == 0);
+    CHECK(atomic_load(&ctx.dispatched) == 0);
+
+    ipwd_loop_quit(ctx.loop);
+    pthread_join(thread, NULL);
+    CHECK(ctx.rv == 0);
+    CHECK(ipwd_loop_wakeups(ctx.loop) == 1);
+    teardown(&ctx);
+}
+
+static void test_dispatch_on_data(void)
+{
+    TEST_CTX ctx;
+    pthread_t thread;
+    setup(&ctx);
+    CHECK(pthread_create(&thread, NULL, run_thread, &ctx) == 0);
+
+    for (int i = 1; i <= 3; i++)
+    {
+        CHECK(write(ctx.fds[1], "a", 1) == 1);
+        CHECK(wait_for(&ctx.dispatched, i, 1000));
+        sleep_ms(20);
+    }
+    /* One wakeup per packet, nothing in between */
+    CHECK(atomic_load(&ctx.dispatched) == 3);
+    CHECK(ipwd_loop_wakeups(ctx.loop) == 3);
+
+    ipwd_loop_quit(ctx.loop);
+    pthread_join(thread, NULL);
+    teardown(&ctx);
+}
+
+static void test_quit_is_prompt(void)
+{
+    TEST_CTX ctx;
+    pthread_t thread;
+    setup(&ctx);
+    CHECK(pthread_create(&thread, NULL, run_thread, &ctx) == 0);
+    sleep_ms(50);
+
+    long start = now_ms();
+    ipwd_loop_quit(ctx.loop);
+    CHECK(wait_for(&ctx.finished, 1, 1000));
+    CHECK(now_ms() - start < 100);
+
+    pthread_join(thread, NULL);
+    CHECK(ctx.rv == 0);
+    teardown(&ctx);
+}
+
+static void test_quit_before_run(void)
+{
+    TEST_CTX ctx;
+    setup(&ctx);
+
+    /* Plugin may be unloaded before the capture thread gets scheduled */
+    ipwd_loop_quit(ctx.loop);
+    CHECK(ipwd_loop_run(ctx.loop) == 0);
+    teardown(&ctx);
+}
+
+static void test_remove_from_callback(void)
+{
+    TEST_CTX ctx;
+    pthread_t thread;
+    setup(&ctx);
+    ctx.remove_on_read = 1;
+    CHECK(pthread_create(&thread, NULL, run_thread, &ctx) == 0);
+
+    CHECK(write(ctx.fds[1], "a", 1) == 1);
+    CHECK(wait_for(&ctx.dispatched, 1, 1000));
+    CHECK(write(ctx.fds[1], "b", 1) == 1);
+    sleep_ms(100);
+    CHECK(atomic_load(&ctx.dispatched) == 1);
+
+    ipwd_loop_quit(ctx.loop);
+    pthread_join(thread, NULL);
+    teardown(&ctx);
+}
+
+typedef struct
+{
+    IPWD_S_LOOP *loop;
+    int order[8];
+    int fired;
+    long fired_at[8];
+    int chain;
+} TEST_TIMERS;
+
+typedef struct
+{
+    TEST_TIMERS *timers;
+    int id;
+} TEST_TIMER_ARG;
+
+static void on_timer(void *userdata)
+{
+    TEST_TIMER_ARG *arg = (TEST_TIMER_ARG *)userdata;
+    TEST_TIMERS *t = arg->timers;
+
+    t->fired_at[t->fired] = now_ms();
+    t->order[t->fired++] = arg->id;
+
+    /* Timer 3 re-arms itself once from its own callback */
+    if (arg->id == 3 && t->chain++ == 0)
+        CHECK(ipwd_loop_add_timer(t->loop, 10000, on_timer, arg) != NULL);
+    else if (arg->id == 3)
+        ipwd_loop_quit(t->loop);
+}
+
+static void test_timers(void)
+{
+    TEST_TIMERS t = {0};
+    TEST_TIMER_ARG args[4];
+    t.loop = ipwd_loop_new();
+    for (int i = 0; i < 4; i++)
+    {
+        args[i].timers = &t;
+        args[i].id = i;
+    }
+
+    long start = now_ms();
+    CHECK(ipwd_loop_add_timer(t.loop, 30000, on_timer, &args[3]) != NULL);
+    CHECK(ipwd_loop_add_timer(t.loop, 10000, on_timer, &args[1]) != NULL);
+    IPWD_S_LOOP_TIMER *cancelled = ipwd_loop_add_timer(t.loop, 5000, on_timer, &args[0]);
+    CHECK(ipwd_loop_add_timer(t.loop, 20000, on_timer, &args[2]) != NULL);
+    ipwd_loop_cancel_timer(t.loop, cancelled);
+
+    CHECK(ipwd_loop_run(t.loop) == 0);
+
+    /* Deadline order, the cancelled one never runs, and one wakeup per expiry */
+    CHECK(t.fired == 4);
+    CHECK(t.order[0] == 1 && t.order[1] == 2 && t.order[2] == 3 && t.order[3] == 3);
+    CHECK(t.fired_at[0] - start >= 10);
+    CHECK(t.fired_at[3] - start >= 40 && t.fired_at[3] - start < 200);
+    CHECK(ipwd_loop_wakeups(t.loop) == 5);
+
+    /* Pending timers are released with the loop */
+    CHECK(ipwd_loop_add_timer(t.loop, 1000000, on_timer, &args[0]) != NULL);
+    ipwd_loop_free(t.loop);
+}
+
+int main(void)
+{
+    test_idle_has_no_wakeups();
+    test_dispatch_on_data();
+    test_quit_is_prompt();
+    test_quit_before_run();
+    test_remove_from_callback();
+    test_timers();
+
+    if (failures)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All event loop tests passed\n");
+    return 0;
+}
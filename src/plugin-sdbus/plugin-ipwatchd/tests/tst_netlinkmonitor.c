@@ -0,0 +1,230 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * Interface table maintenance from synthetic rtnetlink datagrams.
+ */
+
+#include "netlink_monitor.h"
+#include "check.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct
+{
+    int calls;
+    IPWD_S_NL_LINK last;
+    IPWD_S_NL_LINK last_old;
+} TEST_RECORD;
+
+static void on_change(const IPWD_S_NL_LINK *link, const IPWD_S_NL_LINK *old, void *userdata)
+{
+    TEST_RECORD *rec = (TEST_RECORD *)userdata;
+    rec->calls++;
+    rec->last = *link;
+    rec->last_old = *old;
+}
+
+typedef struct
+{
+    char data[4096] __attribute__((aligned(NLMSG_ALIGNTO)));
+    size_t len;
+} TEST_BUF;
+
+static struct nlmsghdr *begin(TEST_BUF *b, int type, size_t payload)
+{
+    struct nlmsghdr *h = (struct nlmsghdr *)(b->data + b->len);
+    memset(h, 0, NLMSG_SPACE(payload));
+    h->nlmsg_len = NLMSG_LENGTH(payload);
+    h->nlmsg_type = type;
+    return h;
+}
+
+static void attr(struct nlmsghdr *h, int type, const void *data, size_t len)
+{
+    struct rtattr *rta = (struct rtattr *)((char *)h + NLMSG_ALIGN(h->nlmsg_len));
+    rta->rta_type = type;
+    rta->rta_len = RTA_LENGTH(len);
+    memcpy(RTA_DATA(rta), data, len);
+    h->nlmsg_len = NLMSG_ALIGN(h->nlmsg_len) + RTA_ALIGN(rta->rta_len);
+}
+
+static void end(TEST_BUF *b, struct nlmsghdr *h)
+{
+    b->len += NLMSG_ALIGN(h->nlmsg_len);
+}
+
+static void add_link(TEST_BUF *b, int type, int ifindex, const char *name, const unsigned char *mac)
+{
+    struct nlmsghdr *h = begin(b, type, sizeof(struct ifinfomsg));
+    struct ifinfomsg *ifi = (struct ifinfomsg *)NLMSG_DATA(h);
+    ifi->ifi_family = AF_UNSPEC;
+    ifi->ifi_index = ifindex;
+    if (name)
+        attr(h, IFLA_IFNAME, name, strlen(name) + 1);
+    if (mac)
+        attr(h, IFLA_ADDRESS, mac, ETH_ALEN);
+    end(b, h);
+}
+
+static void add_addr(TEST_BUF *b, int type, int ifindex, const char *ip, int flags)
+{
+    struct nlmsghdr *h = begin(b, type, sizeof(struct ifaddrmsg));
+    struct ifaddrmsg *ifa = (struct ifaddrmsg *)NLMSG_DATA(h);
+    in_addr_t addr = inet_addr(ip);
+    ifa->ifa_family = AF_INET;
+    ifa->ifa_prefixlen = 24;
+    ifa->ifa_flags = flags;
+    ifa->ifa_index = ifindex;
+    attr(h, IFA_LOCAL, &addr, sizeof(addr));
+    attr(h, IFA_ADDRESS, &addr, sizeof(addr));
+    end(b, h);
+}
+
+static const unsigned char mac1[ETH_ALEN] = { 0x52, 0x54, 0x00, 0x12, 0x34, 0x56 };
+static const unsigned char mac2[ETH_ALEN] = { 0x52, 0x54, 0x00, 0xab, 0xcd, 0xef };
+
+static void test_dump_populates_table(void)
+{
+    TEST_RECORD rec = {0};
+    IPWD_S_NETLINK *nl = ipwd_netlink_new(on_change, &rec);
+    TEST_BUF b = {0};
+
+    /* A dump delivers several messages in one datagram */
+    add_link(&b, RTM_NEWLINK, 2, "eth0", mac1);
+    add_link(&b, RTM_NEWLINK, 3, "wlan0", mac2);
+    add_addr(&b, RTM_NEWADDR, 2, "192.168.1.10", 0);
+    CHECK(ipwd_netlink_process(nl, b.data, b.len) == 0);
+
+    const IPWD_S_NL_LINK *eth0 = ipwd_netlink_find(nl, "eth0");
+    const IPWD_S_NL_LINK *wlan0 = ipwd_netlink_find(nl, "wlan0");
+    CHECK(eth0 && eth0->ifindex == 2 && eth0->has_mac && memcmp(eth0->mac, mac1, ETH_ALEN) == 0);
+    CHECK(eth0 && eth0->ip == inet_addr("192.168.1.10"));
+    CHECK(wlan0 && wlan0->ip == 0);
+    CHECK(ipwd_netlink_find(nl, "eth1") == NULL);
+    CHECK(rec.calls == 3);
+
+    ipwd_netlink_free(nl);
+}
+
+static void test_address_changes(void)
+{
+    TEST_RECORD rec = {0};
+    IPWD_S_NETLINK *nl = ipwd_netlink_new(on_change, &rec);
+    TEST_BUF b = {0};
+
+    add_link(&b, RTM_NEWLINK, 2, "eth0", mac1);
+    add_addr(&b, RTM_NEWADDR, 2, "10.0.0.5", 0);
+    ipwd_netlink_process(nl, b.data, b.len);
+    rec.calls = 0;
+
+    /* Secondary addresses are not what SIOCGIFADDR reports */
+    b.len = 0;
+    add_addr(&b, RTM_NEWADDR, 2, "10.0.0.6", IFA_F_SECONDARY);
+    ipwd_netlink_process(nl, b.data, b.len);
+    CHECK(rec.calls == 0);
+    CHECK(ipwd_netlink_find(nl, "eth0")->ip == inet_addr("10.0.0.5"));
+
+    /* Removing an address that is not the primary one changes nothing */
+    b.len = 0;
+    add_addr(&b, RTM_DELADDR, 2, "10.0.0.7", 0);
+    ipwd_netlink_process(nl, b.data, b.len);
+    CHECK(rec.calls == 0);
+
+    b.len = 0;
+    add_addr(&b, RTM_DELADDR, 2, "10.0.0.5", 0);
+    ipwd_netlink_process(nl, b.data, b.len);
+    CHECK(rec.calls == 1);
+    CHECK(rec.last.ip == 0);
+    CHECK(rec.last_old.ip == inet_addr("10.0.0.5"));
+
+    b.len = 0;
+    add_addr(&b, RTM_NEWADDR, 2, "10.0.0.9", 0);
+    ipwd_netlink_process(nl, b.data, b.len);
+    CHECK(rec.calls == 2);
+    CHECK(rec.last.ip == inet_addr("10.0.0.9"));
+    CHECK(strcmp(rec.last.name, "eth0") == 0);
+
+    /* Repeated notification with identical state is not reported again */
+    ipwd_netlink_process(nl, b.data, b.len);
+    CHECK(rec.calls == 2);
+
+    ipwd_netlink_free(nl);
+}
+
+static void test_link_changes(void)
+{
+    TEST_RECORD rec = {0};
+    IPWD_S_NETLINK *nl = ipwd_netlink_new(on_change, &rec);
+    TEST_BUF b = {0};
+
+    add_link(&b, RTM_NEWLINK, 4, "usb0", mac1);
+    add_addr(&b, RTM_NEWADDR, 4, "172.16.0.2", 0);
+    ipwd_netlink_process(nl, b.data, b.len);
+
+    /* MAC address change keeps the address */
+    b.len = 0;
+    add_link(&b, RTM_NEWLINK, 4, "usb0", mac2);
+    ipwd_netlink_process(nl, b.data, b.len);
+    CHECK(memcmp(rec.last.mac, mac2, ETH_ALEN) == 0);
+    CHECK(rec.last.ip == inet_addr("172.16.0.2"));
+
+    /* Rename is tracked by index */
+    b.len = 0;
+    add_link(&b, RTM_NEWLINK, 4, "enx0", NULL);
+    ipwd_netlink_process(nl, b.data, b.len);
+    CHECK(ipwd_netlink_find(nl, "usb0") == NULL);
+    CHECK(ipwd_netlink_find(nl, "enx0") != NULL);
+    CHECK(strcmp(rec.last_old.name, "usb0") == 0);
+
+    int calls = rec.calls;
+    b.len = 0;
+    add_link(&b, RTM_DELLINK, 4, "enx0", NULL);
+    ipwd_netlink_process(nl, b.data, b.len);
+    CHECK(rec.calls == calls + 1);
+    CHECK(rec.last.ip == 0 && rec.last.has_mac == 0);
+    CHECK(strcmp(rec.last.name, "enx0") == 0);
+    CHECK(ipwd_netlink_find(nl, "enx0") == NULL);
+
+    ipwd_netlink_free(nl);
+}
+
+static void test_error_message(void)
+{
+    IPWD_S_NETLINK *nl = ipwd_netlink_new(NULL, NULL);
+    TEST_BUF b = {0};
+
+    struct nlmsghdr *h = begin(&b, NLMSG_ERROR, sizeof(struct nlmsgerr));
+    ((struct nlmsgerr *)NLMSG_DATA(h))->error = -EPERM;
+    end(&b, h);
+    CHECK(ipwd_netlink_process(nl, b.data, b.len) == -EPERM);
+
+    /* Truncated datagrams are ignored */
+    b.len = 0;
+    add_link(&b, RTM_NEWLINK, 2, "eth0", mac1);
+    CHECK(ipwd_netlink_process(nl, b.data, 8) == 0);
+    CHECK(ipwd_netlink_find(nl, "eth0") == NULL);
+
+    ipwd_netlink_free(nl);
+}
+
+int main(void)
+{
+    test_dump_populates_table();
+    test_address_changes();
+    test_link_changes();
+    test_error_message();
+
+    if (failures)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All netlink monitor tests passed\n");
+    return 0;
+}
@@ -0,0 +1,277 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * Re-probe schedule driven by a simulated clock: the test jumps from one
+ * deadline to the next the way the plugin's loop timer would, and records
+ * when each conflict was probed and checked.
+ */
+
+#include "reprobe.h"
+#include "check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//! Number of conflicts recorded at the same moment
+#define TEST_CONFLICTS 200
+
+//! Maximum number of probes recorded per conflict
+#define TEST_MAX_PROBES 16
+
+typedef struct
+{
+    IPWD_S_REPROBE reprobe;
+    int answers;                        /**< Checks to answer before going silent, -1 for always */
+    int misses;                         /**< Consecutive silent checks */
+    int resolved;
+    int probe_fails;                    /**< Probes to fail before sending */
+    int probes;
+    uint64_t probe_time[TEST_MAX_PROBES];
+    uint64_t check_time[TEST_MAX_PROBES];
+} TEST_CONFLICT;
+
+typedef struct
+{
+    IPWD_S_REPROBER *reprober;
+    uint64_t now;                       /**< Simulated clock, microseconds */
+    uint64_t last_step;                 /**< Time of the previous callback, to check ordering */
+    int ordered;
+} TEST_ENV;
+
+static int on_probe(void *owner, void *userdata)
+{
+    TEST_CONFLICT *conflict = (TEST_CONFLICT *)owner;
+    TEST_ENV *env = (TEST_ENV *)userdata;
+
+    env->ordered &= env->now >= env->last_step;
+    env->last_step = env->now;
+
+    if (conflict->probe_fails > 0)
+    {
+        conflict->probe_fails--;
+        return IPWD_REPROBE_FAILED;
+    }
+    if (conflict->probes < TEST_MAX_PROBES)
+        conflict->probe_time[conflict->probes] = env->now;
+    conflict->probes++;
+    return IPWD_REPROBE_SENT;
+}
+
+static int on_check(void *owner, void *userdata)
+{
+    TEST_CONFLICT *conflict = (TEST_CONFLICT *)owner;
+    TEST_ENV *env = (TEST_ENV *)userdata;
+
+    if (conflict->probes <= TEST_MAX_PROBES)
+        conflict->check_time[conflict->probes - 1] = env->now;
+
+    if (conflict->answers != 0)
+    {
+        if (conflict->answers > 0)
+            conflict->answers--;
+        conflict->misses = 0;
+        return IPWD_REPROBE_ANSWERED;
+    }
+
+    /* Same rule as the plugin: three silent probes resolve the conflict */
+    if (++conflict->misses >= 3)
+    {
+        conflict->resolved = 1;
+        ipwd_reprober_remove(env->reprober, &conflict->reprobe);
+        return IPWD_REPROBE_DONE;
+    }
+    return IPWD_REPROBE_SILENT;
+}
+
+static void env_init(TEST_ENV *env, unsigned int seed)
+{
+    memset(env, 0, sizeof(*env));
+    env->reprober = ipwd_reprober_new(on_probe, on_check, env, seed);
+    env->now = 1000000;
+    env->ordered = 1;
+    CHECK(env->reprober != NULL);
+}
+
+/* Jump the clock from deadline to deadline until until, like the loop timer */
+static void advance(TEST_ENV *env, uint64_t until)
+{
+    uint64_t next;
+    while ((next = ipwd_reprober_next(env->reprober)) <= until)
+    {
+        CHECK(next >= env->now);
+        env->now = next;
+        ipwd_reprober_run(env->reprober, env->now);
+    }
+    env->now = until;
+}
+
+static uint64_t interval(int backoff)
+{
+    uint64_t usec = IPWD_REPROBE_INTERVAL_USEC;
+    while (backoff-- > 0 && usec < IPWD_REPROBE_MAX_INTERVAL_USEC)
+        usec *= 2;
+    return usec < IPWD_REPROBE_MAX_INTERVAL_USEC ? usec : IPWD_REPROBE_MAX_INTERVAL_USEC;
+}
+
+static int within_jitter(uint64_t gap, uint64_t expected)
+{
+    uint64_t spread = expected * IPWD_REPROBE_JITTER_PERCENT / 100;
+    return gap >= expected - spread && gap <= expected + spread;
+}
+
+static void test_backoff_while_answered(void)
+{
+    TEST_ENV env;
+    TEST_CONFLICT conflict;
+    env_init(&env, 1);
+    memset(&conflict, 0, sizeof(conflict));
+    conflict.answers = -1;
+
+    uint64_t added = env.now;
+    CHECK(ipwd_reprober_add(env.reprober, &conflict.reprobe, &conflict, env.now) == 0);
+    advance(&env, added + 600000000ULL);
+
+    /* First probe one jittered base interval after the conflict was recorded */
+    CHECK(within_jitter(conflict.probe_time[0] - added, IPWD_REPROBE_INTERVAL_USEC));
+
+    /* Every check closes the window, then the interval doubles up to the cap */
+    int capped = 0;
+    for (int i = 0; i + 1 < conflict.probes && i + 1 < TEST_MAX_PROBES; i++)
+    {
+        CHECK(conflict.check_time[i] - conflict.probe_time[i] == IPWD_REPROBE_WINDOW_USEC);
+        uint64_t gap = conflict.probe_time[i + 1] - conflict.check_time[i];
+        CHECK(within_jitter(gap, interval(i + 1)));
+        capped += interval(i + 1) == IPWD_REPROBE_MAX_INTERVAL_USEC;
+    }
+    CHECK(capped > 0);
+
+    /* Ten minutes of a persistent conflict: 5+10+20+40 s, then every 80 s */
+    CHECK(conflict.probes >= 8 && conflict.probes <= 10);
+    printf("answered conflict: %d probes in 600 s, intervals", conflict.probes);
+    for (int i = 0; i + 1 < conflict.probes && i + 1 < TEST_MAX_PROBES; i++)
+        printf(" %.1f", (conflict.probe_time[i + 1] - conflict.check_time[i]) / 1e6);
+    printf(" s\n");
+
+    ipwd_reprober_remove(env.reprober, &conflict.reprobe);
+    CHECK(ipwd_reprober_next(env.reprober) == IPWD_REPROBE_NEVER);
+    ipwd_reprober_free(env.reprober);
+}
+
+static void test_silence_resets_backoff_and_resolves(void)
+{
+    TEST_ENV env;
+    TEST_CONFLICT conflict;
+    env_init(&env, 2);
+    memset(&conflict, 0, sizeof(conflict));
+    conflict.answers = 3;
+
+    CHECK(ipwd_reprober_add(env.reprober, &conflict.reprobe, &conflict, env.now) == 0);
+    advance(&env, env.now + 600000000ULL);
+
+    /* Three answers back off, the first silent check falls back to the base interval */
+    CHECK(conflict.resolved == 1);
+    CHECK(conflict.probes == 6);
+    CHECK(within_jitter(conflict.probe_time[3] - conflict.check_time[2], interval(3)));
+    CHECK(within_jitter(conflict.probe_time[4] - conflict.check_time[3], interval(0)));
+    CHECK(within_jitter(conflict.probe_time[5] - conflict.check_time[4], interval(0)));
+
+    /* Nothing left to wake up for */
+    CHECK(ipwd_reprober_next(env.reprober) == IPWD_REPROBE_NEVER);
+    ipwd_reprober_free(env.reprober);
+}
+
+static void test_failed_probe_retries_without_window(void)
+{
+    TEST_ENV env;
+    TEST_CONFLICT conflict;
+    env_init(&env, 3);
+    memset(&conflict, 0, sizeof(conflict));
+    conflict.answers = -1;
+    conflict.probe_fails = 2;
+
+    uint64_t added = env.now;
+    CHECK(ipwd_reprober_add(env.reprober, &conflict.reprobe, &conflict, env.now) == 0);
+    advance(&env, added + 4 * IPWD_REPROBE_INTERVAL_USEC);
+
+    /* Two failed attempts a base interval apart, then the probe goes out */
+    CHECK(conflict.probes == 1);
+    CHECK(conflict.probe_time[0] - added >= 3 * (IPWD_REPROBE_INTERVAL_USEC * (100 - IPWD_REPROBE_JITTER_PERCENT) / 100));
+
+    ipwd_reprober_free(env.reprober);
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void test_jitter_spreads_conflicts(void)
+{
+    TEST_ENV env;
+    static TEST_CONFLICT conflicts[TEST_CONFLICTS];
+    uint64_t first[TEST_CONFLICTS];
+    env_init(&env, 4);
+    memset(conflicts, 0, sizeof(conflicts));
+
+    /* A spoofing burst records many conflicts at the same instant */
+    uint64_t added = env.now;
+    for (int i = 0; i < TEST_CONFLICTS; i++)
+    {
+        conflicts[i].answers = -1;
+        CHECK(ipwd_reprober_add(env.reprober, &conflicts[i].reprobe, &conflicts[i], env.now) == 0);
+    }
+
+    /* Unscheduling some, including ones never added, keeps the rest in order */
+    TEST_CONFLICT never_added;
+    memset(&never_added, 0, sizeof(never_added));
+    ipwd_reprober_remove(env.reprober, &never_added.reprobe);
+    for (int i = 0; i < TEST_CONFLICTS; i += 10)
+        ipwd_reprober_remove(env.reprober, &conflicts[i].reprobe);
+
+    advance(&env, added + 2 * IPWD_REPROBE_INTERVAL_USEC);
+    CHECK(env.ordered);
+
+    int n = 0;
+    for (int i = 0; i < TEST_CONFLICTS; i++)
+    {
+        if (i % 10 == 0)
+        {
+            CHECK(conflicts[i].probes == 0);
+            continue;
+        }
+        CHECK(conflicts[i].probes == 1);
+        CHECK(within_jitter(conflicts[i].probe_time[0] - added, IPWD_REPROBE_INTERVAL_USEC));
+        first[n++] = conflicts[i].probe_time[0];
+    }
+
+    /* Probes spread over the jitter range instead of one burst */
+    qsort(first, n, sizeof(first[0]), compare_u64);
+    int distinct = 1;
+    for (int i = 1; i < n; i++)
+        distinct += first[i] != first[i - 1];
+    uint64_t span = first[n - 1] - first[0];
+    CHECK(distinct > n * 9 / 10);
+    CHECK(span > IPWD_REPROBE_INTERVAL_USEC * IPWD_REPROBE_JITTER_PERCENT / 100);
+    printf("%d conflicts recorded together: first probes spread over %.2f s\n", n, span / 1e6);
+
+    ipwd_reprober_free(env.reprober);
+}
+
+int main(void)
+{
+    test_backoff_while_answered();
+    test_silence_resets_backoff_and_resolves();
+    test_failed_probe_retries_without_window();
+    test_jitter_spreads_conflicts();
+
+    if (failures)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All re-probe tests passed\n");
+    return 0;
+}
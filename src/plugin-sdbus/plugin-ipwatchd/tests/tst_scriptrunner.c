@@ -0,0 +1,303 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * Conflict script runner with real child processes: small shell scripts
+ * append their arguments to a log next to them. Limits run on a simulated
+ * clock, while children are collected in real time the way the plugin's
+ * reap timer does it.
+ */
+
+#include "script_runner.h"
+#include "check.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+//! Conflicts in the flood
+#define TEST_FLOOD 100000
+
+//! Distinct (IP, MAC) pairs in the flood
+#define TEST_FLOOD_PAIRS 200
+
+//! Simulated length of the flood
+#define TEST_FLOOD_USEC 60000000ULL
+
+int debug_flag = 0;
+int syslog_flag = 0;
+
+static char dir[] = "/tmp/tst-ipwatchd-script-XXXXXX";
+
+static uint64_t wall_usec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/* Script appending its arguments to <path>.log, after sleeping delay seconds */
+static void write_script(char *path, size_t len, const char *name, int delay)
+{
+    snprintf(path, len, "%s/%s", dir, name);
+    FILE *f = fopen(path, "w");
+    CHECK(f != NULL);
+    if (!f)
+        return;
+    fprintf(f, "#!/bin/sh\n%s\necho \"$*\" >> \"$0.log\"\n", delay ? "sleep 1" : "");
+    fclose(f);
+    chmod(path, 0755);
+}
+
+static int count_lines(const char *script)
+{
+    char path[300];
+    snprintf(path, sizeof(path), "%s.log", script);
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return 0;
+
+    int lines = 0, c;
+    while ((c = fgetc(f)) != EOF)
+        lines += c == '\n';
+    fclose(f);
+    return lines;
+}
+
+/* Collect children in real time until none is left */
+static void wait_all(IPWD_S_SCRIPT_RUNNER *runner)
+{
+    uint64_t deadline = wall_usec() + 10000000ULL;
+    while (ipwd_script_runner_reap(runner) > 0 && wall_usec() < deadline)
+        usleep(10000);
+    CHECK(ipwd_script_runner_reap(runner) == 0);
+}
+
+static void pair(int i, in_addr_t *ip, uint8_t *mac)
+{
+    static const uint8_t base[6] = { 0x52, 0x54, 0x00, 0x00, 0x00, 0x00 };
+    memcpy(mac, base, 6);
+    mac[5] = (uint8_t)i;
+    mac[4] = (uint8_t)(i >> 8);
+    *ip = htonl(0xc0000200 + (uint32_t)(i % 250) + 1);
+}
+
+/* First line of the script's log */
+static void first_line(const char *script, char *line, size_t len)
+{
+    char log[300];
+    snprintf(log, sizeof(log), "%s.log", script);
+    line[0] = '\0';
+    FILE *f = fopen(log, "r");
+    CHECK(f != NULL);
+    if (f)
+    {
+        CHECK(fgets(line, (int)len, f) != NULL);
+        fclose(f);
+    }
+}
+
+static void test_arguments(void)
+{
+    char script[256], line[128];
+    write_script(script, sizeof(script), "args", 0);
+
+    /* The MAC in ether_ntoa form, as in the log and the D-Bus signals */
+    IPWD_S_SCRIPT_RUNNER *runner = ipwd_script_runner_new(script);
+    const uint8_t mac[6] = { 0x02, 0x00, 0x5e, 0x10, 0x00, 0x01 };
+    CHECK(ipwd_script_runner_run(runner, "eth0", inet_addr("192.0.2.1"), mac, 1000000) == IPWD_SCRIPT_STARTED);
+    wait_all(runner);
+    ipwd_script_runner_free(runner);
+
+    first_line(script, line, sizeof(line));
+    CHECK(strcmp(line, "eth0 192.0.2.1 2:0:5e:10:0:1\n") == 0);
+}
+
+static void test_command_arguments(void)
+{
+    char script[256], command[300], line[128];
+    write_script(script, sizeof(script), "cmd", 0);
+
+    /* Configured arguments come before the conflict's */
+    snprintf(command, sizeof(command), " %s\t--notify  now ", script);
+    IPWD_S_SCRIPT_RUNNER *runner = ipwd_script_runner_new(command);
+    CHECK(runner != NULL);
+    const uint8_t mac[6] = { 0x52, 0x54, 0x00, 0x12, 0x34, 0x56 };
+    CHECK(ipwd_script_runner_run(runner, "eth0", inet_addr("192.0.2.1"), mac, 1000000) == IPWD_SCRIPT_STARTED);
+    wait_all(runner);
+    ipwd_script_runner_free(runner);
+
+    first_line(script, line, sizeof(line));
+    CHECK(strcmp(line, "--notify now eth0 192.0.2.1 52:54:0:12:34:56\n") == 0);
+
+    errno = 0;
+    CHECK(ipwd_script_runner_new(" \t ") == NULL);
+    CHECK(errno == EINVAL);
+}
+
+static void test_duplicates(void)
+{
+    char script[256];
+    write_script(script, sizeof(script), "dup", 0);
+
+    IPWD_S_SCRIPT_RUNNER *runner = ipwd_script_runner_new(script);
+    const uint8_t mac[6] = { 0x52, 0x54, 0x00, 0x12, 0x34, 0x56 };
+    const uint8_t other[6] = { 0x52, 0x54, 0x00, 0x12, 0x34, 0x57 };
+    in_addr_t ip = inet_addr("192.0.2.1");
+    uint64_t now = 1000000;
+
+    CHECK(ipwd_script_runner_run(runner, "eth0", ip, mac, now) == IPWD_SCRIPT_STARTED);
+    CHECK(ipwd_script_runner_run(runner, "eth0", ip, mac, now + 1000000) == IPWD_SCRIPT_DUPLICATE);
+    CHECK(ipwd_script_runner_run(runner, "eth1", ip, mac, now + IPWD_SCRIPT_DEDUP_USEC - 1) == IPWD_SCRIPT_DUPLICATE);
+
+    /* Another remote host on the same address is a conflict of its own */
+    CHECK(ipwd_script_runner_run(runner, "eth0", ip, other, now + 1000000) == IPWD_SCRIPT_STARTED);
+    CHECK(ipwd_script_runner_run(runner, "eth0", ip, mac, now + IPWD_SCRIPT_DEDUP_USEC) == IPWD_SCRIPT_STARTED);
+
+    wait_all(runner);
+    CHECK(count_lines(script) == 3);
+    ipwd_script_runner_free(runner);
+}
+
+static void test_running_scripts_are_bounded(void)
+{
+    char script[256];
+    write_script(script, sizeof(script), "slow", 1);
+
+    IPWD_S_SCRIPT_RUNNER *runner = ipwd_script_runner_new(script);
+    uint64_t now = 1000000, longest = 0;
+    int outcomes[4] = { 0 };
+
+    for (int i = 0; i < IPWD_SCRIPT_MAX_RUNNING + 2; i++)
+    {
+        in_addr_t ip;
+        uint8_t mac[6];
+        pair(i, &ip, mac);
+
+        uint64_t start = wall_usec();
+        int rv = ipwd_script_runner_run(runner, "eth0", ip, mac, now);
+        uint64_t took = wall_usec() - start;
+        longest = took > longest ? took : longest;
+        CHECK(rv >= 0 && rv < 4);
+        if (rv >= 0 && rv < 4)
+            outcomes[rv]++;
+    }
+
+    /* Scripts sleep for a second, starting them must not wait for that */
+    CHECK(outcomes[IPWD_SCRIPT_STARTED] == IPWD_SCRIPT_MAX_RUNNING);
+    CHECK(outcomes[IPWD_SCRIPT_BUSY] == 2);
+    CHECK(longest < 500000);
+    printf("slow script: %d started, %d refused while busy, longest start %.1f ms\n",
+           outcomes[IPWD_SCRIPT_STARTED], outcomes[IPWD_SCRIPT_BUSY], longest / 1e3);
+
+    wait_all(runner);
+    CHECK(count_lines(script) == IPWD_SCRIPT_MAX_RUNNING);
+    ipwd_script_runner_free(runner);
+}
+
+static void test_flood(void)
+{
+    char script[256];
+    write_script(script, sizeof(script), "flood", 0);
+
+    IPWD_S_SCRIPT_RUNNER *runner = ipwd_script_runner_new(script);
+    uint64_t start_time = 1000000;
+    uint64_t longest = 0, wall_start = wall_usec();
+    int max_running = 0;
+    int outcomes[4] = { 0 };
+
+    /* A spoofing storm: conflicts for many pairs, each repeated many times */
+    for (int i = 0; i < TEST_FLOOD; i++)
+    {
+        in_addr_t ip;
+        uint8_t mac[6];
+        pair(i % TEST_FLOOD_PAIRS, &ip, mac);
+        uint64_t now = start_time + TEST_FLOOD_USEC * (uint64_t)i / TEST_FLOOD;
+
+        uint64_t start = wall_usec();
+        int rv = ipwd_script_runner_run(runner, "eth0", ip, mac, now);
+        uint64_t took = wall_usec() - start;
+        longest = took > longest ? took : longest;
+
+        CHECK(rv >= 0 && rv < 4);
+        if (rv >= 0 && rv < 4)
+            outcomes[rv]++;
+
+        int running = ipwd_script_runner_reap(runner);
+        max_running = running > max_running ? running : max_running;
+    }
+    uint64_t wall = wall_usec() - wall_start;
+
+    /* The burst, then one start per refill interval at most */
+    unsigned long bound = IPWD_SCRIPT_BURST + TEST_FLOOD_USEC / IPWD_SCRIPT_REFILL_USEC;
+    unsigned long started = ipwd_script_runner_started(runner);
+    CHECK(started == (unsigned long)outcomes[IPWD_SCRIPT_STARTED]);
+    CHECK(started > 0 && started <= bound);
+    CHECK(max_running <= IPWD_SCRIPT_MAX_RUNNING);
+    printf("%d conflicts over %llu s: %lu scripts started (bound %lu), %d duplicate, %d busy, %d rate limited, "
+           "longest call %.1f ms, %.2f s in total\n",
+           TEST_FLOOD, (unsigned long long)(TEST_FLOOD_USEC / 1000000), started, bound,
+           outcomes[IPWD_SCRIPT_DUPLICATE], outcomes[IPWD_SCRIPT_BUSY], outcomes[IPWD_SCRIPT_RATE_LIMITED],
+           longest / 1e3, wall / 1e6);
+
+    wait_all(runner);
+    CHECK(count_lines(script) == (int)started);
+    ipwd_script_runner_free(runner);
+}
+
+static void test_missing_script(void)
+{
+    char script[256];
+    snprintf(script, sizeof(script), "%s/missing", dir);
+
+    IPWD_S_SCRIPT_RUNNER *runner = ipwd_script_runner_new(script);
+    const uint8_t mac[6] = { 0x52, 0x54, 0x00, 0x12, 0x34, 0x56 };
+    CHECK(ipwd_script_runner_run(runner, "eth0", inet_addr("192.0.2.1"), mac, 1000000) == -ENOENT);
+    CHECK(ipwd_script_runner_started(runner) == 0);
+    CHECK(ipwd_script_runner_reap(runner) == 0);
+    ipwd_script_runner_free(runner);
+}
+
+static void remove_dir(void)
+{
+    static const char *names[] = { "args", "cmd", "dup", "slow", "flood" };
+    char path[256];
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+        unlink(path);
+        strncat(path, ".log", sizeof(path) - strlen(path) - 1);
+        unlink(path);
+    }
+    rmdir(dir);
+}
+
+int main(void)
+{
+    if (!mkdtemp(dir))
+    {
+        fprintf(stderr, "Unable to create %s: %s\n", dir, strerror(errno));
+        return 1;
+    }
+
+    test_arguments();
+    test_command_arguments();
+    test_duplicates();
+    test_running_scripts_are_bounded();
+    test_flood();
+    test_missing_script();
+    remove_dir();
+
+    if (failures)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All script runner tests passed\n");
+    return 0;
+}
@@ -28,10 +28,13 @@
 extern IPWD_S_DEVS devices;
 extern IPWD_S_CONFIG config;
 extern int testing_flag;
+extern int debug_flag;
 
 
 //! Callback for "pcap_loop" with standard parameters. Called when ARP packet is received (detection of conflict is done here).
 /*!
+ * Addresses are compared in binary form. Strings are only produced for
+ * messages, replies sent with ipwd_genarp and the user-defined script.
  * \param args Last parameter of pcap_loop
  * \param header Packet header
  * \param packet Packet data
@@ -45,80 +48,59 @@ void ipwd_analyse (u_char * args, const struct pcap_pkthdr *header, const u_char
 	int rv = 0;
 	int i = 0;
 
-	/* Get addresses from packet */
-	IPWD_S_ARP_HEADER *arpaddr;
-	arpaddr = (IPWD_S_ARP_HEADER *) (packet + IPWD_ARP_HEADER_SIZE);
-
-	/* Source IP address */
-	char rcv_sip[IPWD_MAX_DEVICE_ADDRESS_LEN];
-	char *p_rcv_sip = NULL;
-
-	/* Following variable was added because gcc 4.4.1 displayed warning: dereferencing type-punned pointer will break strict-aliasing rules */
-	struct in_addr * p_arp_spa = (struct in_addr *) &arpaddr->arp_spa;
-
-	if ((p_rcv_sip = inet_ntoa (*(p_arp_spa))) == NULL)
+	/* Ignore truncated packets */
+	if (header->caplen < IPWD_ARP_HEADER_SIZE + sizeof (IPWD_S_ARP_HEADER))
 	{
-		ipwd_message (IPWD_MSG_TYPE_ERROR, "Could not get source IP address from packet");
 		return;
 	}
 
-	memset (rcv_sip, '\0', IPWD_MAX_DEVICE_ADDRESS_LEN);
-	strncpy (rcv_sip, p_rcv_sip, IPWD_MAX_DEVICE_ADDRESS_LEN - 1);
-
-	/* Source MAC address */
-	char rcv_smac[IPWD_MAX_DEVICE_ADDRESS_LEN];
-	char *p_rcv_smac = NULL;
-
-	if ((p_rcv_smac = ether_ntoa ((const struct ether_addr *) &arpaddr->arp_sha)) == NULL)
-	{
-		ipwd_message (IPWD_MSG_TYPE_ERROR, "Could not get source MAC address from packet");
-		return;
-	}
+	/* Get addresses from packet */
+	const IPWD_S_ARP_HEADER *arpaddr;
+	arpaddr = (const IPWD_S_ARP_HEADER *) (packet + IPWD_ARP_HEADER_SIZE);
 
-	memset (rcv_smac, '\0', IPWD_MAX_DEVICE_ADDRESS_LEN);
-	strncpy (rcv_smac, p_rcv_smac, IPWD_MAX_DEVICE_ADDRESS_LEN - 1);
+	in_addr_t rcv_sip = 0;
+	in_addr_t rcv_dip = 0;
+	memcpy (&rcv_sip, arpaddr->arp_spa, sizeof (rcv_sip));
+	memcpy (&rcv_dip, arpaddr->arp_tpa, sizeof (rcv_dip));
 
-	/* Destination IP address */
-	char rcv_dip[IPWD_MAX_DEVICE_ADDRESS_LEN];
-	char *p_rcv_dip = NULL;
+	const u_int8_t *rcv_smac = arpaddr->arp_sha;
+	const u_int8_t *rcv_dmac = arpaddr->arp_tha;
 
-	/* Following variable was added because gcc 4.4.1 displayed warning: dereferencing type-punned pointer will break strict-aliasing rules */
-	struct in_addr * p_arp_tpa = (struct in_addr *) &arpaddr->arp_tpa;
+	/* String forms of source addresses, filled only when needed */
+	char rcv_sip_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
+	char rcv_smac_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
 
-	if ((p_rcv_dip = inet_ntoa (*(p_arp_tpa))) == NULL)
+	if (debug_flag)
 	{
-		ipwd_message (IPWD_MSG_TYPE_ERROR, "Could not get destination IP address from packet");
-		return;
+		char rcv_dip_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
+		char rcv_dmac_str[IPWD_MAX_DEVICE_ADDRESS_LEN];
+
+		ipwd_format_ip (rcv_sip, rcv_sip_str);
+		ipwd_format_mac (rcv_smac, rcv_smac_str);
+		ipwd_format_ip (rcv_dip, rcv_dip_str);
+		ipwd_format_mac (rcv_dmac, rcv_dmac_str);
+		ipwd_message (IPWD_MSG_TYPE_DEBUG, "Received ARP packet: S:%s-%s D:%s-%s", rcv_sip_str, rcv_smac_str, rcv_dip_str, rcv_dmac_str);
 	}
 
-	memset (rcv_dip, '\0', IPWD_MAX_DEVICE_ADDRESS_LEN);
-	strncpy (rcv_dip, p_rcv_dip, IPWD_MAX_DEVICE_ADDRESS_LEN - 1);
-
-	/* Destination MAC address */
-	char rcv_dmac[IPWD_MAX_DEVICE_ADDRESS_LEN];
-	char *p_rcv_dmac = NULL;
-
-	if ((p_rcv_dmac = ether_ntoa ((const struct ether_addr *) &arpaddr->arp_tha)) == NULL)
-	{
-		ipwd_message (IPWD_MSG_TYPE_ERROR, "Could not get destination MAC address from packet");
-		return;
-	}
-
-	memset (rcv_dmac, '\0', IPWD_MAX_DEVICE_ADDRESS_LEN);
-	strncpy (rcv_dmac, p_rcv_dmac, IPWD_MAX_DEVICE_ADDRESS_LEN - 1);
-
-	ipwd_message (IPWD_MSG_TYPE_DEBUG, "Received ARP packet: S:%s-%s D:%s-%s", rcv_sip, rcv_smac, rcv_dip, rcv_dmac);
-
 	/* Call hook for ARP packet processing */
 	if (ipwd_hook_on_arp_packet(rcv_sip, rcv_smac, rcv_dip, rcv_dmac) != 0)
 	{
 		return; /* Hook handled the packet, skip further processing */
 	}
 
+	/* Devices structure may be kept current by the hook, skip querying interfaces then */
+	int devices_cached = ipwd_hook_devices_cached();
+
 	/* Update devices structure with actual IP and MAC addresses of interfaces */
 	for (i = 0; i < devices.devnum; i++)
 	{
-		if (ipwd_devinfo (devices.dev[i].device, devices.dev[i].ip, devices.dev[i].mac) == IPWD_RV_ERROR)
+		if (devices_cached)
+		{
+			if (devices.dev[i].state == IPWD_DEVICE_STATE_UNUSABLE)
+				continue;
+		}
+		else if ((ipwd_devinfo (devices.dev[i].device, devices.dev[i].ip, devices.dev[i].mac) == IPWD_RV_ERROR)
+		         || (ipwd_devinfo_binary (&devices.dev[i]) == IPWD_RV_ERROR))
 		{
 			devices.dev[i].state = IPWD_DEVICE_STATE_UNUSABLE;
 			continue;
@@ -129,7 +111,7 @@ void ipwd_analyse (u_char * args, const struct pcap_pkthdr *header, const u_char
 		}
 
 		/* Ignore packets coming from local interfaces */
-		if (strcasecmp (rcv_smac, devices.dev[i].mac) == 0)
+		if (memcmp (rcv_smac, &devices.dev[i].hwaddr, ETH_ALEN) == 0)
 		{
 			return;
 		}
@@ -145,14 +127,18 @@ void ipwd_analyse (u_char * args, const struct pcap_pkthdr *header, const u_char
 		if (testing_flag == 0)
 		{
 			/* Check if received packet causes conflict with IP address of this interface */
-			if (!((strcasecmp (rcv_sip, devices.dev[i].ip) == 0) && (strcasecmp (rcv_smac, devices.dev[i].mac) != 0)))
+			if (!((rcv_sip == devices.dev[i].addr) && (memcmp (rcv_smac, &devices.dev[i].hwaddr, ETH_ALEN) != 0)))
 			{
 				/* Call hook for potential conflict resolution */
-				ipwd_hook_on_conflict_resolved(devices.dev[i].device, devices.dev[i].ip, devices.dev[i].mac, rcv_smac);
+				ipwd_hook_on_conflict_resolved(devices.dev[i].device, devices.dev[i].addr, (const u_int8_t *) &devices.dev[i].hwaddr, rcv_smac);
 				continue;
 			}
 		}
 
+		/* Conflicts are rare, format the remote addresses for messages and replies */
+		ipwd_format_ip (rcv_sip, rcv_sip_str);
+		ipwd_format_mac (rcv_smac, rcv_smac_str);
+
 		/* Get current system time */
 		if (gettimeofday (&current_time, NULL) != 0)
 		{
@@ -165,7 +151,7 @@ void ipwd_analyse (u_char * args, const struct pcap_pkthdr *header, const u_char
 		/* Check if current time is within the defend interval */
 		if (difference < config.defend_interval)
 		{
-			ipwd_message (IPWD_MSG_TYPE_ALERT, "MAC address %s causes IP conflict with address %s set on interface %s - no action taken because this happened within the defend interval", rcv_smac, devices.dev[i].ip, devices.dev[i].device);
+			ipwd_message (IPWD_MSG_TYPE_ALERT, "MAC address %s causes IP conflict with address %s set on interface %s - no action taken because this happened within the defend interval", rcv_smac_str, devices.dev[i].ip, devices.dev[i].device);
 			break;
 		}
 
@@ -176,27 +162,27 @@ void ipwd_analyse (u_char * args, const struct pcap_pkthdr *header, const u_char
 		/* Handle IP conflict */
 		if (devices.dev[i].mode == IPWD_PROTECTION_MODE_ACTIVE)
 		{
-			ipwd_message (IPWD_MSG_TYPE_ALERT, "MAC address %s causes IP conflict with address %s set on interface %s - active mode - reply sent", rcv_smac, devices.dev[i].ip, devices.dev[i].device);
+			ipwd_message (IPWD_MSG_TYPE_ALERT, "MAC address %s causes IP conflict with address %s set on interface %s - active mode - reply sent", rcv_smac_str, devices.dev[i].ip, devices.dev[i].device);
 
 			/* Send reply to conflicting system */
-			ipwd_genarp (devices.dev[i].device, devices.dev[i].ip, devices.dev[i].mac, rcv_sip, rcv_smac, ARPOP_REPLY);
+			ipwd_genarp (devices.dev[i].device, devices.dev[i].ip, devices.dev[i].mac, rcv_sip_str, rcv_smac_str, ARPOP_REPLY);
 
 			/* Send GARP request to update cache of our neighbours */
 			ipwd_genarp (devices.dev[i].device, devices.dev[i].ip, devices.dev[i].mac, devices.dev[i].ip, "ff:ff:ff:ff:ff:ff", ARPOP_REQUEST);
 		}
 		else
 		{
-			ipwd_message (IPWD_MSG_TYPE_ALERT, "MAC address %s causes IP conflict with address %s set on interface %s - passive mode - reply not sent", rcv_smac, devices.dev[i].ip, devices.dev[i].device);
+			ipwd_message (IPWD_MSG_TYPE_ALERT, "MAC address %s causes IP conflict with address %s set on interface %s - passive mode - reply not sent", rcv_smac_str, devices.dev[i].ip, devices.dev[i].device);
 		}
 
 		/* Call hook for conflict notification */
-		ipwd_hook_on_conflict(devices.dev[i].device, devices.dev[i].ip, devices.dev[i].mac, rcv_smac, 
+		ipwd_hook_on_conflict(devices.dev[i].device, devices.dev[i].addr, (const u_int8_t *) &devices.dev[i].hwaddr, rcv_smac, 
 		                      devices.dev[i].mode == IPWD_PROTECTION_MODE_ACTIVE);
 
-		if (config.script != NULL)
+		if (config.script != NULL && ipwd_hook_on_run_script (config.script, devices.dev[i].device, devices.dev[i].addr, rcv_smac) == 0)
 		{
 			/* Run user-defined script in form: script "dev" "ip" "mac" */
-			command_len = strlen (config.script) + 2 + strlen (devices.dev[i].device) + 3 + strlen (devices.dev[i].ip) + 3 + strlen (rcv_smac) + 2;
+			command_len = strlen (config.script) + 2 + strlen (devices.dev[i].device) + 3 + strlen (devices.dev[i].ip) + 3 + strlen (rcv_smac_str) + 2;
 
 			if ((command = (char *) malloc (command_len * sizeof (char))) == NULL)
 			{
@@ -204,7 +190,7 @@ void ipwd_analyse (u_char * args, const struct pcap_pkthdr *header, const u_char
 				break;
  			}
 
-			snprintf (command, command_len, "%s \"%s\" \"%s\" \"%s\"", config.script, devices.dev[i].device, devices.dev[i].ip, rcv_smac);
+			snprintf (command, command_len, "%s \"%s\" \"%s\" \"%s\"", config.script, devices.dev[i].device, devices.dev[i].ip, rcv_smac_str);
 
 			rv = system (command);
 			if (rv == -1)
@@ -223,4 +209,3 @@ void ipwd_analyse (u_char * args, const struct pcap_pkthdr *header, const u_char
 
 	}
 }
-
@@ -75,6 +75,7 @@ int ipwd_read_config (const char *filename)
 	char errbuf[PCAP_ERRBUF_SIZE];
 
 	int iface_len = 0;
+	size_t value_len = 0;
 
 	// Initialize structures with default values
 	config.facility = LOG_DAEMON;
@@ -221,12 +222,22 @@ int ipwd_read_config (const char *filename)
 			}
 		}
 
-		/* Path to user-defined script */
+		/* Path to user-defined script, optionally followed by its arguments */
 		if (strcasecmp (variable, "user_script") == 0)
 		{
-			if (ipwd_file_exists (value) == IPWD_RV_ERROR)
+			char script_path[400];
+
+			sscanf (line, "%*s %399[^\n]", value);
+			value_len = strlen (value);
+			while ((value_len > 0) && ((value[value_len - 1] == ' ') || (value[value_len - 1] == '\t')))
+			{
+				value[--value_len] = '\0';
+			}
+
+			sscanf (value, "%399s", script_path);
+			if (ipwd_file_exists (script_path) == IPWD_RV_ERROR)
 			{
-				ipwd_message (IPWD_MSG_TYPE_ERROR, "Configuration parse error : file %s specified as user_script does not exist", value);
+				ipwd_message (IPWD_MSG_TYPE_ERROR, "Configuration parse error : file %s specified as user_script does not exist", script_path);
 				return (IPWD_RV_ERROR);
 			}
 	
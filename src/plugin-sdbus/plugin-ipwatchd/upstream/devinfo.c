@@ -113,6 +113,35 @@ int ipwd_devinfo (const char *p_dev, char *p_ip, char *p_mac)
 }
 
 
+//! Fills binary forms of IP and MAC addresses of device from their string forms
+/*!
+ * \param dev Device with ip and mac strings filled by ipwd_devinfo
+ * \return IPWD_RV_SUCCESS if successful IPWD_RV_ERROR otherwise
+ */
+int ipwd_devinfo_binary (IPWD_S_DEV * dev)
+{
+
+	struct in_addr addr;
+
+	if (inet_pton (AF_INET, dev->ip, &addr) != 1)
+	{
+		ipwd_message (IPWD_MSG_TYPE_ERROR, "Could not convert IP address %s of the device \"%s\"", dev->ip, dev->device);
+		return (IPWD_RV_ERROR);
+	}
+
+	if (ether_aton_r (dev->mac, &dev->hwaddr) == NULL)
+	{
+		ipwd_message (IPWD_MSG_TYPE_ERROR, "Could not convert MAC address %s of the device \"%s\"", dev->mac, dev->device);
+		return (IPWD_RV_ERROR);
+	}
+
+	dev->addr = addr.s_addr;
+
+	return (IPWD_RV_SUCCESS);
+
+}
+
+
 //! Gets list of available network interfaces and fills devices structure with acquired information
 /*!
  * Based on example from: http://www.doctort.org/adam/nerd-notes/enumerating-network-interfaces-on-linux.html
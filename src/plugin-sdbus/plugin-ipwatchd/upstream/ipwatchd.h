@@ -137,6 +137,8 @@ typedef struct
 	IPWD_DEVICE_STATE state;					/**< Indicates if device should be used in conflict detection process */
 	char ip[IPWD_MAX_DEVICE_ADDRESS_LEN];		/**< IP address of device */
 	char mac[IPWD_MAX_DEVICE_ADDRESS_LEN];		/**< MAC address of device */
+	in_addr_t addr;								/**< IP address of device in binary form (network byte order) */
+	struct ether_addr hwaddr;					/**< MAC address of device in binary form */
 	IPWD_PROTECTION_MODE mode;					/**< IPwatch mode on interface */
 	struct timeval time;						/**< Time information indicating when the last conflict was detected */
 }
@@ -189,6 +191,7 @@ int ipwd_check_pidfile (void);
 
 /* devinfo.c */
 int ipwd_devinfo (const char *p_dev, char *p_ip, char *p_mac);
+int ipwd_devinfo_binary (IPWD_S_DEV * dev);
 int ipwd_fill_devices (void);
 
 /* genarp.c */
@@ -199,6 +202,8 @@ void ipwd_print_help (void);
 
 /* message.c */
 void ipwd_message (IPWD_MSG_TYPE type, const char *format, ...);
+char *ipwd_format_ip (in_addr_t ip, char *buf);
+char *ipwd_format_mac (const u_int8_t * mac, char *buf);
 
 /* signal.c */
 int ipwd_set_signal_handler (void);
@@ -107,3 +107,40 @@ void ipwd_message (IPWD_MSG_TYPE type, const char *format, ...)
 
 }
 
+
+//! Formats IP address for messages
+/*!
+ * Reentrant replacement of inet_ntoa, safe to use from several threads.
+ * \param ip IP address in network byte order
+ * \param buf Buffer of at least IPWD_MAX_DEVICE_ADDRESS_LEN bytes
+ * \return buf
+ */
+char *ipwd_format_ip (in_addr_t ip, char *buf)
+{
+
+	struct in_addr addr;
+	addr.s_addr = ip;
+
+	if (inet_ntop (AF_INET, &addr, buf, IPWD_MAX_DEVICE_ADDRESS_LEN) == NULL)
+	{
+		buf[0] = '\0';
+	}
+
+	return (buf);
+
+}
+
+
+//! Formats MAC address for messages
+/*!
+ * Produces the same form as ether_ntoa, without its static buffer.
+ * \param mac MAC address (ETH_ALEN bytes)
+ * \param buf Buffer of at least IPWD_MAX_DEVICE_ADDRESS_LEN bytes
+ * \return buf
+ */
+char *ipwd_format_mac (const u_int8_t * mac, char *buf)
+{
+
+	return (ether_ntoa_r ((const struct ether_addr *) mac, buf));
+
+}